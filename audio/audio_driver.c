@@ -131,6 +131,120 @@ static void compute_audio_buffer_statistics(void)
    RARCH_LOG("Amount of time spent close to underrun: %.2f %%. Close to blocking: %.2f %%.\n",
          (100.0 * low_water_count) / (samples - 1),
          (100.0 * high_water_count) / (samples - 1));
+   RARCH_LOG("Audio buffer ran empty %u times, final rate adjustment: %.6f.\n",
+         g_extern.audio_data.rate.underruns, g_extern.audio_data.rate.adjust);
+}
+
+/**
+ * audio_driver_readjust_input_rate:
+ *
+ * Dynamic rate control. Nudges the resampling ratio so the
+ * driver buffer converges on AUDIO_RATE_CONTROL_TARGET_FILL.
+ *
+ * The proportional term reacts to jitter like the old controller
+ * did, the integral term slowly learns the clock mismatch between
+ * core and audio device, so the buffer settles at the target instead
+ * of wherever the two happen to balance. That leaves the full buffer
+ * as headroom, which is what makes a small audio_latency usable.
+ * Both terms are limited to audio_rate_control_delta.
+ **/
+void audio_driver_readjust_input_rate(void)
+{
+   double error, proportional, adjust;
+   unsigned write_idx   = g_extern.measure_data.buffer_free_samples_count++ &
+      (AUDIO_BUFFER_FREE_SAMPLES_COUNT - 1);
+   size_t buffer_size   = g_extern.audio_data.driver_buffer_size;
+   size_t avail         = driver.audio->write_avail(driver.audio_data);
+   double max_delta     = g_settings.audio.rate_control_delta;
+
+   if (avail > buffer_size)
+      avail = buffer_size;
+
+   g_extern.measure_data.buffer_free_samples[write_idx] = avail;
+
+   /* A drained buffer means the device either underran already
+    * or is about to. Count every time we find it empty. */
+   if (avail == buffer_size)
+   {
+      if (!g_extern.audio_data.rate.empty)
+         g_extern.audio_data.rate.underruns++;
+      g_extern.audio_data.rate.empty = true;
+   }
+   else
+      g_extern.audio_data.rate.empty = false;
+
+   g_extern.audio_data.rate.fill = 1.0f - (float)avail / buffer_size;
+
+   /* Positive when the buffer is emptier than the target,
+    * i.e. we must produce more samples. Range is [-1, 1]. */
+   error = (double)(AUDIO_RATE_CONTROL_TARGET_FILL -
+         g_extern.audio_data.rate.fill) /
+      (1.0 - AUDIO_RATE_CONTROL_TARGET_FILL);
+   proportional = max_delta * error;
+
+   /* Only integrate while the output isn't saturated in the
+    * same direction, so the integral can't wind up. */
+   adjust = proportional + g_extern.audio_data.rate.integral;
+   if ((adjust < max_delta || error < 0.0) &&
+         (adjust > -max_delta || error > 0.0))
+   {
+      g_extern.audio_data.rate.integral += max_delta * error *
+         AUDIO_RATE_CONTROL_INTEGRAL_GAIN;
+      g_extern.audio_data.rate.integral = max(-max_delta,
+            min(max_delta, g_extern.audio_data.rate.integral));
+   }
+
+   adjust = proportional + g_extern.audio_data.rate.integral;
+   adjust = max(-max_delta, min(max_delta, adjust));
+
+   g_extern.audio_data.rate.adjust = 1.0 + adjust;
+   g_extern.audio_data.src_ratio   = g_extern.audio_data.orig_src_ratio *
+      g_extern.audio_data.rate.adjust;
+}
+
+/**
+ * audio_driver_get_stats:
+ * @stats              : filled with the current telemetry.
+ *
+ * Gets the state of dynamic rate control and the DSP thread.
+ * Fill level and latency are as of the last audio flush.
+ *
+ * Returns: true (1) if either is active, otherwise false (0).
+ **/
+bool audio_driver_get_stats(struct audio_driver_stats *stats)
+{
+   unsigned frame_size;
+
+   if (!stats || !driver.audio_active)
+      return false;
+
+   memset(stats, 0, sizeof(*stats));
+
+#ifdef HAVE_THREADS
+   if (g_extern.audio_data.dsp_thread)
+   {
+      stats->dsp_thread            = true;
+      stats->dsp_thread_latency_ms =
+         audio_dsp_thread_latency(g_extern.audio_data.dsp_thread);
+   }
+#endif
+
+   if (!g_extern.audio_data.rate_control || !g_settings.audio.out_rate)
+      return stats->dsp_thread;
+
+   frame_size = 2 * (g_extern.audio_data.use_float ?
+         sizeof(float) : sizeof(int16_t));
+
+   stats->rate_control = true;
+
+   stats->buffer_fill = g_extern.audio_data.rate.fill;
+   stats->ratio       = g_extern.audio_data.rate.adjust;
+   stats->underruns   = g_extern.audio_data.rate.underruns;
+   stats->latency_ms  = 1000.0f * g_extern.audio_data.rate.fill *
+      g_extern.audio_data.driver_buffer_size / frame_size /
+      g_settings.audio.out_rate;
+
+   return true;
 }
 
 /**
@@ -231,11 +345,19 @@ void find_audio_driver(void)
 
 void uninit_audio(void)
 {
+#ifdef HAVE_THREADS
+   /* Stop the worker before the driver and resampler go away. */
+   audio_dsp_thread_free(g_extern.audio_data.dsp_thread);
+   g_extern.audio_data.dsp_thread = NULL;
+#endif
+
    if (driver.audio_data && driver.audio)
       driver.audio->free(driver.audio_data);
 
    free(g_extern.audio_data.conv_outsamples);
    g_extern.audio_data.conv_outsamples = NULL;
+   free(g_extern.audio_data.sample_buf);
+   g_extern.audio_data.sample_buf      = NULL;
    g_extern.audio_data.data_ptr        = 0;
 
    free(g_extern.audio_data.rewind_buf);
@@ -278,6 +400,8 @@ void init_audio(void)
    /* Used for recording even if audio isn't enabled. */
    rarch_assert(g_extern.audio_data.conv_outsamples =
          (int16_t*)malloc(outsamples_max * sizeof(int16_t)));
+   rarch_assert(g_extern.audio_data.sample_buf =
+         (int16_t*)malloc(max_bufsamples * sizeof(int16_t)));
 
    g_extern.audio_data.block_chunk_size    = AUDIO_CHUNK_SIZE_BLOCKING;
    g_extern.audio_data.nonblock_chunk_size = AUDIO_CHUNK_SIZE_NONBLOCKING;
@@ -349,15 +473,18 @@ void init_audio(void)
 
    if (!rarch_resampler_realloc(&driver.resampler_data,
             &driver.resampler,
-         g_settings.audio.resampler, g_extern.audio_data.orig_src_ratio))
+         g_settings.audio.resampler,
+         (enum resampler_quality)g_settings.audio.resampler_quality,
+         g_extern.audio_data.orig_src_ratio))
    {
       RARCH_ERR("Failed to initialize resampler \"%s\".\n",
             g_settings.audio.resampler);
       driver.audio_active = false;
    }
 
+   /* Only holds one block at a time. */
    rarch_assert(g_extern.audio_data.data = (float*)
-         malloc(max_bufsamples * sizeof(float)));
+         malloc(AUDIO_BLOCK_FRAMES * 2 * sizeof(float)));
 
    g_extern.audio_data.data_ptr = 0;
 
@@ -380,9 +507,24 @@ void init_audio(void)
          RARCH_WARN("Audio rate control was desired, but driver does not support needed features.\n");
    }
 
-   rarch_main_command(RARCH_CMD_DSP_FILTER_DEINIT);
+   rarch_main_command(RARCH_CMD_DSP_FILTER_INIT);
 
    g_extern.measure_data.buffer_free_samples_count = 0;
+   memset(&g_extern.audio_data.rate, 0, sizeof(g_extern.audio_data.rate));
+   g_extern.audio_data.rate.adjust = 1.0;
+
+#ifdef HAVE_THREADS
+   if (driver.audio_active && g_settings.audio.dsp_thread &&
+         !g_extern.system.audio_callback.callback)
+   {
+      g_extern.audio_data.dsp_thread = audio_dsp_thread_new(
+            max_bufsamples, outsamples_max, g_extern.audio_data.use_float);
+      if (g_extern.audio_data.dsp_thread)
+         RARCH_LOG("Running DSP and resampler on a separate thread.\n");
+      else
+         RARCH_WARN("Failed to start DSP thread, continuing without it.\n");
+   }
+#endif
 
    if (driver.audio_active && !g_settings.audio.mute_enable &&
          g_extern.system.audio_callback.callback)
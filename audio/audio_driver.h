@@ -119,6 +119,43 @@ const char *audio_driver_find_ident(int index);
  **/
 const char* config_get_audio_driver_options(void);
 
+/* Dynamic rate control telemetry. */
+struct audio_driver_stats
+{
+   /* The rate control fields are only valid if this is set. */
+   bool rate_control;
+   /* Driver buffer fill level, 0.0 to 1.0. */
+   float buffer_fill;
+   /* Current adjustment of the resampling ratio. */
+   double ratio;
+   /* Times the driver buffer was found drained. */
+   unsigned underruns;
+   /* Audio queued in the driver buffer. */
+   float latency_ms;
+
+   bool dsp_thread;
+   /* Time audio spends in the DSP thread queues. */
+   float dsp_thread_latency_ms;
+};
+
+/**
+ * audio_driver_readjust_input_rate:
+ *
+ * Adjusts the resampling ratio towards the target
+ * buffer fill. Called once per audio flush when
+ * rate control is active.
+ **/
+void audio_driver_readjust_input_rate(void);
+
+/**
+ * audio_driver_get_stats:
+ * @stats              : filled with the current telemetry.
+ *
+ * Returns: true (1) if rate control or the DSP thread is active,
+ * otherwise false (0).
+ **/
+bool audio_driver_get_stats(struct audio_driver_stats *stats);
+
 void find_audio_driver(void);
 
 void uninit_audio(void);
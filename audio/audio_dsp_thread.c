@@ -0,0 +1,324 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "audio_dsp_thread.h"
+#include "audio_utils.h"
+#include <rthreads/rthreads.h>
+#include <queues/fifo_spsc.h>
+#include "../general.h"
+#include "../performance.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Audio in both queues is framed by one of these. */
+struct audio_dsp_packet
+{
+   size_t samples;
+   double ratio;
+   retro_time_t time;
+};
+
+struct audio_dsp_thread
+{
+   sthread_t *thread;
+
+   /* Held by the worker while it uses the DSP filter
+    * and resampler. */
+   slock_t *lock;
+
+   /* Float samples from the emulation thread to the worker,
+    * and finished samples in driver format back. */
+   fifo_spsc_t *in;
+   fifo_spsc_t *out;
+
+   bool use_float;
+   size_t max_samples;
+   size_t max_out_samples;
+
+   /* Emulation thread buffers. */
+   float *push_buf;
+   void *write_buf;
+
+   /* Worker buffers. */
+   float *in_buf;
+   float *resampled;
+   int16_t *converted;
+
+   float latency;
+};
+
+/**
+ * audio_dsp_thread_process:
+ * @thr                  : DSP thread handle.
+ * @samples              : amount of samples in thr->in_buf.
+ * @ratio                : resampling ratio.
+ *
+ * Same pipeline as audio_flush_blocks(), one AUDIO_BLOCK_FRAMES
+ * block at a time through DSP and resampler.
+ *
+ * Returns: amount of samples in thr->resampled.
+ **/
+static size_t audio_dsp_thread_process(audio_dsp_thread_t *thr,
+      size_t samples, double ratio)
+{
+   size_t i;
+   size_t out_samples = 0;
+
+   slock_lock(thr->lock);
+
+   for (i = 0; i < samples; i += AUDIO_BLOCK_FRAMES * 2)
+   {
+      struct resampler_data src_data = {0};
+      struct rarch_dsp_data dsp_data = {0};
+      size_t block = samples - i;
+
+      if (block > AUDIO_BLOCK_FRAMES * 2)
+         block = AUDIO_BLOCK_FRAMES * 2;
+
+      src_data.data_in      = thr->in_buf + i;
+      src_data.input_frames = block >> 1;
+
+      if (g_extern.audio_data.dsp)
+      {
+         dsp_data.input        = thr->in_buf + i;
+         dsp_data.input_frames = block >> 1;
+
+         rarch_dsp_filter_process(g_extern.audio_data.dsp, &dsp_data);
+
+         if (dsp_data.output)
+         {
+            src_data.data_in      = dsp_data.output;
+            src_data.input_frames = dsp_data.output_frames;
+         }
+      }
+
+      src_data.data_out = thr->resampled + out_samples;
+      src_data.ratio    = ratio;
+
+      rarch_resampler_process(driver.resampler,
+            driver.resampler_data, &src_data);
+
+      out_samples += src_data.output_frames * 2;
+   }
+
+   slock_unlock(thr->lock);
+
+   return out_samples;
+}
+
+static void audio_dsp_thread_loop(void *data)
+{
+   audio_dsp_thread_t *thr = (audio_dsp_thread_t*)data;
+
+   for (;;)
+   {
+      struct audio_dsp_packet packet;
+      const void *out;
+      size_t out_size;
+
+      if (!fifo_spsc_wait_read(thr->in, sizeof(packet), -1))
+         break;
+      fifo_spsc_read(thr->in, &packet, sizeof(packet));
+
+      /* The samples follow right behind the header. */
+      if (!fifo_spsc_wait_read(thr->in, packet.samples * sizeof(float), -1))
+         break;
+      fifo_spsc_read(thr->in, thr->in_buf, packet.samples * sizeof(float));
+
+      packet.samples = audio_dsp_thread_process(thr,
+            packet.samples, packet.ratio);
+
+      if (thr->use_float)
+      {
+         out      = thr->resampled;
+         out_size = packet.samples * sizeof(float);
+      }
+      else
+      {
+         audio_convert_float_to_s16(thr->converted,
+               thr->resampled, packet.samples);
+         out      = thr->converted;
+         out_size = packet.samples * sizeof(int16_t);
+      }
+
+      if (!fifo_spsc_wait_write(thr->out, sizeof(packet) + out_size, -1))
+         break;
+      fifo_spsc_write(thr->out, &packet, sizeof(packet));
+      fifo_spsc_write(thr->out, out, out_size);
+   }
+}
+
+/**
+ * audio_dsp_thread_drain:
+ * @thr                  : DSP thread handle.
+ *
+ * Writes everything the worker has finished to the audio driver.
+ *
+ * Returns: false (0) if the audio driver failed, otherwise true (1).
+ **/
+static bool audio_dsp_thread_drain(audio_dsp_thread_t *thr)
+{
+   size_t sample_size = thr->use_float ? sizeof(float) : sizeof(int16_t);
+
+   while (fifo_spsc_read_avail(thr->out) >= sizeof(struct audio_dsp_packet))
+   {
+      struct audio_dsp_packet packet;
+      size_t size;
+      float latency;
+
+      fifo_spsc_read(thr->out, &packet, sizeof(packet));
+
+      size = packet.samples * sample_size;
+      fifo_spsc_wait_read(thr->out, size, -1);
+      fifo_spsc_read(thr->out, thr->write_buf, size);
+
+      latency       = (rarch_get_time_usec() - packet.time) / 1000.0f;
+      thr->latency += (latency - thr->latency) / 16.0f;
+
+      if (size && driver.audio->write(driver.audio_data,
+               thr->write_buf, size) < 0)
+         return false;
+   }
+
+   return true;
+}
+
+bool audio_dsp_thread_push(audio_dsp_thread_t *thr,
+      const int16_t *data, size_t samples, double ratio)
+{
+   struct audio_dsp_packet packet;
+   size_t size;
+
+   if (samples > thr->max_samples)
+      samples = thr->max_samples;
+
+   packet.samples = samples;
+   packet.ratio   = ratio;
+   packet.time    = rarch_get_time_usec();
+   size           = sizeof(packet) + samples * sizeof(float);
+
+   RARCH_PERFORMANCE_INIT(audio_dsp_thread_push);
+   RARCH_PERFORMANCE_START(audio_dsp_thread_push);
+
+   audio_convert_s16_to_float(thr->push_buf, data, samples,
+         g_extern.audio_data.volume_gain);
+
+   /* The worker might be waiting for us to drain its output,
+    * so keep doing that while waiting for room. */
+   while (fifo_spsc_write_avail(thr->in) < size)
+   {
+      if (!audio_dsp_thread_drain(thr))
+      {
+         RARCH_PERFORMANCE_STOP(audio_dsp_thread_push);
+         return false;
+      }
+      fifo_spsc_wait_write(thr->in, size, 1000);
+   }
+
+   fifo_spsc_write(thr->in, &packet, sizeof(packet));
+   fifo_spsc_write(thr->in, thr->push_buf, samples * sizeof(float));
+
+   RARCH_PERFORMANCE_STOP(audio_dsp_thread_push);
+
+   return audio_dsp_thread_drain(thr);
+}
+
+void audio_dsp_thread_lock(audio_dsp_thread_t *thr)
+{
+   if (thr)
+      slock_lock(thr->lock);
+}
+
+void audio_dsp_thread_unlock(audio_dsp_thread_t *thr)
+{
+   if (thr)
+      slock_unlock(thr->lock);
+}
+
+float audio_dsp_thread_latency(audio_dsp_thread_t *thr)
+{
+   return thr->latency;
+}
+
+audio_dsp_thread_t *audio_dsp_thread_new(size_t max_samples,
+      size_t max_out_samples, bool use_float)
+{
+   size_t sample_size      = use_float ? sizeof(float) : sizeof(int16_t);
+   audio_dsp_thread_t *thr = (audio_dsp_thread_t*)
+      calloc(1, sizeof(*thr));
+
+   if (!thr)
+      return NULL;
+
+   thr->use_float       = use_float;
+   thr->max_samples     = max_samples;
+   thr->max_out_samples = max_out_samples;
+
+   /* A few pushes worth of room both ways,
+    * so neither side waits on the other in normal operation. */
+   thr->in  = fifo_spsc_new(4 * (sizeof(struct audio_dsp_packet) +
+            max_samples * sizeof(float)));
+   thr->out = fifo_spsc_new(2 * (sizeof(struct audio_dsp_packet) +
+            max_out_samples * sample_size));
+
+   thr->lock      = slock_new();
+   thr->push_buf  = (float*)malloc(max_samples * sizeof(float));
+   thr->write_buf = malloc(max_out_samples * sample_size);
+   thr->in_buf    = (float*)malloc(max_samples * sizeof(float));
+   thr->resampled = (float*)malloc(max_out_samples * sizeof(float));
+   if (!use_float)
+      thr->converted = (int16_t*)malloc(max_out_samples * sizeof(int16_t));
+
+   if (!thr->in || !thr->out || !thr->lock || !thr->push_buf ||
+         !thr->write_buf || !thr->in_buf || !thr->resampled ||
+         (!use_float && !thr->converted))
+      goto error;
+
+   thr->thread = sthread_create(audio_dsp_thread_loop, thr);
+   if (!thr->thread)
+      goto error;
+
+   return thr;
+
+error:
+   audio_dsp_thread_free(thr);
+   return NULL;
+}
+
+void audio_dsp_thread_free(audio_dsp_thread_t *thr)
+{
+   if (!thr)
+      return;
+
+   if (thr->thread)
+   {
+      fifo_spsc_close(thr->in);
+      fifo_spsc_close(thr->out);
+      sthread_join(thr->thread);
+   }
+
+   fifo_spsc_free(thr->in);
+   fifo_spsc_free(thr->out);
+   if (thr->lock)
+      slock_free(thr->lock);
+
+   free(thr->push_buf);
+   free(thr->write_buf);
+   free(thr->in_buf);
+   free(thr->resampled);
+   free(thr->converted);
+   free(thr);
+}
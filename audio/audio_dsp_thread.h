@@ -0,0 +1,94 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RARCH_AUDIO_DSP_THREAD_H__
+#define RARCH_AUDIO_DSP_THREAD_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <boolean.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct audio_dsp_thread audio_dsp_thread_t;
+
+/**
+ * audio_dsp_thread_new:
+ * @max_samples          : largest amount of samples pushed at once.
+ * @max_out_samples      : largest amount of samples one push can
+ *                         turn into after DSP and resampling.
+ * @use_float            : output float samples instead of int16_t.
+ *
+ * Starts a worker thread which runs the DSP filter and the
+ * resampler on audio pushed with audio_dsp_thread_push().
+ *
+ * Returns: new DSP thread handle, or NULL on failure.
+ **/
+audio_dsp_thread_t *audio_dsp_thread_new(size_t max_samples,
+      size_t max_out_samples, bool use_float);
+
+/**
+ * audio_dsp_thread_free:
+ * @thr                  : DSP thread handle.
+ *
+ * Stops the worker and drops any audio still queued.
+ **/
+void audio_dsp_thread_free(audio_dsp_thread_t *thr);
+
+/**
+ * audio_dsp_thread_push:
+ * @thr                  : DSP thread handle.
+ * @data                 : audio samples from the core.
+ * @samples              : amount of samples.
+ * @ratio                : resampling ratio for these samples.
+ *
+ * Converts @data to float and queues it for the worker, then writes
+ * whatever the worker has finished to the audio driver. Blocks if
+ * the worker falls too far behind.
+ *
+ * Returns: false (0) if the audio driver failed, otherwise true (1).
+ **/
+bool audio_dsp_thread_push(audio_dsp_thread_t *thr,
+      const int16_t *data, size_t samples, double ratio);
+
+/**
+ * audio_dsp_thread_lock:
+ * @thr                  : DSP thread handle, can be NULL.
+ *
+ * Keeps the worker away from the DSP filter and resampler,
+ * e.g. while they are being replaced.
+ **/
+void audio_dsp_thread_lock(audio_dsp_thread_t *thr);
+
+void audio_dsp_thread_unlock(audio_dsp_thread_t *thr);
+
+/**
+ * audio_dsp_thread_latency:
+ * @thr                  : DSP thread handle.
+ *
+ * Returns: average time in milliseconds between pushing audio and
+ * writing it to the audio driver.
+ **/
+float audio_dsp_thread_latency(audio_dsp_thread_t *thr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,12 @@
+filters = 1
+filter0 = eq
+
+# Convolves with an impulse response, e.g. a speaker cabinet or a room.
+# See EQ.dsp for all options.
+eq_impulse_response = "impulse.wav"
+
+# Gain of the impulse response in dB.
+# eq_impulse_response_gain = 0.0
+
+# Latency is one partition, 64 frames by default.
+# eq_partition_size_log2 = 6
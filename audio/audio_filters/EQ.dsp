@@ -7,11 +7,16 @@ filter0 = eq
 # Lower values will allow better frequency resolution, but more ripple.
 # eq_window_beta = 4.0
 
-# The block size on which FFT is done.
-# Too high value requires more processing as well as longer latency but
-# allows finer-grained control over the spectrum.
+# Length of the designed filter.
+# Higher values allow finer-grained control over the spectrum,
+# at the cost of more processing and a longer linear phase delay.
 # eq_block_size_log2 = 8
 
+# The filter is applied in partitions of this size.
+# Smaller partitions lower latency and spread the work evenly,
+# larger ones are cheaper for long filters.
+# eq_partition_size_log2 = 6
+
 # An array of which frequencies to control.
 # You can create an arbitrary amount of these sampling points.
 # The EQ will try to create a frequency response which fits well to these points.
@@ -32,3 +37,11 @@ filter0 = eq
 # with one coefficient per line.
 # eq_impulse_response_output = "eq_impulse.txt"
 
+# Instead of designing a filter, convolve with an impulse response
+# loaded from a WAV file, e.g. a speaker cabinet or a room.
+# 16, 24 and 32-bit integer and 32-bit float PCM are supported.
+# A mono response is used for both channels.
+# eq_impulse_response = "/path/to/impulse.wav"
+
+# Gain of the loaded impulse response in dB.
+# eq_impulse_response_gain = 0.0
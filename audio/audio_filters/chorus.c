@@ -18,6 +18,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #ifndef M_PI
 #define M_PI 3.1415926535897932384626433832795
 #endif
@@ -27,7 +33,7 @@
 
 struct chorus_data
 {
-   float old[2][CHORUS_MAX_DELAY];
+   float old[CHORUS_MAX_DELAY][2];
    unsigned old_ptr;
 
    float delay;
@@ -68,13 +74,13 @@ static void chorus_process(void *data, struct dspfilter_output *output,
          delay_int = CHORUS_MAX_DELAY - 2;
       float delay_frac = delay - delay_int;
 
-      ch->old[0][ch->old_ptr] = in[0];
-      ch->old[1][ch->old_ptr] = in[1];
+      ch->old[ch->old_ptr][0] = in[0];
+      ch->old[ch->old_ptr][1] = in[1];
 
-      float l_a = ch->old[0][(ch->old_ptr - delay_int - 0) & CHORUS_DELAY_MASK];
-      float l_b = ch->old[0][(ch->old_ptr - delay_int - 1) & CHORUS_DELAY_MASK];
-      float r_a = ch->old[1][(ch->old_ptr - delay_int - 0) & CHORUS_DELAY_MASK];
-      float r_b = ch->old[1][(ch->old_ptr - delay_int - 1) & CHORUS_DELAY_MASK];
+      float l_a = ch->old[(ch->old_ptr - delay_int - 0) & CHORUS_DELAY_MASK][0];
+      float l_b = ch->old[(ch->old_ptr - delay_int - 1) & CHORUS_DELAY_MASK][0];
+      float r_a = ch->old[(ch->old_ptr - delay_int - 0) & CHORUS_DELAY_MASK][1];
+      float r_b = ch->old[(ch->old_ptr - delay_int - 1) & CHORUS_DELAY_MASK][1];
 
       // Lerp introduces aliasing of the chorus component, but doing full polyphase here is probably overkill.
       float chorus_l = l_a * (1.0f - delay_frac) + l_b * delay_frac;
@@ -87,6 +93,134 @@ static void chorus_process(void *data, struct dspfilter_output *output,
    }
 }
 
+#if defined(__SSE__) || defined(__ARM_NEON__)
+// The vectorized paths run both channels in parallel lanes. The LFO is
+// a rotating phasor instead of a sin() call per frame, and is reset
+// exactly every period so it doesn't drift.
+struct chorus_lfo
+{
+   double phase_sin, phase_cos;
+   double step_sin, step_cos;
+};
+
+static void chorus_lfo_init(struct chorus_lfo *lfo, const struct chorus_data *ch)
+{
+   double step = 2.0 * M_PI / ch->lfo_period;
+
+   lfo->phase_sin = sin(step * ch->lfo_ptr);
+   lfo->phase_cos = cos(step * ch->lfo_ptr);
+   lfo->step_sin  = sin(step);
+   lfo->step_cos  = cos(step);
+}
+
+// Returns the delay in frames for the current frame, and advances the LFO.
+static inline float chorus_lfo_delay(struct chorus_lfo *lfo, struct chorus_data *ch)
+{
+   float delay = ch->delay + ch->depth * lfo->phase_sin;
+   delay *= ch->input_rate;
+
+   if (++ch->lfo_ptr >= ch->lfo_period)
+   {
+      ch->lfo_ptr    = 0;
+      lfo->phase_sin = 0.0;
+      lfo->phase_cos = 1.0;
+   }
+   else
+   {
+      double phase_sin = lfo->phase_sin * lfo->step_cos + lfo->phase_cos * lfo->step_sin;
+      lfo->phase_cos   = lfo->phase_cos * lfo->step_cos - lfo->phase_sin * lfo->step_sin;
+      lfo->phase_sin   = phase_sin;
+   }
+
+   return delay;
+}
+#endif
+
+#if defined(__SSE__)
+static void chorus_process_sse(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned i;
+   struct chorus_lfo lfo;
+   struct chorus_data *ch = (struct chorus_data*)data;
+   __m128 dry = _mm_set1_ps(ch->mix_dry);
+   __m128 wet = _mm_set1_ps(ch->mix_wet);
+
+   output->samples = input->samples;
+   output->frames  = input->frames;
+   float *out = output->samples;
+
+   chorus_lfo_init(&lfo, ch);
+
+   for (i = 0; i < input->frames; i++, out += 2)
+   {
+      __m128 in   = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)out);
+      float delay = chorus_lfo_delay(&lfo, ch);
+
+      unsigned delay_int = (unsigned)delay;
+      if (delay_int >= CHORUS_MAX_DELAY - 1)
+         delay_int = CHORUS_MAX_DELAY - 2;
+      __m128 delay_frac = _mm_set1_ps(delay - delay_int);
+
+      _mm_storel_pi((__m64*)ch->old[ch->old_ptr], in);
+
+      __m128 a = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)
+            ch->old[(ch->old_ptr - delay_int - 0) & CHORUS_DELAY_MASK]);
+      __m128 b = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)
+            ch->old[(ch->old_ptr - delay_int - 1) & CHORUS_DELAY_MASK]);
+
+      __m128 chorus = _mm_add_ps(
+            _mm_mul_ps(a, _mm_sub_ps(_mm_set1_ps(1.0f), delay_frac)),
+            _mm_mul_ps(b, delay_frac));
+
+      _mm_storel_pi((__m64*)out, _mm_add_ps(_mm_mul_ps(dry, in),
+               _mm_mul_ps(wet, chorus)));
+
+      ch->old_ptr = (ch->old_ptr + 1) & CHORUS_DELAY_MASK;
+   }
+}
+#elif defined(__ARM_NEON__)
+static void chorus_process_neon(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned i;
+   struct chorus_lfo lfo;
+   struct chorus_data *ch = (struct chorus_data*)data;
+
+   output->samples = input->samples;
+   output->frames  = input->frames;
+   float *out = output->samples;
+
+   chorus_lfo_init(&lfo, ch);
+
+   for (i = 0; i < input->frames; i++, out += 2)
+   {
+      float32x2_t in = vld1_f32(out);
+      float delay    = chorus_lfo_delay(&lfo, ch);
+
+      unsigned delay_int = (unsigned)delay;
+      if (delay_int >= CHORUS_MAX_DELAY - 1)
+         delay_int = CHORUS_MAX_DELAY - 2;
+      float delay_frac = delay - delay_int;
+
+      vst1_f32(ch->old[ch->old_ptr], in);
+
+      float32x2_t a = vld1_f32(
+            ch->old[(ch->old_ptr - delay_int - 0) & CHORUS_DELAY_MASK]);
+      float32x2_t b = vld1_f32(
+            ch->old[(ch->old_ptr - delay_int - 1) & CHORUS_DELAY_MASK]);
+
+      float32x2_t chorus = vmla_n_f32(vmul_n_f32(a, 1.0f - delay_frac),
+            b, delay_frac);
+
+      vst1_f32(out, vmla_n_f32(vmul_n_f32(in, ch->mix_dry),
+               chorus, ch->mix_wet));
+
+      ch->old_ptr = (ch->old_ptr + 1) & CHORUS_DELAY_MASK;
+   }
+}
+#endif
+
 static void *chorus_init(const struct dspfilter_info *info,
       const struct dspfilter_config *config, void *userdata)
 {
@@ -133,6 +267,28 @@ static const struct dspfilter_implementation chorus_plug = {
    "chorus",
 };
 
+#if defined(__SSE__)
+static const struct dspfilter_implementation chorus_plug_sse = {
+   chorus_init,
+   chorus_process_sse,
+   chorus_free,
+
+   DSPFILTER_API_VERSION,
+   "Chorus (SSE)",
+   "chorus",
+};
+#elif defined(__ARM_NEON__)
+static const struct dspfilter_implementation chorus_plug_neon = {
+   chorus_init,
+   chorus_process_neon,
+   chorus_free,
+
+   DSPFILTER_API_VERSION,
+   "Chorus (NEON)",
+   "chorus",
+};
+#endif
+
 #ifdef HAVE_FILTERS_BUILTIN
 #define dspfilter_get_implementation chorus_dspfilter_get_implementation
 #endif
@@ -140,6 +296,13 @@ static const struct dspfilter_implementation chorus_plug = {
 const struct dspfilter_implementation *dspfilter_get_implementation(dspfilter_simd_mask_t mask)
 {
    (void)mask;
+#if defined(__SSE__)
+   if (mask & DSPFILTER_SIMD_SSE)
+      return &chorus_plug_sse;
+#elif defined(__ARM_NEON__)
+   if (mask & DSPFILTER_SIMD_NEON)
+      return &chorus_plug_neon;
+#endif
    return &chorus_plug;
 }
 
@@ -17,6 +17,12 @@
 #include <math.h>
 #include <stdlib.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #ifndef min
 #define min(a, b) ((a) < (b) ? (a) : (b))
 #endif
@@ -33,6 +39,7 @@ struct echo_data
 {
    struct echo_channel *channels;
    unsigned num_channels;
+   unsigned min_frames;
    float amp;
 };
 
@@ -91,6 +98,156 @@ static void echo_process(void *data, struct dspfilter_output *output,
    }
 }
 
+// A frame only reaches later frames through the delay lines, so as long
+// as every delay is at least two frames long, the vectorized paths run
+// two frames with both channels in one vector.
+#if defined(__SSE__)
+static void echo_process_sse(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned i = 0, c;
+   struct echo_data *echo = (struct echo_data*)data;
+   __m128 amp = _mm_set1_ps(echo->amp);
+
+   output->samples = input->samples;
+   output->frames  = input->frames;
+
+   float *out = output->samples;
+
+   if (echo->min_frames >= 2)
+   {
+      for (; i + 2 <= input->frames; i += 2, out += 4)
+      {
+         __m128 in  = _mm_loadu_ps(out);
+         __m128 sum = _mm_setzero_ps();
+
+         for (c = 0; c < echo->num_channels; c++)
+         {
+            struct echo_channel *ch = &echo->channels[c];
+            unsigned next = ch->ptr + 1 < ch->frames ? ch->ptr + 1 : 0;
+
+            sum = _mm_add_ps(sum, _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(),
+                        (const __m64*)(ch->buffer + (ch->ptr << 1))),
+                     (const __m64*)(ch->buffer + (next << 1))));
+         }
+
+         sum = _mm_mul_ps(sum, amp);
+
+         for (c = 0; c < echo->num_channels; c++)
+         {
+            struct echo_channel *ch = &echo->channels[c];
+            unsigned next = ch->ptr + 1 < ch->frames ? ch->ptr + 1 : 0;
+            __m128 feedback = _mm_add_ps(in,
+                  _mm_mul_ps(_mm_set1_ps(ch->feedback), sum));
+
+            _mm_storel_pi((__m64*)(ch->buffer + (ch->ptr << 1)), feedback);
+            _mm_storeh_pi((__m64*)(ch->buffer + (next << 1)), feedback);
+
+            ch->ptr = next + 1 < ch->frames ? next + 1 : 0;
+         }
+
+         _mm_storeu_ps(out, _mm_add_ps(in, sum));
+      }
+   }
+
+   for (; i < input->frames; i++, out += 2)
+   {
+      __m128 in  = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)out);
+      __m128 sum = _mm_setzero_ps();
+
+      for (c = 0; c < echo->num_channels; c++)
+         sum = _mm_add_ps(sum, _mm_loadl_pi(_mm_setzero_ps(),
+                  (const __m64*)(echo->channels[c].buffer +
+                     (echo->channels[c].ptr << 1))));
+
+      sum = _mm_mul_ps(sum, amp);
+
+      for (c = 0; c < echo->num_channels; c++)
+      {
+         struct echo_channel *ch = &echo->channels[c];
+
+         _mm_storel_pi((__m64*)(ch->buffer + (ch->ptr << 1)), _mm_add_ps(in,
+                  _mm_mul_ps(_mm_set1_ps(ch->feedback), sum)));
+
+         ch->ptr = ch->ptr + 1 < ch->frames ? ch->ptr + 1 : 0;
+      }
+
+      _mm_storel_pi((__m64*)out, _mm_add_ps(in, sum));
+   }
+}
+#elif defined(__ARM_NEON__)
+static void echo_process_neon(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned i = 0, c;
+   struct echo_data *echo = (struct echo_data*)data;
+
+   output->samples = input->samples;
+   output->frames  = input->frames;
+
+   float *out = output->samples;
+
+   if (echo->min_frames >= 2)
+   {
+      for (; i + 2 <= input->frames; i += 2, out += 4)
+      {
+         float32x4_t in  = vld1q_f32(out);
+         float32x4_t sum = vdupq_n_f32(0.0f);
+
+         for (c = 0; c < echo->num_channels; c++)
+         {
+            struct echo_channel *ch = &echo->channels[c];
+            unsigned next = ch->ptr + 1 < ch->frames ? ch->ptr + 1 : 0;
+
+            sum = vaddq_f32(sum, vcombine_f32(
+                     vld1_f32(ch->buffer + (ch->ptr << 1)),
+                     vld1_f32(ch->buffer + (next << 1))));
+         }
+
+         sum = vmulq_n_f32(sum, echo->amp);
+
+         for (c = 0; c < echo->num_channels; c++)
+         {
+            struct echo_channel *ch = &echo->channels[c];
+            unsigned next = ch->ptr + 1 < ch->frames ? ch->ptr + 1 : 0;
+            float32x4_t feedback = vmlaq_n_f32(in, sum, ch->feedback);
+
+            vst1_f32(ch->buffer + (ch->ptr << 1), vget_low_f32(feedback));
+            vst1_f32(ch->buffer + (next << 1), vget_high_f32(feedback));
+
+            ch->ptr = next + 1 < ch->frames ? next + 1 : 0;
+         }
+
+         vst1q_f32(out, vaddq_f32(in, sum));
+      }
+   }
+
+   for (; i < input->frames; i++, out += 2)
+   {
+      float32x2_t in  = vld1_f32(out);
+      float32x2_t sum = vdup_n_f32(0.0f);
+
+      for (c = 0; c < echo->num_channels; c++)
+         sum = vadd_f32(sum, vld1_f32(echo->channels[c].buffer +
+                  (echo->channels[c].ptr << 1)));
+
+      sum = vmul_n_f32(sum, echo->amp);
+
+      for (c = 0; c < echo->num_channels; c++)
+      {
+         struct echo_channel *ch = &echo->channels[c];
+
+         vst1_f32(ch->buffer + (ch->ptr << 1),
+               vmla_n_f32(in, sum, ch->feedback));
+
+         ch->ptr = ch->ptr + 1 < ch->frames ? ch->ptr + 1 : 0;
+      }
+
+      vst1_f32(out, vadd_f32(in, sum));
+   }
+}
+#endif
+
 static void *echo_init(const struct dspfilter_info *info,
       const struct dspfilter_config *config, void *userdata)
 {
@@ -129,6 +286,9 @@ static void *echo_init(const struct dspfilter_info *info,
 
       echo->channels[i].frames = frames;
       echo->channels[i].feedback = feedback[i];
+
+      if (!i || frames < echo->min_frames)
+         echo->min_frames = frames;
    }
 
    config->free(delay);
@@ -153,6 +313,28 @@ static const struct dspfilter_implementation echo_plug = {
    "echo",
 };
 
+#if defined(__SSE__)
+static const struct dspfilter_implementation echo_plug_sse = {
+   echo_init,
+   echo_process_sse,
+   echo_free,
+
+   DSPFILTER_API_VERSION,
+   "Multi-Echo (SSE)",
+   "echo",
+};
+#elif defined(__ARM_NEON__)
+static const struct dspfilter_implementation echo_plug_neon = {
+   echo_init,
+   echo_process_neon,
+   echo_free,
+
+   DSPFILTER_API_VERSION,
+   "Multi-Echo (NEON)",
+   "echo",
+};
+#endif
+
 #ifdef HAVE_FILTERS_BUILTIN
 #define dspfilter_get_implementation echo_dspfilter_get_implementation
 #endif
@@ -160,6 +342,13 @@ static const struct dspfilter_implementation echo_plug = {
 const struct dspfilter_implementation *dspfilter_get_implementation(dspfilter_simd_mask_t mask)
 {
    (void)mask;
+#if defined(__SSE__)
+   if (mask & DSPFILTER_SIMD_SSE)
+      return &echo_plug_sse;
+#elif defined(__ARM_NEON__)
+   if (mask & DSPFILTER_SIMD_NEON)
+      return &echo_plug_neon;
+#endif
    return &echo_plug;
 }
 
@@ -17,6 +17,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
 
 #include "fft/fft.c"
 
@@ -28,17 +29,46 @@
 #define min(a, b) ((a) < (b) ? (a) : (b))
 #endif
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+// Uniformly partitioned overlap-save convolution.
+// The impulse response is split into partitions of partition_size taps,
+// each transformed once at init. Every partition_size input frames,
+// the newest block is transformed and multiplied with all partitions
+// against a delay line of older input spectra. Latency is one partition,
+// and the work per block doesn't depend on the length of the response.
 struct eq_data
 {
    fft_t *fft;
-   float buffer[8 * 1024];
-
-   float *save;
-   float *block;
-   fft_complex_t *filter;
+   unsigned partition_size;
+   unsigned partitions;
+   // Bins 0 to partition_size, padded for SIMD.
+   // The rest of the spectrum follows from conjugate symmetry.
+   unsigned bins;
+
+   // Input windows, 2 * partition_size per channel.
+   float *input;
+   unsigned input_ptr;
+
+   // Partitioned filter and frequency-domain delay line,
+   // partitions * bins per channel, in split complex format.
+   float *filter_real;
+   float *filter_imag;
+   float *fdl_real;
+   float *fdl_imag;
+   unsigned fdl_ptr;
+
+   float *accum_real;
+   float *accum_imag;
    fft_complex_t *fftblock;
-   unsigned block_size;
-   unsigned block_ptr;
+   float *time;
+
+   float *buffer;
+   unsigned buffer_frames;
 };
 
 struct eq_gain
@@ -54,62 +84,229 @@ static void eq_free(void *data)
       return;
 
    fft_free(eq->fft);
-   free(eq->save);
-   free(eq->block);
+   free(eq->input);
+   free(eq->filter_real);
+   free(eq->filter_imag);
+   free(eq->fdl_real);
+   free(eq->fdl_imag);
+   free(eq->accum_real);
+   free(eq->accum_imag);
    free(eq->fftblock);
-   free(eq->filter);
+   free(eq->time);
+   free(eq->buffer);
    free(eq);
 }
 
+// accum += x * h for bins complex values.
+// bins is always a multiple of 4.
+static void eq_complex_mac(float *accum_real, float *accum_imag,
+      const float *x_real, const float *x_imag,
+      const float *h_real, const float *h_imag, unsigned bins)
+{
+   unsigned i;
+#if defined(__SSE__)
+   for (i = 0; i < bins; i += 4)
+   {
+      __m128 xr = _mm_loadu_ps(x_real + i);
+      __m128 xi = _mm_loadu_ps(x_imag + i);
+      __m128 hr = _mm_loadu_ps(h_real + i);
+      __m128 hi = _mm_loadu_ps(h_imag + i);
+
+      __m128 re = _mm_sub_ps(_mm_mul_ps(xr, hr), _mm_mul_ps(xi, hi));
+      __m128 im = _mm_add_ps(_mm_mul_ps(xr, hi), _mm_mul_ps(xi, hr));
+
+      _mm_storeu_ps(accum_real + i, _mm_add_ps(_mm_loadu_ps(accum_real + i), re));
+      _mm_storeu_ps(accum_imag + i, _mm_add_ps(_mm_loadu_ps(accum_imag + i), im));
+   }
+#elif defined(__ARM_NEON__)
+   for (i = 0; i < bins; i += 4)
+   {
+      float32x4_t xr = vld1q_f32(x_real + i);
+      float32x4_t xi = vld1q_f32(x_imag + i);
+      float32x4_t hr = vld1q_f32(h_real + i);
+      float32x4_t hi = vld1q_f32(h_imag + i);
+
+      float32x4_t re = vld1q_f32(accum_real + i);
+      float32x4_t im = vld1q_f32(accum_imag + i);
+
+      re = vmlaq_f32(re, xr, hr);
+      re = vmlsq_f32(re, xi, hi);
+      im = vmlaq_f32(im, xr, hi);
+      im = vmlaq_f32(im, xi, hr);
+
+      vst1q_f32(accum_real + i, re);
+      vst1q_f32(accum_imag + i, im);
+   }
+#else
+   for (i = 0; i < bins; i++)
+   {
+      accum_real[i] += x_real[i] * h_real[i] - x_imag[i] * h_imag[i];
+      accum_imag[i] += x_real[i] * h_imag[i] + x_imag[i] * h_real[i];
+   }
+#endif
+}
+
+// Transforms a window of 2 * partition_size samples and stores
+// the non-redundant half of the spectrum in split format.
+static void eq_forward(struct eq_data *eq, float *real, float *imag,
+      const float *in)
+{
+   unsigned i;
+
+   fft_process_forward(eq->fft, eq->fftblock, in, 1);
+   for (i = 0; i <= eq->partition_size; i++)
+   {
+      real[i] = eq->fftblock[i].real;
+      imag[i] = eq->fftblock[i].imag;
+   }
+}
+
+static void eq_convolve(struct eq_data *eq, unsigned c, float *out)
+{
+   unsigned i, p;
+   unsigned n           = eq->partition_size;
+   size_t channel_base  = (size_t)c * eq->partitions * eq->bins;
+   float *input         = eq->input + c * 2 * n;
+
+   eq_forward(eq,
+         eq->fdl_real + channel_base + eq->fdl_ptr * eq->bins,
+         eq->fdl_imag + channel_base + eq->fdl_ptr * eq->bins,
+         input);
+
+   memset(eq->accum_real, 0, eq->bins * sizeof(float));
+   memset(eq->accum_imag, 0, eq->bins * sizeof(float));
+
+   // Partition p of the filter meets the block from p blocks ago.
+   for (p = 0; p < eq->partitions; p++)
+   {
+      unsigned slot = (eq->fdl_ptr + eq->partitions - p) % eq->partitions;
+      size_t x      = channel_base + slot * eq->bins;
+      size_t h      = channel_base + p * eq->bins;
+
+      eq_complex_mac(eq->accum_real, eq->accum_imag,
+            eq->fdl_real + x, eq->fdl_imag + x,
+            eq->filter_real + h, eq->filter_imag + h, eq->bins);
+   }
+
+   for (i = 0; i <= n; i++)
+   {
+      eq->fftblock[i].real = eq->accum_real[i];
+      eq->fftblock[i].imag = eq->accum_imag[i];
+   }
+   for (i = 1; i < n; i++)
+      eq->fftblock[2 * n - i] = fft_complex_conj(eq->fftblock[i]);
+
+   fft_process_inverse(eq->fft, eq->time, eq->fftblock, 1);
+
+   // Overlap-save, the first half is wrapped around garbage.
+   for (i = 0; i < n; i++)
+      out[2 * i + c] = eq->time[n + i];
+
+   // Slide the window for the next block.
+   memcpy(input, input + n, n * sizeof(float));
+}
+
 static void eq_process(void *data, struct dspfilter_output *output,
       const struct dspfilter_input *input)
 {
    struct eq_data *eq = (struct eq_data*)data;
+   unsigned n = eq->partition_size;
 
    output->samples = eq->buffer;
    output->frames  = 0;
 
+   // At most one partition is pending from the previous call.
+   if (input->frames + n > eq->buffer_frames)
+   {
+      float *buffer = (float*)realloc(eq->buffer,
+            (input->frames + n) * 2 * sizeof(float));
+      if (!buffer)
+         return;
+
+      eq->buffer        = buffer;
+      eq->buffer_frames = input->frames + n;
+      output->samples   = buffer;
+   }
+
    float *out = eq->buffer;
    const float *in = input->samples;
    unsigned input_frames = input->frames;
 
    while (input_frames)
    {
-      unsigned write_avail = eq->block_size - eq->block_ptr;
+      unsigned i;
+      unsigned write_avail = n - eq->input_ptr;
       if (input_frames < write_avail)
          write_avail = input_frames;
 
-      memcpy(eq->block + eq->block_ptr * 2, in, write_avail * 2 * sizeof(float));
+      for (i = 0; i < write_avail; i++)
+      {
+         eq->input[n + eq->input_ptr + i]     = in[2 * i + 0];
+         eq->input[3 * n + eq->input_ptr + i] = in[2 * i + 1];
+      }
 
       in += write_avail * 2;
       input_frames -= write_avail;
-      eq->block_ptr += write_avail;
+      eq->input_ptr += write_avail;
 
       // Convolve a new block.
-      if (eq->block_ptr == eq->block_size)
+      if (eq->input_ptr == n)
       {
-         unsigned i, c;
+         eq_convolve(eq, 0, out);
+         eq_convolve(eq, 1, out);
+         eq->fdl_ptr = (eq->fdl_ptr + 1) % eq->partitions;
 
-         for (c = 0; c < 2; c++)
-         {
-            fft_process_forward(eq->fft, eq->fftblock, eq->block + c, 2);
-            for (i = 0; i < 2 * eq->block_size; i++)
-               eq->fftblock[i] = fft_complex_mul(eq->fftblock[i], eq->filter[i]);
-            fft_process_inverse(eq->fft, out + c, eq->fftblock, 2);
-         }
+         out += n * 2;
+         output->frames += n;
+         eq->input_ptr = 0;
+      }
+   }
+}
+
+// Splits an impulse response per channel into partitions
+// and transforms each of them.
+static int eq_set_filter(struct eq_data *eq,
+      const float *left, const float *right, unsigned taps)
+{
+   unsigned c, p;
+   unsigned n    = eq->partition_size;
+   size_t size;
 
-         // Overlap add method, so add in saved block now.
-         for (i = 0; i < 2 * eq->block_size; i++)
-            out[i] += eq->save[i];
+   eq->partitions = (taps + n - 1) / n;
+   if (!eq->partitions)
+      eq->partitions = 1;
 
-         // Save block for later.
-         memcpy(eq->save, out + 2 * eq->block_size, 2 * eq->block_size * sizeof(float));
+   size = 2 * (size_t)eq->partitions * eq->bins;
+   eq->filter_real = (float*)calloc(size, sizeof(float));
+   eq->filter_imag = (float*)calloc(size, sizeof(float));
+   eq->fdl_real    = (float*)calloc(size, sizeof(float));
+   eq->fdl_imag    = (float*)calloc(size, sizeof(float));
 
-         out += eq->block_size * 2;
-         output->frames += eq->block_size;
-         eq->block_ptr = 0;
+   if (!eq->filter_real || !eq->filter_imag || !eq->fdl_real || !eq->fdl_imag)
+      return 0;
+
+   for (c = 0; c < 2; c++)
+   {
+      const float *ir = c ? right : left;
+
+      for (p = 0; p < eq->partitions; p++)
+      {
+         size_t h     = ((size_t)c * eq->partitions + p) * eq->bins;
+         unsigned len = taps - p * n;
+         if (len > n)
+            len = n;
+
+         // Zero padded to twice the partition size, so the
+         // circular convolution doesn't wrap around.
+         memset(eq->time, 0, 2 * n * sizeof(float));
+         if (ir)
+            memcpy(eq->time, ir + p * n, len * sizeof(float));
+
+         eq_forward(eq, eq->filter_real + h, eq->filter_imag + h, eq->time);
       }
    }
+
+   return 1;
 }
 
 static int gains_cmp(const void *a_, const void *b_)
@@ -216,26 +413,35 @@ static inline double kaiser_window(double index, double beta)
    return kaiser_besseli0(beta * sqrt(1 - index * index));
 }
 
-static void create_filter(struct eq_data *eq, unsigned size_log2,
+// Designs a linear phase filter from the gain points.
+// Returns block_size - 1 taps, or NULL on failure.
+static float *create_filter(unsigned size_log2,
       struct eq_gain *gains, unsigned num_gains, double beta, const char *filter_path)
 {
    int i;
-   int half_block_size = eq->block_size >> 1;
+   unsigned block_size = 1 << size_log2;
+   int half_block_size = block_size >> 1;
    double window_mod = 1.0 / kaiser_window(0.0, beta);
 
    fft_t *fft = fft_new(size_log2);
-   float *time_filter = (float*)calloc(eq->block_size * 2 + 1, sizeof(*time_filter));
-   if (!fft || !time_filter)
+   fft_complex_t *response = (fft_complex_t*)calloc(block_size + 1, sizeof(*response));
+   float *time_filter = (float*)calloc(block_size * 2 + 1, sizeof(*time_filter));
+   float *taps = (float*)calloc(block_size, sizeof(*taps));
+   if (!fft || !response || !time_filter || !taps)
+   {
+      free(taps);
+      taps = NULL;
       goto end;
+   }
 
    // Make sure bands are in correct order.
    qsort(gains, num_gains, sizeof(*gains), gains_cmp);
 
    // Compute desired filter response.
-   generate_response(eq->filter, gains, num_gains, half_block_size);
+   generate_response(response, gains, num_gains, half_block_size);
 
    // Get equivalent time-domain filter.
-   fft_process_inverse(fft, time_filter, eq->filter, 1);
+   fft_process_inverse(fft, time_filter, response, 1);
 
    // ifftshift() to create the correct linear phase filter.
    // The filter response was designed with zero phase, which won't work unless we compensate
@@ -248,34 +454,184 @@ static void create_filter(struct eq_data *eq, unsigned size_log2,
    }
 
    // Apply a window to smooth out the frequency repsonse.
-   for (i = 0; i < (int)eq->block_size; i++)
+   for (i = 0; i < (int)block_size; i++)
    {
       // Kaiser window.
-      double phase = (double)i / eq->block_size;
+      double phase = (double)i / block_size;
       phase = 2.0 * (phase - 0.5);
       time_filter[i] *= window_mod * kaiser_window(phase, beta);
    }
 
+   // Make our even-length filter odd by discarding the first coefficient.
+   // For some interesting reason, this allows us to design an odd-length linear phase filter.
+   memcpy(taps, time_filter + 1, (block_size - 1) * sizeof(*taps));
+
    // Debugging.
    if (filter_path)
    {
       FILE *file = fopen(filter_path, "w");
       if (file)
       {
-         for (i = 0; i < (int)eq->block_size - 1; i++)
-            fprintf(file, "%.8f\n", time_filter[i + 1]);
+         for (i = 0; i < (int)block_size - 1; i++)
+            fprintf(file, "%.8f\n", taps[i]);
          fclose(file);
       }
    }
 
-   // Padded FFT to create our FFT filter.
-   // Make our even-length filter odd by discarding the first coefficient.
-   // For some interesting reason, this allows us to design an odd-length linear phase filter.
-   fft_process_forward(eq->fft, eq->filter, time_filter + 1, 1);
-
 end:
    fft_free(fft);
+   free(response);
    free(time_filter);
+   return taps;
+}
+
+static uint32_t wav_read_le(const uint8_t *data, unsigned bytes)
+{
+   unsigned i;
+   uint32_t value = 0;
+   for (i = 0; i < bytes; i++)
+      value |= (uint32_t)data[i] << (8 * i);
+   return value;
+}
+
+static float wav_sample(const uint8_t *data, unsigned bits, int is_float)
+{
+   union
+   {
+      uint32_t u;
+      float f;
+   } conv;
+
+   switch (bits)
+   {
+      case 16:
+         return (int16_t)wav_read_le(data, 2) / 32768.0f;
+      case 24:
+         // Sign extend through the top byte.
+         return (int32_t)(wav_read_le(data, 3) << 8) / 2147483648.0f;
+      case 32:
+         conv.u = wav_read_le(data, 4);
+         if (is_float)
+            return conv.f;
+         return (int32_t)conv.u / 2147483648.0f;
+      default:
+         return 0.0f;
+   }
+}
+
+// Loads an impulse response from a PCM WAV file, 16/24/32-bit integer
+// or 32-bit float. Mono responses are used for both channels.
+// The response is linearly resampled if it doesn't match the input rate.
+static float *load_impulse_response(const char *path, float rate,
+      unsigned *out_taps, float **right)
+{
+   uint8_t header[12], chunk[8], fmt[40];
+   unsigned channels = 0, bits = 0, frame_size = 0, i;
+   int is_float = 0;
+   float ir_rate = 0.0f;
+   uint8_t *pcm = NULL;
+   uint32_t pcm_size = 0;
+   unsigned frames, taps;
+   float *left = NULL;
+   double step;
+
+   FILE *file = fopen(path, "rb");
+   if (!file)
+      return NULL;
+
+   if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+         memcmp(header, "RIFF", 4) || memcmp(header + 8, "WAVE", 4))
+      goto error;
+
+   while (fread(chunk, 1, sizeof(chunk), file) == sizeof(chunk))
+   {
+      uint32_t size = wav_read_le(chunk + 4, 4);
+
+      if (!memcmp(chunk, "fmt ", 4) && size >= 16 && size <= sizeof(fmt))
+      {
+         unsigned format;
+         if (fread(fmt, 1, size, file) != size)
+            goto error;
+
+         format   = wav_read_le(fmt + 0, 2);
+         channels = wav_read_le(fmt + 2, 2);
+         ir_rate  = wav_read_le(fmt + 4, 4);
+         bits     = wav_read_le(fmt + 14, 2);
+
+         // WAVE_FORMAT_EXTENSIBLE, the real format is in the sub-format GUID.
+         if (format == 0xfffe && size >= 26)
+            format = wav_read_le(fmt + 24, 2);
+
+         is_float = format == 3;
+         if ((format != 1 && format != 3) || (is_float && bits != 32))
+            goto error;
+      }
+      else if (!memcmp(chunk, "data", 4) && channels)
+      {
+         pcm_size = size;
+         pcm = (uint8_t*)malloc(pcm_size);
+         if (!pcm || fread(pcm, 1, pcm_size, file) != pcm_size)
+            goto error;
+         break;
+      }
+      else if (fseek(file, size + (size & 1), SEEK_CUR) != 0)
+         goto error;
+   }
+
+   if (!pcm || !channels || ir_rate <= 0.0f ||
+         (bits != 16 && bits != 24 && bits != 32))
+      goto error;
+
+   frame_size = channels * bits / 8;
+   frames     = pcm_size / frame_size;
+   step       = ir_rate / rate;
+   taps       = frames / step;
+   if (!taps)
+      goto error;
+
+   left   = (float*)calloc(taps, sizeof(float));
+   *right = (float*)calloc(taps, sizeof(float));
+   if (!left || !*right)
+      goto error;
+
+   for (i = 0; i < taps; i++)
+   {
+      double pos      = i * step;
+      unsigned index  = (unsigned)pos;
+      unsigned next   = index + 1 < frames ? index + 1 : index;
+      float frac      = pos - index;
+      const uint8_t *a = pcm + index * frame_size;
+      const uint8_t *b = pcm + next * frame_size;
+      unsigned offset  = channels > 1 ? bits / 8 : 0;
+
+      left[i] = (1.0f - frac) * wav_sample(a, bits, is_float) +
+         frac * wav_sample(b, bits, is_float);
+      (*right)[i] = (1.0f - frac) * wav_sample(a + offset, bits, is_float) +
+         frac * wav_sample(b + offset, bits, is_float);
+   }
+
+   // Keep the response the same loudness when resampling.
+   if (step < 1.0)
+   {
+      for (i = 0; i < taps; i++)
+      {
+         left[i] *= step;
+         (*right)[i] *= step;
+      }
+   }
+
+   free(pcm);
+   fclose(file);
+   *out_taps = taps;
+   return left;
+
+error:
+   free(pcm);
+   free(left);
+   free(*right);
+   *right = NULL;
+   fclose(file);
+   return NULL;
 }
 
 static void *eq_init(const struct dspfilter_info *info,
@@ -294,57 +650,117 @@ static void *eq_init(const struct dspfilter_info *info,
 
    int size_log2;
    config->get_int(userdata, "block_size_log2", &size_log2, 8);
-   unsigned size = 1 << size_log2;
+
+   int partition_log2;
+   config->get_int(userdata, "partition_size_log2", &partition_log2, 6);
+   if (partition_log2 < 2)
+      partition_log2 = 2;
+
+   float ir_gain;
+   config->get_float(userdata, "impulse_response_gain", &ir_gain, 0.0f);
 
    struct eq_gain *gains = NULL;
-   float *frequencies, *gain;
+   float *frequencies = NULL, *gain = NULL;
    unsigned num_freq, num_gain;
-   config->get_float_array(userdata, "frequencies", &frequencies, &num_freq, default_freq, 2);
-   config->get_float_array(userdata, "gains", &gain, &num_gain, default_gain, 2);
-
+   float *left = NULL, *right = NULL;
+   unsigned taps = 0;
    char *filter_path = NULL;
-   if (!config->get_string(userdata, "impulse_response_output", &filter_path, ""))
+   char *ir_path = NULL;
+
+   if (!config->get_string(userdata, "impulse_response", &ir_path, ""))
    {
-      config->free(filter_path);
-      filter_path = NULL;
+      config->free(ir_path);
+      ir_path = NULL;
    }
 
-   num_gain = num_freq = min(num_gain, num_freq);
+   if (ir_path)
+   {
+      // Cabinet or room response instead of the designed filter.
+      left = load_impulse_response(ir_path, info->input_rate, &taps, &right);
+      config->free(ir_path);
+      if (!left)
+         goto error;
+
+      ir_gain = pow(10.0, ir_gain / 20.0);
+      for (i = 0; i < taps; i++)
+      {
+         left[i] *= ir_gain;
+         right[i] *= ir_gain;
+      }
+   }
+   else
+   {
+      config->get_float_array(userdata, "frequencies", &frequencies, &num_freq, default_freq, 2);
+      config->get_float_array(userdata, "gains", &gain, &num_gain, default_gain, 2);
 
-   gains = (struct eq_gain*)calloc(num_gain, sizeof(*gains));
-   if (!gains)
-      goto error;
+      if (!config->get_string(userdata, "impulse_response_output", &filter_path, ""))
+      {
+         config->free(filter_path);
+         filter_path = NULL;
+      }
 
-   for (i = 0; i < num_gain; i++)
-   {
-      gains[i].freq = frequencies[i] / (0.5f * info->input_rate);
-      gains[i].gain = pow(10.0, gain[i] / 20.0);
+      num_gain = num_freq = min(num_gain, num_freq);
+
+      gains = (struct eq_gain*)calloc(num_gain, sizeof(*gains));
+      if (!gains)
+         goto error;
+
+      for (i = 0; i < num_gain; i++)
+      {
+         gains[i].freq = frequencies[i] / (0.5f * info->input_rate);
+         gains[i].gain = pow(10.0, gain[i] / 20.0);
+      }
+      config->free(frequencies);
+      config->free(gain);
+      frequencies = gain = NULL;
+
+      left = create_filter(size_log2, gains, num_gain, beta, filter_path);
+      config->free(filter_path);
+      filter_path = NULL;
+      if (!left)
+         goto error;
+
+      taps = (1 << size_log2) - 1;
+      right = left;
    }
-   config->free(frequencies);
-   config->free(gain);
 
-   eq->block_size = size;
+   // Partitions longer than the filter only add latency.
+   while (partition_log2 > 2 && (1u << (partition_log2 - 1)) >= taps)
+      partition_log2--;
 
-   eq->save     = (float*)calloc(    size, 2 * sizeof(*eq->save));
-   eq->block    = (float*)calloc(2 * size, 2 * sizeof(*eq->block));
-   eq->fftblock = (fft_complex_t*)calloc(2 * size, sizeof(*eq->fftblock));
-   eq->filter   = (fft_complex_t*)calloc(2 * size, sizeof(*eq->filter));
+   eq->partition_size = 1 << partition_log2;
+   eq->bins = (eq->partition_size + 1 + 3) & ~3;
 
-   // Use an FFT which is twice the block size with zero-padding
+   eq->input    = (float*)calloc(4 * eq->partition_size, sizeof(*eq->input));
+   eq->time     = (float*)calloc(2 * eq->partition_size, sizeof(*eq->time));
+   eq->fftblock = (fft_complex_t*)calloc(2 * eq->partition_size, sizeof(*eq->fftblock));
+   eq->accum_real = (float*)calloc(eq->bins, sizeof(float));
+   eq->accum_imag = (float*)calloc(eq->bins, sizeof(float));
+
+   // Use an FFT which is twice the partition size with zero-padding
    // to make circular convolution => proper convolution.
-   eq->fft = fft_new(size_log2 + 1);
+   eq->fft = fft_new(partition_log2 + 1);
 
-   if (!eq->fft || !eq->fftblock || !eq->save || !eq->block || !eq->filter)
+   if (!eq->fft || !eq->input || !eq->time || !eq->fftblock ||
+         !eq->accum_real || !eq->accum_imag)
       goto error;
 
-   create_filter(eq, size_log2, gains, num_gain, beta, filter_path);
-   config->free(filter_path);
-   filter_path = NULL;
+   if (!eq_set_filter(eq, left, right, taps))
+      goto error;
 
+   if (right != left)
+      free(right);
+   free(left);
    free(gains);
    return eq;
 
 error:
+   if (right != left)
+      free(right);
+   free(left);
+   config->free(frequencies);
+   config->free(gain);
+   config->free(filter_path);
    free(gains);
    eq_free(eq);
    return NULL;
@@ -356,7 +772,7 @@ static const struct dspfilter_implementation eq_plug = {
    eq_free,
 
    DSPFILTER_API_VERSION,
-   "Linear-Phase FFT Equalizer",
+   "Linear-Phase FFT Equalizer / Convolver",
    "eq",
 };
 
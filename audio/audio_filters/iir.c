@@ -19,6 +19,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #ifndef M_PI
 #define M_PI		3.1415926535897932384626433832795
 #endif
@@ -118,6 +124,114 @@ static void iir_process(void *data, struct dspfilter_output *output,
    iir->r.yn2 = yn2_r;
 }
 
+// The vectorized paths run both channels in parallel lanes, with
+// the coefficients scaled by 1 / a0 once instead of dividing every sample.
+#if defined(__SSE__)
+static void iir_process_sse(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned i;
+   float state[4];
+   struct iir_data *iir = (struct iir_data*)data;
+
+   output->samples = input->samples;
+   output->frames  = input->frames;
+
+   float *out = output->samples;
+
+   __m128 b0 = _mm_set1_ps(iir->b0 / iir->a0);
+   __m128 b1 = _mm_set1_ps(iir->b1 / iir->a0);
+   __m128 b2 = _mm_set1_ps(iir->b2 / iir->a0);
+   __m128 a1 = _mm_set1_ps(iir->a1 / iir->a0);
+   __m128 a2 = _mm_set1_ps(iir->a2 / iir->a0);
+
+   __m128 xn1 = _mm_setr_ps(iir->l.xn1, iir->r.xn1, 0.0f, 0.0f);
+   __m128 xn2 = _mm_setr_ps(iir->l.xn2, iir->r.xn2, 0.0f, 0.0f);
+   __m128 yn1 = _mm_setr_ps(iir->l.yn1, iir->r.yn1, 0.0f, 0.0f);
+   __m128 yn2 = _mm_setr_ps(iir->l.yn2, iir->r.yn2, 0.0f, 0.0f);
+
+   for (i = 0; i < input->frames; i++, out += 2)
+   {
+      __m128 in = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)out);
+
+      __m128 res = _mm_mul_ps(b0, in);
+      res = _mm_add_ps(res, _mm_mul_ps(b1, xn1));
+      res = _mm_add_ps(res, _mm_mul_ps(b2, xn2));
+      res = _mm_sub_ps(res, _mm_mul_ps(a1, yn1));
+      res = _mm_sub_ps(res, _mm_mul_ps(a2, yn2));
+
+      xn2 = xn1;
+      xn1 = in;
+      yn2 = yn1;
+      yn1 = res;
+
+      _mm_storel_pi((__m64*)out, res);
+   }
+
+   _mm_storeu_ps(state, _mm_movelh_ps(xn1, xn2));
+   iir->l.xn1 = state[0];
+   iir->r.xn1 = state[1];
+   iir->l.xn2 = state[2];
+   iir->r.xn2 = state[3];
+
+   _mm_storeu_ps(state, _mm_movelh_ps(yn1, yn2));
+   iir->l.yn1 = state[0];
+   iir->r.yn1 = state[1];
+   iir->l.yn2 = state[2];
+   iir->r.yn2 = state[3];
+}
+#elif defined(__ARM_NEON__)
+static void iir_process_neon(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned i;
+   struct iir_data *iir = (struct iir_data*)data;
+
+   output->samples = input->samples;
+   output->frames  = input->frames;
+
+   float *out = output->samples;
+
+   float b0 = iir->b0 / iir->a0;
+   float b1 = iir->b1 / iir->a0;
+   float b2 = iir->b2 / iir->a0;
+   float a1 = iir->a1 / iir->a0;
+   float a2 = iir->a2 / iir->a0;
+
+   float32x2_t xn1 = vset_lane_f32(iir->r.xn1, vdup_n_f32(iir->l.xn1), 1);
+   float32x2_t xn2 = vset_lane_f32(iir->r.xn2, vdup_n_f32(iir->l.xn2), 1);
+   float32x2_t yn1 = vset_lane_f32(iir->r.yn1, vdup_n_f32(iir->l.yn1), 1);
+   float32x2_t yn2 = vset_lane_f32(iir->r.yn2, vdup_n_f32(iir->l.yn2), 1);
+
+   for (i = 0; i < input->frames; i++, out += 2)
+   {
+      float32x2_t in = vld1_f32(out);
+
+      float32x2_t res = vmul_n_f32(in, b0);
+      res = vmla_n_f32(res, xn1, b1);
+      res = vmla_n_f32(res, xn2, b2);
+      res = vmls_n_f32(res, yn1, a1);
+      res = vmls_n_f32(res, yn2, a2);
+
+      xn2 = xn1;
+      xn1 = in;
+      yn2 = yn1;
+      yn1 = res;
+
+      vst1_f32(out, res);
+   }
+
+   iir->l.xn1 = vget_lane_f32(xn1, 0);
+   iir->r.xn1 = vget_lane_f32(xn1, 1);
+   iir->l.xn2 = vget_lane_f32(xn2, 0);
+   iir->r.xn2 = vget_lane_f32(xn2, 1);
+   iir->l.yn1 = vget_lane_f32(yn1, 0);
+   iir->r.yn1 = vget_lane_f32(yn1, 1);
+   iir->l.yn2 = vget_lane_f32(yn2, 0);
+   iir->r.yn2 = vget_lane_f32(yn2, 1);
+}
+#endif
+
 #define CHECK(x) if (!strcmp(str, #x)) return x
 static enum IIRFilter str_to_type(const char *str)
 {
@@ -345,6 +459,28 @@ static const struct dspfilter_implementation iir_plug = {
    "iir",
 };
 
+#if defined(__SSE__)
+static const struct dspfilter_implementation iir_plug_sse = {
+   iir_init,
+   iir_process_sse,
+   iir_free,
+
+   DSPFILTER_API_VERSION,
+   "IIR (SSE)",
+   "iir",
+};
+#elif defined(__ARM_NEON__)
+static const struct dspfilter_implementation iir_plug_neon = {
+   iir_init,
+   iir_process_neon,
+   iir_free,
+
+   DSPFILTER_API_VERSION,
+   "IIR (NEON)",
+   "iir",
+};
+#endif
+
 #ifdef HAVE_FILTERS_BUILTIN
 #define dspfilter_get_implementation iir_dspfilter_get_implementation
 #endif
@@ -352,6 +488,13 @@ static const struct dspfilter_implementation iir_plug = {
 const struct dspfilter_implementation *dspfilter_get_implementation(dspfilter_simd_mask_t mask)
 {
    (void)mask;
+#if defined(__SSE__)
+   if (mask & DSPFILTER_SIMD_SSE)
+      return &iir_plug_sse;
+#elif defined(__ARM_NEON__)
+   if (mask & DSPFILTER_SIMD_NEON)
+      return &iir_plug_neon;
+#endif
    return &iir_plug;
 }
 
@@ -19,6 +19,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #define phaserlfoshape 4.0
 #define phaserlfoskipsamples 20
 
@@ -33,7 +39,7 @@ struct phaser_data
    float fb;
    float depth;
    float drywet;
-   float old[2][24];
+   float old[24][2];
    float gain;
    float fbout[2];
    float lfoskip;
@@ -48,6 +54,13 @@ static void phaser_free(void *data)
    free(data);
 }
 
+static void phaser_update(struct phaser_data *ph)
+{
+   ph->gain = 0.5 * (1.0 + cos(ph->skipcount * ph->lfoskip + ph->phase));
+   ph->gain = (exp(ph->gain * phaserlfoshape) - 1.0) / (exp(phaserlfoshape) - 1);
+   ph->gain = 1.0 - ph->gain * ph->depth;
+}
+
 static void phaser_process(void *data, struct dspfilter_output *output,
       const struct dspfilter_input *input)
 {
@@ -68,19 +81,15 @@ static void phaser_process(void *data, struct dspfilter_output *output,
          m[c] = in[c] + ph->fbout[c] * ph->fb * 0.01f;
 
       if ((ph->skipcount++ % phaserlfoskipsamples) == 0)
-      {
-         ph->gain = 0.5 * (1.0 + cos(ph->skipcount * ph->lfoskip + ph->phase));
-         ph->gain = (exp(ph->gain * phaserlfoshape) - 1.0) / (exp(phaserlfoshape) - 1);
-         ph->gain = 1.0 - ph->gain * ph->depth;
-      }
+         phaser_update(ph);
 
       for (s = 0; s < ph->stages; s++)
       {
          for (c = 0; c < 2; c++)
          {
-            tmp[c] = ph->old[c][s];
-            ph->old[c][s] = ph->gain * tmp[c] + m[c];
-            m[c] = tmp[c] - ph->gain * ph->old[c][s];
+            tmp[c] = ph->old[s][c];
+            ph->old[s][c] = ph->gain * tmp[c] + m[c];
+            m[c] = tmp[c] - ph->gain * ph->old[s][c];
          }
       }
 
@@ -92,6 +101,93 @@ static void phaser_process(void *data, struct dspfilter_output *output,
    }
 }
 
+// The vectorized paths run both channels through
+// the allpass stages in parallel lanes.
+#if defined(__SSE__)
+static void phaser_process_sse(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned i;
+   int s;
+   struct phaser_data *ph = (struct phaser_data*)data;
+
+   __m128 fb     = _mm_set1_ps(ph->fb * 0.01f);
+   __m128 wet    = _mm_set1_ps(ph->drywet);
+   __m128 dry    = _mm_set1_ps(1.0f - ph->drywet);
+   __m128 fbout  = _mm_setr_ps(ph->fbout[0], ph->fbout[1], 0.0f, 0.0f);
+
+   output->samples = input->samples;
+   output->frames  = input->frames;
+   float *out = output->samples;
+
+   for (i = 0; i < input->frames; i++, out += 2)
+   {
+      __m128 in = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)out);
+      __m128 m  = _mm_add_ps(in, _mm_mul_ps(fbout, fb));
+      __m128 gain;
+
+      if ((ph->skipcount++ % phaserlfoskipsamples) == 0)
+         phaser_update(ph);
+
+      gain = _mm_set1_ps(ph->gain);
+
+      for (s = 0; s < ph->stages; s++)
+      {
+         __m128 tmp = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)ph->old[s]);
+         __m128 res = _mm_add_ps(_mm_mul_ps(gain, tmp), m);
+
+         _mm_storel_pi((__m64*)ph->old[s], res);
+         m = _mm_sub_ps(tmp, _mm_mul_ps(gain, res));
+      }
+
+      fbout = m;
+      _mm_storel_pi((__m64*)out, _mm_add_ps(_mm_mul_ps(m, wet),
+               _mm_mul_ps(in, dry)));
+   }
+
+   _mm_storel_pi((__m64*)ph->fbout, fbout);
+}
+#elif defined(__ARM_NEON__)
+static void phaser_process_neon(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned i;
+   int s;
+   struct phaser_data *ph = (struct phaser_data*)data;
+
+   float fb          = ph->fb * 0.01f;
+   float32x2_t fbout = vld1_f32(ph->fbout);
+
+   output->samples = input->samples;
+   output->frames  = input->frames;
+   float *out = output->samples;
+
+   for (i = 0; i < input->frames; i++, out += 2)
+   {
+      float32x2_t in = vld1_f32(out);
+      float32x2_t m  = vmla_n_f32(in, fbout, fb);
+
+      if ((ph->skipcount++ % phaserlfoskipsamples) == 0)
+         phaser_update(ph);
+
+      for (s = 0; s < ph->stages; s++)
+      {
+         float32x2_t tmp = vld1_f32(ph->old[s]);
+         float32x2_t res = vmla_n_f32(m, tmp, ph->gain);
+
+         vst1_f32(ph->old[s], res);
+         m = vmls_n_f32(tmp, res, ph->gain);
+      }
+
+      fbout = m;
+      vst1_f32(out, vmla_n_f32(vmul_n_f32(m, ph->drywet),
+               in, 1.0f - ph->drywet));
+   }
+
+   vst1_f32(ph->fbout, fbout);
+}
+#endif
+
 static void *phaser_init(const struct dspfilter_info *info,
       const struct dspfilter_config *config, void *userdata)
 {
@@ -129,6 +225,28 @@ static const struct dspfilter_implementation phaser_plug = {
    "phaser",
 };
 
+#if defined(__SSE__)
+static const struct dspfilter_implementation phaser_plug_sse = {
+   phaser_init,
+   phaser_process_sse,
+   phaser_free,
+
+   DSPFILTER_API_VERSION,
+   "Phaser (SSE)",
+   "phaser",
+};
+#elif defined(__ARM_NEON__)
+static const struct dspfilter_implementation phaser_plug_neon = {
+   phaser_init,
+   phaser_process_neon,
+   phaser_free,
+
+   DSPFILTER_API_VERSION,
+   "Phaser (NEON)",
+   "phaser",
+};
+#endif
+
 #ifdef HAVE_FILTERS_BUILTIN
 #define dspfilter_get_implementation phaser_dspfilter_get_implementation
 #endif
@@ -136,6 +254,13 @@ static const struct dspfilter_implementation phaser_plug = {
 const struct dspfilter_implementation *dspfilter_get_implementation(dspfilter_simd_mask_t mask)
 {
    (void)mask;
+#if defined(__SSE__)
+   if (mask & DSPFILTER_SIMD_SSE)
+      return &phaser_plug_sse;
+#elif defined(__ARM_NEON__)
+   if (mask & DSPFILTER_SIMD_NEON)
+      return &phaser_plug_neon;
+#endif
    return &phaser_plug;
 }
 
@@ -19,6 +19,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 struct comb
 {
    float *buffer;
@@ -300,6 +306,256 @@ static const struct dspfilter_implementation reverb_plug = {
    "reverb",
 };
 
+#if defined(__SSE__) || defined(__ARM_NEON__)
+// Both channels share the same tunings, so their delay lines always
+// sit at the same position. The vectorized path keeps them interleaved
+// and runs both channels of two combs in every vector.
+struct reverb_lanes
+{
+   float *comb[numcombs];
+   unsigned combsize[numcombs];
+   unsigned combidx[numcombs];
+   float filterstore[numcombs * 2];
+
+   float *allpass[numallpasses];
+   unsigned allpasssize[numallpasses];
+   unsigned allpassidx[numallpasses];
+
+   float gain;
+   float feedback;
+   float damp1, damp2;
+   float allpassfeedback;
+   float dry, wet1;
+
+   float *buffer;
+};
+
+static void reverb_lanes_free(void *data)
+{
+   struct reverb_lanes *rev = (struct reverb_lanes*)data;
+   free(rev->buffer);
+   free(rev);
+}
+
+static void *reverb_lanes_init(const struct dspfilter_info *info,
+      const struct dspfilter_config *config, void *userdata)
+{
+   unsigned i, size = 0;
+   float *buffer;
+   struct reverb_data *ref;
+   struct reverb_lanes *rev = (struct reverb_lanes*)calloc(1, sizeof(*rev));
+   if (!rev)
+      return NULL;
+
+   // Let the scalar model work out the parameters.
+   ref = (struct reverb_data*)reverb_init(info, config, userdata);
+   if (!ref)
+      goto error;
+
+   for (i = 0; i < numcombs; i++)
+      size += ref->left.combL[i].bufsize;
+   for (i = 0; i < numallpasses; i++)
+      size += ref->left.allpassL[i].bufsize;
+
+   rev->buffer = (float*)calloc(size, 2 * sizeof(float));
+   if (!rev->buffer)
+      goto error;
+
+   buffer = rev->buffer;
+   for (i = 0; i < numcombs; i++)
+   {
+      rev->comb[i]     = buffer;
+      rev->combsize[i] = ref->left.combL[i].bufsize;
+      buffer += 2 * rev->combsize[i];
+   }
+
+   for (i = 0; i < numallpasses; i++)
+   {
+      rev->allpass[i]     = buffer;
+      rev->allpasssize[i] = ref->left.allpassL[i].bufsize;
+      buffer += 2 * rev->allpasssize[i];
+   }
+
+   rev->gain            = ref->left.gain;
+   rev->feedback        = ref->left.combL[0].feedback;
+   rev->damp1           = ref->left.combL[0].damp1;
+   rev->damp2           = ref->left.combL[0].damp2;
+   rev->allpassfeedback = ref->left.allpassL[0].feedback;
+   rev->dry             = ref->left.dry;
+   rev->wet1            = ref->left.wet1;
+
+   reverb_free(ref);
+   return rev;
+
+error:
+   if (ref)
+      reverb_free(ref);
+   reverb_lanes_free(rev);
+   return NULL;
+}
+#endif
+
+#if defined(__SSE__)
+static void reverb_process_sse(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned i, c;
+   struct reverb_lanes *rev = (struct reverb_lanes*)data;
+   __m128 filterstore[numcombs / 2];
+
+   __m128 gain            = _mm_set1_ps(rev->gain);
+   __m128 feedback        = _mm_set1_ps(rev->feedback);
+   __m128 damp1           = _mm_set1_ps(rev->damp1);
+   __m128 damp2           = _mm_set1_ps(rev->damp2);
+   __m128 allpassfeedback = _mm_set1_ps(rev->allpassfeedback);
+   __m128 dry             = _mm_set1_ps(rev->dry);
+   __m128 wet1            = _mm_set1_ps(rev->wet1);
+
+   output->samples = input->samples;
+   output->frames  = input->frames;
+   float *out = output->samples;
+
+   for (c = 0; c < numcombs / 2; c++)
+      filterstore[c] = _mm_loadu_ps(rev->filterstore + 4 * c);
+
+   for (i = 0; i < input->frames; i++, out += 2)
+   {
+      // { L, R, L, R }
+      __m128 in  = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)out);
+      __m128 x   = _mm_mul_ps(_mm_movelh_ps(in, in), gain);
+      __m128 sum = _mm_setzero_ps();
+
+      for (c = 0; c < numcombs / 2; c++)
+      {
+         float *a = rev->comb[2 * c + 0] + 2 * rev->combidx[2 * c + 0];
+         float *b = rev->comb[2 * c + 1] + 2 * rev->combidx[2 * c + 1];
+
+         __m128 comb = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(),
+                  (const __m64*)a), (const __m64*)b);
+
+         filterstore[c] = _mm_add_ps(_mm_mul_ps(comb, damp2),
+               _mm_mul_ps(filterstore[c], damp1));
+
+         __m128 res = _mm_add_ps(x, _mm_mul_ps(filterstore[c], feedback));
+         _mm_storel_pi((__m64*)a, res);
+         _mm_storeh_pi((__m64*)b, res);
+
+         sum = _mm_add_ps(sum, comb);
+      }
+
+      for (c = 0; c < numcombs; c++)
+         if (++rev->combidx[c] >= rev->combsize[c])
+            rev->combidx[c] = 0;
+
+      sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+
+      for (c = 0; c < numallpasses; c++)
+      {
+         float *a = rev->allpass[c] + 2 * rev->allpassidx[c];
+         __m128 bufout = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)a);
+
+         _mm_storel_pi((__m64*)a, _mm_add_ps(sum,
+                  _mm_mul_ps(bufout, allpassfeedback)));
+         sum = _mm_sub_ps(bufout, sum);
+
+         if (++rev->allpassidx[c] >= rev->allpasssize[c])
+            rev->allpassidx[c] = 0;
+      }
+
+      _mm_storel_pi((__m64*)out, _mm_add_ps(_mm_mul_ps(in, dry),
+               _mm_mul_ps(sum, wet1)));
+   }
+
+   for (c = 0; c < numcombs / 2; c++)
+      _mm_storeu_ps(rev->filterstore + 4 * c, filterstore[c]);
+}
+
+static const struct dspfilter_implementation reverb_plug_sse = {
+   reverb_lanes_init,
+   reverb_process_sse,
+   reverb_lanes_free,
+
+   DSPFILTER_API_VERSION,
+   "Reverb (SSE)",
+   "reverb",
+};
+#elif defined(__ARM_NEON__)
+static void reverb_process_neon(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned i, c;
+   struct reverb_lanes *rev = (struct reverb_lanes*)data;
+   float32x4_t filterstore[numcombs / 2];
+
+   output->samples = input->samples;
+   output->frames  = input->frames;
+   float *out = output->samples;
+
+   for (c = 0; c < numcombs / 2; c++)
+      filterstore[c] = vld1q_f32(rev->filterstore + 4 * c);
+
+   for (i = 0; i < input->frames; i++, out += 2)
+   {
+      // { L, R, L, R }
+      float32x2_t in  = vld1_f32(out);
+      float32x2_t x2  = vmul_n_f32(in, rev->gain);
+      float32x4_t x   = vcombine_f32(x2, x2);
+      float32x4_t sum = vdupq_n_f32(0.0f);
+      float32x2_t mono;
+
+      for (c = 0; c < numcombs / 2; c++)
+      {
+         float *a = rev->comb[2 * c + 0] + 2 * rev->combidx[2 * c + 0];
+         float *b = rev->comb[2 * c + 1] + 2 * rev->combidx[2 * c + 1];
+
+         float32x4_t comb = vcombine_f32(vld1_f32(a), vld1_f32(b));
+
+         filterstore[c] = vmlaq_n_f32(vmulq_n_f32(comb, rev->damp2),
+               filterstore[c], rev->damp1);
+
+         float32x4_t res = vmlaq_n_f32(x, filterstore[c], rev->feedback);
+         vst1_f32(a, vget_low_f32(res));
+         vst1_f32(b, vget_high_f32(res));
+
+         sum = vaddq_f32(sum, comb);
+      }
+
+      for (c = 0; c < numcombs; c++)
+         if (++rev->combidx[c] >= rev->combsize[c])
+            rev->combidx[c] = 0;
+
+      mono = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+
+      for (c = 0; c < numallpasses; c++)
+      {
+         float *a = rev->allpass[c] + 2 * rev->allpassidx[c];
+         float32x2_t bufout = vld1_f32(a);
+
+         vst1_f32(a, vmla_n_f32(mono, bufout, rev->allpassfeedback));
+         mono = vsub_f32(bufout, mono);
+
+         if (++rev->allpassidx[c] >= rev->allpasssize[c])
+            rev->allpassidx[c] = 0;
+      }
+
+      vst1_f32(out, vmla_n_f32(vmul_n_f32(in, rev->dry), mono, rev->wet1));
+   }
+
+   for (c = 0; c < numcombs / 2; c++)
+      vst1q_f32(rev->filterstore + 4 * c, filterstore[c]);
+}
+
+static const struct dspfilter_implementation reverb_plug_neon = {
+   reverb_lanes_init,
+   reverb_process_neon,
+   reverb_lanes_free,
+
+   DSPFILTER_API_VERSION,
+   "Reverb (NEON)",
+   "reverb",
+};
+#endif
+
 #ifdef HAVE_FILTERS_BUILTIN
 #define dspfilter_get_implementation reverb_dspfilter_get_implementation
 #endif
@@ -307,6 +563,13 @@ static const struct dspfilter_implementation reverb_plug = {
 const struct dspfilter_implementation *dspfilter_get_implementation(dspfilter_simd_mask_t mask)
 {
    (void)mask;
+#if defined(__SSE__)
+   if (mask & DSPFILTER_SIMD_SSE)
+      return &reverb_plug_sse;
+#elif defined(__ARM_NEON__)
+   if (mask & DSPFILTER_SIMD_NEON)
+      return &reverb_plug_neon;
+#endif
    return &reverb_plug;
 }
 
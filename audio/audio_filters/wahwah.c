@@ -19,6 +19,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #define wahwahlfoskipsamples 30
 
 #ifndef M_PI
@@ -45,6 +51,25 @@ static void wahwah_free(void *data)
    free(data);
 }
 
+static void wahwah_update(struct wahwah_data *wah)
+{
+   float frequency = (1.0 + cos(wah->skipcount * wah->lfoskip + wah->phase)) / 2.0;
+   frequency = frequency * wah->depth * (1.0 - wah->freqofs) + wah->freqofs;
+   frequency = exp((frequency - 1.0) * 6.0);
+
+   float omega = M_PI * frequency;
+   float sn = sin(omega);
+   float cs = cos(omega);
+   float alpha = sn / (2.0 * wah->res);
+
+   wah->b0 = (1.0 - cs) / 2.0;
+   wah->b1 = 1.0 - cs;
+   wah->b2 = (1.0 - cs) / 2.0;
+   wah->a0 = 1.0 + alpha;
+   wah->a1 = -2.0 * cs;
+   wah->a2 = 1.0 - alpha;
+}
+
 static void wahwah_process(void *data, struct dspfilter_output *output,
       const struct dspfilter_input *input)
 {
@@ -60,23 +85,7 @@ static void wahwah_process(void *data, struct dspfilter_output *output,
       float in[2] = { out[0], out[1] };
 
       if ((wah->skipcount++ % wahwahlfoskipsamples) == 0)
-      {
-         float frequency = (1.0 + cos(wah->skipcount * wah->lfoskip + wah->phase)) / 2.0;
-         frequency = frequency * wah->depth * (1.0 - wah->freqofs) + wah->freqofs;
-         frequency = exp((frequency - 1.0) * 6.0);
-
-         float omega = M_PI * frequency;
-         float sn = sin(omega);
-         float cs = cos(omega);
-         float alpha = sn / (2.0 * wah->res);
-
-         wah->b0 = (1.0 - cs) / 2.0;
-         wah->b1 = 1.0 - cs;
-         wah->b2 = (1.0 - cs) / 2.0;
-         wah->a0 = 1.0 + alpha;
-         wah->a1 = -2.0 * cs;
-         wah->a2 = 1.0 - alpha;
-      }
+         wahwah_update(wah);
 
       float out_l = (wah->b0 * in[0] + wah->b1 * wah->l.xn1 + wah->b2 * wah->l.xn2 - wah->a1 * wah->l.yn1 - wah->a2 * wah->l.yn2) / wah->a0;
       float out_r = (wah->b0 * in[1] + wah->b1 * wah->r.xn1 + wah->b2 * wah->r.xn2 - wah->a1 * wah->r.yn1 - wah->a2 * wah->r.yn2) / wah->a0;
@@ -96,6 +105,136 @@ static void wahwah_process(void *data, struct dspfilter_output *output,
    }
 }
 
+// The vectorized paths run both channels in parallel lanes, with
+// the coefficients scaled by 1 / a0 once per LFO step instead of
+// dividing every sample.
+#if defined(__SSE__)
+static void wahwah_process_sse(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned i;
+   float state[4];
+   struct wahwah_data *wah = (struct wahwah_data*)data;
+   __m128 b0, b1, b2, a1, a2;
+
+   output->samples = input->samples;
+   output->frames  = input->frames;
+   float *out = output->samples;
+
+   __m128 xn1 = _mm_setr_ps(wah->l.xn1, wah->r.xn1, 0.0f, 0.0f);
+   __m128 xn2 = _mm_setr_ps(wah->l.xn2, wah->r.xn2, 0.0f, 0.0f);
+   __m128 yn1 = _mm_setr_ps(wah->l.yn1, wah->r.yn1, 0.0f, 0.0f);
+   __m128 yn2 = _mm_setr_ps(wah->l.yn2, wah->r.yn2, 0.0f, 0.0f);
+
+   b0 = _mm_set1_ps(wah->b0 / wah->a0);
+   b1 = _mm_set1_ps(wah->b1 / wah->a0);
+   b2 = _mm_set1_ps(wah->b2 / wah->a0);
+   a1 = _mm_set1_ps(wah->a1 / wah->a0);
+   a2 = _mm_set1_ps(wah->a2 / wah->a0);
+
+   for (i = 0; i < input->frames; i++, out += 2)
+   {
+      if ((wah->skipcount++ % wahwahlfoskipsamples) == 0)
+      {
+         wahwah_update(wah);
+
+         b0 = _mm_set1_ps(wah->b0 / wah->a0);
+         b1 = _mm_set1_ps(wah->b1 / wah->a0);
+         b2 = _mm_set1_ps(wah->b2 / wah->a0);
+         a1 = _mm_set1_ps(wah->a1 / wah->a0);
+         a2 = _mm_set1_ps(wah->a2 / wah->a0);
+      }
+
+      __m128 in = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)out);
+
+      __m128 res = _mm_mul_ps(b0, in);
+      res = _mm_add_ps(res, _mm_mul_ps(b1, xn1));
+      res = _mm_add_ps(res, _mm_mul_ps(b2, xn2));
+      res = _mm_sub_ps(res, _mm_mul_ps(a1, yn1));
+      res = _mm_sub_ps(res, _mm_mul_ps(a2, yn2));
+
+      xn2 = xn1;
+      xn1 = in;
+      yn2 = yn1;
+      yn1 = res;
+
+      _mm_storel_pi((__m64*)out, res);
+   }
+
+   _mm_storeu_ps(state, _mm_movelh_ps(xn1, xn2));
+   wah->l.xn1 = state[0];
+   wah->r.xn1 = state[1];
+   wah->l.xn2 = state[2];
+   wah->r.xn2 = state[3];
+
+   _mm_storeu_ps(state, _mm_movelh_ps(yn1, yn2));
+   wah->l.yn1 = state[0];
+   wah->r.yn1 = state[1];
+   wah->l.yn2 = state[2];
+   wah->r.yn2 = state[3];
+}
+#elif defined(__ARM_NEON__)
+static void wahwah_process_neon(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned i;
+   struct wahwah_data *wah = (struct wahwah_data*)data;
+
+   output->samples = input->samples;
+   output->frames  = input->frames;
+   float *out = output->samples;
+
+   float32x2_t xn1 = vset_lane_f32(wah->r.xn1, vdup_n_f32(wah->l.xn1), 1);
+   float32x2_t xn2 = vset_lane_f32(wah->r.xn2, vdup_n_f32(wah->l.xn2), 1);
+   float32x2_t yn1 = vset_lane_f32(wah->r.yn1, vdup_n_f32(wah->l.yn1), 1);
+   float32x2_t yn2 = vset_lane_f32(wah->r.yn2, vdup_n_f32(wah->l.yn2), 1);
+
+   float b0 = wah->b0 / wah->a0;
+   float b1 = wah->b1 / wah->a0;
+   float b2 = wah->b2 / wah->a0;
+   float a1 = wah->a1 / wah->a0;
+   float a2 = wah->a2 / wah->a0;
+
+   for (i = 0; i < input->frames; i++, out += 2)
+   {
+      if ((wah->skipcount++ % wahwahlfoskipsamples) == 0)
+      {
+         wahwah_update(wah);
+
+         b0 = wah->b0 / wah->a0;
+         b1 = wah->b1 / wah->a0;
+         b2 = wah->b2 / wah->a0;
+         a1 = wah->a1 / wah->a0;
+         a2 = wah->a2 / wah->a0;
+      }
+
+      float32x2_t in = vld1_f32(out);
+
+      float32x2_t res = vmul_n_f32(in, b0);
+      res = vmla_n_f32(res, xn1, b1);
+      res = vmla_n_f32(res, xn2, b2);
+      res = vmls_n_f32(res, yn1, a1);
+      res = vmls_n_f32(res, yn2, a2);
+
+      xn2 = xn1;
+      xn1 = in;
+      yn2 = yn1;
+      yn1 = res;
+
+      vst1_f32(out, res);
+   }
+
+   wah->l.xn1 = vget_lane_f32(xn1, 0);
+   wah->r.xn1 = vget_lane_f32(xn1, 1);
+   wah->l.xn2 = vget_lane_f32(xn2, 0);
+   wah->r.xn2 = vget_lane_f32(xn2, 1);
+   wah->l.yn1 = vget_lane_f32(yn1, 0);
+   wah->r.yn1 = vget_lane_f32(yn1, 1);
+   wah->l.yn2 = vget_lane_f32(yn2, 0);
+   wah->r.yn2 = vget_lane_f32(yn2, 1);
+}
+#endif
+
 static void *wahwah_init(const struct dspfilter_info *info,
       const struct dspfilter_config *config, void *userdata)
 {
@@ -112,6 +251,10 @@ static void *wahwah_init(const struct dspfilter_info *info,
    wah->lfoskip = wah->freq * 2.0 * M_PI / info->input_rate;
    wah->phase = wah->startphase * M_PI / 180.0;
 
+   // The first frame recomputes these, but have
+   // valid coefficients before that.
+   wahwah_update(wah);
+
    return wah;
 }
 
@@ -125,6 +268,28 @@ static const struct dspfilter_implementation wahwah_plug = {
    "wahwah",
 };
 
+#if defined(__SSE__)
+static const struct dspfilter_implementation wahwah_plug_sse = {
+   wahwah_init,
+   wahwah_process_sse,
+   wahwah_free,
+
+   DSPFILTER_API_VERSION,
+   "Wah-Wah (SSE)",
+   "wahwah",
+};
+#elif defined(__ARM_NEON__)
+static const struct dspfilter_implementation wahwah_plug_neon = {
+   wahwah_init,
+   wahwah_process_neon,
+   wahwah_free,
+
+   DSPFILTER_API_VERSION,
+   "Wah-Wah (NEON)",
+   "wahwah",
+};
+#endif
+
 #ifdef HAVE_FILTERS_BUILTIN
 #define dspfilter_get_implementation wahwah_dspfilter_get_implementation
 #endif
@@ -132,6 +297,13 @@ static const struct dspfilter_implementation wahwah_plug = {
 const struct dspfilter_implementation *dspfilter_get_implementation(dspfilter_simd_mask_t mask)
 {
    (void)mask;
+#if defined(__SSE__)
+   if (mask & DSPFILTER_SIMD_SSE)
+      return &wahwah_plug_sse;
+#elif defined(__ARM_NEON__)
+   if (mask & DSPFILTER_SIMD_NEON)
+      return &wahwah_plug_neon;
+#endif
    return &wahwah_plug;
 }
 
@@ -168,6 +168,7 @@ static const rarch_resampler_t *find_resampler_driver(const char *ident)
  * resampler_append_plugs:
  * @re                         : Resampler handle
  * @backend                    : Resampler backend that is about to be set.
+ * @quality                    : Quality level.
  * @bw_ratio                   : Bandwidth ratio.
  *
  * Initializes resampler driver based on queried CPU features.
@@ -176,11 +177,11 @@ static const rarch_resampler_t *find_resampler_driver(const char *ident)
  **/
 static bool resampler_append_plugs(void **re,
       const rarch_resampler_t **backend,
-      double bw_ratio)
+      enum resampler_quality quality, double bw_ratio)
 {
    resampler_simd_mask_t mask = rarch_get_cpu_features();
 
-   *re = (*backend)->init(&resampler_config, bw_ratio, mask);
+   *re = (*backend)->init(&resampler_config, bw_ratio, quality, mask);
 
    if (!*re)
       return false;
@@ -192,6 +193,7 @@ static bool resampler_append_plugs(void **re,
  * @re                         : Resampler handle
  * @backend                    : Resampler backend that is about to be set.
  * @ident                      : Identifier name for resampler we want.
+ * @quality                    : Quality level, see enum resampler_quality.
  * @bw_ratio                   : Bandwidth ratio.
  *
  * Reallocates resampler. Will free previous handle before 
@@ -200,7 +202,7 @@ static bool resampler_append_plugs(void **re,
  * Returns: true (1) if successful, otherwise false (0).
  **/
 bool rarch_resampler_realloc(void **re, const rarch_resampler_t **backend,
-      const char *ident, double bw_ratio)
+      const char *ident, enum resampler_quality quality, double bw_ratio)
 {
    if (*re && *backend)
       (*backend)->free(*re);
@@ -208,7 +210,7 @@ bool rarch_resampler_realloc(void **re, const rarch_resampler_t **backend,
    *re      = NULL;
    *backend = find_resampler_driver(ident);
 
-   if (!resampler_append_plugs(re, backend, bw_ratio))
+   if (!resampler_append_plugs(re, backend, quality, bw_ratio))
       goto error;
 
    return true;
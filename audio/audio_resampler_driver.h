@@ -53,7 +53,19 @@ extern "C" {
  */
 typedef unsigned resampler_simd_mask_t;
 
-#define RESAMPLER_API_VERSION 1
+#define RESAMPLER_API_VERSION 2
+
+/* Quality/performance trade-off, only used by resamplers
+ * which have more than one quality level. */
+enum resampler_quality
+{
+   RESAMPLER_QUALITY_DONTCARE = 0,
+   RESAMPLER_QUALITY_LOWEST,
+   RESAMPLER_QUALITY_LOWER,
+   RESAMPLER_QUALITY_NORMAL,
+   RESAMPLER_QUALITY_HIGHER,
+   RESAMPLER_QUALITY_HIGHEST
+};
 
 struct resampler_data
 {
@@ -108,7 +120,8 @@ struct resampler_config
 /* Bandwidth factor. Will be < 1.0 for downsampling, > 1.0 for upsampling. 
  * Corresponds to expected resampling ratio. */
 typedef void *(*resampler_init_t)(const struct resampler_config *config,
-      double bandwidth_mod, resampler_simd_mask_t mask);
+      double bandwidth_mod, enum resampler_quality quality,
+      resampler_simd_mask_t mask);
 
 /* Frees the handle. */
 typedef void (*resampler_free_t)(void *data);
@@ -177,6 +190,7 @@ const char *audio_resampler_driver_find_ident(int index);
  * @re                         : Resampler handle
  * @backend                    : Resampler backend that is about to be set.
  * @ident                      : Identifier name for resampler we want.
+ * @quality                    : Quality level, see enum resampler_quality.
  * @bw_ratio                   : Bandwidth ratio.
  *
  * Reallocates resampler. Will free previous handle before 
@@ -185,7 +199,7 @@ const char *audio_resampler_driver_find_ident(int index);
  * Returns: true (1) if successful, otherwise false (0).
  **/
 bool rarch_resampler_realloc(void **re, const rarch_resampler_t **backend,
-      const char *ident, double bw_ratio);
+      const char *ident, enum resampler_quality quality, double bw_ratio);
 
 /* Convenience macros.
  * freep makes sure to set handles to NULL to avoid double-free 
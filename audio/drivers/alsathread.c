@@ -20,7 +20,7 @@
 #include <alsa/asoundlib.h>
 #include "../../general.h"
 #include <rthreads/rthreads.h>
-#include <queues/fifo_buffer.h>
+#include <queues/fifo_spsc.h>
 
 #define TRY_ALSA(x) if (x < 0) { \
                   goto error; \
@@ -38,11 +38,8 @@ typedef struct alsa_thread
    size_t period_size;
    snd_pcm_uframes_t period_frames;
 
-   fifo_buffer_t *buffer;
+   fifo_spsc_t *buffer;
    sthread_t *worker_thread;
-   slock_t *fifo_lock;
-   scond_t *cond;
-   slock_t *cond_lock;
 } alsa_thread_t;
 
 static void alsa_worker_thread(void *data)
@@ -58,12 +55,7 @@ static void alsa_worker_thread(void *data)
 
    while (!alsa->thread_dead)
    {
-      slock_lock(alsa->fifo_lock);
-      size_t avail = fifo_read_avail(alsa->buffer);
-      size_t fifo_size = min(alsa->period_size, avail);
-      fifo_read(alsa->buffer, buf, fifo_size);
-      scond_signal(alsa->cond);
-      slock_unlock(alsa->fifo_lock);
+      size_t fifo_size = fifo_spsc_read(alsa->buffer, buf, alsa->period_size);
 
       /* If underrun, fill rest with silence. */
       memset(buf + fifo_size, 0, alsa->period_size - fifo_size);
@@ -92,10 +84,9 @@ static void alsa_worker_thread(void *data)
    }
 
 end:
-   slock_lock(alsa->cond_lock);
    alsa->thread_dead = true;
-   scond_signal(alsa->cond);
-   slock_unlock(alsa->cond_lock);
+   /* Wakes up a writer blocked on a full buffer. */
+   fifo_spsc_close(alsa->buffer);
    free(buf);
 }
 
@@ -129,13 +120,7 @@ static void alsa_thread_free(void *data)
          sthread_join(alsa->worker_thread);
       }
       if (alsa->buffer)
-         fifo_free(alsa->buffer);
-      if (alsa->cond)
-         scond_free(alsa->cond);
-      if (alsa->fifo_lock)
-         slock_free(alsa->fifo_lock);
-      if (alsa->cond_lock)
-         slock_free(alsa->cond_lock);
+         fifo_spsc_free(alsa->buffer);
       if (alsa->pcm)
       {
          snd_pcm_drop(alsa->pcm);
@@ -208,11 +193,8 @@ static void *alsa_thread_init(const char *device,
    snd_pcm_hw_params_free(params);
    snd_pcm_sw_params_free(sw_params);
 
-   alsa->fifo_lock = slock_new();
-   alsa->cond_lock = slock_new();
-   alsa->cond = scond_new();
-   alsa->buffer = fifo_new(alsa->buffer_size);
-   if (!alsa->fifo_lock || !alsa->cond_lock || !alsa->cond || !alsa->buffer)
+   alsa->buffer = fifo_spsc_new(alsa->buffer_size);
+   if (!alsa->buffer)
       goto error;
 
    alsa->worker_thread = sthread_create(alsa_worker_thread, alsa);
@@ -245,37 +227,17 @@ static ssize_t alsa_thread_write(void *data, const void *buf, size_t size)
       return -1;
 
    if (alsa->nonblock)
-   {
-      slock_lock(alsa->fifo_lock);
-      size_t avail = fifo_write_avail(alsa->buffer);
-      size_t write_amt = min(avail, size);
-      fifo_write(alsa->buffer, buf, write_amt);
-      slock_unlock(alsa->fifo_lock);
-      return write_amt;
-   }
+      return fifo_spsc_write(alsa->buffer, buf, size);
    else
    {
       size_t written = 0;
       while (written < size && !alsa->thread_dead)
       {
-         slock_lock(alsa->fifo_lock);
-         size_t avail = fifo_write_avail(alsa->buffer);
+         written += fifo_spsc_write(alsa->buffer,
+               (const char*)buf + written, size - written);
 
-         if (avail == 0)
-         {
-            slock_unlock(alsa->fifo_lock);
-            slock_lock(alsa->cond_lock);
-            if (!alsa->thread_dead)
-               scond_wait(alsa->cond, alsa->cond_lock);
-            slock_unlock(alsa->cond_lock);
-         }
-         else
-         {
-            size_t write_amt = min(size - written, avail);
-            fifo_write(alsa->buffer, (const char*)buf + written, write_amt);
-            slock_unlock(alsa->fifo_lock);
-            written += write_amt;
-         }
+         if (written < size && !fifo_spsc_wait_write(alsa->buffer, 1, -1))
+            break;
       }
       return written;
    }
@@ -319,10 +281,7 @@ static size_t alsa_thread_write_avail(void *data)
 
    if (alsa->thread_dead)
       return 0;
-   slock_lock(alsa->fifo_lock);
-   size_t val = fifo_write_avail(alsa->buffer);
-   slock_unlock(alsa->fifo_lock);
-   return val;
+   return fifo_spsc_write_avail(alsa->buffer);
 }
 
 static size_t alsa_thread_buffer_size(void *data)
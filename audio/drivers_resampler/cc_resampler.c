@@ -26,6 +26,7 @@
 #if !defined(RESAMPLER_TEST) && defined(RARCH_INTERNAL)
 #include "../../general.h"
 #else
+#include <stdio.h>
 /* FIXME - variadic macros not supported for MSVC 2003 */
 #define RARCH_LOG(...) fprintf(stderr, __VA_ARGS__)
 #endif
@@ -190,9 +191,11 @@ static void resampler_CC_free(void *re_)
 }
 
 static void *resampler_CC_init(const struct resampler_config *config,
-      double bandwidth_mod, resampler_simd_mask_t mask)
+      double bandwidth_mod, enum resampler_quality quality,
+      resampler_simd_mask_t mask)
 {
    (void)mask;
+   (void)quality;
    (void)bandwidth_mod;
    (void)config;
 
@@ -550,7 +553,8 @@ static void resampler_CC_free(void *re_)
 }
 
 static void *resampler_CC_init(const struct resampler_config *config,
-      double bandwidth_mod, resampler_simd_mask_t mask)
+      double bandwidth_mod, enum resampler_quality quality,
+      resampler_simd_mask_t mask)
 {
    int i;
    rarch_CC_resampler_t *re = (rarch_CC_resampler_t*)
@@ -561,6 +565,7 @@ static void *resampler_CC_init(const struct resampler_config *config,
     * C codepath or NEON codepath. This will help out
     * Android. */
    (void)mask;
+   (void)quality;
    (void)config;
 
    if (!re)
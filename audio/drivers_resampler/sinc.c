@@ -1,6 +1,6 @@
 /*  RetroArch - A frontend for libretro.
  *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
- * 
+ *
  *  RetroArch is free software: you can redistribute it and/or modify it under the terms
  *  of the GNU General Public License as published by the Free Software Found-
  *  ation, either version 3 of the License, or (at your option) any later version.
@@ -25,6 +25,7 @@
 #if !defined(RESAMPLER_TEST) && defined(RARCH_INTERNAL)
 #include "../../general.h"
 #else
+#include <stdio.h>
 #define RARCH_LOG(...) fprintf(stderr, __VA_ARGS__)
 #endif
 
@@ -32,77 +33,71 @@
 #include <xmmintrin.h>
 #endif
 
-/* Rough SNR values for upsampling:
- * LOWEST: 40 dB
- * LOWER: 55 dB
- * NORMAL: 70 dB
- * HIGHER: 110 dB
- * HIGHEST: 140 dB
- */
-
-/* TODO, make all this more configurable. */
-#if defined(SINC_LOWEST_QUALITY)
-#define SINC_WINDOW_LANCZOS
-#define CUTOFF 0.98
-#define PHASE_BITS 12
-#define SINC_COEFF_LERP 0
-#define SUBPHASE_BITS 10
-#define SIDELOBES 2
-#define ENABLE_AVX 0
-#elif defined(SINC_LOWER_QUALITY)
-#define SINC_WINDOW_LANCZOS
-#define CUTOFF 0.98
-#define PHASE_BITS 12
-#define SUBPHASE_BITS 10
-#define SINC_COEFF_LERP 0
-#define SIDELOBES 4
-#define ENABLE_AVX 0
-#elif defined(SINC_HIGHER_QUALITY)
-#define SINC_WINDOW_KAISER
-#define SINC_WINDOW_KAISER_BETA 10.5
-#define CUTOFF 0.90
-#define PHASE_BITS 10
-#define SUBPHASE_BITS 14
-#define SINC_COEFF_LERP 1
-#define SIDELOBES 32
-#define ENABLE_AVX 1
-#elif defined(SINC_HIGHEST_QUALITY)
-#define SINC_WINDOW_KAISER
-#define SINC_WINDOW_KAISER_BETA 14.5
-#define CUTOFF 0.962
-#define PHASE_BITS 10
-#define SUBPHASE_BITS 14
-#define SINC_COEFF_LERP 1
-#define SIDELOBES 128
-#define ENABLE_AVX 1
-#else
-#define SINC_WINDOW_KAISER
-#define SINC_WINDOW_KAISER_BETA 5.5
-#define CUTOFF 0.825
-#define PHASE_BITS 8
-#define SUBPHASE_BITS 16
-#define SINC_COEFF_LERP 1
-#define SIDELOBES 8
-#define ENABLE_AVX 0
+/* The AVX2 kernel is built with a function-level target,
+ * so it can be picked at runtime without building the whole
+ * file for AVX2. */
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || \
+      (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#include <immintrin.h>
+#define SINC_HAVE_AVX2
+#define SINC_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#elif defined(_MSC_VER) && _MSC_VER >= 1700 && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#define SINC_HAVE_AVX2
+#define SINC_TARGET_AVX2
 #endif
 
-/* For the little amount of taps we're using,
- * SSE1 is faster than AVX for some reason.
- * AVX code is kept here though as by increasing number
- * of sinc taps, the AVX code is clearly faster than SSE1.
- */
+/* For the little amount of taps used by the lower quality
+ * levels, SSE1 is faster than AVX. Below this amount of taps,
+ * AVX2 is not used even when it is available. */
+#define SINC_AVX2_MIN_TAPS 32
 
-#if defined(__AVX__) && ENABLE_AVX
-#include <immintrin.h>
-#endif
+enum sinc_window
+{
+   SINC_WINDOW_LANCZOS = 0,
+   SINC_WINDOW_KAISER
+};
+
+struct sinc_params
+{
+   enum sinc_window window;
+   double kaiser_beta;
+   double cutoff;
+   unsigned phase_bits;
+   unsigned subphase_bits;
+   unsigned sidelobes;
+   /* Interpolate between phases, needs a delta table. */
+   bool coeff_lerp;
+};
+
+/* Indexed by enum resampler_quality.
+ *
+ * SNR for 44.1 kHz to 48 kHz, as measured by audio/test/bench-sinc
+ * with a 1 kHz (10 kHz) tone:
+ * LOWEST: 45 dB (33 dB)
+ * LOWER: 57 dB (55 dB)
+ * NORMAL: 67 dB (68 dB)
+ * HIGHER: 111 dB (91 dB)
+ * HIGHEST: 111 dB (91 dB)
+ *
+ * HIGHEST has a higher cutoff than HIGHER, so it keeps more of the
+ * top end, but its SNR is no better at these rates.
+ */
+static const struct sinc_params sinc_quality_params[] = {
+   { SINC_WINDOW_KAISER,   5.5, 0.825,  8, 16,   8, true  }, /* DONTCARE */
+   { SINC_WINDOW_LANCZOS,  0.0, 0.98,  12, 10,   2, false }, /* LOWEST */
+   { SINC_WINDOW_LANCZOS,  0.0, 0.98,  12, 10,   4, false }, /* LOWER */
+   { SINC_WINDOW_KAISER,   5.5, 0.825,  8, 16,   8, true  }, /* NORMAL */
+   { SINC_WINDOW_KAISER,  10.5, 0.90,  10, 14,  32, true  }, /* HIGHER */
+   { SINC_WINDOW_KAISER,  14.5, 0.962, 10, 14, 128, true  }, /* HIGHEST */
+};
 
-#define PHASES (1 << (PHASE_BITS + SUBPHASE_BITS))
+typedef struct rarch_sinc_resampler rarch_sinc_resampler_t;
 
-#define TAPS (SIDELOBES * 2)
-#define SUBPHASE_MASK ((1 << SUBPHASE_BITS) - 1)
-#define SUBPHASE_MOD (1.0f / (1 << SUBPHASE_BITS))
+typedef void (*sinc_kernel_t)(rarch_sinc_resampler_t *resamp,
+      float *out_buffer);
 
-typedef struct rarch_sinc_resampler
+struct rarch_sinc_resampler
 {
    float *phase_table;
    float *buffer_l;
@@ -113,11 +108,19 @@ typedef struct rarch_sinc_resampler
    unsigned ptr;
    uint32_t time;
 
-   /* A buffer for phase_table, buffer_l and buffer_r 
+   uint32_t phases;
+   unsigned subphase_bits;
+   uint32_t subphase_mask;
+   float subphase_mod;
+
+   const struct sinc_params *params;
+   sinc_kernel_t kernel;
+
+   /* A buffer for phase_table, buffer_l and buffer_r
     * are created in a single calloc().
     * Ensure that we get as good cache locality as we can hope for. */
    float *main_buffer;
-} rarch_sinc_resampler_t;
+};
 
 static inline double sinc(double val)
 {
@@ -126,12 +129,6 @@ static inline double sinc(double val)
    return sin(val) / val;
 }
 
-#if defined(SINC_WINDOW_LANCZOS)
-static inline double window_function(double idx)
-{
-   return sinc(M_PI * idx);
-}
-#elif defined(SINC_WINDOW_KAISER)
 /* Modified Bessel function of first order.
  * Check Wiki for mathematical definition ... */
 static inline double besseli0(double x)
@@ -160,19 +157,21 @@ static inline double besseli0(double x)
    return sum;
 }
 
-static inline double window_function(double idx)
+static inline double window_function(const struct sinc_params *params,
+      double idx)
 {
-   return besseli0(SINC_WINDOW_KAISER_BETA * sqrt(1 - idx * idx));
+   if (params->window == SINC_WINDOW_LANCZOS)
+      return sinc(M_PI * idx);
+   return besseli0(params->kaiser_beta * sqrt(1 - idx * idx));
 }
-#else
-#error "No SINC window function defined."
-#endif
 
 static void init_sinc_table(rarch_sinc_resampler_t *resamp, double cutoff,
       float *phase_table, int phases, int taps, bool calculate_delta)
 {
    int i, j, p;
-   double window_mod = window_function(0.0); /* Need to normalize w(0) to 1.0. */
+   const struct sinc_params *params = resamp->params;
+   /* Need to normalize w(0) to 1.0. */
+   double window_mod = window_function(params, 0.0);
    int stride = calculate_delta ? 2 : 1;
    double sidelobes = taps / 2.0;
 
@@ -187,8 +186,8 @@ static void init_sinc_table(rarch_sinc_resampler_t *resamp, double cutoff,
          window_phase = 2.0 * window_phase - 1.0; /* [-1, 1) */
          sinc_phase = sidelobes * window_phase;
 
-         val = cutoff * sinc(M_PI * sinc_phase * cutoff) * 
-            window_function(window_phase) / window_mod;
+         val = cutoff * sinc(M_PI * sinc_phase * cutoff) *
+            window_function(params, window_phase) / window_mod;
          phase_table[i * stride * taps + j] = val;
       }
    }
@@ -200,7 +199,7 @@ static void init_sinc_table(rarch_sinc_resampler_t *resamp, double cutoff,
       {
          for (j = 0; j < taps; j++)
          {
-            float delta = phase_table[(p + 1) * stride * taps + j] - 
+            float delta = phase_table[(p + 1) * stride * taps + j] -
                phase_table[p * stride * taps + j];
             phase_table[(p * stride + 1) * taps + j] = delta;
          }
@@ -216,8 +215,8 @@ static void init_sinc_table(rarch_sinc_resampler_t *resamp, double cutoff,
          window_phase = 2.0 * window_phase - 1.0; /* (-1, 1] */
          sinc_phase = sidelobes * window_phase;
 
-         val = cutoff * sinc(M_PI * sinc_phase * cutoff) * 
-            window_function(window_phase) / window_mod;
+         val = cutoff * sinc(M_PI * sinc_phase * cutoff) *
+            window_function(params, window_phase) / window_mod;
          delta = (val - phase_table[phase * stride * taps + j]);
          phase_table[(phase * stride + 1) * taps + j] = delta;
       }
@@ -234,7 +233,7 @@ static void *aligned_alloc__(size_t boundary, size_t size)
    if (!ptr)
       return NULL;
 
-   addr           = ((uintptr_t)ptr + sizeof(uintptr_t) + boundary) 
+   addr           = ((uintptr_t)ptr + sizeof(uintptr_t) + boundary)
                     & ~(boundary - 1);
    place          = (void**)addr;
    place[-1]      = ptr;
@@ -248,9 +247,12 @@ static void aligned_free__(void *ptr)
    free(p[-1]);
 }
 
-#if !(defined(__AVX__) && ENABLE_AVX) && !defined(__SSE__)
-static inline void process_sinc_C(rarch_sinc_resampler_t *resamp,
-      float *out_buffer)
+/* Each kernel comes in a plain and an interpolating (lerp) flavor.
+ * They are written once as an inline function taking a constant
+ * flag, so the flag is folded away in both wrappers. */
+
+static inline void process_sinc_C_generic(rarch_sinc_resampler_t *resamp,
+      float *out_buffer, bool lerp)
 {
    unsigned i;
    float sum_l = 0.0f;
@@ -259,22 +261,18 @@ static inline void process_sinc_C(rarch_sinc_resampler_t *resamp,
    const float *buffer_r = resamp->buffer_r + resamp->ptr;
 
    unsigned taps  = resamp->taps;
-   unsigned phase = resamp->time >> SUBPHASE_BITS;
-#if SINC_COEFF_LERP
-   const float *phase_table = resamp->phase_table + phase * taps * 2;
+   unsigned phase = resamp->time >> resamp->subphase_bits;
+   const float *phase_table = resamp->phase_table +
+      phase * taps * (lerp ? 2 : 1);
    const float *delta_table = phase_table + taps;
-   float delta = (float)(resamp->time & SUBPHASE_MASK) * SUBPHASE_MOD;
-#else
-   const float *phase_table = resamp->phase_table + phase * taps;
-#endif
+   float delta = (float)(resamp->time & resamp->subphase_mask) *
+      resamp->subphase_mod;
 
    for (i = 0; i < taps; i++)
    {
-#if SINC_COEFF_LERP
-      float sinc_val = phase_table[i] + delta_table[i] * delta;
-#else
       float sinc_val = phase_table[i];
-#endif
+      if (lerp)
+         sinc_val   += delta_table[i] * delta;
       sum_l         += buffer_l[i] * sinc_val;
       sum_r         += buffer_r[i] * sinc_val;
    }
@@ -282,104 +280,130 @@ static inline void process_sinc_C(rarch_sinc_resampler_t *resamp,
    out_buffer[0] = sum_l;
    out_buffer[1] = sum_r;
 }
-#endif
 
-#if defined(__AVX__) && ENABLE_AVX
-#define process_sinc_func process_sinc
-static void process_sinc(rarch_sinc_resampler_t *resamp, float *out_buffer)
+static void process_sinc_C(rarch_sinc_resampler_t *resamp, float *out_buffer)
+{
+   process_sinc_C_generic(resamp, out_buffer, false);
+}
+
+static void process_sinc_C_lerp(rarch_sinc_resampler_t *resamp,
+      float *out_buffer)
+{
+   process_sinc_C_generic(resamp, out_buffer, true);
+}
+
+#ifdef __SSE__
+static inline void process_sinc_sse_generic(rarch_sinc_resampler_t *resamp,
+      float *out_buffer, bool lerp)
 {
    unsigned i;
-   __m256 sum_l = _mm256_setzero_ps();
-   __m256 sum_r = _mm256_setzero_ps();
+   __m128 sum;
+   __m128 sum_l  = _mm_setzero_ps();
+   __m128 sum_r  = _mm_setzero_ps();
+   __m128 sum_l2 = _mm_setzero_ps();
+   __m128 sum_r2 = _mm_setzero_ps();
+   __m128 sum_l3 = _mm_setzero_ps();
+   __m128 sum_r3 = _mm_setzero_ps();
+   __m128 sum_l4 = _mm_setzero_ps();
+   __m128 sum_r4 = _mm_setzero_ps();
 
    const float *buffer_l = resamp->buffer_l + resamp->ptr;
    const float *buffer_r = resamp->buffer_r + resamp->ptr;
 
    unsigned taps = resamp->taps;
-   unsigned phase = resamp->time >> SUBPHASE_BITS;
-#if SINC_COEFF_LERP
-   const float *phase_table = resamp->phase_table + phase * taps * 2;
+   unsigned phase = resamp->time >> resamp->subphase_bits;
+   const float *phase_table = resamp->phase_table +
+      phase * taps * (lerp ? 2 : 1);
    const float *delta_table = phase_table + taps;
-   __m256 delta = _mm256_set1_ps((float)
-         (resamp->time & SUBPHASE_MASK) * SUBPHASE_MOD);
-#else
-   const float *phase_table = resamp->phase_table + phase * taps;
-#endif
+   __m128 delta = _mm_set1_ps((float)
+         (resamp->time & resamp->subphase_mask) * resamp->subphase_mod);
 
-   for (i = 0; i < taps; i += 8)
+   /* Four sets of sums, so that the adds of the longer
+    * filters don't all wait on each other. */
+   for (i = 0; i + 16 <= taps; i += 16)
    {
-      __m256 buf_l = _mm256_loadu_ps(buffer_l + i);
-      __m256 buf_r = _mm256_loadu_ps(buffer_r + i);
+      __m128 _sinc  = _mm_load_ps(phase_table + i);
+      __m128 _sinc2 = _mm_load_ps(phase_table + i + 4);
+      __m128 _sinc3 = _mm_load_ps(phase_table + i + 8);
+      __m128 _sinc4 = _mm_load_ps(phase_table + i + 12);
 
-#if SINC_COEFF_LERP
-      __m256 deltas = _mm256_load_ps(delta_table + i);
-      __m256 sinc = _mm256_add_ps(_mm256_load_ps(phase_table + i),
-            _mm256_mul_ps(deltas, delta));
-#else
-      __m256 sinc = _mm256_load_ps(phase_table + i);
-#endif
-      sum_l       = _mm256_add_ps(sum_l, _mm256_mul_ps(buf_l, sinc));
-      sum_r       = _mm256_add_ps(sum_r, _mm256_mul_ps(buf_r, sinc));
+      if (lerp)
+      {
+         _sinc      = _mm_add_ps(_sinc,
+               _mm_mul_ps(_mm_load_ps(delta_table + i), delta));
+         _sinc2     = _mm_add_ps(_sinc2,
+               _mm_mul_ps(_mm_load_ps(delta_table + i + 4), delta));
+         _sinc3     = _mm_add_ps(_sinc3,
+               _mm_mul_ps(_mm_load_ps(delta_table + i + 8), delta));
+         _sinc4     = _mm_add_ps(_sinc4,
+               _mm_mul_ps(_mm_load_ps(delta_table + i + 12), delta));
+      }
+
+      sum_l  = _mm_add_ps(sum_l,
+            _mm_mul_ps(_mm_loadu_ps(buffer_l + i), _sinc));
+      sum_r  = _mm_add_ps(sum_r,
+            _mm_mul_ps(_mm_loadu_ps(buffer_r + i), _sinc));
+      sum_l2 = _mm_add_ps(sum_l2,
+            _mm_mul_ps(_mm_loadu_ps(buffer_l + i + 4), _sinc2));
+      sum_r2 = _mm_add_ps(sum_r2,
+            _mm_mul_ps(_mm_loadu_ps(buffer_r + i + 4), _sinc2));
+      sum_l3 = _mm_add_ps(sum_l3,
+            _mm_mul_ps(_mm_loadu_ps(buffer_l + i + 8), _sinc3));
+      sum_r3 = _mm_add_ps(sum_r3,
+            _mm_mul_ps(_mm_loadu_ps(buffer_r + i + 8), _sinc3));
+      sum_l4 = _mm_add_ps(sum_l4,
+            _mm_mul_ps(_mm_loadu_ps(buffer_l + i + 12), _sinc4));
+      sum_r4 = _mm_add_ps(sum_r4,
+            _mm_mul_ps(_mm_loadu_ps(buffer_r + i + 12), _sinc4));
    }
 
-   /* hadd on AVX is weird, and acts on low-lanes 
-    * and high-lanes separately. */
-   __m256 res_l = _mm256_hadd_ps(sum_l, sum_l);
-   __m256 res_r = _mm256_hadd_ps(sum_r, sum_r);
-   res_l = _mm256_hadd_ps(res_l, res_l);
-   res_r = _mm256_hadd_ps(res_r, res_r);
-   res_l = _mm256_add_ps(_mm256_permute2f128_ps(res_l, res_l, 1), res_l);
-   res_r = _mm256_add_ps(_mm256_permute2f128_ps(res_r, res_r, 1), res_r);
-
-   /* This is optimized to mov %xmmN, [mem].
-    * There doesn't seem to be any _mm256_store_ss intrinsic. */
-   _mm_store_ss(out_buffer + 0, _mm256_extractf128_ps(res_l, 0));
-   _mm_store_ss(out_buffer + 1, _mm256_extractf128_ps(res_r, 0));
-}
-#elif defined(__SSE__)
-#define process_sinc_func process_sinc
-static void process_sinc(rarch_sinc_resampler_t *resamp, float *out_buffer)
-{
-   unsigned i;
-   __m128 sum_l = _mm_setzero_ps();
-   __m128 sum_r = _mm_setzero_ps();
+   if (i + 8 <= taps)
+   {
+      __m128 _sinc  = _mm_load_ps(phase_table + i);
+      __m128 _sinc2 = _mm_load_ps(phase_table + i + 4);
 
-   const float *buffer_l = resamp->buffer_l + resamp->ptr;
-   const float *buffer_r = resamp->buffer_r + resamp->ptr;
+      if (lerp)
+      {
+         _sinc      = _mm_add_ps(_sinc,
+               _mm_mul_ps(_mm_load_ps(delta_table + i), delta));
+         _sinc2     = _mm_add_ps(_sinc2,
+               _mm_mul_ps(_mm_load_ps(delta_table + i + 4), delta));
+      }
 
-   unsigned taps = resamp->taps;
-   unsigned phase = resamp->time >> SUBPHASE_BITS;
-#if SINC_COEFF_LERP
-   const float *phase_table = resamp->phase_table + phase * taps * 2;
-   const float *delta_table = phase_table + taps;
-   __m128 delta = _mm_set1_ps((float)
-         (resamp->time & SUBPHASE_MASK) * SUBPHASE_MOD);
-#else
-   const float *phase_table = resamp->phase_table + phase * taps;
-#endif
+      sum_l  = _mm_add_ps(sum_l,
+            _mm_mul_ps(_mm_loadu_ps(buffer_l + i), _sinc));
+      sum_r  = _mm_add_ps(sum_r,
+            _mm_mul_ps(_mm_loadu_ps(buffer_r + i), _sinc));
+      sum_l2 = _mm_add_ps(sum_l2,
+            _mm_mul_ps(_mm_loadu_ps(buffer_l + i + 4), _sinc2));
+      sum_r2 = _mm_add_ps(sum_r2,
+            _mm_mul_ps(_mm_loadu_ps(buffer_r + i + 4), _sinc2));
+      i     += 8;
+   }
 
-   for (i = 0; i < taps; i += 4)
+   if (i < taps)
    {
-      __m128 buf_l = _mm_loadu_ps(buffer_l + i);
-      __m128 buf_r = _mm_loadu_ps(buffer_r + i);
-
-#if SINC_COEFF_LERP
-      __m128 deltas = _mm_load_ps(delta_table + i);
-      __m128 _sinc = _mm_add_ps(_mm_load_ps(phase_table + i),
-            _mm_mul_ps(deltas, delta));
-#else
       __m128 _sinc = _mm_load_ps(phase_table + i);
-#endif
-      sum_l       = _mm_add_ps(sum_l, _mm_mul_ps(buf_l, _sinc));
-      sum_r       = _mm_add_ps(sum_r, _mm_mul_ps(buf_r, _sinc));
+
+      if (lerp)
+         _sinc     = _mm_add_ps(_sinc,
+               _mm_mul_ps(_mm_load_ps(delta_table + i), delta));
+
+      sum_l        = _mm_add_ps(sum_l,
+            _mm_mul_ps(_mm_loadu_ps(buffer_l + i), _sinc));
+      sum_r        = _mm_add_ps(sum_r,
+            _mm_mul_ps(_mm_loadu_ps(buffer_r + i), _sinc));
    }
 
+   sum_l = _mm_add_ps(_mm_add_ps(sum_l, sum_l2), _mm_add_ps(sum_l3, sum_l4));
+   sum_r = _mm_add_ps(_mm_add_ps(sum_r, sum_r2), _mm_add_ps(sum_r3, sum_r4));
+
    /* Them annoying shuffles.
     * sum_l = { l3, l2, l1, l0 }
     * sum_r = { r3, r2, r1, r0 }
     */
 
-   __m128 sum = _mm_add_ps(_mm_shuffle_ps(sum_l, sum_r,
+   sum = _mm_add_ps(_mm_shuffle_ps(sum_l, sum_r,
             _MM_SHUFFLE(1, 0, 1, 0)),
          _mm_shuffle_ps(sum_l, sum_r, _MM_SHUFFLE(3, 2, 3, 2)));
 
@@ -390,7 +414,7 @@ static void process_sinc(rarch_sinc_resampler_t *resamp, float *out_buffer)
    sum = _mm_add_ps(_mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 3, 1, 1)), sum);
 
    /* sum   = {R1, R1, L1, L1 } + { R1, R0, L1, L0 }
-    * sum   = { X,  R,  X,  L } 
+    * sum   = { X,  R,  X,  L }
     */
 
    /* Store L */
@@ -399,20 +423,116 @@ static void process_sinc(rarch_sinc_resampler_t *resamp, float *out_buffer)
    /* movehl { X, R, X, L } == { X, R, X, R } */
    _mm_store_ss(out_buffer + 1, _mm_movehl_ps(sum, sum));
 }
-#elif defined(__ARM_NEON__)
 
-#if SINC_COEFF_LERP
-#error "NEON asm does not support SINC lerp."
+static void process_sinc_sse(rarch_sinc_resampler_t *resamp,
+      float *out_buffer)
+{
+   process_sinc_sse_generic(resamp, out_buffer, false);
+}
+
+static void process_sinc_sse_lerp(rarch_sinc_resampler_t *resamp,
+      float *out_buffer)
+{
+   process_sinc_sse_generic(resamp, out_buffer, true);
+}
 #endif
 
-/* Need to make this function pointer as Android doesn't 
- * have built-in targets for NEON and plain ARMv7a.
- */
-static void (*process_sinc_func)(rarch_sinc_resampler_t *resamp,
-      float *out_buffer);
+#ifdef SINC_HAVE_AVX2
+/* Every CPU with AVX2 so far also has FMA3. */
+static inline SINC_TARGET_AVX2 void process_sinc_avx2_generic(
+      rarch_sinc_resampler_t *resamp, float *out_buffer, bool lerp)
+{
+   unsigned i;
+   __m128 sum, half_l, half_r;
+   __m256 sum_l  = _mm256_setzero_ps();
+   __m256 sum_r  = _mm256_setzero_ps();
+   __m256 sum_l2 = _mm256_setzero_ps();
+   __m256 sum_r2 = _mm256_setzero_ps();
+
+   const float *buffer_l = resamp->buffer_l + resamp->ptr;
+   const float *buffer_r = resamp->buffer_r + resamp->ptr;
+
+   unsigned taps = resamp->taps;
+   unsigned phase = resamp->time >> resamp->subphase_bits;
+   const float *phase_table = resamp->phase_table +
+      phase * taps * (lerp ? 2 : 1);
+   const float *delta_table = phase_table + taps;
+   __m256 delta = _mm256_set1_ps((float)
+         (resamp->time & resamp->subphase_mask) * resamp->subphase_mod);
+
+   /* Two sets of sums, so that the FMAs of the longer
+    * filters don't all wait on each other. */
+   for (i = 0; i + 16 <= taps; i += 16)
+   {
+      __m256 _sinc  = _mm256_load_ps(phase_table + i);
+      __m256 _sinc2 = _mm256_load_ps(phase_table + i + 8);
+
+      if (lerp)
+      {
+         _sinc      = _mm256_fmadd_ps(_mm256_load_ps(delta_table + i),
+               delta, _sinc);
+         _sinc2     = _mm256_fmadd_ps(_mm256_load_ps(delta_table + i + 8),
+               delta, _sinc2);
+      }
+
+      sum_l  = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_l + i),
+            _sinc, sum_l);
+      sum_r  = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_r + i),
+            _sinc, sum_r);
+      sum_l2 = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_l + i + 8),
+            _sinc2, sum_l2);
+      sum_r2 = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_r + i + 8),
+            _sinc2, sum_r2);
+   }
+
+   if (i < taps)
+   {
+      __m256 _sinc = _mm256_load_ps(phase_table + i);
+
+      if (lerp)
+         _sinc     = _mm256_fmadd_ps(_mm256_load_ps(delta_table + i),
+               delta, _sinc);
+
+      sum_l = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_l + i), _sinc, sum_l);
+      sum_r = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_r + i), _sinc, sum_r);
+   }
+
+   sum_l = _mm256_add_ps(sum_l, sum_l2);
+   sum_r = _mm256_add_ps(sum_r, sum_r2);
+
+   /* Fold the high lanes onto the low ones, then
+    * reduce like the SSE kernel does. */
+   half_l = _mm_add_ps(_mm256_castps256_ps128(sum_l),
+         _mm256_extractf128_ps(sum_l, 1));
+   half_r = _mm_add_ps(_mm256_castps256_ps128(sum_r),
+         _mm256_extractf128_ps(sum_r, 1));
+
+   sum = _mm_add_ps(_mm_shuffle_ps(half_l, half_r,
+            _MM_SHUFFLE(1, 0, 1, 0)),
+         _mm_shuffle_ps(half_l, half_r, _MM_SHUFFLE(3, 2, 3, 2)));
+   sum = _mm_add_ps(_mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 3, 1, 1)), sum);
+
+   _mm_store_ss(out_buffer + 0, sum);
+   _mm_store_ss(out_buffer + 1, _mm_movehl_ps(sum, sum));
+}
 
-/* Assumes that taps >= 8, and that taps is a multiple of 8. */
-void process_sinc_neon_asm(float *out, const float *left, 
+static SINC_TARGET_AVX2 void process_sinc_avx2(
+      rarch_sinc_resampler_t *resamp, float *out_buffer)
+{
+   process_sinc_avx2_generic(resamp, out_buffer, false);
+}
+
+static SINC_TARGET_AVX2 void process_sinc_avx2_lerp(
+      rarch_sinc_resampler_t *resamp, float *out_buffer)
+{
+   process_sinc_avx2_generic(resamp, out_buffer, true);
+}
+#endif
+
+#if defined(__ARM_NEON__)
+/* Assumes that taps >= 8, and that taps is a multiple of 8.
+ * Does not support lerp, the C kernel is used for those levels. */
+void process_sinc_neon_asm(float *out, const float *left,
       const float *right, const float *coeff, unsigned taps);
 
 static void process_sinc_neon(rarch_sinc_resampler_t *resamp,
@@ -421,21 +541,73 @@ static void process_sinc_neon(rarch_sinc_resampler_t *resamp,
    const float *buffer_l = resamp->buffer_l + resamp->ptr;
    const float *buffer_r = resamp->buffer_r + resamp->ptr;
 
-   unsigned phase = resamp->time >> SUBPHASE_BITS;
+   unsigned phase = resamp->time >> resamp->subphase_bits;
    unsigned taps = resamp->taps;
    const float *phase_table = resamp->phase_table + phase * taps;
 
    process_sinc_neon_asm(out_buffer, buffer_l, buffer_r, phase_table, taps);
 }
-#else /* Plain ol' C99 */
-#define process_sinc_func process_sinc_C
 #endif
 
+/**
+ * sinc_select_kernel:
+ * @re                 : Resampler handle, taps must not be rounded yet.
+ * @mask               : SIMD instruction sets supported by the CPU.
+ * @ident              : Set to name of the selected kernel.
+ *
+ * Picks the fastest kernel for @mask and the quality level,
+ * and rounds up the amount of taps to what it requires.
+ *
+ * Returns: kernel to use.
+ **/
+static sinc_kernel_t sinc_select_kernel(rarch_sinc_resampler_t *re,
+      resampler_simd_mask_t mask, const char **ident)
+{
+   bool lerp = re->params->coeff_lerp;
+
+   (void)mask;
+
+#ifdef SINC_HAVE_AVX2
+   if ((mask & RESAMPLER_SIMD_AVX2) && re->taps >= SINC_AVX2_MIN_TAPS)
+   {
+      re->taps = (re->taps + 7) & ~7;
+      *ident   = "AVX2";
+      return lerp ? process_sinc_avx2_lerp : process_sinc_avx2;
+   }
+#endif
+
+#ifdef __SSE__
+   if (mask & RESAMPLER_SIMD_SSE)
+   {
+      re->taps = (re->taps + 3) & ~3;
+      *ident   = "SSE";
+      return lerp ? process_sinc_sse_lerp : process_sinc_sse;
+   }
+#endif
+
+#if defined(__ARM_NEON__)
+   /* Need to check at runtime as Android doesn't
+    * have built-in targets for NEON and plain ARMv7a. */
+   if ((mask & RESAMPLER_SIMD_NEON) && !lerp)
+   {
+      re->taps = (re->taps + 7) & ~7;
+      *ident   = "NEON";
+      return process_sinc_neon;
+   }
+#endif
+
+   re->taps = (re->taps + 3) & ~3;
+   *ident   = "C";
+   return lerp ? process_sinc_C_lerp : process_sinc_C;
+}
+
 static void resampler_sinc_process(void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *re = (rarch_sinc_resampler_t*)re_;
 
-   uint32_t ratio = PHASES / data->ratio;
+   uint32_t phases    = re->phases;
+   uint32_t ratio     = phases / data->ratio;
+   sinc_kernel_t kernel = re->kernel;
 
    const float *input = data->data_in;
    float *output      = data->data_out;
@@ -444,7 +616,7 @@ static void resampler_sinc_process(void *re_, struct resampler_data *data)
 
    while (frames)
    {
-      while (frames && re->time >= PHASES)
+      while (frames && re->time >= phases)
       {
          /* Push in reverse to make filter more obvious. */
          if (!re->ptr)
@@ -454,13 +626,13 @@ static void resampler_sinc_process(void *re_, struct resampler_data *data)
          re->buffer_l[re->ptr + re->taps] = re->buffer_l[re->ptr] = *input++;
          re->buffer_r[re->ptr + re->taps] = re->buffer_r[re->ptr] = *input++;
 
-         re->time -= PHASES;
+         re->time -= phases;
          frames--;
       }
 
-      while (re->time < PHASES)
+      while (re->time < phases)
       {
-         process_sinc_func(re, output);
+         kernel(re, output);
          output += 2;
          out_frames++;
          re->time += ratio;
@@ -473,16 +645,18 @@ static void resampler_sinc_process(void *re_, struct resampler_data *data)
 static void resampler_sinc_free(void *re)
 {
    rarch_sinc_resampler_t *resampler = (rarch_sinc_resampler_t*)re;
-   if (resampler)
+   if (resampler && resampler->main_buffer)
       aligned_free__(resampler->main_buffer);
    free(resampler);
 }
 
 static void *resampler_sinc_new(const struct resampler_config *config,
-      double bandwidth_mod, resampler_simd_mask_t mask)
+      double bandwidth_mod, enum resampler_quality quality,
+      resampler_simd_mask_t mask)
 {
    size_t phase_elems, elems;
    double cutoff;
+   const char *kernel_ident = NULL;
    rarch_sinc_resampler_t *re = (rarch_sinc_resampler_t*)
       calloc(1, sizeof(*re));
    (void)config;
@@ -490,12 +664,19 @@ static void *resampler_sinc_new(const struct resampler_config *config,
    if (!re)
       return NULL;
 
-   memset(re, 0, sizeof(*re));
+   if ((unsigned)quality > RESAMPLER_QUALITY_HIGHEST)
+      quality = RESAMPLER_QUALITY_DONTCARE;
 
-   re->taps = TAPS;
-   cutoff = CUTOFF;
+   re->params        = &sinc_quality_params[quality];
+   re->subphase_bits = re->params->subphase_bits;
+   re->subphase_mask = (1 << re->subphase_bits) - 1;
+   re->subphase_mod  = 1.0f / (1 << re->subphase_bits);
+   re->phases        = 1 << (re->params->phase_bits + re->subphase_bits);
 
-   /* Downsampling, must lower cutoff, and extend number of 
+   re->taps = re->params->sidelobes * 2;
+   cutoff   = re->params->cutoff;
+
+   /* Downsampling, must lower cutoff, and extend number of
     * taps accordingly to keep same stopband attenuation. */
    if (bandwidth_mod < 1.0)
    {
@@ -504,16 +685,11 @@ static void *resampler_sinc_new(const struct resampler_config *config,
    }
 
    /* Be SIMD-friendly. */
-#if (defined(__AVX__) && ENABLE_AVX) || defined(__ARM_NEON__)
-   re->taps = (re->taps + 7) & ~7;
-#else
-   re->taps = (re->taps + 3) & ~3;
-#endif
+   re->kernel = sinc_select_kernel(re, mask, &kernel_ident);
 
-   phase_elems = (1 << PHASE_BITS) * re->taps;
-#if SINC_COEFF_LERP
-   phase_elems *= 2;
-#endif
+   phase_elems = (1 << re->params->phase_bits) * re->taps;
+   if (re->params->coeff_lerp)
+      phase_elems *= 2;
    elems = phase_elems + 4 * re->taps;
 
    re->main_buffer = (float*)
@@ -521,28 +697,18 @@ static void *resampler_sinc_new(const struct resampler_config *config,
    if (!re->main_buffer)
       goto error;
 
+   memset(re->main_buffer, 0, sizeof(float) * elems);
+
    re->phase_table = re->main_buffer;
    re->buffer_l = re->main_buffer + phase_elems;
    re->buffer_r = re->buffer_l + 2 * re->taps;
 
    init_sinc_table(re, cutoff, re->phase_table,
-         1 << PHASE_BITS, re->taps, SINC_COEFF_LERP);
-
-#if defined(__AVX__) && ENABLE_AVX
-   RARCH_LOG("Sinc resampler [AVX]\n");
-#elif defined(__SSE__)
-   RARCH_LOG("Sinc resampler [SSE]\n");
-#elif defined(__ARM_NEON__)
-   process_sinc_func = mask & RESAMPLER_SIMD_NEON 
-      ? process_sinc_neon : process_sinc_C;
-   RARCH_LOG("Sinc resampler [%s]\n",
-         mask & RESAMPLER_SIMD_NEON ? "NEON" : "C");
-#else
-   RARCH_LOG("Sinc resampler [C]\n");
-#endif
+         1 << re->params->phase_bits, re->taps, re->params->coeff_lerp);
 
-   RARCH_LOG("SINC params (%u phase bits, %u taps).\n",
-         PHASE_BITS, re->taps);
+   RARCH_LOG("Sinc resampler [%s]\n", kernel_ident);
+   RARCH_LOG("SINC params (quality %u, %u phase bits, %u taps).\n",
+         (unsigned)quality, re->params->phase_bits, re->taps);
    return re;
 
 error:
@@ -558,4 +724,3 @@ rarch_resampler_t sinc_resampler = {
    "sinc",
    "sinc"
 };
-
@@ -0,0 +1,218 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Microbenchmark for the sinc resampler.
+// Runs every quality level with every kernel the CPU supports,
+// and reports time per output frame and SNR for a couple of tones.
+
+#include "test_resampler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+// Time spent on each speed measurement, in seconds.
+#define BENCH_TIME 0.25
+
+static double get_time(void)
+{
+   struct timespec tv;
+   clock_gettime(CLOCK_MONOTONIC, &tv);
+   return tv.tv_sec + tv.tv_nsec / 1000000000.0;
+}
+
+static void gen_signal(float *out, double omega, size_t frames)
+{
+   for (size_t i = 0; i < frames; i++)
+      out[2 * i + 0] = out[2 * i + 1] = 0.5 * cos(omega * i);
+}
+
+// Fits a sine of the given frequency to the second half of the output
+// with least squares. Everything not explained by it counts as noise.
+static void fit_sine(const float *out, size_t frames, double omega,
+      double *signal, double *noise)
+{
+   double cc = 0.0, ss = 0.0, cs = 0.0, yc = 0.0, ys = 0.0;
+   size_t start = frames / 2;
+
+   for (size_t i = start; i < frames; i++)
+   {
+      double c = cos(omega * i);
+      double s = sin(omega * i);
+      cc += c * c;
+      ss += s * s;
+      cs += c * s;
+      yc += out[2 * i] * c;
+      ys += out[2 * i] * s;
+   }
+
+   double det = cc * ss - cs * cs;
+   double a = (yc * ss - ys * cs) / det;
+   double b = (ys * cc - yc * cs) / det;
+
+   *signal = 0.0;
+   *noise = 0.0;
+   for (size_t i = start; i < frames; i++)
+   {
+      double fit = a * cos(omega * i) + b * sin(omega * i);
+      double err = out[2 * i] - fit;
+      *signal += fit * fit;
+      *noise += err * err;
+   }
+}
+
+// The resampler steps through phases in fixed point, so the actual
+// ratio is slightly off. Search for the output frequency which fits best,
+// otherwise the drift would show up as noise at the higher levels.
+static double measure_snr(const float *out, size_t frames, double omega)
+{
+   double best_signal = 0.0, best_noise = HUGE_VAL;
+
+   for (int k = -40; k <= 40; k++)
+   {
+      double signal, noise;
+      fit_sine(out, frames, omega * (1.0 + k * 1e-8), &signal, &noise);
+      if (noise < best_noise)
+      {
+         best_noise = noise;
+         best_signal = signal;
+      }
+   }
+
+   if (best_noise <= 0.0)
+      return 999.0;
+   return 10.0 * log10(best_signal / best_noise);
+}
+
+static double run_snr(enum resampler_quality quality,
+      resampler_simd_mask_t mask, double in_rate, double out_rate,
+      double freq)
+{
+   double ratio = out_rate / in_rate;
+   size_t in_frames = in_rate;
+   float *input = malloc(in_frames * 2 * sizeof(float));
+   float *output = malloc((size_t)(in_frames * ratio + 16) * 2 * sizeof(float));
+   void *re = sinc_resampler.init(NULL, ratio, quality, mask);
+   double snr;
+
+   gen_signal(input, 2.0 * M_PI * freq / in_rate, in_frames);
+
+   struct resampler_data data = {
+      .data_in = input,
+      .data_out = output,
+      .input_frames = in_frames,
+      .ratio = ratio,
+   };
+   sinc_resampler.process(re, &data);
+
+   snr = measure_snr(output, data.output_frames, 2.0 * M_PI * freq / out_rate);
+
+   sinc_resampler.free(re);
+   free(input);
+   free(output);
+   return snr;
+}
+
+static double run_speed(enum resampler_quality quality,
+      resampler_simd_mask_t mask, double in_rate, double out_rate)
+{
+   double ratio = out_rate / in_rate;
+   size_t chunk = 1024;
+   float *input = malloc(chunk * 2 * sizeof(float));
+   float *output = malloc((size_t)(chunk * ratio + 16) * 2 * sizeof(float));
+   void *re = sinc_resampler.init(NULL, ratio, quality, mask);
+   size_t out_frames = 0;
+   double start, elapsed;
+
+   gen_signal(input, 2.0 * M_PI * 1000.0 / in_rate, chunk);
+
+   start = get_time();
+   do
+   {
+      // Check the clock rarely, so it doesn't show up in the result.
+      for (unsigned i = 0; i < 64; i++)
+      {
+         struct resampler_data data = {
+            .data_in = input,
+            .data_out = output,
+            .input_frames = chunk,
+            .ratio = ratio,
+         };
+         sinc_resampler.process(re, &data);
+         out_frames += data.output_frames;
+      }
+      elapsed = get_time() - start;
+   } while (elapsed < BENCH_TIME);
+
+   sinc_resampler.free(re);
+   free(input);
+   free(output);
+   return elapsed * 1000000000.0 / out_frames;
+}
+
+int main(int argc, char *argv[])
+{
+   static const char *quality_names[] = {
+      "dontcare", "lowest", "lower", "normal", "higher", "highest",
+   };
+   static const struct
+   {
+      const char *name;
+      resampler_simd_mask_t mask;
+   } kernels[] = {
+      { "C", 0 },
+      { "SSE", RESAMPLER_SIMD_SSE },
+      { "AVX2", RESAMPLER_SIMD_SSE | RESAMPLER_SIMD_AVX2 },
+      { "NEON", RESAMPLER_SIMD_NEON },
+   };
+
+   double in_rate = 44100.0;
+   double out_rate = 48000.0;
+   resampler_simd_mask_t cpu = test_resampler_simd_mask();
+
+   if (argc == 3)
+   {
+      in_rate = strtod(argv[1], NULL);
+      out_rate = strtod(argv[2], NULL);
+   }
+   else if (argc != 1)
+   {
+      fprintf(stderr, "Usage: %s [in-rate out-rate]\n", argv[0]);
+      return 1;
+   }
+
+   printf("Sinc resampler, %.0f Hz -> %.0f Hz.\n", in_rate, out_rate);
+   printf("AVX2 is only picked for quality levels with enough taps.\n\n");
+   printf("%-8s %-5s %10s %12s %12s\n",
+         "quality", "mask", "ns/frame", "SNR @ 1 kHz", "SNR @ 10 kHz");
+
+   for (unsigned q = RESAMPLER_QUALITY_LOWEST; q <= RESAMPLER_QUALITY_HIGHEST; q++)
+   {
+      for (unsigned k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+      {
+         if ((kernels[k].mask & cpu) != kernels[k].mask)
+            continue;
+
+         double ns = run_speed(q, kernels[k].mask, in_rate, out_rate);
+         double snr_low = run_snr(q, kernels[k].mask, in_rate, out_rate, 1000.0);
+         double snr_high = run_snr(q, kernels[k].mask, in_rate, out_rate, 10000.0);
+
+         printf("%-8s %-5s %10.2f %9.1f dB %9.1f dB\n",
+               quality_names[q], kernels[k].name, ns, snr_low, snr_high);
+      }
+   }
+
+   return 0;
+}
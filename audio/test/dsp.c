@@ -0,0 +1,349 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks the vectorized paths of the stock DSP plugins against their
+// scalar versions. Both get the same signal in the same odd-sized chunks,
+// and the outputs must match to within float rounding.
+// Also reports the time per frame of each path.
+
+#include "../audio_filters/dspfilter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#ifndef M_PI
+#define M_PI 3.1415926535897932384626433832795
+#endif
+
+#define TEST_RATE 44100.0f
+#define TEST_FRAMES (2 * 44100)
+
+// Largest error allowed, relative to the peak of the scalar output.
+#define TEST_TOLERANCE 1e-4
+
+// Time spent on each speed measurement, in seconds.
+#define BENCH_TIME 0.25
+
+extern const struct dspfilter_implementation *reverb_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+extern const struct dspfilter_implementation *iir_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+extern const struct dspfilter_implementation *echo_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+extern const struct dspfilter_implementation *phaser_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+extern const struct dspfilter_implementation *wahwah_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+extern const struct dspfilter_implementation *chorus_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+
+struct test_param
+{
+   const char *key;
+   const char *string;
+   float values[4];
+   unsigned num_values;
+};
+
+struct test_case
+{
+   const char *name;
+   dspfilter_get_implementation_t get_implementation;
+   const struct test_param *params;
+};
+
+static const struct test_param iir_peq[] = {
+   { .key = "type", .string = "PEQ" },
+   { .key = "frequency", .values = { 3000.0f }, .num_values = 1 },
+   { .key = "gain", .values = { 9.0f }, .num_values = 1 },
+   { .key = "quality", .values = { 4.0f }, .num_values = 1 },
+   { NULL },
+};
+
+static const struct test_param echo_multi[] = {
+   { .key = "delay", .values = { 200.0f, 333.3f, 51.7f }, .num_values = 3 },
+   { .key = "feedback", .values = { 0.5f, 0.3f, 0.2f }, .num_values = 3 },
+   { NULL },
+};
+
+// A one frame delay has to go through the single frame path.
+static const struct test_param echo_short[] = {
+   { .key = "delay", .values = { 0.02f, 10.0f }, .num_values = 2 },
+   { .key = "feedback", .values = { 0.4f, 0.4f }, .num_values = 2 },
+   { NULL },
+};
+
+static const struct test_param phaser_deep[] = {
+   { .key = "stages", .values = { 12.0f }, .num_values = 1 },
+   { .key = "feedback", .values = { 60.0f }, .num_values = 1 },
+   { .key = "depth", .values = { 0.8f }, .num_values = 1 },
+   { NULL },
+};
+
+static const struct test_param chorus_fast[] = {
+   { .key = "lfo_freq", .values = { 7.0f }, .num_values = 1 },
+   { .key = "depth_ms", .values = { 5.0f }, .num_values = 1 },
+   { NULL },
+};
+
+static const struct test_case tests[] = {
+   { "reverb", reverb_dspfilter_get_implementation, NULL },
+   { "iir", iir_dspfilter_get_implementation, NULL },
+   { "iir-peq", iir_dspfilter_get_implementation, iir_peq },
+   { "echo", echo_dspfilter_get_implementation, NULL },
+   { "echo-multi", echo_dspfilter_get_implementation, echo_multi },
+   { "echo-short", echo_dspfilter_get_implementation, echo_short },
+   { "phaser", phaser_dspfilter_get_implementation, NULL },
+   { "phaser-deep", phaser_dspfilter_get_implementation, phaser_deep },
+   { "wahwah", wahwah_dspfilter_get_implementation, NULL },
+   { "chorus", chorus_dspfilter_get_implementation, NULL },
+   { "chorus-fast", chorus_dspfilter_get_implementation, chorus_fast },
+};
+
+// Chunk sizes cycled through while processing, to catch
+// state not carried over between calls and odd frame counts.
+static const unsigned chunk_sizes[] = { 1, 735, 64, 7, 1024, 333, 2 };
+
+static const struct test_param *find_param(void *userdata, const char *key)
+{
+   const struct test_param *param = (const struct test_param*)userdata;
+
+   for (; param && param->key; param++)
+      if (!strcmp(param->key, key))
+         return param;
+   return NULL;
+}
+
+static int config_get_float(void *userdata, const char *key,
+      float *value, float default_value)
+{
+   const struct test_param *param = find_param(userdata, key);
+   *value = param ? param->values[0] : default_value;
+   return param != NULL;
+}
+
+static int config_get_int(void *userdata, const char *key,
+      int *value, int default_value)
+{
+   const struct test_param *param = find_param(userdata, key);
+   *value = param ? (int)param->values[0] : default_value;
+   return param != NULL;
+}
+
+static int config_get_float_array(void *userdata, const char *key,
+      float **values, unsigned *out_num_values,
+      const float *default_values, unsigned num_default_values)
+{
+   const struct test_param *param = find_param(userdata, key);
+   if (param)
+   {
+      default_values = param->values;
+      num_default_values = param->num_values;
+   }
+
+   *values = malloc(num_default_values * sizeof(float));
+   memcpy(*values, default_values, num_default_values * sizeof(float));
+   *out_num_values = num_default_values;
+   return param != NULL;
+}
+
+static int config_get_int_array(void *userdata, const char *key,
+      int **values, unsigned *out_num_values,
+      const int *default_values, unsigned num_default_values)
+{
+   const struct test_param *param = find_param(userdata, key);
+   unsigned num = param ? param->num_values : num_default_values;
+
+   *values = malloc(num * sizeof(int));
+   for (unsigned i = 0; i < num; i++)
+      (*values)[i] = param ? (int)param->values[i] : default_values[i];
+   *out_num_values = num;
+   return param != NULL;
+}
+
+static int config_get_string(void *userdata, const char *key,
+      char **output, const char *default_output)
+{
+   const struct test_param *param = find_param(userdata, key);
+   *output = strdup(param ? param->string : default_output);
+   return param != NULL;
+}
+
+static const struct dspfilter_config test_config = {
+   config_get_float,
+   config_get_int,
+   config_get_float_array,
+   config_get_int_array,
+   config_get_string,
+   free,
+};
+
+static double get_time(void)
+{
+   struct timespec tv;
+   clock_gettime(CLOCK_MONOTONIC, &tv);
+   return tv.tv_sec + tv.tv_nsec / 1000000000.0;
+}
+
+// Decaying noise bursts on top of two tones, different on each channel.
+static void gen_signal(float *out, size_t frames)
+{
+   unsigned seed = 1;
+
+   for (size_t i = 0; i < frames; i++)
+   {
+      float burst = expf(-(float)(i % 11025) / 2000.0f);
+
+      seed = seed * 1664525u + 1013904223u;
+      float noise_l = ((seed >> 8) / 16777216.0f - 0.5f) * burst;
+      seed = seed * 1664525u + 1013904223u;
+      float noise_r = ((seed >> 8) / 16777216.0f - 0.5f) * burst;
+
+      out[2 * i + 0] = 0.3f * sinf(2.0f * M_PI * 440.0f * i / TEST_RATE) + 0.2f * noise_l;
+      out[2 * i + 1] = 0.3f * sinf(2.0f * M_PI * 1234.0f * i / TEST_RATE) + 0.2f * noise_r;
+   }
+}
+
+static void run_filter(const struct dspfilter_implementation *impl,
+      void *data, float *samples, size_t frames)
+{
+   size_t done = 0;
+
+   for (unsigned c = 0; done < frames; c = (c + 1) % (sizeof(chunk_sizes) / sizeof(chunk_sizes[0])))
+   {
+      struct dspfilter_output output = {0};
+      struct dspfilter_input input = {0};
+
+      input.samples = samples + 2 * done;
+      input.frames = chunk_sizes[c];
+      if (input.frames > frames - done)
+         input.frames = frames - done;
+
+      impl->process(data, &output, &input);
+
+      // All of these plugins work in place.
+      if (output.samples != input.samples || output.frames != input.frames)
+      {
+         fprintf(stderr, "%s did not process in place.\n", impl->ident);
+         exit(1);
+      }
+
+      done += input.frames;
+   }
+}
+
+static double run_speed(const struct dspfilter_implementation *impl,
+      const struct test_param *params, const float *signal)
+{
+   const struct dspfilter_info info = { TEST_RATE };
+   size_t chunk = 1024;
+   float *samples = malloc(chunk * 2 * sizeof(float));
+   void *data = impl->init(&info, &test_config, (void*)params);
+   size_t frames = 0;
+   double start, elapsed;
+
+   start = get_time();
+   do
+   {
+      // Check the clock rarely, so it doesn't show up in the result.
+      for (unsigned i = 0; i < 64; i++)
+      {
+         struct dspfilter_output output = {0};
+         struct dspfilter_input input = { samples, chunk };
+
+         memcpy(samples, signal + 2 * (frames % (TEST_FRAMES - chunk)),
+               chunk * 2 * sizeof(float));
+         impl->process(data, &output, &input);
+         frames += chunk;
+      }
+      elapsed = get_time() - start;
+   } while (elapsed < BENCH_TIME);
+
+   impl->free(data);
+   free(samples);
+   return elapsed * 1000000000.0 / frames;
+}
+
+int main(void)
+{
+   int ret = 0;
+   const struct dspfilter_info info = { TEST_RATE };
+   float *signal = malloc(TEST_FRAMES * 2 * sizeof(float));
+   float *ref = malloc(TEST_FRAMES * 2 * sizeof(float));
+   float *out = malloc(TEST_FRAMES * 2 * sizeof(float));
+   dspfilter_simd_mask_t mask = 0;
+
+#if defined(__SSE__)
+   mask |= DSPFILTER_SIMD_SSE;
+#elif defined(__ARM_NEON__)
+   mask |= DSPFILTER_SIMD_NEON;
+#endif
+
+   gen_signal(signal, TEST_FRAMES);
+
+   printf("%-12s %-20s %10s %10s %10s\n",
+         "filter", "implementation", "C ns/f", "SIMD ns/f", "error");
+
+   for (unsigned t = 0; t < sizeof(tests) / sizeof(tests[0]); t++)
+   {
+      const struct dspfilter_implementation *scalar = tests[t].get_implementation(0);
+      const struct dspfilter_implementation *simd = tests[t].get_implementation(mask);
+      void *params = (void*)tests[t].params;
+      double peak = 0.0, error = 0.0;
+
+      if (simd == scalar)
+      {
+         printf("%-12s no vectorized path\n", tests[t].name);
+         continue;
+      }
+
+      void *scalar_data = scalar->init(&info, &test_config, params);
+      void *simd_data = simd->init(&info, &test_config, params);
+      if (!scalar_data || !simd_data)
+      {
+         fprintf(stderr, "%s: init failed.\n", tests[t].name);
+         return 1;
+      }
+
+      memcpy(ref, signal, TEST_FRAMES * 2 * sizeof(float));
+      memcpy(out, signal, TEST_FRAMES * 2 * sizeof(float));
+      run_filter(scalar, scalar_data, ref, TEST_FRAMES);
+      run_filter(simd, simd_data, out, TEST_FRAMES);
+
+      scalar->free(scalar_data);
+      simd->free(simd_data);
+
+      for (size_t i = 0; i < TEST_FRAMES * 2; i++)
+      {
+         double diff = fabs(ref[i] - out[i]);
+         if (fabs(ref[i]) > peak)
+            peak = fabs(ref[i]);
+         if (!(diff <= error)) // Catches NaN too.
+            error = diff;
+      }
+
+      error = peak > 0.0 ? error / peak : error;
+
+      printf("%-12s %-20s %10.2f %10.2f %10.2g %s\n",
+            tests[t].name, simd->ident,
+            run_speed(scalar, tests[t].params, signal),
+            run_speed(simd, tests[t].params, signal),
+            error, error <= TEST_TOLERANCE ? "" : "FAIL");
+
+      if (!(error <= TEST_TOLERANCE))
+         ret = 1;
+   }
+
+   free(signal);
+   free(ref);
+   free(out);
+   return ret;
+}
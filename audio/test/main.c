@@ -16,16 +16,12 @@
 // Resampler that reads raw S16NE/stereo from stdin and outputs to stdout in S16NE/stereo.
 // Used for testing and performance benchmarking.
 
-#include "../resamplers/resampler.h"
+#include "test_resampler.h"
 #include "../audio_utils.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 
-#ifndef RESAMPLER_IDENT
-#define RESAMPLER_IDENT "sinc"
-#endif
-
 int main(int argc, char *argv[])
 {
    srand(time(NULL));
@@ -36,18 +32,23 @@ int main(int argc, char *argv[])
    float output_f[1024 * 8];
 
    double ratio_max_deviation = 0.0;
+   enum resampler_quality quality = RESAMPLER_QUALITY_DONTCARE;
 
-   if (argc < 3 || argc > 4)
+   if (argc < 3 || argc > 5)
    {
-      fprintf(stderr, "Usage: %s <in-rate> <out-rate> [ratio deviation] (max ratio: 8.0)\n", argv[0]);
+      fprintf(stderr, "Usage: %s <in-rate> <out-rate> [ratio deviation] [quality 1-5] (max ratio: 8.0)\n", argv[0]);
       return 1;
    }
-   else if (argc == 4)
+
+   if (argc >= 4)
    {
       ratio_max_deviation = fabs(strtod(argv[3], NULL));
       fprintf(stderr, "Ratio deviation: %.4f.\n", ratio_max_deviation);
    }
 
+   if (argc == 5)
+      quality = (enum resampler_quality)strtoul(argv[4], NULL, 0);
+
    double in_rate = strtod(argv[1], NULL);
    double out_rate = strtod(argv[2], NULL);
 
@@ -58,9 +59,10 @@ int main(int argc, char *argv[])
       return 1;
    }
 
-   const rarch_resampler_t *resampler = NULL;
-   void *re = NULL;
-   if (!rarch_resampler_realloc(&re, &resampler, RESAMPLER_IDENT, out_rate / in_rate))
+   const rarch_resampler_t *resampler = &TEST_RESAMPLER;
+   void *re = resampler->init(NULL, out_rate / in_rate, quality,
+         test_resampler_simd_mask());
+   if (!re)
    {
       fprintf(stderr, "Failed to allocate resampler ...\n");
       return 1;
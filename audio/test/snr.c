@@ -13,7 +13,7 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "../resamplers/resampler.h"
+#include "test_resampler.h"
 #include "../audio_utils.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -23,10 +23,6 @@
 #include <assert.h>
 #include <stdbool.h>
 
-#ifndef RESAMPLER_IDENT
-#define RESAMPLER_IDENT "sinc"
-#endif
-
 #undef min
 #define min(a, b) (((a) < (b)) ? (a) : (b))
 
@@ -241,13 +237,16 @@ static void calculate_snr(struct snr_result *res,
 
 int main(int argc, char *argv[])
 {
-   if (argc != 2)
+   if (argc < 2 || argc > 3)
    {
-      fprintf(stderr, "Usage: %s <ratio> (out-rate is fixed for FFT).\n", argv[0]);
+      fprintf(stderr, "Usage: %s <ratio> [quality 1-5] (out-rate is fixed for FFT).\n", argv[0]);
       return 1;
    }
 
    double ratio = strtod(argv[1], NULL);
+   enum resampler_quality quality = argc == 3 ?
+      (enum resampler_quality)strtoul(argv[2], NULL, 0) :
+      RESAMPLER_QUALITY_DONTCARE;
 
    const unsigned fft_samples = 1024 * 128;
    unsigned out_rate = fft_samples / 2;
@@ -271,9 +270,10 @@ int main(int argc, char *argv[])
    assert(input);
    assert(output);
 
-   void *re = NULL;
-   const rarch_resampler_t *resampler = NULL;
-   if (!rarch_resampler_realloc(&re, &resampler, RESAMPLER_IDENT, ratio))
+   const rarch_resampler_t *resampler = &TEST_RESAMPLER;
+   void *re = resampler->init(NULL, ratio, quality,
+         test_resampler_simd_mask());
+   if (!re)
       return 1;
 
    test_fft();
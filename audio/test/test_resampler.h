@@ -0,0 +1,44 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TEST_RESAMPLER_H
+#define __TEST_RESAMPLER_H
+
+#include "../audio_resampler_driver.h"
+
+// The test programs talk to the resampler backends directly,
+// so they don't need the frontend's config and CPU feature code.
+#ifdef RESAMPLER_CC
+#define TEST_RESAMPLER CC_resampler
+#else
+#define TEST_RESAMPLER sinc_resampler
+#endif
+
+static inline resampler_simd_mask_t test_resampler_simd_mask(void)
+{
+   resampler_simd_mask_t mask = 0;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("sse"))
+      mask |= RESAMPLER_SIMD_SSE;
+   if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+      mask |= RESAMPLER_SIMD_AVX2;
+#elif defined(__ARM_NEON__)
+   mask |= RESAMPLER_SIMD_NEON;
+#endif
+   return mask;
+}
+
+#endif
@@ -22,6 +22,10 @@
 #endif
 
 #include "general.h"
+#ifdef HAVE_THREADS
+#include "gfx/video_thread_wrapper.h"
+#include "gfx/video_shader_async.h"
+#endif
 #include "compat/strl.h"
 #include "compat/posix_string.h"
 #include <file/file_path.h>
@@ -47,6 +51,10 @@ struct rarch_cmd
 
 #if defined(HAVE_NETWORK_CMD) && defined(HAVE_NETPLAY)
    int net_fd;
+
+   /* Sender of the message being parsed, replies go here. */
+   struct sockaddr_storage reply_addr;
+   socklen_t reply_addr_len;
 #endif
 
    bool state[RARCH_BIND_LIST_END];
@@ -174,6 +182,12 @@ struct cmd_action_map
    const char *arg_desc;
 };
 
+struct cmd_query_map
+{
+   const char *str;
+   void (*query)(char *s, size_t len);
+};
+
 static const struct cmd_map map[] = {
    { "FAST_FORWARD",           RARCH_FAST_FORWARD_KEY },
    { "FAST_FORWARD_HOLD",      RARCH_FAST_FORWARD_HOLD_KEY },
@@ -204,6 +218,7 @@ static const struct cmd_map map[] = {
    { "DISK_NEXT",              RARCH_DISK_NEXT },
    { "DISK_PREV",              RARCH_DISK_PREV },
    { "GRAB_MOUSE_TOGGLE",      RARCH_GRAB_MOUSE_TOGGLE },
+   { "REWIND_SEEK",            RARCH_REWIND_SEEK },
    { "MENU_TOGGLE",            RARCH_MENU_TOGGLE },
    { "MENU_UP",                RETRO_DEVICE_ID_JOYPAD_UP },
    { "MENU_DOWN",              RETRO_DEVICE_ID_JOYPAD_DOWN },
@@ -236,6 +251,12 @@ static bool cmd_set_shader(const char *arg)
    msg_queue_push(g_extern.msg_queue, msg, 1, 120);
    RARCH_LOG("Applying shader \"%s\".\n", arg);
 
+#ifdef HAVE_THREADS
+   if (g_settings.video.shader_async)
+      return video_shader_async_load(type, arg);
+   video_shader_async_cancel();
+#endif
+
    return driver.video->set_shader(driver.video_data, type, arg);
 }
 
@@ -243,6 +264,103 @@ static const struct cmd_action_map action_map[] = {
    { "SET_SHADER", cmd_set_shader, "<shader path>" },
 };
 
+static void cmd_get_audio_stats(char *s, size_t len)
+{
+   char tmp[128];
+   struct audio_driver_stats stats;
+
+   if (!audio_driver_get_stats(&stats))
+   {
+      strlcpy(s, "AUDIO_STATS N/A", len);
+      return;
+   }
+
+   strlcpy(s, "AUDIO_STATS", len);
+
+   if (stats.rate_control)
+   {
+      snprintf(tmp, sizeof(tmp),
+            " fill=%.3f ratio=%.6f underruns=%u latency_ms=%.1f",
+            stats.buffer_fill, stats.ratio, stats.underruns, stats.latency_ms);
+      strlcat(s, tmp, len);
+   }
+
+   if (stats.dsp_thread)
+   {
+      snprintf(tmp, sizeof(tmp), " dsp_thread_latency_ms=%.1f",
+            stats.dsp_thread_latency_ms);
+      strlcat(s, tmp, len);
+   }
+}
+
+#ifdef HAVE_THREADS
+static void cmd_get_video_stats(char *s, size_t len)
+{
+   struct rarch_threaded_video_stats stats;
+
+   if (!rarch_threaded_video_get_stats(&stats))
+   {
+      strlcpy(s, "VIDEO_STATS N/A", len);
+      return;
+   }
+
+   snprintf(s, len, "VIDEO_STATS frames=%u dropped=%u direct=%u",
+         stats.frames, stats.dropped, stats.direct);
+}
+#endif
+
+/* Commands which send a single line back to whoever asked. */
+static const struct cmd_query_map query_map[] = {
+   { "GET_AUDIO_STATS", cmd_get_audio_stats },
+#ifdef HAVE_THREADS
+   { "GET_VIDEO_STATS", cmd_get_video_stats },
+#endif
+};
+
+static bool command_get_query(const char *tok, unsigned *index)
+{
+   unsigned i;
+
+   for (i = 0; i < ARRAY_SIZE(query_map); i++)
+   {
+      if (strcmp(tok, query_map[i].str) == 0)
+      {
+         if (index)
+            *index = i;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+/**
+ * command_reply:
+ * @handle             : command handle.
+ * @msg                : reply, without newline.
+ *
+ * Network commands get the reply sent back to their
+ * sender, commands read from stdin get it on stdout.
+ **/
+static void command_reply(rarch_cmd_t *handle, const char *msg)
+{
+#if defined(HAVE_NETWORK_CMD) && defined(HAVE_NETPLAY)
+   if (handle->reply_addr_len)
+   {
+      char buf[1024];
+      strlcpy(buf, msg, sizeof(buf));
+      strlcat(buf, "\n", sizeof(buf));
+      sendto(handle->net_fd, buf, strlen(buf), 0,
+            (struct sockaddr*)&handle->reply_addr, handle->reply_addr_len);
+      return;
+   }
+#endif
+
+   (void)handle;
+   fprintf(stdout, "%s\n", msg);
+   fflush(stdout);
+}
+
 static bool command_get_arg(const char *tok,
       const char **arg, unsigned *index)
 {
@@ -289,7 +407,13 @@ static void parse_sub_msg(rarch_cmd_t *handle, const char *tok)
    const char *arg = NULL;
    unsigned index  = 0;
 
-   if (command_get_arg(tok, &arg, &index))
+   if (command_get_query(tok, &index))
+   {
+      char reply[1024];
+      query_map[index].query(reply, sizeof(reply));
+      command_reply(handle, reply);
+   }
+   else if (command_get_arg(tok, &arg, &index))
    {
       if (arg)
       {
@@ -347,8 +471,11 @@ static void network_cmd_poll(rarch_cmd_t *handle)
    for (;;)
    {
       char buf[1024];
-      ssize_t ret = recvfrom(handle->net_fd, buf,
-            sizeof(buf) - 1, 0, NULL, NULL);
+      ssize_t ret;
+
+      handle->reply_addr_len = sizeof(handle->reply_addr);
+      ret = recvfrom(handle->net_fd, buf, sizeof(buf) - 1, 0,
+            (struct sockaddr*)&handle->reply_addr, &handle->reply_addr_len);
 
       if (ret <= 0)
          break;
@@ -356,6 +483,8 @@ static void network_cmd_poll(rarch_cmd_t *handle)
       buf[ret] = '\0';
       parse_msg(handle, buf);
    }
+
+   handle->reply_addr_len = 0;
 }
 #endif
 
@@ -522,8 +651,19 @@ void rarch_cmd_poll(rarch_cmd_t *handle)
 }
 
 #if defined(HAVE_NETWORK_CMD) && defined(HAVE_NETPLAY)
+/**
+ * send_udp_packet:
+ * @host               : host to send to.
+ * @port               : port to send to.
+ * @msg                : command.
+ * @reply              : if not NULL, waits for a reply and stores it here.
+ * @reply_size         : size of @reply.
+ *
+ * Returns: true (1) if the command was sent and, if requested,
+ * a reply was received, otherwise false (0).
+ **/
 static bool send_udp_packet(const char *host,
-      uint16_t port, const char *msg)
+      uint16_t port, const char *msg, char *reply, size_t reply_size)
 {
    char port_buf[16];
    struct addrinfo hints, *res = NULL;
@@ -566,6 +706,29 @@ static bool send_udp_packet(const char *host,
          goto end;
       }
 
+      if (reply)
+      {
+         fd_set fds;
+         struct timeval tv = {1, 0};
+         ssize_t reply_len = 0;
+
+         FD_ZERO(&fds);
+         FD_SET(fd, &fds);
+
+         if (socket_select(fd + 1, &fds, NULL, NULL, &tv) > 0)
+            reply_len = recv(fd, reply, reply_size - 1, 0);
+
+         /* One answer is enough, skip the remaining targets. */
+         if (reply_len > 0)
+         {
+            reply[reply_len] = '\0';
+            goto end;
+         }
+
+         if (!tmp->ai_next)
+            ret = false;
+      }
+
       socket_close(fd);
       fd = -1;
       tmp = tmp->ai_next;
@@ -582,7 +745,7 @@ static bool verify_command(const char *cmd)
 {
    unsigned i;
 
-   if (command_get_arg(cmd, NULL, NULL))
+   if (command_get_arg(cmd, NULL, NULL) || command_get_query(cmd, NULL))
       return true;
 
    RARCH_ERR("Command \"%s\" is not recognized by RetroArch.\n", cmd);
@@ -593,6 +756,9 @@ static bool verify_command(const char *cmd)
    for (i = 0; i < sizeof(action_map) / sizeof(action_map[0]); i++)
       RARCH_ERR("\t\t%s %s\n", action_map[i].str, action_map[i].arg_desc);
 
+   for (i = 0; i < ARRAY_SIZE(query_map); i++)
+      RARCH_ERR("\t\t%s\n", query_map[i].str);
+
    return false;
 }
 
@@ -635,7 +801,20 @@ bool network_cmd_send(const char *cmd_)
    RARCH_LOG("Sending command: \"%s\" to %s:%hu\n",
          cmd, host, (unsigned short)port);
 
-   ret = verify_command(cmd) && send_udp_packet(host, port, cmd);
+   if (command_get_query(cmd, NULL))
+   {
+      char reply[1024];
+
+      ret = verify_command(cmd) && send_udp_packet(host, port, cmd,
+            reply, sizeof(reply));
+
+      if (ret)
+         fputs(reply, stdout);
+      else
+         RARCH_ERR("No reply to \"%s\".\n", cmd);
+   }
+   else
+      ret = verify_command(cmd) && send_udp_packet(host, port, cmd, NULL, 0);
    free(command);
 
    g_extern.verbosity = old_verbose;
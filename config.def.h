@@ -371,11 +371,28 @@ static const bool hard_sync = false;
  */
 static const unsigned hard_sync_frames = 0;
 
+/* Streams frames to the GPU through a ring of pixel buffers
+ * instead of uploading them straight from the core's buffer.
+ * Only used by the GL driver on desktop GL. */
+static const bool pbo_upload = false;
+
 /* Sets how many milliseconds to delay after VSync before running the core.
  * Can reduce latency at cost of higher risk of stuttering.
  */
 static const unsigned frame_delay = 0;
 
+/* Measures how long the core takes to produce a frame and
+ * picks the largest frame delay which still leaves enough room.
+ * Overrides video_frame_delay.
+ */
+static const bool frame_delay_auto = false;
+
+/* Runs the core this many frames ahead every frame and only shows the
+ * last one, then rolls back using savestates.
+ * Hides that many frames of the game's own input lag.
+ */
+static const unsigned run_ahead_frames = 0;
+
 /* Inserts a black frame inbetween frames.
  * Useful for 120 Hz monitors who want to play 60 Hz material with eliminated 
  * ghosting. video_refresh_rate should still be configured as if it 
@@ -415,6 +432,10 @@ static const bool shader_enable = true;
 static const bool shader_enable = false;
 #endif
 
+/* Shaders switched at runtime are loaded on a separate thread,
+ * while the current one keeps rendering. */
+static const bool shader_async = true;
+
 /* Only scale in integer steps.
  * The base size depends on system-reported geometry and aspect ratio.
  * If video_force_aspect is not set, X/Y will be integer scaled independently.
@@ -522,6 +543,25 @@ static const bool audio_enable = true;
 /* Output samplerate. */
 static const unsigned out_rate = 48000;
 
+/* Quality level of the sinc resampler, from 1 (lowest)
+ * to 5 (highest). Higher levels need a lot more CPU time. */
+#if defined(SINC_LOWEST_QUALITY)
+static const unsigned audio_resampler_quality = 1;
+#elif defined(SINC_LOWER_QUALITY)
+static const unsigned audio_resampler_quality = 2;
+#elif defined(SINC_HIGHER_QUALITY)
+static const unsigned audio_resampler_quality = 4;
+#elif defined(SINC_HIGHEST_QUALITY)
+static const unsigned audio_resampler_quality = 5;
+#else
+static const unsigned audio_resampler_quality = 3;
+#endif
+
+/* Runs the DSP plugin and the resampler on a separate thread.
+ * Takes load off the emulation thread with heavy DSP chains,
+ * at the cost of about one audio chunk of extra latency. */
+static const bool audio_dsp_thread = false;
+
 /* Audio device (e.g. hw:0,0 or /dev/audio). If NULL, will use defaults. */
 static const char *audio_device = NULL;
 
@@ -566,6 +606,24 @@ static const unsigned rewind_buffer_size = 20 << 20; /* 20MiB */
 /* How many frames to rewind at a time. */
 static const unsigned rewind_granularity = 1;
 
+/* Amount of threads used to encode rewind states.
+ * With 0, states are encoded on the main thread. With 1 or more,
+ * encoding is done in the background and large states are split
+ * over the given amount of threads. */
+static const unsigned rewind_threads = 0;
+
+/* Store a full rewind state every this many rewind frames, so
+ * that long jumps back don't need to go through every delta.
+ * 0 disables keyframes. */
+static const unsigned rewind_keyframe_interval = 0;
+
+/* How many seconds the rewind seek hotkey jumps back. */
+static const unsigned rewind_seek_seconds = 10;
+
+/* Deflate rewind frames to fit more history in the buffer.
+ * Uses an encoder thread even if rewind_threads is 0. */
+static const bool rewind_compression = false;
+
 /* Pause gameplay when gameplay loses focus. */
 static const bool pause_nonactive = false;
 
@@ -577,6 +635,15 @@ static const unsigned autosave_interval = 0;
  * user 1 rather than user 2. */
 static const bool netplay_client_swap_input = true;
 
+/* Delays local input by this many frames over netplay,
+ * so the other side has it before it is needed and has to
+ * roll back less often. */
+static const unsigned netplay_input_latency_frames = 0;
+
+/* Raises netplay input latency above netplay_input_latency_frames
+ * as needed to cover the measured round trip time. */
+static const bool netplay_input_latency_auto = false;
+
 /* On save state load, block SRAM from being overwritten.
  * This could potentially lead to buggy games. */
 static const bool block_sram_overwrite = false;
@@ -724,6 +791,7 @@ static const struct retro_keybind retro_keybinds_1[] = {
    { true, RARCH_DISK_NEXT,                RETRO_LBL_DISK_NEXT,            RETROK_UNKNOWN, NO_BTN, 0, AXIS_NONE },
    { true, RARCH_DISK_PREV,                RETRO_LBL_DISK_PREV,            RETROK_UNKNOWN, NO_BTN, 0, AXIS_NONE },
    { true, RARCH_GRAB_MOUSE_TOGGLE,        RETRO_LBL_GRAB_MOUSE_TOGGLE,    RETROK_F11,     NO_BTN, 0, AXIS_NONE },
+   { true, RARCH_REWIND_SEEK,              RETRO_LBL_REWIND_SEEK,          RETROK_UNKNOWN, NO_BTN, 0, AXIS_NONE },
    { true, RARCH_MENU_TOGGLE,              RETRO_LBL_MENU_TOGGLE,          RETROK_F1,      NO_BTN, 0, AXIS_NONE },
 };
 
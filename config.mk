@@ -0,0 +1,140 @@
+CC = /usr/bin/gcc
+CFLAGS = 
+CXX = /usr/bin/g++
+CXXFLAGS = 
+WINDRES = 
+ASFLAGS = 
+LDFLAGS = 
+INCLUDE_DIRS =  -I./decompress/7zip/
+LIBRARY_DIRS =  -L/usr/lib64
+PACKAGE_NAME = retroarch
+PREFIX = /usr/local
+HAVE_RGUI = 1
+HAVE_GLUI = 0
+HAVE_XMB = 0
+HAVE_ALSA = 0
+ALSA_CFLAGS = 
+ALSA_LIBS = 
+HAVE_OSS = 1
+HAVE_OSS_BSD = 0
+HAVE_OSS_LIB = 0
+HAVE_AL = 0
+AL_CFLAGS = 
+AL_LIBS = 
+HAVE_RSOUND = 0
+RSOUND_CFLAGS = 
+RSOUND_LIBS = 
+HAVE_ROAR = 0
+ROAR_CFLAGS = 
+ROAR_LIBS = 
+HAVE_JACK = 0
+JACK_CFLAGS = 
+JACK_LIBS = 
+HAVE_COREAUDIO = 0
+HAVE_PULSE = 0
+PULSE_CFLAGS = 
+PULSE_LIBS = 
+HAVE_SDL = 0
+SDL_CFLAGS = 
+SDL_LIBS = 
+HAVE_SDL2 = 0
+SDL2_CFLAGS = 
+SDL2_LIBS = 
+HAVE_D3D9 = 0
+HAVE_OPENGL = 1
+HAVE_EXYNOS = 0
+HAVE_OMAP = 0
+HAVE_GLES = 0
+HAVE_GLES3 = 0
+HAVE_VG = 0
+VG_CFLAGS = 
+VG_LIBS = 
+HAVE_EGL = 1
+EGL_CFLAGS = 
+EGL_LIBS = -lEGL
+HAVE_KMS = 0
+HAVE_GBM = 0
+GBM_CFLAGS = 
+GBM_LIBS = 
+HAVE_DRM = 0
+DRM_CFLAGS = 
+DRM_LIBS = 
+HAVE_DYLIB = 1
+HAVE_GETOPT_LONG = 1
+HAVE_THREADS = 1
+HAVE_CG = 0
+CG_CFLAGS = 
+CG_LIBS = 
+HAVE_LIBXML2 = 1
+LIBXML2_CFLAGS = -I/usr/include/libxml2
+LIBXML2_LIBS = -lxml2
+HAVE_ZLIB = 1
+ZLIB_CFLAGS = 
+ZLIB_LIBS = -lz
+HAVE_DYNAMIC = 1
+HAVE_AVCODEC = 0
+AVCODEC_CFLAGS = 
+AVCODEC_LIBS = 
+HAVE_AVFORMAT = 0
+AVFORMAT_CFLAGS = 
+AVFORMAT_LIBS = 
+HAVE_AVUTIL = 0
+AVUTIL_CFLAGS = 
+AVUTIL_LIBS = 
+HAVE_SWSCALE = 0
+SWSCALE_CFLAGS = 
+SWSCALE_LIBS = 
+HAVE_FREETYPE = 1
+FREETYPE_CFLAGS = -I/usr/include/freetype2 -I/usr/include/libpng16
+FREETYPE_LIBS = -lfreetype
+HAVE_XKBCOMMON = 0
+XKBCOMMON_CFLAGS = 
+XKBCOMMON_LIBS = 
+HAVE_XVIDEO = 0
+HAVE_X11 = 0
+X11_CFLAGS = 
+X11_LIBS = -lX11
+HAVE_XEXT = 1
+XEXT_CFLAGS = 
+XEXT_LIBS = -lXext
+HAVE_XF86VM = 0
+XF86VM_CFLAGS = 
+XF86VM_LIBS = 
+HAVE_XINERAMA = 0
+XINERAMA_CFLAGS = 
+XINERAMA_LIBS = 
+HAVE_WAYLAND = 0
+WAYLAND_CFLAGS = 
+WAYLAND_LIBS = 
+HAVE_MALI_FBDEV = 0
+HAVE_VIVANTE_FBDEV = 0
+HAVE_NETWORKING = 1
+HAVE_NETPLAY = 1
+HAVE_NETWORK_CMD = 1
+HAVE_STDIN_CMD = 1
+HAVE_COMMAND = 1
+HAVE_SOCKET_LEGACY = 0
+HAVE_FBO = 1
+HAVE_STRL = 0
+HAVE_STRCASESTR = 1
+HAVE_MMAP = 1
+HAVE_PYTHON = 0
+HAVE_VIDEOCORE = 0
+HAVE_NEON = 0
+HAVE_FLOATHARD = 0
+HAVE_FLOATSOFTFP = 0
+HAVE_UDEV = 0
+UDEV_CFLAGS = 
+UDEV_LIBS = 
+HAVE_V4L2 = 0
+V4L2_CFLAGS = 
+V4L2_LIBS = 
+HAVE_AV_CHANNEL_LAYOUT = 0
+HAVE_7ZIP = 1
+HAVE_PARPORT = 1
+NOUNUSED = yes
+NOUNUSED_VARIABLE = yes
+DYLIB_LIB = -ldl
+MAN_DIR = /usr/local/share/man/man1
+OS = Linux
+GLOBAL_CONFIG_DIR = 
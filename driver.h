@@ -34,6 +34,7 @@
 #include "camera/camera_driver.h"
 #include "location/location_driver.h"
 #include "audio/audio_resampler_driver.h"
+#include "audio/audio_dsp_thread.h"
 #include "record/record_driver.h"
 
 #include "libretro_version_1.h"
@@ -46,6 +47,10 @@
 #include "command.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <rthreads/task_pool.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -57,6 +62,19 @@ extern "C" {
 
 #define AUDIO_MAX_RATIO 16
 
+/* retro_flush_audio() runs each block of this many frames through
+ * the whole pipeline before starting on the next, so the
+ * intermediate buffers stay in cache. */
+#define AUDIO_BLOCK_FRAMES 256
+
+/* Dynamic rate control keeps the driver buffer this full. */
+#define AUDIO_RATE_CONTROL_TARGET_FILL 0.5
+/* Fraction of the proportional term added to the integral
+ * every audio flush. Slow enough not to chase frame time
+ * jitter, the buffer still settles on the target within
+ * seconds after a clock change. */
+#define AUDIO_RATE_CONTROL_INTEGRAL_GAIN (1.0 / 128.0)
+
 /* Specialized _POINTER that targets the full screen regardless of viewport.
  * Should not be used by a libretro implementation as coordinates returned
  * make no sense.
@@ -123,6 +141,7 @@ enum
    RARCH_DISK_NEXT,
    RARCH_DISK_PREV,
    RARCH_GRAB_MOUSE_TOGGLE,
+   RARCH_REWIND_SEEK,
 
    RARCH_MENU_TOGGLE,
 
@@ -273,6 +292,11 @@ typedef struct driver
    struct scaler_ctx scaler;
    void *scaler_out;
 
+#ifdef HAVE_THREADS
+   /* Worker threads shared by softfilters and the scaler. */
+   task_pool_t *video_pool;
+#endif
+
    /* Graphics driver requires RGBA byte order data (ABGR on little-endian)
     * for 32-bit.
     * This takes effect for overlay and shader cores that wants to load
@@ -740,6 +740,23 @@ bool rarch_environment_cb(unsigned cmd, void *data)
                g_settings.user_language);
          break;
 
+      case RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER:
+      {
+         struct retro_framebuffer *fb = (struct retro_framebuffer*)data;
+
+         /* Converted or filtered frames get copied anyway. */
+         if (g_extern.system.pix_fmt == RETRO_PIXEL_FORMAT_0RGB1555 ||
+               g_extern.filter.filter)
+            return false;
+
+         if (!driver.video_poke ||
+               !driver.video_poke->get_current_software_framebuffer)
+            return false;
+
+         return driver.video_poke->get_current_software_framebuffer(
+               driver.video_data, fb);
+      }
+
       case RETRO_ENVIRONMENT_SET_PIXEL_FORMAT:
       {
          enum retro_pixel_format pix_fmt = 
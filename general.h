@@ -146,7 +146,9 @@ struct settings
       bool black_frame_insertion;
       unsigned swap_interval;
       unsigned hard_sync_frames;
+      bool pbo_upload;
       unsigned frame_delay;
+      bool frame_delay_auto;
 #ifdef GEKKO
       unsigned viwidth;
       bool vfilter;
@@ -162,6 +164,7 @@ struct settings
 
       char shader_path[PATH_MAX_LENGTH];
       bool shader_enable;
+      bool shader_async;
 
       char softfilter_plugin[PATH_MAX_LENGTH];
       float refresh_rate;
@@ -260,6 +263,8 @@ struct settings
       float max_timing_skew;
       float volume; /* dB scale. */
       char resampler[32];
+      unsigned resampler_quality;
+      bool dsp_thread;
    } audio;
 
    struct
@@ -288,6 +293,8 @@ struct settings
       char device_names[MAX_USERS][64];
       bool autodetect_enable;
       bool netplay_client_swap_input;
+      unsigned netplay_input_latency_frames;
+      bool netplay_input_latency_auto;
 
       unsigned turbo_period;
       unsigned turbo_duty_cycle;
@@ -352,6 +359,12 @@ struct settings
    bool rewind_enable;
    size_t rewind_buffer_size;
    unsigned rewind_granularity;
+   unsigned rewind_threads;
+   unsigned rewind_keyframe_interval;
+   unsigned rewind_seek_seconds;
+   bool rewind_compression;
+
+   unsigned run_ahead_frames;
 
    float slowmotion_ratio;
    float fastforward_ratio;
@@ -397,6 +410,9 @@ typedef struct rarch_resolution
 #define AUDIO_BUFFER_FREE_SAMPLES_COUNT (8 * 1024)
 #define MEASURE_FRAME_TIME_SAMPLES_COUNT (2 * 1024)
 
+#define FRAME_DELAY_HISTOGRAM_SIZE 64
+#define FRAME_DELAY_BUCKET_USEC 250
+
 #ifdef HAVE_NETWORKING
 typedef int (*http_cb_t               )(void *data, size_t len);
 #endif
@@ -489,6 +505,25 @@ struct global
       retro_time_t last_frame_time;
    } frame_limit;
 
+   struct
+   {
+      /* Delay in use by automatic frame delay, in microseconds. */
+      retro_time_t delay;
+      retro_time_t submit_time;
+
+      uint64_t frames;
+      uint64_t late_frames;
+      unsigned frames_since_late;
+
+      /* Core run time, from pretro_run() until the frame is
+       * handed to the video driver. Buckets are FRAME_DELAY_BUCKET_USEC
+       * wide, the last one catches everything slower.
+       * 'recent' decays over time and drives the tuning. */
+      uint32_t histogram[FRAME_DELAY_HISTOGRAM_SIZE];
+      uint32_t recent[FRAME_DELAY_HISTOGRAM_SIZE];
+      uint32_t recent_count;
+   } frame_delay;
+
    struct
    {
       struct retro_system_info info;
@@ -545,16 +580,31 @@ struct global
       float *outsamples;
       int16_t *conv_outsamples;
 
+      /* Collects frames from audio_sample() until a chunk is full. */
+      int16_t *sample_buf;
+
       int16_t *rewind_buf;
       size_t rewind_ptr;
       size_t rewind_size;
 
       rarch_dsp_filter_t *dsp;
+      audio_dsp_thread_t *dsp_thread;
 
-      bool rate_control; 
+      bool rate_control;
       double orig_src_ratio;
       size_t driver_buffer_size;
 
+      /* Dynamic rate control state and telemetry,
+       * see audio_driver_readjust_input_rate(). */
+      struct
+      {
+         double integral;
+         double adjust;
+         float fill;
+         bool empty;
+         unsigned underruns;
+      } rate;
+
       float volume_gain;
    } audio_data;
 
@@ -565,6 +615,9 @@ struct global
 
       retro_time_t frame_time_samples[MEASURE_FRAME_TIME_SAMPLES_COUNT];
       uint64_t frame_time_samples_count;
+
+      retro_time_t pacing_error_samples[MEASURE_FRAME_TIME_SAMPLES_COUNT];
+      uint64_t pacing_error_samples_count;
    } measure_data;
 
    struct
@@ -599,6 +652,16 @@ struct global
    size_t state_size;
    bool frame_is_reverse;
 
+   /* Run-ahead support. */
+   struct
+   {
+      void *state;
+      size_t state_size;
+      bool hide_video;
+      bool hide_audio;
+      bool unsupported;
+   } run_ahead;
+
    /* Movie playback/recording support. */
    struct
    {
@@ -1136,6 +1136,9 @@ static inline void gl_convert_frame_rgb16_32(gl_t *gl, void *output,
 
    gl->scaler.in_stride  = in_pitch;
    gl->scaler.out_stride = width * sizeof(uint32_t);
+#ifdef HAVE_THREADS
+   gl->scaler.pool       = driver.video_pool;
+#endif
    scaler_ctx_scale(&gl->scaler, output, input);
 }
 #endif
@@ -1159,6 +1162,9 @@ static inline void gl_convert_frame_argb8888_abgr8888(gl_t *gl,
 
    gl->scaler.in_stride  = in_pitch;
    gl->scaler.out_stride = width * sizeof(uint32_t);
+#ifdef HAVE_THREADS
+   gl->scaler.pool       = driver.video_pool;
+#endif
    scaler_ctx_scale(&gl->scaler, output, input);
 }
 #endif
@@ -1264,6 +1270,183 @@ static void gl_init_textures(gl_t *gl, const video_info_t *video)
    glBindTexture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
 }
 
+#ifdef HAVE_GL_SYNC
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+static void gl_init_upload_ring(gl_t *gl)
+{
+   const GLbitfield persistent_flags = GL_MAP_WRITE_BIT |
+      GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+   gl->upload_enable = false;
+   if (!g_settings.video.pbo_upload)
+      return;
+
+   if (!glMapBufferRange || !glUnmapBuffer)
+   {
+      RARCH_WARN("[GL]: glMapBufferRange is missing, "
+            "not using PBO upload.\n");
+      return;
+   }
+
+   /* Large enough for a full texture after conversion to 32-bit. */
+   gl->upload_size  = gl->tex_w * gl->tex_h * sizeof(uint32_t);
+   gl->upload_index = 0;
+
+   glGenBuffers(1, &gl->upload_pbo);
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->upload_pbo);
+
+   if (gl->have_sync && glBufferStorage &&
+         gl_query_extension(gl, "ARB_buffer_storage"))
+   {
+      glBufferStorage(GL_PIXEL_UNPACK_BUFFER,
+            gl->upload_size * GL_UPLOAD_RING_SIZE, NULL, persistent_flags);
+      gl->upload_map = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
+            gl->upload_size * GL_UPLOAD_RING_SIZE, persistent_flags);
+
+      if (!gl->upload_map)
+      {
+         /* Storage can't be respecified, start over. */
+         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+         glDeleteBuffers(1, &gl->upload_pbo);
+         glGenBuffers(1, &gl->upload_pbo);
+         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->upload_pbo);
+      }
+   }
+
+   if (gl->upload_map)
+      RARCH_LOG("[GL]: Uploading frames through %u persistently mapped PBOs.\n",
+            GL_UPLOAD_RING_SIZE);
+   else
+   {
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, gl->upload_size,
+            NULL, GL_STREAM_DRAW);
+      RARCH_LOG("[GL]: Uploading frames through an orphaned PBO.\n");
+   }
+
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+   gl->upload_enable = true;
+}
+
+static void gl_free_upload_ring(gl_t *gl)
+{
+   unsigned i;
+
+   if (!gl->upload_enable)
+      return;
+
+   for (i = 0; i < GL_UPLOAD_RING_SIZE; i++)
+   {
+      if (!gl->upload_fences[i])
+         continue;
+      glDeleteSync(gl->upload_fences[i]);
+      gl->upload_fences[i] = NULL;
+   }
+
+   if (gl->upload_map)
+   {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->upload_pbo);
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      gl->upload_map = NULL;
+   }
+
+   glDeleteBuffers(1, &gl->upload_pbo);
+   gl->upload_pbo    = 0;
+   gl->upload_enable = false;
+}
+
+/**
+ * gl_copy_frame_pbo:
+ * @gl                 : pointer to GL driver data.
+ * @frame              : frame from the core.
+ * @width              : width of the frame.
+ * @height             : height of the frame.
+ * @pitch              : pitch of the frame.
+ *
+ * Writes the frame, converted if need be, into the next part of
+ * the upload ring and uploads the texture from there.
+ *
+ * Returns: false if the buffer could not be mapped, in which
+ * case nothing was uploaded.
+ **/
+static bool gl_copy_frame_pbo(gl_t *gl, const void *frame,
+      unsigned width, unsigned height, unsigned pitch)
+{
+   uint8_t *dst         = NULL;
+   size_t offset        = 0;
+   bool convert         = gl->base_size == 2 && !gl->have_es2_compat;
+   unsigned line_bytes  = width * (convert ? sizeof(uint32_t) : gl->base_size);
+
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->upload_pbo);
+
+   if (gl->upload_map)
+   {
+      GLsync fence = gl->upload_fences[gl->upload_index];
+
+      /* Only waits if the GPU is still reading the frame
+       * uploaded from this part GL_UPLOAD_RING_SIZE frames ago. */
+      if (fence)
+      {
+         glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+         glDeleteSync(fence);
+         gl->upload_fences[gl->upload_index] = NULL;
+      }
+
+      offset = gl->upload_index * gl->upload_size;
+      dst    = (uint8_t*)gl->upload_map + offset;
+   }
+   else
+   {
+      /* Orphan the old storage, the driver hands out
+       * new memory while the GPU still reads the old one. */
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, gl->upload_size,
+            NULL, GL_STREAM_DRAW);
+      dst = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
+            gl->upload_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+      if (!dst)
+      {
+         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+         return false;
+      }
+   }
+
+   if (convert)
+      gl_convert_frame_rgb16_32(gl, dst, frame, width, height, pitch);
+   else
+   {
+      unsigned h;
+      const uint8_t *src = (const uint8_t*)frame;
+
+      for (h = 0; h < height; h++, src += pitch, dst += line_bytes)
+         memcpy(dst, src, line_bytes);
+   }
+
+   if (!gl->upload_map)
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+   glPixelStorei(GL_UNPACK_ALIGNMENT, get_alignment(line_bytes));
+   glTexSubImage2D(GL_TEXTURE_2D,
+         0, 0, 0, width, height, gl->texture_type,
+         gl->texture_fmt, (const GLvoid*)offset);
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+   if (gl->upload_map)
+   {
+      gl->upload_fences[gl->upload_index] =
+         glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      gl->upload_index = (gl->upload_index + 1) % GL_UPLOAD_RING_SIZE;
+   }
+
+   return true;
+}
+#endif
+
 static inline void gl_copy_frame(gl_t *gl, const void *frame,
       unsigned width, unsigned height, unsigned pitch)
 {
@@ -1353,6 +1536,15 @@ static inline void gl_copy_frame(gl_t *gl, const void *frame,
    glUnmapBuffer(GL_TEXTURE_REFERENCE_BUFFER_SCE);
 #else
    const GLvoid *data_buf = frame;
+
+#ifdef HAVE_GL_SYNC
+   if (gl->upload_enable && gl_copy_frame_pbo(gl, frame, width, height, pitch))
+   {
+      RARCH_PERFORMANCE_STOP(copy_frame);
+      return;
+   }
+#endif
+
    glPixelStorei(GL_UNPACK_ALIGNMENT, get_alignment(pitch));
 
    if (gl->base_size == 2 && !gl->have_es2_compat)
@@ -1733,6 +1925,8 @@ static void gl_free(void *data)
       }
       gl->fence_count = 0;
    }
+
+   gl_free_upload_ring(gl);
 #endif
 
    if (gl->font_driver && gl->font_handle)
@@ -2417,6 +2611,10 @@ static void *gl_init(const video_info_t *video, const input_driver_t **input, vo
    gl_init_pbo_readback(gl);
 #endif
 
+#ifdef HAVE_GL_SYNC
+   gl_init_upload_ring(gl);
+#endif
+
    if (!gl_check_error())
    {
       gl->ctx_driver->destroy(gl);
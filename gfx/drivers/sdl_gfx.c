@@ -310,6 +310,9 @@ static void *sdl_gfx_init(const video_info_t *video, const input_driver_t **inpu
    vid->scaler.scaler_type = video->smooth ? SCALER_TYPE_BILINEAR : SCALER_TYPE_POINT;
    vid->scaler.in_fmt  = video->rgb32 ? SCALER_FMT_ARGB8888 : SCALER_FMT_RGB565;
    vid->scaler.out_fmt = SCALER_FMT_ARGB8888;
+#ifdef HAVE_THREADS
+   vid->scaler.pool    = driver.video_pool;
+#endif
 
    vid->menu.scaler = vid->scaler;
    vid->menu.scaler.scaler_type = SCALER_TYPE_BILINEAR;
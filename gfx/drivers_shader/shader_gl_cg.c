@@ -39,6 +39,10 @@
 
 #include "../video_state_tracker.h"
 
+#ifdef HAVE_THREADS
+#include "../video_shader_async.h"
+#endif
+
 #if 0
 #define RARCH_CG_DEBUG
 #endif
@@ -665,31 +669,39 @@ static bool load_preset(cg_shader_data_t *cg, const char *path)
       return false;
 
    RARCH_LOG("Loading Cg meta-shader: %s\n", path);
-   config_file_t *conf = config_file_new(path);
-   if (!conf)
-   {
-      RARCH_ERR("Failed to load preset.\n");
-      return false;
-   }
 
-   cg->cg_shader = (struct video_shader*)calloc(1, sizeof(*cg->cg_shader));
+#ifdef HAVE_THREADS
+   cg->cg_shader = video_shader_async_take_shader(path);
+#endif
+
    if (!cg->cg_shader)
    {
-      config_file_free(conf);
-      return false;
-   }
+      config_file_t *conf = config_file_new(path);
+      if (!conf)
+      {
+         RARCH_ERR("Failed to load preset.\n");
+         return false;
+      }
 
-   if (!video_shader_read_conf_cgp(conf, cg->cg_shader))
-   {
-      RARCH_ERR("Failed to parse CGP file.\n");
+      cg->cg_shader = (struct video_shader*)calloc(1, sizeof(*cg->cg_shader));
+      if (!cg->cg_shader)
+      {
+         config_file_free(conf);
+         return false;
+      }
+
+      if (!video_shader_read_conf_cgp(conf, cg->cg_shader))
+      {
+         RARCH_ERR("Failed to parse CGP file.\n");
+         config_file_free(conf);
+         return false;
+      }
+
+      video_shader_resolve_relative(cg->cg_shader, path);
+      video_shader_resolve_parameters(conf, cg->cg_shader);
       config_file_free(conf);
-      return false;
    }
 
-   video_shader_resolve_relative(cg->cg_shader, path);
-   video_shader_resolve_parameters(conf, cg->cg_shader);
-   config_file_free(conf);
-
    if (cg->cg_shader->passes > GFX_MAX_SHADERS - 3)
    {
       RARCH_WARN("Too many shaders ... Capping shader amount to %d.\n",
@@ -22,6 +22,11 @@
 #include "../video_state_tracker.h"
 #include "../../dynamic.h"
 #include "../../file_ops.h"
+#include "../../hash.h"
+
+#ifdef HAVE_THREADS
+#include "../video_shader_async.h"
+#endif
 
 #ifdef HAVE_CONFIG_H
 #include "../../config.h"
@@ -41,6 +46,15 @@
 
 #define PREV_TEXTURES (MAX_TEXTURES - 1)
 
+/* Linked programs are kept on disk as driver specific binaries,
+ * so presets don't have to be compiled on every start. */
+#ifndef HAVE_OPENGLES
+#define HAVE_GLSL_PROGRAM_CACHE
+#endif
+
+#define GLSL_VERTEX_DEFINE   "#define VERTEX\n#define PARAMETER_UNIFORM\n"
+#define GLSL_FRAGMENT_DEFINE "#define FRAGMENT\n#define PARAMETER_UNIFORM\n"
+
 
 /* Cache the VBO. */
 struct cache_vbo
@@ -215,6 +229,12 @@ typedef struct glsl_shader_data
    GLuint gl_teximage[GFX_MAX_TEXTURES];
    GLint gl_attribs[PREV_TEXTURES + 1 + 4 + GFX_MAX_SHADERS];
    state_tracker_t *gl_state_tracker;
+#ifdef HAVE_GLSL_PROGRAM_CACHE
+   /* Empty if program binaries can't be used. */
+   char program_cache_dir[PATH_MAX_LENGTH];
+   unsigned program_cache_hits;
+   unsigned program_cache_misses;
+#endif
 } glsl_shader_data_t;
 
 static bool glsl_core;
@@ -311,35 +331,58 @@ static void print_linker_log(GLuint obj)
    free(info_log);
 }
 
+/**
+ * get_shader_version:
+ * @version            : buffer for the #version line.
+ * @size               : size of @version.
+ * @program            : shader source.
+ *
+ * Core contexts need a #version line, which is added
+ * in front of shaders that don't have one.
+ *
+ * Returns: GLSL version put into @version, or 0 if
+ * none is needed.
+ **/
+static unsigned get_shader_version(char *version, size_t size,
+      const char *program)
+{
+   unsigned version_no = 0;
+   unsigned gl_ver     = glsl_major * 100 + glsl_minor * 10;
+
+   *version = '\0';
+   if (!glsl_core || strstr(program, "#version"))
+      return 0;
+
+   switch (gl_ver)
+   {
+      case 300:
+         version_no = 130;
+         break;
+      case 310:
+         version_no = 140;
+         break;
+      case 320:
+         version_no = 150;
+         break;
+      default:
+         version_no = gl_ver;
+         break;
+   }
+
+   snprintf(version, size, "#version %u\n", version_no);
+   return version_no;
+}
+
 static bool compile_shader(glsl_shader_data_t *glsl,
       GLuint shader,
       const char *define, const char *program)
 {
    char version[32] = {0};
-   if (glsl_core && !strstr(program, "#version"))
-   {
-      unsigned version_no = 0;
-      unsigned gl_ver = glsl_major * 100 + glsl_minor * 10;
-
-      switch (gl_ver)
-      {
-         case 300:
-            version_no = 130;
-            break;
-         case 310:
-            version_no = 140;
-            break;
-         case 320:
-            version_no = 150;
-            break;
-         default:
-            version_no = gl_ver;
-            break;
-      }
+   unsigned version_no = get_shader_version(version,
+         sizeof(version), program);
 
-      snprintf(version, sizeof(version), "#version %u\n", version_no);
+   if (version_no)
       RARCH_LOG("[GL]: Using GLSL version %u.\n", version_no);
-   }
 
    const char *source[] = { version, define, glsl->glsl_alias_define, program };
    glShaderSource(shader, ARRAY_SIZE(source), source, NULL);
@@ -367,21 +410,217 @@ static bool link_program(GLuint prog)
    return true;
 }
 
+#ifdef HAVE_GLSL_PROGRAM_CACHE
+static bool program_cache_supported(void)
+{
+   GLint formats       = 0;
+   unsigned major      = 0;
+   unsigned minor      = 0;
+   const char *version = (const char*)glGetString(GL_VERSION);
+
+   if (!glGetProgramBinary || !glProgramBinary || !glProgramParameteri)
+      return false;
+   if (!version || sscanf(version, "%u.%u", &major, &minor) != 2)
+      return false;
+
+   /* Core in GL 4.1. Older core contexts can't
+    * list extensions with glGetString. */
+   if (major * 10 + minor < 41)
+   {
+      const char *ext = NULL;
+
+      if (glsl_core)
+         return false;
+      ext = (const char*)glGetString(GL_EXTENSIONS);
+      if (!ext || !strstr(ext, "ARB_get_program_binary"))
+         return false;
+   }
+
+   /* Some drivers support the API, but no formats. */
+   glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+   return formats > 0;
+}
+
+static void program_cache_init(glsl_shader_data_t *glsl)
+{
+   char config_dir[PATH_MAX_LENGTH];
+
+   *glsl->program_cache_dir   = '\0';
+   glsl->program_cache_hits   = 0;
+   glsl->program_cache_misses = 0;
+
+   if (!*g_extern.config_path || !program_cache_supported())
+      return;
+
+   fill_pathname_basedir(config_dir, g_extern.config_path,
+         sizeof(config_dir));
+   fill_pathname_join(glsl->program_cache_dir, config_dir,
+         "shader_cache", sizeof(glsl->program_cache_dir));
+
+   if (!path_is_directory(glsl->program_cache_dir) &&
+         !path_mkdir(glsl->program_cache_dir))
+   {
+      RARCH_WARN("[GLSL]: Cannot create program cache directory %s.\n",
+            glsl->program_cache_dir);
+      *glsl->program_cache_dir = '\0';
+   }
+}
+
+/**
+ * program_cache_path:
+ * @glsl               : GLSL shader data.
+ * @vertex             : vertex shader source, or NULL.
+ * @fragment           : fragment shader source, or NULL.
+ * @path               : buffer for the path of the cache file.
+ * @size               : size of @path.
+ *
+ * The cache file is named after a hash of everything passed to
+ * glShaderSource() and of the driver strings, so a binary is never
+ * used with other sources or after a driver update. Shader
+ * parameters are uniforms and don't change the binary.
+ *
+ * Returns: false if there is no program cache.
+ **/
+static bool program_cache_path(glsl_shader_data_t *glsl,
+      const char *vertex, const char *fragment,
+      char *path, size_t size)
+{
+   unsigned i;
+   char hash[65];
+   char vertex_version[32]   = {0};
+   char fragment_version[32] = {0};
+   const char *parts[11];
+   size_t len                = 0;
+   uint8_t *key              = NULL;
+
+   if (!*glsl->program_cache_dir)
+      return false;
+
+   if (vertex)
+      get_shader_version(vertex_version, sizeof(vertex_version), vertex);
+   if (fragment)
+      get_shader_version(fragment_version, sizeof(fragment_version), fragment);
+
+   parts[0]  = (const char*)glGetString(GL_VENDOR);
+   parts[1]  = (const char*)glGetString(GL_RENDERER);
+   parts[2]  = (const char*)glGetString(GL_VERSION);
+   parts[3]  = glsl->glsl_alias_define;
+   parts[4]  = vertex_version;
+   parts[5]  = vertex ? GLSL_VERTEX_DEFINE : "";
+   parts[6]  = vertex ? vertex : "";
+   parts[7]  = fragment_version;
+   parts[8]  = fragment ? GLSL_FRAGMENT_DEFINE : "";
+   parts[9]  = fragment ? fragment : "";
+   parts[10] = "";
+
+   for (i = 0; i < ARRAY_SIZE(parts); i++)
+      len += (parts[i] ? strlen(parts[i]) : 0) + 1;
+
+   key = (uint8_t*)malloc(len);
+   if (!key)
+      return false;
+
+   /* Keep the terminators, so parts can't run into each other. */
+   for (i = 0, len = 0; i < ARRAY_SIZE(parts); i++)
+   {
+      size_t part_len = parts[i] ? strlen(parts[i]) + 1 : 1;
+      memcpy(key + len, parts[i] ? parts[i] : "", part_len);
+      len += part_len;
+   }
+
+   sha256_hash(hash, key, len);
+   free(key);
+
+   fill_pathname_join(path, glsl->program_cache_dir, hash, size);
+   strlcat(path, ".bin", size);
+   return true;
+}
+
+/* Cache files hold the binary format, followed by the binary. */
+static bool program_cache_load(GLuint prog, const char *path)
+{
+   uint32_t format;
+   GLint status = GL_FALSE;
+   void *buf    = NULL;
+   long len     = read_file(path, &buf);
+
+   if (len <= (long)sizeof(format))
+   {
+      free(buf);
+      return false;
+   }
+
+   memcpy(&format, buf, sizeof(format));
+   glProgramBinary(prog, format, (const uint8_t*)buf + sizeof(format),
+         len - sizeof(format));
+   free(buf);
+
+   glGetProgramiv(prog, GL_LINK_STATUS, &status);
+   return status == GL_TRUE;
+}
+
+static void program_cache_save(GLuint prog, const char *path)
+{
+   uint32_t format;
+   GLenum binary_format = 0;
+   GLint len            = 0;
+   uint8_t *buf         = NULL;
+
+   glGetProgramiv(prog, GL_PROGRAM_BINARY_LENGTH, &len);
+   if (len <= 0)
+      return;
+
+   buf = (uint8_t*)malloc(len + sizeof(format));
+   if (!buf)
+      return;
+
+   glGetProgramBinary(prog, len, &len, &binary_format, buf + sizeof(format));
+   format = binary_format;
+   memcpy(buf, &format, sizeof(format));
+
+   if (!write_file(path, buf, len + sizeof(format)))
+      RARCH_WARN("[GLSL]: Failed to write program cache %s.\n", path);
+
+   free(buf);
+}
+#endif
+
 static GLuint compile_program(glsl_shader_data_t *glsl,
       const char *vertex,
       const char *fragment, unsigned i)
 {
    GLuint vert = 0, frag = 0, prog = glCreateProgram();
+#ifdef HAVE_GLSL_PROGRAM_CACHE
+   char cache_path[PATH_MAX_LENGTH];
+   bool cached = false;
+#endif
    if (!prog)
       return 0;
 
+#ifdef HAVE_GLSL_PROGRAM_CACHE
+   cached = (vertex || fragment) && program_cache_path(glsl,
+         vertex, fragment, cache_path, sizeof(cache_path));
+
+   if (cached && program_cache_load(prog, cache_path))
+   {
+      RARCH_LOG("[GLSL]: Program #%u loaded from cache.\n", i);
+      glsl->program_cache_hits++;
+      goto end;
+   }
+
+   if (cached)
+   {
+      RARCH_LOG("[GLSL]: Program #%u not in cache.\n", i);
+      glsl->program_cache_misses++;
+      glProgramParameteri(prog, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+   }
+#endif
+
    if (vertex)
    {
       RARCH_LOG("Found GLSL vertex shader.\n");
       vert = glCreateShader(GL_VERTEX_SHADER);
-      if (!compile_shader(
-               glsl,
-               vert, "#define VERTEX\n#define PARAMETER_UNIFORM\n", vertex))
+      if (!compile_shader(glsl, vert, GLSL_VERTEX_DEFINE, vertex))
       {
          RARCH_ERR("Failed to compile vertex shader #%u\n", i);
          return 0;
@@ -394,8 +633,7 @@ static GLuint compile_program(glsl_shader_data_t *glsl,
    {
       RARCH_LOG("Found GLSL fragment shader.\n");
       frag = glCreateShader(GL_FRAGMENT_SHADER);
-      if (!compile_shader(glsl, frag,
-               "#define FRAGMENT\n#define PARAMETER_UNIFORM\n", fragment))
+      if (!compile_shader(glsl, frag, GLSL_FRAGMENT_DEFINE, fragment))
       {
          RARCH_ERR("Failed to compile fragment shader #%u\n", i);
          return 0;
@@ -421,6 +659,17 @@ static GLuint compile_program(glsl_shader_data_t *glsl,
       if (frag)
          glDeleteShader(frag);
 
+#ifdef HAVE_GLSL_PROGRAM_CACHE
+      if (cached)
+         program_cache_save(prog, cache_path);
+#endif
+   }
+
+#ifdef HAVE_GLSL_PROGRAM_CACHE
+end:
+#endif
+   if (vertex || fragment)
+   {
       glUseProgram(prog);
       GLint location = get_uniform(glsl, prog, "Texture");
       glUniform1i(location, 0);
@@ -706,6 +955,7 @@ static void gl_glsl_deinit(void)
 static bool gl_glsl_init(void *data, const char *path)
 {
    unsigned i;
+   bool prepared              = false;
    config_file_t *conf        = NULL;
    glsl_shader_data_t *glsl   = NULL;
    const char *stock_vertex   = NULL;
@@ -741,14 +991,23 @@ static bool gl_glsl_init(void *data, const char *path)
    }
 #endif
 
-   glsl->glsl_shader = (struct video_shader*)calloc(1, sizeof(*glsl->glsl_shader));
+#ifdef HAVE_THREADS
+   glsl->glsl_shader = video_shader_async_take_shader(path);
+   prepared          = glsl->glsl_shader != NULL;
+#endif
+
+   if (!glsl->glsl_shader)
+      glsl->glsl_shader = (struct video_shader*)
+         calloc(1, sizeof(*glsl->glsl_shader));
    if (!glsl->glsl_shader)
    {
       free(glsl);
       return false;
    }
 
-   if (path)
+   if (prepared)
+      RARCH_LOG("[GL]: Using GLSL shader prepared in the background.\n");
+   else if (path)
    {
       bool ret;
       if (strcmp(path_get_extension(path), "glsl") == 0)
@@ -792,8 +1051,11 @@ static bool gl_glsl_init(void *data, const char *path)
       glsl->glsl_shader->modern = true;
    }
 
-   video_shader_resolve_relative(glsl->glsl_shader, path);
-   video_shader_resolve_parameters(conf, glsl->glsl_shader);
+   if (!prepared)
+   {
+      video_shader_resolve_relative(glsl->glsl_shader, path);
+      video_shader_resolve_parameters(conf, glsl->glsl_shader);
+   }
 
    if (conf)
    {
@@ -840,6 +1102,10 @@ static bool gl_glsl_init(void *data, const char *path)
       }
    }
 
+#ifdef HAVE_GLSL_PROGRAM_CACHE
+   program_cache_init(glsl);
+#endif
+
    if (!(glsl->gl_program[0] = compile_program(glsl, stock_vertex, stock_fragment, 0)))
    {
       RARCH_ERR("GLSL stock programs failed to compile.\n");
@@ -903,6 +1169,12 @@ static bool gl_glsl_init(void *data, const char *path)
       glsl->gl_uniforms[GL_SHADER_STOCK_BLEND] = glsl->gl_uniforms[0];
    }
 
+#ifdef HAVE_GLSL_PROGRAM_CACHE
+   if (*glsl->program_cache_dir)
+      RARCH_LOG("[GLSL]: Program cache: %u hit(s), %u miss(es).\n",
+            glsl->program_cache_hits, glsl->program_cache_misses);
+#endif
+
    gl_glsl_reset_attrib(glsl);
 
    for (i = 0; i < GFX_MAX_SHADERS; i++)
@@ -16,6 +16,10 @@
 
 #include "gl_common.h"
 
+#ifdef HAVE_THREADS
+#include "video_shader_async.h"
+#endif
+
 void gl_load_texture_data(GLuint obj, const struct texture_image *img,
       GLenum wrap, bool linear, bool mipmap)
 {
@@ -66,7 +70,12 @@ bool gl_load_luts(const struct video_shader *generic_shader,
       RARCH_LOG("Loading texture image from: \"%s\" ...\n",
             generic_shader->lut[i].path);
 
-      if (!texture_image_load(&img, generic_shader->lut[i].path))
+      /* May have been decoded in the background already. */
+      if (
+#ifdef HAVE_THREADS
+            !video_shader_async_take_lut(generic_shader->lut[i].path, &img) &&
+#endif
+            !texture_image_load(&img, generic_shader->lut[i].path))
       {
          RARCH_ERR("Failed to load texture image from: \"%s\"\n",
                generic_shader->lut[i].path);
@@ -369,6 +369,18 @@ typedef struct gl
    bool have_sync;
    GLsync fences[MAX_FENCES];
    unsigned fence_count;
+
+   /* Ring of pixel unpack buffers frames are streamed through.
+    * With ARB_buffer_storage it is one persistently mapped buffer,
+    * each part guarded by a fence, otherwise a single buffer
+    * which is orphaned every frame. */
+#define GL_UPLOAD_RING_SIZE 3
+   bool upload_enable;
+   GLuint upload_pbo;
+   void *upload_map;
+   size_t upload_size;
+   GLsync upload_fences[GL_UPLOAD_RING_SIZE];
+   unsigned upload_index;
 #endif
 
    bool core_context;
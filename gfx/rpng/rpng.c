@@ -25,6 +25,11 @@
 #include <malloc.h>
 #endif
 
+#if defined(__SSE2__)
+#define RPNG_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
 #ifdef RARCH_INTERNAL
 #include "../../hash.h"
 #else
@@ -53,7 +58,7 @@ struct png_chunk
 {
    uint32_t size;
    char type[4];
-   uint8_t *data;
+   const uint8_t *data;
 };
 
 struct png_ihdr
@@ -82,18 +87,22 @@ static uint32_t dword_be(const uint8_t *buf)
    return (buf[0] << 24) | (buf[1] << 16) | (buf[2] << 8) | (buf[3] << 0);
 }
 
-static bool read_chunk_header(FILE *file, struct png_chunk *chunk)
+/* Chunks are 4 bytes size, 4 bytes type, data and 4 bytes CRC.
+ * As the CRC isn't checked, it may be cut off at the end of the file. */
+static bool read_chunk_header(const uint8_t *buf, size_t size,
+      struct png_chunk *chunk)
 {
-   uint8_t dword[4] = {0};
-
-   if (fread(dword, 1, 4, file) != 4)
+   if (size < 2 * sizeof(uint32_t))
       return false;
 
-   chunk->size = dword_be(dword);
+   chunk->size = dword_be(buf);
+   memcpy(chunk->type, buf + 4, 4);
 
-   if (fread(chunk->type, 1, 4, file) != 4)
+   if (chunk->size > size - 2 * sizeof(uint32_t))
       return false;
 
+   /* Ignore CRC. */
+   chunk->data = buf + 8;
    return true;
 }
 
@@ -108,12 +117,6 @@ struct
    { "PLTE", PNG_CHUNK_PLTE },
 };
 
-struct idat_buffer
-{
-   uint8_t *data;
-   size_t size;
-};
-
 static enum png_chunk_type png_chunk_type(const struct png_chunk *chunk)
 {
    unsigned i;
@@ -127,42 +130,12 @@ static enum png_chunk_type png_chunk_type(const struct png_chunk *chunk)
    return PNG_CHUNK_NOOP;
 }
 
-static bool png_read_chunk(FILE *file, struct png_chunk *chunk)
-{
-   free(chunk->data);
-   chunk->data = (uint8_t*)calloc(1, chunk->size + sizeof(uint32_t)); /* CRC32 */
-   if (!chunk->data)
-      return false;
-
-   if (fread(chunk->data, 1, chunk->size + 
-            sizeof(uint32_t), file) != (chunk->size + sizeof(uint32_t)))
-   {
-      free(chunk->data);
-      return false;
-   }
-
-   /* Ignore CRC. */
-   return true;
-}
-
-static void png_free_chunk(struct png_chunk *chunk)
-{
-   if (!chunk)
-      return;
-
-   free(chunk->data);
-   chunk->data = NULL;
-}
-
-static bool png_parse_ihdr(FILE *file,
-      struct png_chunk *chunk, struct png_ihdr *ihdr)
+static bool png_parse_ihdr(const struct png_chunk *chunk,
+      struct png_ihdr *ihdr)
 {
    unsigned i;
    bool ret = true;
 
-   if (!png_read_chunk(file, chunk))
-      return false;
-
    if (chunk->size != 13)
       GOTO_END_ERROR();
 
@@ -177,6 +150,10 @@ static bool png_parse_ihdr(FILE *file,
    if (ihdr->width == 0 || ihdr->height == 0)
       GOTO_END_ERROR();
 
+   /* The decoded image has to fit in memory. */
+   if ((uint64_t)ihdr->width * ihdr->height > SIZE_MAX / sizeof(uint32_t))
+      GOTO_END_ERROR();
+
    if (ihdr->color_type == 2 || 
          ihdr->color_type == 4 || ihdr->color_type == 6)
    {
@@ -238,7 +215,6 @@ static bool png_parse_ihdr(FILE *file,
 #endif
 
 end:
-   png_free_chunk(chunk);
    return ret;
 }
 
@@ -281,11 +257,29 @@ static inline void copy_line_rgb(uint32_t *data,
 static inline void copy_line_rgba(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned bpp)
 {
-   unsigned i;
+   unsigned i = 0;
 
    bpp /= 8;
 
-   for (i = 0; i < width; i++)
+#if defined(RPNG_SIMD_SSE2)
+   if (bpp == 1)
+   {
+      __m128i ga_mask = _mm_set1_epi32(0xff00ff00);
+
+      /* RGBA bytes to ARGB words is a swap of R and B. */
+      for (; i + 4 <= width; i += 4, decoded += 16)
+      {
+         __m128i x  = _mm_loadu_si128((const __m128i*)decoded);
+         __m128i rb = _mm_andnot_si128(ga_mask, x);
+
+         rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+         _mm_storeu_si128((__m128i*)(data + i),
+               _mm_or_si128(_mm_and_si128(x, ga_mask), rb));
+      }
+   }
+#endif
+
+   for (; i < width; i++)
    {
       uint32_t r, g, b, a;
       r        = *decoded;
@@ -303,10 +297,8 @@ static inline void copy_line_rgba(uint32_t *data,
 static inline void copy_line_bw(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned depth)
 {
-   unsigned i, bit = 0;
+   unsigned i, bit = 0, mul, mask;
    static const unsigned mul_table[] = { 0, 0xff, 0x55, 0, 0x11, 0, 0, 0, 0x01 };
-   unsigned mul  = mul_table[depth];
-   unsigned mask = (1 << depth) - 1;
 
    if (depth == 16)
    {
@@ -318,6 +310,9 @@ static inline void copy_line_bw(uint32_t *data,
       return;
    }
 
+   mul  = mul_table[depth];
+   mask = (1 << depth) - 1;
+
    for (i = 0; i < width; i++, bit += depth)
    {
       unsigned byte = bit >> 3;
@@ -418,11 +413,247 @@ static void png_pass_geom(const struct png_ihdr *ihdr,
 }
 
 
+/* Scanlines are unfiltered in buffers with PNG_LINE_PAD bytes in
+ * front, which stay zero, so the filters can read the pixel left of
+ * the first one like any other. There are as many bytes behind the
+ * line, so vector loops may run past its end. */
+#define PNG_LINE_PAD 16
+
+static uint8_t *png_alloc_line(unsigned pitch)
+{
+   uint8_t *line = (uint8_t*)calloc(1, pitch + 2 * PNG_LINE_PAD);
+   return line ? line + PNG_LINE_PAD : NULL;
+}
+
+static void png_free_line(uint8_t *line)
+{
+   if (line)
+      free(line - PNG_LINE_PAD);
+}
+
+#if defined(RPNG_SIMD_SSE2)
+/* Pixels of 3 or 4 bytes, in the low lane of a vector. */
+static inline __m128i png_load_pixel(const uint8_t *ptr, unsigned bpp)
+{
+   uint32_t pixel = 0;
+   memcpy(&pixel, ptr, bpp);
+   return _mm_cvtsi32_si128(pixel);
+}
+
+static inline void png_store_pixel(uint8_t *ptr, __m128i pixel, unsigned bpp)
+{
+   uint32_t val = _mm_cvtsi128_si32(pixel);
+   memcpy(ptr, &val, bpp);
+}
+
+static inline void png_unfilter_sub_sse2(uint8_t *line,
+      unsigned bpp, unsigned pitch)
+{
+   unsigned i;
+   __m128i a = _mm_setzero_si128();
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      a = _mm_add_epi8(a, png_load_pixel(line + i, bpp));
+      png_store_pixel(line + i, a, bpp);
+   }
+}
+
+static void png_unfilter_up_sse2(uint8_t *line,
+      const uint8_t *prev, unsigned pitch)
+{
+   unsigned i;
+
+   for (i = 0; i < pitch; i += 16)
+   {
+      __m128i x = _mm_loadu_si128((const __m128i*)(line + i));
+      __m128i b = _mm_loadu_si128((const __m128i*)(prev + i));
+      _mm_storeu_si128((__m128i*)(line + i), _mm_add_epi8(x, b));
+   }
+}
+
+static inline void png_unfilter_avg_sse2(uint8_t *line,
+      const uint8_t *prev, unsigned bpp, unsigned pitch)
+{
+   unsigned i;
+   __m128i a   = _mm_setzero_si128();
+   __m128i one = _mm_set1_epi8(1);
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      __m128i b   = png_load_pixel(prev + i, bpp);
+      /* pavgb rounds up, the filter rounds down. */
+      __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+            _mm_and_si128(_mm_xor_si128(a, b), one));
+
+      a = _mm_add_epi8(avg, png_load_pixel(line + i, bpp));
+      png_store_pixel(line + i, a, bpp);
+   }
+}
+
+static inline __m128i png_abs_epi16(__m128i x)
+{
+   return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+static inline __m128i png_select(__m128i mask, __m128i a, __m128i b)
+{
+   return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static inline void png_unfilter_paeth_sse2(uint8_t *line,
+      const uint8_t *prev, unsigned bpp, unsigned pitch)
+{
+   unsigned i;
+   __m128i zero = _mm_setzero_si128();
+   __m128i a    = zero;
+   __m128i c    = zero;
+
+   /* Each channel in a 16-bit lane. p = a + b - c, so
+    * |p - a| = |b - c|, |p - b| = |a - c| and
+    * |p - c| = |(b - c) + (a - c)|. */
+   for (i = 0; i < pitch; i += bpp)
+   {
+      __m128i b  = _mm_unpacklo_epi8(png_load_pixel(prev + i, bpp), zero);
+      __m128i pa = _mm_sub_epi16(b, c);
+      __m128i pb = _mm_sub_epi16(a, c);
+      __m128i pc = _mm_add_epi16(pa, pb);
+      __m128i smallest, pred;
+
+      pa       = png_abs_epi16(pa);
+      pb       = png_abs_epi16(pb);
+      pc       = png_abs_epi16(pc);
+      smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+
+      /* Ties go to a, then b. */
+      pred = png_select(_mm_cmpeq_epi16(smallest, pa), a,
+            png_select(_mm_cmpeq_epi16(smallest, pb), b, c));
+
+      pred = _mm_add_epi8(_mm_packus_epi16(pred, pred),
+            png_load_pixel(line + i, bpp));
+      png_store_pixel(line + i, pred, bpp);
+
+      a = _mm_unpacklo_epi8(pred, zero);
+      c = b;
+   }
+}
+#endif
+
+/**
+ * png_unfilter_line:
+ * @line               : filtered scanline, unfiltered in place.
+ * @prev               : previous unfiltered scanline.
+ * @filter             : filter type of @line.
+ * @bpp                : bytes per pixel, at least 1.
+ * @pitch              : bytes per scanline.
+ *
+ * Both scanlines come from png_alloc_line().
+ *
+ * Returns: false if @filter is unknown.
+ **/
+static bool png_unfilter_line(uint8_t *line, const uint8_t *prev,
+      unsigned filter, unsigned bpp, unsigned pitch)
+{
+   unsigned i;
+   /* The pixels left of line and prev, zero for the first one. */
+   const uint8_t *left      = line - bpp;
+   const uint8_t *prev_left = prev - bpp;
+
+   switch (filter)
+   {
+      case 0: /* None */
+         break;
+
+      case 1: /* Sub */
+#if defined(RPNG_SIMD_SSE2)
+         if (bpp == 4 || bpp == 3)
+         {
+            /* Constant bpp, so the pixel copies turn into moves. */
+            if (bpp == 4)
+               png_unfilter_sub_sse2(line, 4, pitch);
+            else
+               png_unfilter_sub_sse2(line, 3, pitch);
+            break;
+         }
+#endif
+         for (i = 0; i < pitch; i++)
+            line[i] += left[i];
+         break;
+
+      case 2: /* Up */
+#if defined(RPNG_SIMD_SSE2)
+         png_unfilter_up_sse2(line, prev, pitch);
+#else
+         for (i = 0; i < pitch; i++)
+            line[i] += prev[i];
+#endif
+         break;
+
+      case 3: /* Average */
+#if defined(RPNG_SIMD_SSE2)
+         if (bpp == 4 || bpp == 3)
+         {
+            if (bpp == 4)
+               png_unfilter_avg_sse2(line, prev, 4, pitch);
+            else
+               png_unfilter_avg_sse2(line, prev, 3, pitch);
+            break;
+         }
+#endif
+         for (i = 0; i < pitch; i++)
+            line[i] += (left[i] + prev[i]) >> 1;
+         break;
+
+      case 4: /* Paeth */
+#if defined(RPNG_SIMD_SSE2)
+         if (bpp == 4 || bpp == 3)
+         {
+            if (bpp == 4)
+               png_unfilter_paeth_sse2(line, prev, 4, pitch);
+            else
+               png_unfilter_paeth_sse2(line, prev, 3, pitch);
+            break;
+         }
+#endif
+         for (i = 0; i < pitch; i++)
+            line[i] += paeth(left[i], prev[i], prev_left[i]);
+         break;
+
+      default:
+         return false;
+   }
+
+   return true;
+}
+
+static void png_copy_line(uint32_t *data, const uint8_t *decoded,
+      const struct png_ihdr *ihdr, unsigned width, const uint32_t *palette)
+{
+   switch (ihdr->color_type)
+   {
+      case 0:
+         copy_line_bw(data, decoded, width, ihdr->depth);
+         break;
+      case 2:
+         copy_line_rgb(data, decoded, width, ihdr->depth);
+         break;
+      case 3:
+         copy_line_plt(data, decoded, width, ihdr->depth, palette);
+         break;
+      case 4:
+         copy_line_gray_alpha(data, decoded, width, ihdr->depth);
+         break;
+      case 6:
+         copy_line_rgba(data, decoded, width, ihdr->depth);
+         break;
+   }
+}
+
 static bool png_reverse_filter(uint32_t *data, const struct png_ihdr *ihdr,
       const uint8_t *inflate_buf, size_t inflate_buf_size,
       const uint32_t *palette)
 {
-   unsigned i, h;
+   unsigned h;
    unsigned bpp;
    unsigned pitch;
    size_t pass_size;
@@ -435,8 +666,8 @@ static bool png_reverse_filter(uint32_t *data, const struct png_ihdr *ihdr,
    if (inflate_buf_size < pass_size)
       return false;
 
-   prev_scanline    = (uint8_t*)calloc(1, pitch);
-   decoded_scanline = (uint8_t*)calloc(1, pitch);
+   prev_scanline    = png_alloc_line(pitch);
+   decoded_scanline = png_alloc_line(pitch);
 
    if (!prev_scanline || !decoded_scanline)
       GOTO_END_ERROR();
@@ -444,70 +675,24 @@ static bool png_reverse_filter(uint32_t *data, const struct png_ihdr *ihdr,
    for (h = 0; h < ihdr->height;
          h++, inflate_buf += pitch, data += ihdr->width)
    {
+      uint8_t *tmp    = NULL;
       unsigned filter = *inflate_buf++;
 
-      switch (filter)
-      {
-         case 0: /* None */
-            memcpy(decoded_scanline, inflate_buf, pitch);
-            break;
-
-         case 1: /* Sub */
-            for (i = 0; i < bpp; i++)
-               decoded_scanline[i] = inflate_buf[i];
-            for (i = bpp; i < pitch; i++)
-               decoded_scanline[i] = decoded_scanline[i - bpp] + inflate_buf[i];
-            break;
-
-         case 2: /* Up */
-            for (i = 0; i < pitch; i++)
-               decoded_scanline[i] = prev_scanline[i] + inflate_buf[i];
-            break;
-
-         case 3: /* Average */
-            for (i = 0; i < bpp; i++)
-            {
-               uint8_t avg = prev_scanline[i] >> 1;
-               decoded_scanline[i] = avg + inflate_buf[i];
-            }
-            for (i = bpp; i < pitch; i++)
-            {
-               uint8_t avg = (decoded_scanline[i - bpp] + prev_scanline[i]) >> 1;
-               decoded_scanline[i] = avg + inflate_buf[i];
-            }
-            break;
+      memcpy(decoded_scanline, inflate_buf, pitch);
+      if (!png_unfilter_line(decoded_scanline, prev_scanline,
+               filter, bpp, pitch))
+         GOTO_END_ERROR();
 
-         case 4: /* Paeth */
-            for (i = 0; i < bpp; i++)
-               decoded_scanline[i] = paeth(0, prev_scanline[i], 0) + inflate_buf[i];
-            for (i = bpp; i < pitch; i++)
-               decoded_scanline[i] = paeth(decoded_scanline[i - bpp],
-                     prev_scanline[i], prev_scanline[i - bpp]) + inflate_buf[i];
-            break;
+      png_copy_line(data, decoded_scanline, ihdr, ihdr->width, palette);
 
-         default:
-            GOTO_END_ERROR();
-      }
-
-      if (ihdr->color_type == 0)
-         copy_line_bw(data, decoded_scanline, ihdr->width, ihdr->depth);
-      else if (ihdr->color_type == 2)
-         copy_line_rgb(data, decoded_scanline, ihdr->width, ihdr->depth);
-      else if (ihdr->color_type == 3)
-         copy_line_plt(data, decoded_scanline, ihdr->width,
-               ihdr->depth, palette);
-      else if (ihdr->color_type == 4)
-         copy_line_gray_alpha(data, decoded_scanline, ihdr->width,
-               ihdr->depth);
-      else if (ihdr->color_type == 6)
-         copy_line_rgba(data, decoded_scanline, ihdr->width, ihdr->depth);
-
-      memcpy(prev_scanline, decoded_scanline, pitch);
+      tmp              = prev_scanline;
+      prev_scanline    = decoded_scanline;
+      decoded_scanline = tmp;
    }
 
 end:
-   free(decoded_scanline);
-   free(prev_scanline);
+   png_free_line(decoded_scanline);
+   png_free_line(prev_scanline);
    return ret;
 }
 
@@ -606,58 +791,175 @@ static bool png_reverse_filter_adam7(uint32_t *data,
    return true;
 }
 
-static bool png_append_idat(FILE *file,
-      const struct png_chunk *chunk, struct idat_buffer *buf)
+static bool png_read_plte(const struct png_chunk *chunk,
+      uint32_t *buffer, unsigned entries)
 {
-   uint8_t *new_buffer = (uint8_t*)realloc(buf->data, buf->size + chunk->size);
+   unsigned i;
 
-   if (!new_buffer)
+   if (entries > 256)
       return false;
 
-   buf->data  = new_buffer;
-   if (fread(buf->data + buf->size, 1, chunk->size, file) != chunk->size)
-      return false;
-   if (fseek(file, sizeof(uint32_t), SEEK_CUR) < 0)
-      return false;
-   buf->size += chunk->size;
+   for (i = 0; i < entries; i++)
+   {
+      uint32_t r = chunk->data[3 * i + 0];
+      uint32_t g = chunk->data[3 * i + 1];
+      uint32_t b = chunk->data[3 * i + 2];
+      buffer[i] = (r << 16) | (g << 8) | (b << 0) | (0xffu << 24);
+   }
+
    return true;
 }
 
-static bool png_read_plte(FILE *file, uint32_t *buffer, unsigned entries)
+/* IDAT chunks are inflated as they come. Non-interlaced images are
+ * unfiltered and converted one scanline at a time, so the inflated
+ * image is never held in memory as a whole. Adam7 images are
+ * inflated completely first, then deinterlaced pass by pass. */
+struct png_decoder
 {
-   unsigned i;
-   uint8_t buf[256 * 3];
+   z_stream stream;
+   bool stream_init;
 
-   if (entries > 256)
+   const struct png_ihdr *ihdr;
+   const uint32_t *palette;
+   uint32_t *data;
+
+   unsigned bpp;
+   unsigned pitch;
+   unsigned line_index;
+   size_t line_pos;
+   uint8_t *line;
+   uint8_t *prev_line;
+
+   uint8_t *inflate_buf;
+   size_t inflate_buf_size;
+};
+
+static bool png_decoder_init(struct png_decoder *dec,
+      const struct png_ihdr *ihdr, const uint32_t *palette)
+{
+   size_t size = (size_t)ihdr->width * ihdr->height * sizeof(uint32_t);
+
+   dec->ihdr    = ihdr;
+   dec->palette = palette;
+
+#ifdef GEKKO
+   /* we often use these in textures, make sure they're 32-byte aligned */
+   dec->data = (uint32_t*)memalign(32, size);
+#else
+   dec->data = (uint32_t*)malloc(size);
+#endif
+   if (!dec->data)
       return false;
 
-   if (fread(buf, 3, entries, file) != entries)
+   if (inflateInit(&dec->stream) != Z_OK)
       return false;
+   dec->stream_init = true;
 
-   for (i = 0; i < entries; i++)
+   png_pass_geom(ihdr, ihdr->width, ihdr->height,
+         &dec->bpp, &dec->pitch, &dec->inflate_buf_size);
+
+   if (ihdr->interlace == 1)
    {
-      uint32_t r = buf[3 * i + 0];
-      uint32_t g = buf[3 * i + 1];
-      uint32_t b = buf[3 * i + 2];
-      buffer[i] = (r << 16) | (g << 8) | (b << 0) | (0xffu << 24);
+      dec->inflate_buf_size *= 2; /* To be sure. */
+      dec->inflate_buf = (uint8_t*)malloc(dec->inflate_buf_size);
+      if (!dec->inflate_buf)
+         return false;
+
+      dec->stream.next_out  = dec->inflate_buf;
+      dec->stream.avail_out = dec->inflate_buf_size;
+      return true;
    }
 
-   if (fseek(file, sizeof(uint32_t), SEEK_CUR) < 0)
+   dec->line      = png_alloc_line(dec->pitch);
+   dec->prev_line = png_alloc_line(dec->pitch);
+   return dec->line && dec->prev_line;
+}
+
+static void png_decoder_free(struct png_decoder *dec)
+{
+   if (dec->stream_init)
+      inflateEnd(&dec->stream);
+   png_free_line(dec->line);
+   png_free_line(dec->prev_line);
+   free(dec->inflate_buf);
+}
+
+static bool png_decoder_line_done(struct png_decoder *dec)
+{
+   uint8_t *tmp    = NULL;
+   unsigned filter = dec->line[-1];
+
+   /* Back to zero, it's left of the first pixel. */
+   dec->line[-1] = 0;
+
+   if (!png_unfilter_line(dec->line, dec->prev_line,
+            filter, dec->bpp, dec->pitch))
       return false;
 
+   png_copy_line(dec->data + (size_t)dec->line_index * dec->ihdr->width,
+         dec->line, dec->ihdr, dec->ihdr->width, dec->palette);
+
+   tmp            = dec->prev_line;
+   dec->prev_line = dec->line;
+   dec->line      = tmp;
+   dec->line_index++;
+   dec->line_pos  = 0;
    return true;
 }
 
-bool rpng_load_image_argb(const char *path, uint32_t **data,
-      unsigned *width, unsigned *height)
+static bool png_decoder_idat(struct png_decoder *dec,
+      const struct png_chunk *chunk)
 {
-   long pos, file_len;
-   FILE *file;
-   char header[8];
-   uint8_t *inflate_buf = NULL;
-   size_t inflate_buf_size = 0;
-   z_stream stream = {0};
-   struct idat_buffer idat_buf = {0};
+   z_stream *stream = &dec->stream;
+
+   stream->next_in  = (Bytef*)chunk->data;
+   stream->avail_in = chunk->size;
+
+   if (dec->inflate_buf)
+   {
+      int zret = inflate(stream, Z_NO_FLUSH);
+      return zret == Z_OK || zret == Z_STREAM_END ||
+         (zret == Z_BUF_ERROR && !stream->avail_in);
+   }
+
+   while (stream->avail_in && dec->line_index < dec->ihdr->height)
+   {
+      int zret;
+
+      /* The filter type byte lands in front of the scanline. */
+      stream->next_out  = dec->line - 1 + dec->line_pos;
+      stream->avail_out = dec->pitch + 1 - dec->line_pos;
+
+      zret = inflate(stream, Z_NO_FLUSH);
+      if (zret != Z_OK && zret != Z_STREAM_END)
+         return false;
+
+      dec->line_pos = dec->pitch + 1 - stream->avail_out;
+
+      if (dec->line_pos == dec->pitch + 1 && !png_decoder_line_done(dec))
+         return false;
+
+      if (zret == Z_STREAM_END)
+         break;
+   }
+
+   return true;
+}
+
+static bool png_decoder_finish(struct png_decoder *dec)
+{
+   if (!dec->inflate_buf)
+      return dec->line_index == dec->ihdr->height;
+
+   return png_reverse_filter_adam7(dec->data, dec->ihdr,
+         dec->inflate_buf, dec->stream.total_out, dec->palette);
+}
+
+bool rpng_load_image_argb_from_memory(const uint8_t *buf, size_t size,
+      uint32_t **data, unsigned *width, unsigned *height)
+{
+   const uint8_t *end = buf + size;
+   struct png_decoder dec = {{0}};
    struct png_ihdr ihdr = {0};
    uint32_t palette[256] = {0};
    bool has_ihdr = false;
@@ -670,35 +972,24 @@ bool rpng_load_image_argb(const char *path, uint32_t **data,
    *width  = 0;
    *height = 0;
 
-   file = fopen(path, "rb");
-   if (!file)
-      return false;
-
-   fseek(file, 0, SEEK_END);
-   file_len = ftell(file);
-   rewind(file);
-
-   if (fread(header, 1, sizeof(header), file) != sizeof(header))
+   if (size < sizeof(png_magic) ||
+         memcmp(buf, png_magic, sizeof(png_magic)) != 0)
       GOTO_END_ERROR();
 
-   if (memcmp(header, png_magic, sizeof(png_magic)) != 0)
-      GOTO_END_ERROR();
-
-   /* feof() apparently isn't triggered after a seek (IEND). */
-   for (pos = ftell(file); 
-         pos < file_len && pos >= 0; pos = ftell(file))
+   for (buf += sizeof(png_magic); buf < end && !has_iend; )
    {
       struct png_chunk chunk = {0};
 
-      if (!read_chunk_header(file, &chunk))
+      if (!read_chunk_header(buf, end - buf, &chunk))
          GOTO_END_ERROR();
 
+      buf += chunk.size + 2 * sizeof(uint32_t);
+      buf += (end - buf) < 4 ? (end - buf) : 4; /* CRC */
+
       switch (png_chunk_type(&chunk))
       {
          case PNG_CHUNK_NOOP:
          default:
-            if (fseek(file, chunk.size + sizeof(uint32_t), SEEK_CUR) < 0)
-               GOTO_END_ERROR();
             break;
 
          case PNG_CHUNK_ERROR:
@@ -708,7 +999,7 @@ bool rpng_load_image_argb(const char *path, uint32_t **data,
             if (has_ihdr || has_idat || has_iend)
                GOTO_END_ERROR();
 
-            if (!png_parse_ihdr(file, &chunk, &ihdr))
+            if (!png_parse_ihdr(&chunk, &ihdr))
                GOTO_END_ERROR();
 
             has_ihdr = true;
@@ -721,7 +1012,7 @@ bool rpng_load_image_argb(const char *path, uint32_t **data,
             if (chunk.size % 3)
                GOTO_END_ERROR();
 
-            if (!png_read_plte(file, palette, chunk.size / 3))
+            if (!png_read_plte(&chunk, palette, chunk.size / 3))
                GOTO_END_ERROR();
 
             has_plte = true;
@@ -731,7 +1022,10 @@ bool rpng_load_image_argb(const char *path, uint32_t **data,
             if (!has_ihdr || has_iend || (ihdr.color_type == 3 && !has_plte))
                GOTO_END_ERROR();
 
-            if (!png_append_idat(file, &chunk, &idat_buf))
+            if (!has_idat && !png_decoder_init(&dec, &ihdr, palette))
+               GOTO_END_ERROR();
+
+            if (!png_decoder_idat(&dec, &chunk))
                GOTO_END_ERROR();
 
             has_idat = true;
@@ -741,9 +1035,6 @@ bool rpng_load_image_argb(const char *path, uint32_t **data,
             if (!has_ihdr || !has_idat)
                GOTO_END_ERROR();
 
-            if (fseek(file, sizeof(uint32_t), SEEK_CUR) < 0)
-               GOTO_END_ERROR();
-
             has_iend = true;
             break;
       }
@@ -752,57 +1043,58 @@ bool rpng_load_image_argb(const char *path, uint32_t **data,
    if (!has_ihdr || !has_idat || !has_iend)
       GOTO_END_ERROR();
 
-   if (inflateInit(&stream) != Z_OK)
+   if (!png_decoder_finish(&dec))
       GOTO_END_ERROR();
 
-   png_pass_geom(&ihdr, ihdr.width, ihdr.height, NULL, NULL, &inflate_buf_size);
-   if (ihdr.interlace == 1) /* To be sure. */
-      inflate_buf_size *= 2;
+   *data   = dec.data;
+   *width  = ihdr.width;
+   *height = ihdr.height;
 
-   inflate_buf = (uint8_t*)malloc(inflate_buf_size);
-   if (!inflate_buf)
-      GOTO_END_ERROR();
+end:
+   if (!ret)
+      free(dec.data);
+   png_decoder_free(&dec);
+   return ret;
+}
 
-   stream.next_in   = idat_buf.data;
-   stream.avail_in  = idat_buf.size;
-   stream.avail_out = inflate_buf_size;
-   stream.next_out  = inflate_buf;
+bool rpng_load_image_argb(const char *path, uint32_t **data,
+      unsigned *width, unsigned *height)
+{
+   long file_len;
+   FILE *file;
+   uint8_t *buf = NULL;
+   bool ret     = true;
 
-   if (inflate(&stream, Z_FINISH) != Z_STREAM_END)
-   {
-      inflateEnd(&stream);
+   *data   = NULL;
+   *width  = 0;
+   *height = 0;
+
+   file = fopen(path, "rb");
+   if (!file)
+      return false;
+
+   /* The whole file is read in one go, chunks are parsed
+    * from memory. */
+   fseek(file, 0, SEEK_END);
+   file_len = ftell(file);
+   rewind(file);
+
+   if (file_len <= 0)
       GOTO_END_ERROR();
-   }
-   inflateEnd(&stream);
 
-   *width  = ihdr.width;
-   *height = ihdr.height;
-#ifdef GEKKO
-   /* we often use these in textures, make sure they're 32-byte aligned */
-   *data = (uint32_t*)memalign(32, ihdr.width * ihdr.height * sizeof(uint32_t));
-#else
-   *data = (uint32_t*)malloc(ihdr.width * ihdr.height * sizeof(uint32_t));
-#endif
-   if (!*data)
+   buf = (uint8_t*)malloc(file_len);
+   if (!buf)
       GOTO_END_ERROR();
 
-   if (ihdr.interlace == 1)
-   {
-      if (!png_reverse_filter_adam7(*data,
-               &ihdr, inflate_buf, stream.total_out, palette))
-         GOTO_END_ERROR();
-   }
-   else if (!png_reverse_filter(*data,
-            &ihdr, inflate_buf, stream.total_out, palette))
+   if (fread(buf, 1, file_len, file) != (size_t)file_len)
       GOTO_END_ERROR();
 
+   ret = rpng_load_image_argb_from_memory(buf, file_len,
+         data, width, height);
+
 end:
-   if (file)
-      fclose(file);
-   if (!ret)
-      free(*data);
-   free(idat_buf.data);
-   free(inflate_buf);
+   fclose(file);
+   free(buf);
    return ret;
 }
 
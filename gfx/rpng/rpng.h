@@ -17,6 +17,7 @@
 #define RPNG_H__
 
 #include <stdint.h>
+#include <stddef.h>
 
 #include <boolean.h>
 
@@ -31,6 +32,10 @@ extern "C" {
 bool rpng_load_image_argb(const char *path, uint32_t **data,
       unsigned *width, unsigned *height);
 
+/* Same as rpng_load_image_argb(), for a PNG file already in memory. */
+bool rpng_load_image_argb_from_memory(const uint8_t *buf, size_t size,
+      uint32_t **data, unsigned *width, unsigned *height);
+
 #ifdef HAVE_ZLIB_DEFLATE
 bool rpng_save_image_argb(const char *path, const uint32_t *data,
       unsigned width, unsigned height, unsigned pitch);
@@ -0,0 +1,467 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Runs .filt softfilter configs over a sequence of frames, and reports
+// the time per frame of the plain C and the vectorized implementation.
+// The vectorized output, rendered in several bands, must be the same
+// as the C output to the bit, including the padding of the rows.
+//
+// Usage: bench-filters [-f frames.raw WIDTHxHEIGHT] filter.filt...
+//
+// frames.raw holds XRGB8888 frames back to back, for example a recording
+// converted with ffmpeg -i movie.mkv -f rawvideo -pix_fmt bgr0 frames.raw.
+// Without it, a scrolling tile scene is generated instead.
+
+#include "../video_filters/softfilter.h"
+#include <file/config_file.h>
+#include <file/config_file_userdata.h>
+#include <boolean.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define GEN_WIDTH 256
+#define GEN_HEIGHT 224
+#define GEN_FRAMES 120
+
+// Bands the vectorized implementation is split into. They run in
+// reverse order, so bands depending on each other show up.
+#define TEST_BANDS 7
+
+// Pixels of padding after every output row, which no filter may touch.
+#define ROW_PADDING 16
+
+// Time spent on each speed measurement, in seconds.
+#define BENCH_TIME 0.5
+
+extern const struct softfilter_implementation *blargg_ntsc_snes_get_implementation(softfilter_simd_mask_t simd);
+extern const struct softfilter_implementation *lq2x_get_implementation(softfilter_simd_mask_t simd);
+extern const struct softfilter_implementation *phosphor2x_get_implementation(softfilter_simd_mask_t simd);
+extern const struct softfilter_implementation *twoxbr_get_implementation(softfilter_simd_mask_t simd);
+extern const struct softfilter_implementation *epx_get_implementation(softfilter_simd_mask_t simd);
+extern const struct softfilter_implementation *twoxsai_get_implementation(softfilter_simd_mask_t simd);
+extern const struct softfilter_implementation *supereagle_get_implementation(softfilter_simd_mask_t simd);
+extern const struct softfilter_implementation *supertwoxsai_get_implementation(softfilter_simd_mask_t simd);
+extern const struct softfilter_implementation *darken_get_implementation(softfilter_simd_mask_t simd);
+extern const struct softfilter_implementation *scale2x_get_implementation(softfilter_simd_mask_t simd);
+
+static const softfilter_get_implementation_t plugs[] = {
+   blargg_ntsc_snes_get_implementation,
+   lq2x_get_implementation,
+   phosphor2x_get_implementation,
+   twoxbr_get_implementation,
+   darken_get_implementation,
+   twoxsai_get_implementation,
+   supertwoxsai_get_implementation,
+   supereagle_get_implementation,
+   epx_get_implementation,
+   scale2x_get_implementation,
+};
+
+static const struct softfilter_config filter_config = {
+   config_userdata_get_float,
+   config_userdata_get_int,
+   config_userdata_get_float_array,
+   config_userdata_get_int_array,
+   config_userdata_get_string,
+   config_userdata_free,
+};
+
+struct frames
+{
+   unsigned width;
+   unsigned height;
+   unsigned count;
+   uint32_t *xrgb8888;
+   uint16_t *rgb565;
+};
+
+struct format
+{
+   const char *name;
+   unsigned fmt;
+   unsigned bpp;
+};
+
+static const struct format formats[] = {
+   { "RGB565", SOFTFILTER_FMT_RGB565, SOFTFILTER_BPP_RGB565 },
+   { "XRGB8888", SOFTFILTER_FMT_XRGB8888, SOFTFILTER_BPP_XRGB8888 },
+};
+
+static double get_time(void)
+{
+   struct timespec tv;
+   clock_gettime(CLOCK_MONOTONIC, &tv);
+   return tv.tv_sec + tv.tv_nsec / 1000000000.0;
+}
+
+// Every instruction set level which may pick its own implementation,
+// so the SSE2 paths get checked on AVX2 machines too.
+static unsigned get_simd_levels(softfilter_simd_mask_t *levels)
+{
+   unsigned count = 0;
+
+#if defined(__SSE2__)
+   levels[count++] = SOFTFILTER_SIMD_SSE2;
+#if defined(__GNUC__)
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx2"))
+      levels[count++] = SOFTFILTER_SIMD_SSE2 | SOFTFILTER_SIMD_AVX2;
+#endif
+#elif defined(__ARM_NEON__)
+   levels[count++] = SOFTFILTER_SIMD_NEON;
+#endif
+
+   return count;
+}
+
+// Rows of 8x8 tiles from a small palette over a flat sky, scrolling
+// sideways by a pixel a frame, and a few round sprites moving over it.
+// Close enough to console output to have both flat areas and edges.
+static void gen_frames(struct frames *frames)
+{
+   static const uint32_t palette[] = {
+      0x204080, 0xf8d8a0, 0x806040, 0x40a040,
+      0x206020, 0xe0e0e0, 0x000000, 0xc03030,
+   };
+
+   frames->width    = GEN_WIDTH;
+   frames->height   = GEN_HEIGHT;
+   frames->count    = GEN_FRAMES;
+   frames->xrgb8888 = malloc(GEN_WIDTH * GEN_HEIGHT * GEN_FRAMES * sizeof(uint32_t));
+
+   for (unsigned f = 0; f < GEN_FRAMES; f++)
+   {
+      uint32_t *frame = frames->xrgb8888 + f * GEN_WIDTH * GEN_HEIGHT;
+
+      for (unsigned y = 0; y < GEN_HEIGHT; y++)
+      {
+         for (unsigned x = 0; x < GEN_WIDTH; x++)
+         {
+            unsigned tx = (x + f) / 8, ty = y / 8;
+            unsigned u = (x + f) % 8, v = y % 8;
+            uint32_t color = palette[0];
+
+            if (y >= GEN_HEIGHT / 2)
+            {
+               unsigned seed = (tx * 73 + ty * 151) ^ (tx >> 2);
+               unsigned tile = seed % 5;
+               if (tile == 0)
+                  color = palette[2 + ((u ^ v) & 1)];
+               else if (tile == 1)
+                  color = (u == 0 || v == 0) ? palette[6] : palette[1];
+               else if (tile == 2)
+                  color = (u + v < 8) ? palette[3] : palette[4];
+               else
+                  color = palette[1];
+            }
+            else if (((x + 3 * f) / 16 + y / 24) % 11 == 0 && v < 6)
+               color = palette[5];
+
+            frame[y * GEN_WIDTH + x] = color;
+         }
+      }
+
+      for (unsigned s = 0; s < 6; s++)
+      {
+         unsigned sx = (s * 40 + f * (s + 1)) % (GEN_WIDTH - 16);
+         unsigned sy = (s * 33 + f * 2) % (GEN_HEIGHT - 16);
+
+         for (unsigned y = 0; y < 16; y++)
+            for (unsigned x = 0; x < 16; x++)
+               if ((x - 8) * (x - 8) + (y - 8) * (y - 8) < 50)
+                  frame[(sy + y) * GEN_WIDTH + sx + x] =
+                     palette[7 - (x + y) / 12 * 2];
+      }
+   }
+}
+
+static bool load_frames(struct frames *frames, const char *path,
+      unsigned width, unsigned height)
+{
+   size_t frame_size = width * height * sizeof(uint32_t);
+   FILE *file = fopen(path, "rb");
+   long size;
+
+   if (!file)
+      return false;
+
+   fseek(file, 0, SEEK_END);
+   size = ftell(file);
+   rewind(file);
+
+   frames->width    = width;
+   frames->height   = height;
+   frames->count    = size / frame_size;
+   frames->xrgb8888 = malloc(frames->count * frame_size);
+
+   if (!frames->count || fread(frames->xrgb8888, frame_size,
+            frames->count, file) != frames->count)
+   {
+      fclose(file);
+      return false;
+   }
+
+   fclose(file);
+   return true;
+}
+
+static void convert_frames(struct frames *frames)
+{
+   size_t pixels = frames->width * frames->height * frames->count;
+
+   frames->rgb565 = malloc(pixels * sizeof(uint16_t));
+   for (size_t i = 0; i < pixels; i++)
+   {
+      uint32_t c = frames->xrgb8888[i];
+      frames->rgb565[i] = ((c >> 8) & 0xf800) | ((c >> 5) & 0x07e0) | ((c >> 3) & 0x001f);
+   }
+}
+
+static const void *get_frame(const struct frames *frames,
+      const struct format *format, unsigned index)
+{
+   size_t offset = (size_t)index * frames->width * frames->height;
+
+   if (format->fmt == SOFTFILTER_FMT_RGB565)
+      return frames->rgb565 + offset;
+   return frames->xrgb8888 + offset;
+}
+
+static void *create_filter(const struct softfilter_implementation *impl,
+      config_file_t *conf, const struct format *format,
+      const struct frames *frames, unsigned bands,
+      softfilter_simd_mask_t mask)
+{
+   struct config_file_userdata userdata;
+
+   // Same lookup as in RetroArch, index-specific configs first.
+   userdata.conf      = conf;
+   userdata.prefix[0] = "filter";
+   userdata.prefix[1] = impl->short_ident;
+
+   return impl->create(&filter_config, format->fmt, format->fmt,
+         frames->width, frames->height, bands, mask, &userdata);
+}
+
+static void run_filter(const struct softfilter_implementation *impl,
+      void *data, const struct format *format, const struct frames *frames,
+      unsigned index, void *output, size_t output_stride)
+{
+   struct softfilter_work_packet packets[TEST_BANDS];
+   unsigned bands = impl->query_num_threads(data);
+
+   impl->get_work_packets(data, packets, output, output_stride,
+         get_frame(frames, format, index), frames->width, frames->height,
+         frames->width * format->bpp);
+
+   for (unsigned i = bands; i; i--)
+      packets[i - 1].work(data, packets[i - 1].thread_data);
+}
+
+static double run_speed(const struct softfilter_implementation *impl,
+      config_file_t *conf, const struct format *format,
+      const struct frames *frames, softfilter_simd_mask_t mask)
+{
+   void *data = create_filter(impl, conf, format, frames, 1, mask);
+   unsigned count = 0, out_width, out_height;
+   size_t stride;
+   void *output;
+   double start, elapsed;
+
+   impl->query_output_size(data, &out_width, &out_height,
+         frames->width, frames->height);
+   stride = out_width * format->bpp;
+   output = malloc(stride * out_height);
+
+   start = get_time();
+   do
+   {
+      // Check the clock rarely, so it doesn't show up in the result.
+      for (unsigned i = 0; i < 8; i++, count++)
+         run_filter(impl, data, format, frames, count % frames->count,
+               output, stride);
+      elapsed = get_time() - start;
+   } while (elapsed < BENCH_TIME);
+
+   impl->destroy(data);
+   free(output);
+   return elapsed * 1000000.0 / count;
+}
+
+static softfilter_get_implementation_t find_plug(const char *ident)
+{
+   for (unsigned i = 0; i < sizeof(plugs) / sizeof(plugs[0]); i++)
+   {
+      const struct softfilter_implementation *impl = plugs[i](0);
+      if (!strcmp(impl->short_ident, ident))
+         return plugs[i];
+   }
+   return NULL;
+}
+
+// Returns false if the vectorized output differs from the C output.
+static bool test_simd(const char *name, config_file_t *conf,
+      const struct softfilter_implementation *scalar,
+      const struct softfilter_implementation *simd,
+      softfilter_simd_mask_t mask, const struct format *format,
+      const struct frames *frames, double scalar_time)
+{
+   unsigned out_width, out_height;
+   size_t stride, size;
+   bool match = true;
+   void *scalar_data, *simd_data;
+   uint8_t *ref, *out;
+   double simd_time;
+
+   scalar->query_output_size(NULL, &out_width, &out_height,
+         frames->width, frames->height);
+   stride = (out_width + ROW_PADDING) * format->bpp;
+   size   = stride * out_height;
+   ref    = malloc(size);
+   out    = malloc(size);
+
+   scalar_data = create_filter(scalar, conf, format, frames, 1, 0);
+   simd_data   = create_filter(simd, conf, format, frames, TEST_BANDS, mask);
+   if (!scalar_data || !simd_data)
+   {
+      fprintf(stderr, "%s: create failed.\n", name);
+      exit(1);
+   }
+
+   for (unsigned f = 0; f < frames->count && match; f++)
+   {
+      memset(ref, 0xa5, size);
+      memset(out, 0xa5, size);
+      run_filter(scalar, scalar_data, format, frames, f, ref, stride);
+      run_filter(simd, simd_data, format, frames, f, out, stride);
+      match = !memcmp(ref, out, size);
+   }
+
+   scalar->destroy(scalar_data);
+   simd->destroy(simd_data);
+
+   simd_time = run_speed(simd, conf, format, frames, mask);
+   printf("%-28s %-9s %-28s %9.1f %9.1f %7.2fx %s\n", name, format->name,
+         simd->ident, scalar_time, simd_time, scalar_time / simd_time,
+         match ? "" : "FAIL");
+
+   free(ref);
+   free(out);
+   return match;
+}
+
+static bool test_format(const char *name, config_file_t *conf,
+      softfilter_get_implementation_t get_implementation,
+      const struct format *format, const struct frames *frames,
+      const softfilter_simd_mask_t *levels, unsigned num_levels)
+{
+   const struct softfilter_implementation *scalar = get_implementation(0);
+   const struct softfilter_implementation *prev = scalar;
+   double scalar_time = run_speed(scalar, conf, format, frames, 0);
+   bool ret = true;
+
+   for (unsigned l = 0; l < num_levels; l++)
+   {
+      const struct softfilter_implementation *simd = get_implementation(levels[l]);
+      if (simd == prev)
+         continue;
+
+      if (!test_simd(name, conf, scalar, simd, levels[l],
+               format, frames, scalar_time))
+         ret = false;
+      prev = simd;
+   }
+
+   if (prev == scalar)
+      printf("%-28s %-9s %-28s %9.1f\n", name, format->name,
+            scalar->ident, scalar_time);
+
+   return ret;
+}
+
+int main(int argc, char *argv[])
+{
+   int ret = 0;
+   struct frames frames = {0};
+   softfilter_simd_mask_t levels[4];
+   unsigned num_levels = get_simd_levels(levels);
+
+   if (argc > 3 && !strcmp(argv[1], "-f"))
+   {
+      unsigned width, height;
+      if (sscanf(argv[3], "%ux%u", &width, &height) != 2 ||
+            !load_frames(&frames, argv[2], width, height))
+      {
+         fprintf(stderr, "Could not load frames from %s.\n", argv[2]);
+         return 1;
+      }
+      argc -= 3;
+      argv += 3;
+   }
+   else
+      gen_frames(&frames);
+
+   if (argc < 2)
+   {
+      fprintf(stderr, "Usage: %s [-f frames.raw WIDTHxHEIGHT] filter.filt...\n", argv[0]);
+      return 1;
+   }
+
+   convert_frames(&frames);
+
+   printf("%u frames of %ux%u\n", frames.count, frames.width, frames.height);
+   printf("%-28s %-9s %-28s %9s %9s\n", "config", "format",
+         "implementation", "C us/f", "SIMD us/f");
+
+   for (int i = 1; i < argc; i++)
+   {
+      char name[64];
+      softfilter_get_implementation_t get_implementation;
+      config_file_t *conf = config_file_new(argv[i]);
+      const char *base = strrchr(argv[i], '/');
+
+      base = base ? base + 1 : argv[i];
+
+      if (!conf || !config_get_array(conf, "filter", name, sizeof(name)))
+      {
+         fprintf(stderr, "%s: no filter in config.\n", argv[i]);
+         return 1;
+      }
+
+      get_implementation = find_plug(name);
+      if (!get_implementation)
+      {
+         fprintf(stderr, "%s: unknown filter %s.\n", argv[i], name);
+         return 1;
+      }
+
+      for (unsigned f = 0; f < sizeof(formats) / sizeof(formats[0]); f++)
+      {
+         if (!(get_implementation(0)->query_input_formats() & formats[f].fmt))
+            continue;
+         if (!test_format(base, conf, get_implementation,
+                  &formats[f], &frames, levels, num_levels))
+            ret = 1;
+      }
+
+      config_file_free(conf);
+   }
+
+   free(frames.xrgb8888);
+   free(frames.rgb565);
+   return ret;
+}
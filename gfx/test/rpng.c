@@ -0,0 +1,247 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Round trips generated images through the PNG encoder and decoder,
+// which picks a filter per row, so every filter gets unfiltered, both
+// for 4 (ARGB) and 3 (BGR24) bytes per pixel. Then decodes a corpus of
+// PNG files and reports the time per image.
+//
+// Usage: bench-rpng [file.png|directory]...
+//
+// Directories are scanned for .png files, not recursively. Without
+// arguments, the images in media/ are used.
+
+#include "../rpng/rpng.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define TEST_PATH "/tmp/bench-rpng.png"
+#define DEFAULT_CORPUS "../../media"
+
+// Time spent decoding each image, in seconds.
+#define BENCH_TIME 0.25
+
+static const unsigned test_sizes[][2] = {
+   { 7, 3 }, { 64, 64 }, { 333, 97 }, { 1024, 768 },
+};
+
+static double get_time(void)
+{
+   struct timespec tv;
+   clock_gettime(CLOCK_MONOTONIC, &tv);
+   return tv.tv_sec + tv.tv_nsec / 1000000000.0;
+}
+
+// Smooth parts favour Sub, Up, Average and Paeth, the noisy ones None.
+static void gen_image(uint32_t *data, unsigned width, unsigned height)
+{
+   unsigned seed = 1;
+
+   for (unsigned y = 0; y < height; y++)
+   {
+      for (unsigned x = 0; x < width; x++)
+      {
+         uint32_t col;
+
+         seed = seed * 1664525u + 1013904223u;
+         col  = ((x * 255 / width) << 16) | ((y * 255 / height) << 8) |
+            (((x + y) * 3) & 0xff);
+         if ((y / 16) % 3 == 2)
+            col ^= seed >> 8;
+         data[y * width + x] = col | ((255 - (y & 0x3f)) << 24);
+      }
+   }
+}
+
+static bool round_trip(unsigned width, unsigned height, bool bgr24)
+{
+   bool match      = false;
+   uint32_t *out   = NULL;
+   unsigned out_w  = 0, out_h = 0;
+   uint32_t *image = malloc(width * height * sizeof(uint32_t));
+   uint8_t *bgr    = malloc(width * height * 3);
+
+   gen_image(image, width, height);
+
+   if (bgr24)
+   {
+      for (unsigned i = 0; i < width * height; i++)
+      {
+         bgr[3 * i + 0] = image[i] >> 0;
+         bgr[3 * i + 1] = image[i] >> 8;
+         bgr[3 * i + 2] = image[i] >> 16;
+         image[i] |= 0xff000000u;
+      }
+
+      if (!rpng_save_image_bgr24(TEST_PATH, bgr, width, height, width * 3))
+         goto end;
+   }
+   else if (!rpng_save_image_argb(TEST_PATH, image, width, height,
+            width * sizeof(uint32_t)))
+      goto end;
+
+   if (!rpng_load_image_argb(TEST_PATH, &out, &out_w, &out_h))
+      goto end;
+
+   match = out_w == width && out_h == height &&
+      !memcmp(out, image, width * height * sizeof(uint32_t));
+
+end:
+   free(image);
+   free(bgr);
+   free(out);
+   return match;
+}
+
+static uint8_t *read_file(const char *path, size_t *size)
+{
+   uint8_t *buf = NULL;
+   FILE *file   = fopen(path, "rb");
+   long len;
+
+   if (!file)
+      return NULL;
+
+   fseek(file, 0, SEEK_END);
+   len = ftell(file);
+   rewind(file);
+
+   if (len > 0 && (buf = malloc(len)) && fread(buf, 1, len, file) != (size_t)len)
+   {
+      free(buf);
+      buf = NULL;
+   }
+
+   fclose(file);
+   *size = len;
+   return buf;
+}
+
+struct totals
+{
+   unsigned images;
+   unsigned failed;
+   double time;
+   double pixels;
+};
+
+static void bench_file(const char *path, struct totals *totals)
+{
+   size_t size;
+   uint32_t *data  = NULL;
+   unsigned width  = 0, height = 0, runs = 0;
+   uint8_t *buf    = read_file(path, &size);
+   double start, elapsed;
+   const char *base = strrchr(path, '/');
+
+   base = base ? base + 1 : path;
+
+   if (!buf || !rpng_load_image_argb_from_memory(buf, size,
+            &data, &width, &height))
+   {
+      printf("%-32s %s\n", base, "FAIL");
+      totals->failed++;
+      free(buf);
+      return;
+   }
+   free(data);
+
+   start = get_time();
+   do
+   {
+      rpng_load_image_argb_from_memory(buf, size, &data, &width, &height);
+      free(data);
+      runs++;
+      elapsed = get_time() - start;
+   } while (elapsed < BENCH_TIME);
+
+   printf("%-32s %5ux%-5u %10.1f %10.1f\n", base, width, height,
+         elapsed * 1000000.0 / runs,
+         (double)width * height * runs / elapsed / 1000000.0);
+
+   totals->images++;
+   totals->time   += elapsed / runs;
+   totals->pixels += (double)width * height;
+   free(buf);
+}
+
+static void bench_path(const char *path, struct totals *totals)
+{
+   struct stat st;
+   DIR *dir;
+   struct dirent *entry;
+
+   if (stat(path, &st) || !S_ISDIR(st.st_mode))
+   {
+      bench_file(path, totals);
+      return;
+   }
+
+   if (!(dir = opendir(path)))
+      return;
+
+   while ((entry = readdir(dir)))
+   {
+      char file[4096];
+      const char *ext = strrchr(entry->d_name, '.');
+
+      if (!ext || strcmp(ext, ".png"))
+         continue;
+
+      snprintf(file, sizeof(file), "%s/%s", path, entry->d_name);
+      bench_file(file, totals);
+   }
+
+   closedir(dir);
+}
+
+int main(int argc, char *argv[])
+{
+   int ret = 0;
+   struct totals totals = {0};
+
+   for (unsigned i = 0; i < sizeof(test_sizes) / sizeof(test_sizes[0]); i++)
+   {
+      for (unsigned bgr24 = 0; bgr24 < 2; bgr24++)
+      {
+         if (!round_trip(test_sizes[i][0], test_sizes[i][1], bgr24))
+         {
+            fprintf(stderr, "Round trip of %ux%u %s failed.\n",
+                  test_sizes[i][0], test_sizes[i][1], bgr24 ? "BGR24" : "ARGB");
+            ret = 1;
+         }
+      }
+   }
+   remove(TEST_PATH);
+
+   printf("%-32s %11s %10s %10s\n", "image", "size", "us/image", "Mpix/s");
+
+   if (argc < 2)
+      bench_path(DEFAULT_CORPUS, &totals);
+   for (int i = 1; i < argc; i++)
+      bench_path(argv[i], &totals);
+
+   if (totals.images)
+      printf("%u images, %.1f ms in total, %.1f Mpix/s.\n", totals.images,
+            totals.time * 1000.0, totals.pixels / totals.time / 1000000.0);
+   if (totals.failed)
+      printf("%u images failed to decode.\n", totals.failed);
+
+   return ret;
+}
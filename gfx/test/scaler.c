@@ -0,0 +1,210 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks the AVX2 kernels of the scaler against the SSE2 ones,
+// which must give exactly the same result, and reports the time
+// per frame of each, and the time needed to set up a geometry
+// the first time and when its filters are already cached.
+
+#include <gfx/scaler/scaler.h>
+#include <gfx/scaler/scaler_int.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Time spent on each speed measurement, in seconds.
+#define BENCH_TIME 0.5
+
+struct test_case
+{
+   const char *name;
+   enum scaler_type type;
+   enum scaler_pix_fmt in_fmt;
+   int in_width, in_height;
+   int out_width, out_height;
+};
+
+// Odd sizes to get through the leftover pixels.
+static const struct test_case tests[] = {
+   { "bilinear-up", SCALER_TYPE_BILINEAR, SCALER_FMT_ARGB8888, 256, 224, 1280, 960 },
+   { "bilinear-down", SCALER_TYPE_BILINEAR, SCALER_FMT_RGB565, 640, 480, 321, 239 },
+   { "sinc-up", SCALER_TYPE_SINC, SCALER_FMT_ARGB8888, 320, 240, 641, 481 },
+   { "sinc-down", SCALER_TYPE_SINC, SCALER_FMT_0RGB1555, 1280, 720, 427, 239 },
+};
+
+static double get_time(void)
+{
+   struct timespec tv;
+   clock_gettime(CLOCK_MONOTONIC, &tv);
+   return tv.tv_sec + tv.tv_nsec / 1000000000.0;
+}
+
+static int bytes_per_pixel(enum scaler_pix_fmt fmt)
+{
+   return fmt == SCALER_FMT_ARGB8888 ? 4 : 2;
+}
+
+// Gradients with some noise, so saturation gets exercised by sinc.
+static void gen_frame(uint8_t *frame, const struct test_case *test)
+{
+   unsigned seed = 1;
+   int bpp = bytes_per_pixel(test->in_fmt);
+
+   for (int y = 0; y < test->in_height; y++)
+   {
+      for (int x = 0; x < test->in_width; x++)
+      {
+         uint32_t col;
+
+         seed = seed * 1664525u + 1013904223u;
+         col  = (((x * 255 / test->in_width) << 16) |
+               ((y * 255 / test->in_height) << 8) |
+               ((x ^ y) & 0xff)) ^ ((seed >> 8) & ((x & 8) ? 0xffffff : 0x0f0f0f));
+
+         if (bpp == 4)
+            ((uint32_t*)frame)[y * test->in_width + x] = col | 0xff000000u;
+         else
+            ((uint16_t*)frame)[y * test->in_width + x] = (uint16_t)(col ^ (col >> 16));
+      }
+   }
+}
+
+static double run_speed(struct scaler_ctx *ctx, void *output, const void *input)
+{
+   unsigned frames = 0;
+   double start = get_time(), elapsed;
+
+   do
+   {
+      scaler_ctx_scale(ctx, output, input);
+      frames++;
+      elapsed = get_time() - start;
+   } while (elapsed < BENCH_TIME);
+
+   return elapsed * 1000000.0 / frames;
+}
+
+// Alternates between the test geometry and another one,
+// which only regenerates filters if the cache misses.
+static double run_gen_filter(struct scaler_ctx *ctx, const struct test_case *test)
+{
+   unsigned runs = 0;
+   double start = get_time(), elapsed;
+
+   do
+   {
+      ctx->out_width  = test->out_width / 2;
+      ctx->out_height = test->out_height / 2;
+      scaler_ctx_gen_filter(ctx);
+      ctx->out_width  = test->out_width;
+      ctx->out_height = test->out_height;
+      scaler_ctx_gen_filter(ctx);
+      runs += 2;
+      elapsed = get_time() - start;
+   } while (elapsed < BENCH_TIME);
+
+   return elapsed * 1000000.0 / runs;
+}
+
+static void init_ctx(struct scaler_ctx *ctx, const struct test_case *test)
+{
+   memset(ctx, 0, sizeof(*ctx));
+   ctx->scaler_type = test->type;
+   ctx->in_fmt      = test->in_fmt;
+   ctx->out_fmt     = SCALER_FMT_ARGB8888;
+   ctx->in_width    = test->in_width;
+   ctx->in_height   = test->in_height;
+   ctx->in_stride   = test->in_width * bytes_per_pixel(test->in_fmt);
+   ctx->out_width   = test->out_width;
+   ctx->out_height  = test->out_height;
+   ctx->out_stride  = test->out_width * sizeof(uint32_t);
+}
+
+int main(void)
+{
+   int ret = 0;
+
+#ifndef SCALER_HAVE_AVX2
+   fprintf(stderr, "Built without AVX2 kernels.\n");
+   return 0;
+#else
+   if (!scaler_cpu_has_avx2())
+   {
+      fprintf(stderr, "This CPU has no AVX2.\n");
+      return 0;
+   }
+
+   printf("%-14s %10s %10s %10s %10s\n",
+         "scaler", "SSE2 us/f", "AVX2 us/f", "gen us", "cached us");
+
+   for (unsigned t = 0; t < sizeof(tests) / sizeof(tests[0]); t++)
+   {
+      const struct test_case *test = &tests[t];
+      struct scaler_ctx ctx;
+      size_t out_size = test->out_width * test->out_height * sizeof(uint32_t);
+      uint8_t *input  = malloc(test->in_width * test->in_height * 4);
+      uint32_t *ref   = malloc(out_size);
+      uint32_t *out   = malloc(out_size);
+      double sse2_time, avx2_time, gen_time, cached_time;
+      bool match;
+
+      gen_frame(input, test);
+      init_ctx(&ctx, test);
+
+      // A new context each time so nothing is cached.
+      gen_time = get_time();
+      for (unsigned i = 0; i < 16; i++)
+      {
+         scaler_ctx_gen_reset(&ctx);
+         init_ctx(&ctx, test);
+         if (!scaler_ctx_gen_filter(&ctx))
+         {
+            fprintf(stderr, "%s: failed to generate filter.\n", test->name);
+            return 1;
+         }
+      }
+      gen_time = (get_time() - gen_time) * 1000000.0 / 16;
+
+      ctx.scaler_horiz = scaler_argb8888_horiz;
+      ctx.scaler_vert  = scaler_argb8888_vert;
+      scaler_ctx_scale(&ctx, ref, input);
+      sse2_time = run_speed(&ctx, ref, input);
+
+      ctx.scaler_horiz = scaler_argb8888_horiz_avx2;
+      ctx.scaler_vert  = scaler_argb8888_vert_avx2;
+      memset(out, 0, out_size);
+      scaler_ctx_scale(&ctx, out, input);
+      match = !memcmp(ref, out, out_size);
+      avx2_time = run_speed(&ctx, out, input);
+
+      cached_time = run_gen_filter(&ctx, test);
+
+      printf("%-14s %10.1f %10.1f %10.1f %10.1f %s\n",
+            test->name, sse2_time, avx2_time, gen_time, cached_time,
+            match ? "" : "FAIL");
+
+      if (!match)
+         ret = 1;
+
+      scaler_ctx_gen_reset(&ctx);
+      free(input);
+      free(ref);
+      free(out);
+   }
+
+   return ret;
+#endif
+}
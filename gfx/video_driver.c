@@ -18,11 +18,15 @@
 #include <string/string_list.h>
 #include "video_driver.h"
 #include "video_thread_wrapper.h"
+#ifdef HAVE_THREADS
+#include "video_shader_async.h"
+#endif
 #include "video_pixel_converter.h"
 #include "video_viewport.h"
 #include "video_monitor.h"
 #include "../general.h"
 #include "../retroarch.h"
+#include "../performance.h"
 
 static const video_driver_t *video_drivers[] = {
 #ifdef HAVE_OPENGL
@@ -346,6 +350,12 @@ void uninit_video_input(void)
 
    deinit_video_filter();
 
+#ifdef HAVE_THREADS
+   video_shader_async_deinit();
+   task_pool_free(driver.video_pool);
+   driver.video_pool = NULL;
+#endif
+
    rarch_main_command(RARCH_CMD_SHADER_DIR_DEINIT);
    video_monitor_compute_fps_statistics();
 }
@@ -359,6 +369,13 @@ void init_video(void)
    video_info_t video = {0};
    static uint16_t dummy_pixels[32] = {0};
 
+#ifdef HAVE_THREADS
+   /* The thread calling into the pool works too,
+    * so one worker less than there are cores. */
+   if (!driver.video_pool)
+      driver.video_pool = task_pool_new(rarch_get_cpu_cores() - 1);
+#endif
+
    init_video_filter(g_extern.system.pix_fmt);
    rarch_main_command(RARCH_CMD_SHADER_DIR_INIT);
 
@@ -109,6 +109,11 @@ typedef struct video_poke_interface
    void (*grab_mouse_toggle)(void *data);
 
    struct video_shader *(*get_current_shader)(void *data);
+
+   /* Buffer the core can render the next frame into, see
+    * RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER. */
+   bool (*get_current_software_framebuffer)(void *data,
+         struct retro_framebuffer *framebuffer);
 } video_poke_interface_t;
 
 typedef struct video_driver
@@ -22,6 +22,7 @@
 #include "../file_ext.h"
 #include <file/dir_list.h>
 #include "../performance.h"
+#include "../general.h"
 #include <stdlib.h>
 
 struct rarch_soft_plug
@@ -32,46 +33,10 @@ struct rarch_soft_plug
    const struct softfilter_implementation *impl;
 };
 
-#ifdef HAVE_THREADS
-#include <rthreads/rthreads.h>
-
-struct filter_thread_data
-{
-   sthread_t *thread;
-   const struct softfilter_work_packet *packet;
-   scond_t *cond;
-   slock_t *lock;
-   void *userdata;
-   bool die;
-   bool done;
-};
-
-static void filter_thread_loop(void *data)
-{
-   struct filter_thread_data *thr = (struct filter_thread_data*)data;
-
-   for (;;)
-   {
-      bool die;
-      slock_lock(thr->lock);
-      while (thr->done && !thr->die)
-         scond_wait(thr->cond, thr->lock);
-      die = thr->die;
-      slock_unlock(thr->lock);
-
-      if (die)
-         break;
-
-      if (thr->packet && thr->packet->work)
-         thr->packet->work(thr->userdata, thr->packet->thread_data);
-
-      slock_lock(thr->lock);
-      thr->done = true;
-      scond_signal(thr->cond);
-      slock_unlock(thr->lock);
-   }
-}
-#endif
+/* Each thread gets a few bands of rows, so the ones
+ * which finish early can take over the rest. */
+#define SOFTFILTER_BANDS_PER_THREAD 4
+#define SOFTFILTER_MIN_BAND_HEIGHT 8
 
 struct rarch_softfilter
 {
@@ -87,11 +52,9 @@ struct rarch_softfilter
    enum retro_pixel_format pix_fmt, out_pix_fmt;
 
    struct softfilter_work_packet *packets;
+   unsigned bands;
+   /* Most threads the bands run on, 0 for the whole pool. */
    unsigned threads;
-
-#ifdef HAVE_THREADS
-   struct filter_thread_data *thread_data;
-#endif
 };
 
 static const struct softfilter_implementation *
@@ -123,7 +86,7 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
       softfilter_simd_mask_t cpu_features,
       unsigned threads)
 {
-   unsigned input_fmts, input_fmt, output_fmts, i;
+   unsigned input_fmts, input_fmt, output_fmts, bands;
    char key[64], name[64];
    struct config_file_userdata userdata;
 
@@ -192,58 +155,50 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    filt->max_width = max_width;
    filt->max_height = max_height;
 
+   filt->threads = threads;
+
+   if (threads == RARCH_SOFTFILTER_THREADS_AUTO)
+   {
+#ifdef HAVE_THREADS
+      threads = task_pool_threads(driver.video_pool);
+#else
+      threads = 1;
+#endif
+   }
+
+   /* Filters split the frame into as many bands as
+    * they are told threads. */
+   bands = threads > 1 ? threads * SOFTFILTER_BANDS_PER_THREAD : 1;
+   if (bands > max_height / SOFTFILTER_MIN_BAND_HEIGHT)
+      bands = max(max_height / SOFTFILTER_MIN_BAND_HEIGHT, 1);
+
    filt->impl_data = filt->impl->create(
          &softfilter_config, input_fmt, input_fmt, max_width, max_height,
-         threads != RARCH_SOFTFILTER_THREADS_AUTO ? threads : 
-         rarch_get_cpu_cores(), cpu_features,
-         &userdata);
+         bands, cpu_features, &userdata);
    if (!filt->impl_data)
    {
       RARCH_ERR("Failed to create softfilter state.\n");
       return false;
    }
 
-   threads = filt->impl->query_num_threads(filt->impl_data);
-   if (!threads)
+   bands = filt->impl->query_num_threads(filt->impl_data);
+   if (!bands)
    {
       RARCH_ERR("Invalid number of threads.\n");
       return false;
    }
 
-   RARCH_LOG("Using %u threads for softfilter.\n", threads);
+   RARCH_LOG("Using %u bands on %u threads for softfilter.\n",
+         bands, threads);
 
    filt->packets = (struct softfilter_work_packet*)
-      calloc(threads, sizeof(*filt->packets));
+      calloc(bands, sizeof(*filt->packets));
    if (!filt->packets)
    {
       RARCH_ERR("Failed to allocate softfilter packets.\n");
       return false;
    }
-
-#ifdef HAVE_THREADS
-   filt->thread_data = (struct filter_thread_data*)
-      calloc(threads, sizeof(*filt->thread_data));
-   if (!filt->thread_data)
-      return false;
-   filt->threads = threads;
-
-   for (i = 0; i < threads; i++)
-   {
-      filt->thread_data[i].userdata = filt->impl_data;
-      filt->thread_data[i].done = true;
-
-      filt->thread_data[i].lock = slock_new();
-      if (!filt->thread_data[i].lock)
-         return false;
-      filt->thread_data[i].cond = scond_new();
-      if (!filt->thread_data[i].cond)
-         return false;
-      filt->thread_data[i].thread = sthread_create(
-            filter_thread_loop, &filt->thread_data[i]);
-      if (!filt->thread_data[i].thread)
-         return false;
-   }
-#endif
+   filt->bands = bands;
 
    return true;
 }
@@ -449,21 +404,6 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
    free(filt->plugs);
 #endif
 
-#ifdef HAVE_THREADS
-   for (i = 0; i < filt->threads; i++)
-   {
-      if (!filt->thread_data[i].thread)
-         continue;
-      slock_lock(filt->thread_data[i].lock);
-      filt->thread_data[i].die = true;
-      scond_signal(filt->thread_data[i].cond);
-      slock_unlock(filt->thread_data[i].lock);
-      sthread_join(filt->thread_data[i].thread);
-      slock_free(filt->thread_data[i].lock);
-      scond_free(filt->thread_data[i].cond);
-   }
-   free(filt->thread_data);
-#endif
    free(filt);
 }
 
@@ -489,44 +429,31 @@ enum retro_pixel_format rarch_softfilter_get_output_format(
    return filt->out_pix_fmt;
 }
 
+static void softfilter_work(void *data, unsigned index)
+{
+   rarch_softfilter_t *filt = (rarch_softfilter_t*)data;
+   const struct softfilter_work_packet *packet = &filt->packets[index];
+
+   if (packet->work)
+      packet->work(filt->impl_data, packet->thread_data);
+}
+
 void rarch_softfilter_process(rarch_softfilter_t *filt,
       void *output, size_t output_stride,
       const void *input, unsigned width, unsigned height, size_t input_stride)
 {
-   unsigned i;
-
    if (filt && filt->impl && filt->impl->get_work_packets)
       filt->impl->get_work_packets(filt->impl_data, filt->packets,
             output, output_stride, input, width, height, input_stride);
-   
-#ifdef HAVE_THREADS
-   /* Fire off workers */
-   for (i = 0; i < filt->threads; i++)
-   {
-#if 0
-      RARCH_LOG("Firing off filter thread %u ...\n", i);
-#endif
-      filt->thread_data[i].packet = &filt->packets[i];
-      slock_lock(filt->thread_data[i].lock);
-      filt->thread_data[i].done = false;
-      scond_signal(filt->thread_data[i].cond);
-      slock_unlock(filt->thread_data[i].lock);
-   }
 
-   /* Wait for workers */
-   for (i = 0; i < filt->threads; i++)
+#ifdef HAVE_THREADS
+   task_pool_run_limited(driver.video_pool, softfilter_work, filt,
+         filt->bands, filt->threads);
+#else
    {
-#if 0
-      RARCH_LOG("Waiting for filter thread %u ...\n", i);
-#endif
-      slock_lock(filt->thread_data[i].lock);
-      while (!filt->thread_data[i].done)
-         scond_wait(filt->thread_data[i].cond, filt->thread_data[i].lock);
-      slock_unlock(filt->thread_data[i].lock);
+      unsigned i;
+      for (i = 0; i < filt->bands; i++)
+         softfilter_work(filt, i);
    }
-#else
-   for (i = 0; i < filt->threads; i++)
-      filt->packets[i].work(filt->impl_data, filt->packets[i].thread_data);
 #endif
 }
-
@@ -554,7 +554,7 @@ static void twoxbr_generic_xrgb8888(void *data, unsigned width, unsigned height,
       int first, int last, uint32_t *src,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
-   unsigned nextline, finish;
+   unsigned y, nextline, finish;
    uint32_t pg_red_mask      = RED_MASK8888;
    uint32_t pg_green_mask    = GREEN_MASK8888;
    uint32_t pg_blue_mask     = BLUE_MASK8888;
@@ -564,12 +564,15 @@ static void twoxbr_generic_xrgb8888(void *data, unsigned width, unsigned height,
 
    (void)filt;
 
-   nextline = (last) ? 0 : src_stride;
-   
-   for (; height; height--)
+   for (y = 0; y < height; y++)
    {
       uint32_t *in  = (uint32_t*)src;
       uint32_t *out = (uint32_t*)dst;
+
+      /* Rows which would look outside the image
+       * only look at their own row instead. */
+      nextline = ((first && y < 2) || (last && y + 2 >= height)) ?
+         0 : src_stride;
  
       for (finish = width; finish; finish -= 1)
       {
@@ -618,20 +621,23 @@ static void twoxbr_generic_rgb565(void *data, unsigned width, unsigned height,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
    uint16_t pg_red_mask, pg_green_mask, pg_blue_mask, pg_lbmask;
-   unsigned nextline, finish;
+   unsigned y, nextline, finish;
    struct filter_data *filt = (struct filter_data*)data;
 
    pg_red_mask   = RED_MASK565;
    pg_green_mask = GREEN_MASK565;
    pg_blue_mask  = BLUE_MASK565;
    pg_lbmask     = PG_LBMASK565;
-   nextline = (last) ? 0 : src_stride;
-   
- 
-   for (; height; height--)
+
+   for (y = 0; y < height; y++)
    {
       uint16_t *in  = (uint16_t*)src;
       uint16_t *out = (uint16_t*)dst;
+
+      /* Rows which would look outside the image
+       * only look at their own row instead. */
+      nextline = ((first && y < 2) || (last && y + 2 >= height)) ?
+         0 : src_stride;
  
       for (finish = width; finish; finish -= 1)
       {
@@ -730,7 +736,7 @@ static void twoxbr_generic_packets(void *data,
  
       /* Workers need to know if they can access 
        * pixels outside their given buffer. */
-      thr->first = y_start;
+      thr->first = y_start == 0;
       thr->last = y_end == height;
  
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
@@ -19,9 +19,23 @@
 #include <stdlib.h>
 #include <string.h>
 #include <boolean.h>
+#include <retro_inline.h>
 #include "snes_ntsc/snes_ntsc.h"
 #include "snes_ntsc/snes_ntsc.c"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* The AVX2 blitter is built with a function-level target,
+ * so it can be picked at runtime like in a distributed build. */
+#if defined(__SSE2__) && (defined(__clang__) || \
+      (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#include <immintrin.h>
+#define BLARGG_NTSC_SNES_HAVE_AVX2
+#define BLARGG_NTSC_SNES_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation blargg_ntsc_snes_get_implementation
 #define softfilter_thread_data blargg_ntsc_snes_softfilter_thread_data
@@ -39,8 +53,14 @@ struct softfilter_thread_data
    unsigned height;
    int first;
    int last;
+   int burst;
 };
 
+typedef void (*blargg_ntsc_snes_blit_t)(snes_ntsc_t const *ntsc,
+      SNES_NTSC_IN_T const *input, long in_row_width,
+      int burst_phase, int in_width, int in_height,
+      void *rgb_out, long out_pitch, int first, int last);
+
 struct filter_data
 {
    unsigned threads;
@@ -49,6 +69,8 @@ struct filter_data
    struct snes_ntsc_t *ntsc;
    int burst;
    int burst_toggle;
+   /* Blitter for rows up to 256 pixels wide. */
+   blargg_ntsc_snes_blit_t blit;
 };
 
 
@@ -128,7 +150,7 @@ static void *blargg_ntsc_snes_generic_create(const struct softfilter_config *con
       return NULL;
    filt->workers = (struct softfilter_thread_data*)
       calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    if (!filt->workers)
    {
@@ -137,6 +159,7 @@ static void *blargg_ntsc_snes_generic_create(const struct softfilter_config *con
    }
 
    blargg_ntsc_snes_initialize(filt, config, userdata);
+   filt->blit = snes_ntsc_blit;
 
    return filt;
 }
@@ -164,27 +187,239 @@ static void blargg_ntsc_snes_generic_destroy(void *data)
    free(filt);
 }
 
+/* Vectorized blitters for rows up to 256 pixels wide.
+ *
+ * snes_ntsc_blit() adds six kernel entries for every output pixel.
+ * Written out for a chunk of 3 input and 7 output pixels, output
+ * pixel x of a chunk is
+ *
+ *    k0[x] + p0[x + 7] + p1[x + 19] + p2[x + 31]
+ *    + k1[x + 12] (x >= 2) + k2[x + 24] (x >= 4)
+ *    + q1[x + 26] (x <= 1) + q2[x + 38] (x <= 3)
+ *
+ * where k, p and q are the kernels of the input pixels of this chunk,
+ * the one before and the one before that. Every term is a run of
+ * entries next to each other, so a chunk is a handful of vector loads
+ * and adds, with an eighth lane which is thrown away. Clamping and
+ * conversion are the same as in SNES_NTSC_RGB_OUT, so the output
+ * matches snes_ntsc_blit(). */
+#define BLARGG_NTSC_SNES_BLIT(chunk) \
+{ \
+   int chunk_count = (in_width - 1) / snes_ntsc_in_chunk; \
+   \
+   for (; in_height; --in_height) \
+   { \
+      char const *ktable = (char const*)ntsc->table + \
+         burst_phase * (snes_ntsc_burst_size * sizeof(snes_ntsc_rgb_t)); \
+      snes_ntsc_rgb_t const *black = SNES_NTSC_IN_FORMAT(ktable, snes_ntsc_black); \
+      snes_ntsc_rgb_t const *p0 = black; \
+      snes_ntsc_rgb_t const *p1 = black; \
+      snes_ntsc_rgb_t const *p2 = SNES_NTSC_IN_FORMAT(ktable, SNES_NTSC_ADJ_IN(input[0])); \
+      snes_ntsc_rgb_t const *q1 = black; \
+      snes_ntsc_rgb_t const *q2 = black; \
+      SNES_NTSC_IN_T const *line_in = input + 1; \
+      uint16_t *line_out = (uint16_t*)rgb_out; \
+      uint16_t final_pixels[8]; \
+      int n; \
+      \
+      for (n = chunk_count; n; --n) \
+      { \
+         snes_ntsc_rgb_t const *k0 = SNES_NTSC_IN_FORMAT(ktable, SNES_NTSC_ADJ_IN(line_in[0])); \
+         snes_ntsc_rgb_t const *k1 = SNES_NTSC_IN_FORMAT(ktable, SNES_NTSC_ADJ_IN(line_in[1])); \
+         snes_ntsc_rgb_t const *k2 = SNES_NTSC_IN_FORMAT(ktable, SNES_NTSC_ADJ_IN(line_in[2])); \
+         \
+         /* The eighth pixel is written over by the next chunk. */ \
+         chunk(line_out, k0, k1, k2, p0, p1, p2, q1, q2); \
+         \
+         q1 = p1; \
+         q2 = p2; \
+         p0 = k0; \
+         p1 = k1; \
+         p2 = k2; \
+         line_in  += 3; \
+         line_out += 7; \
+      } \
+      \
+      /* finish final pixels, without writing past the row */ \
+      chunk(final_pixels, black, black, black, p0, p1, p2, q1, q2); \
+      memcpy(line_out, final_pixels, 7 * sizeof(uint16_t)); \
+      \
+      burst_phase = (burst_phase + 1) % snes_ntsc_burst_count; \
+      input += in_row_width; \
+      rgb_out = (char*)rgb_out + out_pitch; \
+   } \
+}
+
+#if defined(__SSE2__)
+#define BLARGG_NTSC_SNES_LOAD_SSE2(kernel) \
+   _mm_loadu_si128((const __m128i*)(kernel))
+
+/* SNES_NTSC_CLAMP_ and the 16-bit SNES_NTSC_RGB_OUT_, with shift 1.
+ * The result is sign-extended so it survives the saturating pack. */
+static INLINE __m128i blargg_ntsc_snes_rgb565_sse2(__m128i raw)
+{
+   __m128i sub   = _mm_and_si128(_mm_srli_epi32(raw, 8),
+         _mm_set1_epi32(snes_ntsc_clamp_mask));
+   __m128i clamp = _mm_sub_epi32(_mm_set1_epi32(snes_ntsc_clamp_add), sub);
+   __m128i out;
+
+   raw   = _mm_or_si128(raw, clamp);
+   clamp = _mm_sub_epi32(clamp, sub);
+   raw   = _mm_and_si128(raw, clamp);
+
+   out = _mm_or_si128(
+         _mm_and_si128(_mm_srli_epi32(raw, 12), _mm_set1_epi32(0xF800)),
+         _mm_and_si128(_mm_srli_epi32(raw, 7), _mm_set1_epi32(0x07E0)));
+   out = _mm_or_si128(out,
+         _mm_and_si128(_mm_srli_epi32(raw, 3), _mm_set1_epi32(0x001F)));
+   return _mm_srai_epi32(_mm_slli_epi32(out, 16), 16);
+}
+
+static INLINE void blargg_ntsc_snes_chunk_sse2(uint16_t *out,
+      snes_ntsc_rgb_t const *k0, snes_ntsc_rgb_t const *k1,
+      snes_ntsc_rgb_t const *k2, snes_ntsc_rgb_t const *p0,
+      snes_ntsc_rgb_t const *p1, snes_ntsc_rgb_t const *p2,
+      snes_ntsc_rgb_t const *q1, snes_ntsc_rgb_t const *q2)
+{
+   const __m128i from2 = _mm_setr_epi32(0, 0, -1, -1);
+   const __m128i upto2 = _mm_setr_epi32(-1, -1, 0, 0);
+   __m128i lo, hi;
+
+   /* Output pixels 0 to 3. */
+   lo = _mm_add_epi32(
+         _mm_add_epi32(BLARGG_NTSC_SNES_LOAD_SSE2(k0), BLARGG_NTSC_SNES_LOAD_SSE2(p0 + 7)),
+         _mm_add_epi32(BLARGG_NTSC_SNES_LOAD_SSE2(p1 + 19), BLARGG_NTSC_SNES_LOAD_SSE2(p2 + 31)));
+   lo = _mm_add_epi32(lo, _mm_add_epi32(
+            _mm_and_si128(BLARGG_NTSC_SNES_LOAD_SSE2(k1 + 12), from2),
+            _mm_and_si128(BLARGG_NTSC_SNES_LOAD_SSE2(q1 + 26), upto2)));
+   lo = _mm_add_epi32(lo, BLARGG_NTSC_SNES_LOAD_SSE2(q2 + 38));
+
+   /* Output pixels 4 to 7. */
+   hi = _mm_add_epi32(
+         _mm_add_epi32(BLARGG_NTSC_SNES_LOAD_SSE2(k0 + 4), BLARGG_NTSC_SNES_LOAD_SSE2(p0 + 11)),
+         _mm_add_epi32(BLARGG_NTSC_SNES_LOAD_SSE2(p1 + 23), BLARGG_NTSC_SNES_LOAD_SSE2(p2 + 35)));
+   hi = _mm_add_epi32(hi, _mm_add_epi32(
+            BLARGG_NTSC_SNES_LOAD_SSE2(k1 + 16), BLARGG_NTSC_SNES_LOAD_SSE2(k2 + 28)));
+
+   _mm_storeu_si128((__m128i*)out, _mm_packs_epi32(
+            blargg_ntsc_snes_rgb565_sse2(lo), blargg_ntsc_snes_rgb565_sse2(hi)));
+}
+
+static void blargg_ntsc_snes_blit_sse2(snes_ntsc_t const *ntsc,
+      SNES_NTSC_IN_T const *input, long in_row_width,
+      int burst_phase, int in_width, int in_height,
+      void *rgb_out, long out_pitch, int first, int last)
+BLARGG_NTSC_SNES_BLIT(blargg_ntsc_snes_chunk_sse2)
+#endif
+
+#ifdef BLARGG_NTSC_SNES_HAVE_AVX2
+/* One vector for the whole chunk. The partial terms use masked loads,
+ * which don't touch memory in masked lanes, since q2 would reach past
+ * the end of the kernel. */
+BLARGG_NTSC_SNES_TARGET_AVX2
+static INLINE void blargg_ntsc_snes_chunk_avx2(uint16_t *out,
+      snes_ntsc_rgb_t const *k0, snes_ntsc_rgb_t const *k1,
+      snes_ntsc_rgb_t const *k2, snes_ntsc_rgb_t const *p0,
+      snes_ntsc_rgb_t const *p1, snes_ntsc_rgb_t const *p2,
+      snes_ntsc_rgb_t const *q1, snes_ntsc_rgb_t const *q2)
+{
+   const __m256i from2 = _mm256_setr_epi32(0, 0, -1, -1, -1, -1, -1, -1);
+   const __m256i from4 = _mm256_setr_epi32(0, 0, 0, 0, -1, -1, -1, -1);
+   __m256i raw, sub, clamp, rgb;
+
+   raw = _mm256_add_epi32(
+         _mm256_add_epi32(
+            _mm256_loadu_si256((const __m256i*)k0),
+            _mm256_loadu_si256((const __m256i*)(p0 + 7))),
+         _mm256_add_epi32(
+            _mm256_loadu_si256((const __m256i*)(p1 + 19)),
+            _mm256_loadu_si256((const __m256i*)(p2 + 31))));
+   raw = _mm256_add_epi32(raw, _mm256_add_epi32(
+            _mm256_maskload_epi32((const int*)(k1 + 12), from2),
+            _mm256_maskload_epi32((const int*)(k2 + 24), from4)));
+   raw = _mm256_add_epi32(raw, _mm256_add_epi32(
+            _mm256_maskload_epi32((const int*)(q1 + 26),
+               _mm256_andnot_si256(from2, _mm256_set1_epi32(-1))),
+            _mm256_maskload_epi32((const int*)(q2 + 38),
+               _mm256_andnot_si256(from4, _mm256_set1_epi32(-1)))));
+
+   sub   = _mm256_and_si256(_mm256_srli_epi32(raw, 8),
+         _mm256_set1_epi32(snes_ntsc_clamp_mask));
+   clamp = _mm256_sub_epi32(_mm256_set1_epi32(snes_ntsc_clamp_add), sub);
+   raw   = _mm256_or_si256(raw, clamp);
+   clamp = _mm256_sub_epi32(clamp, sub);
+   raw   = _mm256_and_si256(raw, clamp);
+
+   rgb = _mm256_or_si256(
+         _mm256_and_si256(_mm256_srli_epi32(raw, 12), _mm256_set1_epi32(0xF800)),
+         _mm256_and_si256(_mm256_srli_epi32(raw, 7), _mm256_set1_epi32(0x07E0)));
+   rgb = _mm256_or_si256(rgb,
+         _mm256_and_si256(_mm256_srli_epi32(raw, 3), _mm256_set1_epi32(0x001F)));
+   rgb = _mm256_srai_epi32(_mm256_slli_epi32(rgb, 16), 16);
+
+   _mm_storeu_si128((__m128i*)out, _mm_packs_epi32(
+            _mm256_castsi256_si128(rgb), _mm256_extracti128_si256(rgb, 1)));
+}
+
+BLARGG_NTSC_SNES_TARGET_AVX2
+static void blargg_ntsc_snes_blit_avx2(snes_ntsc_t const *ntsc,
+      SNES_NTSC_IN_T const *input, long in_row_width,
+      int burst_phase, int in_width, int in_height,
+      void *rgb_out, long out_pitch, int first, int last)
+BLARGG_NTSC_SNES_BLIT(blargg_ntsc_snes_chunk_avx2)
+#endif
+
+#if defined(__SSE2__)
+static void *blargg_ntsc_snes_sse2_create(const struct softfilter_config *config,
+      unsigned in_fmt, unsigned out_fmt,
+      unsigned max_width, unsigned max_height,
+      unsigned threads, softfilter_simd_mask_t simd, void *userdata)
+{
+   struct filter_data *filt = (struct filter_data*)
+      blargg_ntsc_snes_generic_create(config, in_fmt, out_fmt,
+            max_width, max_height, threads, simd, userdata);
+   if (!filt)
+      return NULL;
+   filt->blit = blargg_ntsc_snes_blit_sse2;
+   return filt;
+}
+#endif
+
+#ifdef BLARGG_NTSC_SNES_HAVE_AVX2
+static void *blargg_ntsc_snes_avx2_create(const struct softfilter_config *config,
+      unsigned in_fmt, unsigned out_fmt,
+      unsigned max_width, unsigned max_height,
+      unsigned threads, softfilter_simd_mask_t simd, void *userdata)
+{
+   struct filter_data *filt = (struct filter_data*)
+      blargg_ntsc_snes_generic_create(config, in_fmt, out_fmt,
+            max_width, max_height, threads, simd, userdata);
+   if (!filt)
+      return NULL;
+   filt->blit = blargg_ntsc_snes_blit_avx2;
+   return filt;
+}
+#endif
+
 static void blargg_ntsc_snes_render_rgb565(void *data, int width, int height,
-      int first, int last,
+      int first, int last, int burst,
       uint16_t *input, int pitch, uint16_t *output, int outpitch)
 {
    struct filter_data *filt = (struct filter_data*)data;
    if(width <= 256)
-      snes_ntsc_blit(filt->ntsc, input, pitch, filt->burst,
+      filt->blit(filt->ntsc, input, pitch, burst,
             width, height, output, outpitch * 2, first, last);
    else
-      snes_ntsc_blit_hires(filt->ntsc, input, pitch, filt->burst,
+      snes_ntsc_blit_hires(filt->ntsc, input, pitch, burst,
             width, height, output, outpitch * 2, first, last);
-
-   filt->burst ^= filt->burst_toggle;
 }
 
 static void blargg_ntsc_snes_rgb565(void *data, unsigned width, unsigned height,
-      int first, int last, uint16_t *src, 
+      int first, int last, int burst, uint16_t *src, 
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
    blargg_ntsc_snes_render_rgb565(data, width, height,
-         first, last,
+         first, last, burst,
          src, src_stride,
          dst, dst_stride);
 
@@ -200,7 +435,7 @@ static void blargg_ntsc_snes_work_cb_rgb565(void *data, void *thread_data)
    unsigned height = thr->height;
 
    blargg_ntsc_snes_rgb565(data, width, height,
-         thr->first, thr->last, input,
+         thr->first, thr->last, thr->burst, input,
          thr->in_pitch / SOFTFILTER_BPP_RGB565,
          output,
          thr->out_pitch / SOFTFILTER_BPP_RGB565);
@@ -229,13 +464,19 @@ static void blargg_ntsc_snes_generic_packets(void *data,
 
       /* Workers need to know if they can 
        * access pixels outside their given buffer. */
-      thr->first = y_start;
+      thr->first = y_start == 0;
       thr->last = y_end == height;
 
+      /* The burst phase advances every line, so bands
+       * have to start where the previous one left off. */
+      thr->burst = (filt->burst + y_start) % snes_ntsc_burst_count;
+
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work = blargg_ntsc_snes_work_cb_rgb565;
       packets[i].thread_data = thr;
    }
+
+   filt->burst ^= filt->burst_toggle;
 }
 
 static const struct softfilter_implementation blargg_ntsc_snes_generic = {
@@ -253,10 +494,52 @@ static const struct softfilter_implementation blargg_ntsc_snes_generic = {
    "blargg_ntsc_snes",
 };
 
+#if defined(__SSE2__)
+static const struct softfilter_implementation blargg_ntsc_snes_sse2 = {
+   blargg_ntsc_snes_generic_input_fmts,
+   blargg_ntsc_snes_generic_output_fmts,
+
+   blargg_ntsc_snes_sse2_create,
+   blargg_ntsc_snes_generic_destroy,
+
+   blargg_ntsc_snes_generic_threads,
+   blargg_ntsc_snes_generic_output,
+   blargg_ntsc_snes_generic_packets,
+   SOFTFILTER_API_VERSION,
+   "Blargg NTSC SNES (SSE2)",
+   "blargg_ntsc_snes",
+};
+#endif
+
+#ifdef BLARGG_NTSC_SNES_HAVE_AVX2
+static const struct softfilter_implementation blargg_ntsc_snes_avx2 = {
+   blargg_ntsc_snes_generic_input_fmts,
+   blargg_ntsc_snes_generic_output_fmts,
+
+   blargg_ntsc_snes_avx2_create,
+   blargg_ntsc_snes_generic_destroy,
+
+   blargg_ntsc_snes_generic_threads,
+   blargg_ntsc_snes_generic_output,
+   blargg_ntsc_snes_generic_packets,
+   SOFTFILTER_API_VERSION,
+   "Blargg NTSC SNES (AVX2)",
+   "blargg_ntsc_snes",
+};
+#endif
+
 const struct softfilter_implementation *softfilter_get_implementation(
       softfilter_simd_mask_t simd)
 {
    (void)simd;
+#ifdef BLARGG_NTSC_SNES_HAVE_AVX2
+   if (simd & SOFTFILTER_SIMD_AVX2)
+      return &blargg_ntsc_snes_avx2;
+#endif
+#if defined(__SSE2__)
+   if (simd & SOFTFILTER_SIMD_SSE2)
+      return &blargg_ntsc_snes_sse2;
+#endif
    return &blargg_ntsc_snes_generic;
 }
 
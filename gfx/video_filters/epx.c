@@ -15,6 +15,7 @@
  */
 
 #include "softfilter.h"
+#include "scale2x_simd.h"
 #include <stdlib.h>
 
 #ifdef RARCH_INTERNAL
@@ -43,6 +44,8 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   /* Vectorized row, NULL for the plain C filter. */
+   scale2x_row_rgb565_t row_rgb565;
 };
 
 static unsigned epx_generic_input_fmts(void)
@@ -104,6 +107,38 @@ static void epx_generic_destroy(void *data)
    free(filt);
 }
 
+#if defined(__SSE2__)
+static void *epx_sse2_create(const struct softfilter_config *config,
+      unsigned in_fmt, unsigned out_fmt,
+      unsigned max_width, unsigned max_height,
+      unsigned threads, softfilter_simd_mask_t simd, void *userdata)
+{
+   struct filter_data *filt = (struct filter_data*)epx_generic_create(
+         config, in_fmt, out_fmt, max_width, max_height,
+         threads, simd, userdata);
+   if (!filt)
+      return NULL;
+   filt->row_rgb565 = scale2x_row_rgb565_sse2;
+   return filt;
+}
+#endif
+
+#ifdef SCALE2X_HAVE_AVX2
+static void *epx_avx2_create(const struct softfilter_config *config,
+      unsigned in_fmt, unsigned out_fmt,
+      unsigned max_width, unsigned max_height,
+      unsigned threads, softfilter_simd_mask_t simd, void *userdata)
+{
+   struct filter_data *filt = (struct filter_data*)epx_generic_create(
+         config, in_fmt, out_fmt, max_width, max_height,
+         threads, simd, userdata);
+   if (!filt)
+      return NULL;
+   filt->row_rgb565 = scale2x_row_rgb565_avx2;
+   return filt;
+}
+#endif
+
 static void EPX_16 (int width, int height,
       int first, int last,
       uint16_t *src, int src_stride, uint16_t *dst, int dst_stride)
@@ -111,11 +146,11 @@ static void EPX_16 (int width, int height,
 	uint16_t	colorX, colorA, colorB, colorC, colorD;
 	uint16_t	*sP, *uP, *lP;
 	uint32_t	*dP1, *dP2;
-	int		w, prevline;
-
-   prevline = (first) ? 0 : src_stride;
+	int		w, rows;
 
-	height -= 2;
+	/* Only the edges of the image get special treatment,
+	 * rows at the edges of a band go through the main loop. */
+	rows = height - (first ? 1 : 0) - (last ? 1 : 0);
 
 	/*   D
 	 * A X C
@@ -124,52 +159,27 @@ static void EPX_16 (int width, int height,
 
 	/* top edge */
 
-	sP  = (uint16_t *)(src - prevline);
-	lP  = (uint16_t *) (src + src_stride);
-	dP1 = (uint32_t *) dst;
-	dP2 = (uint32_t *) (dst + dst_stride);
-
-	// left edge
-
-	colorX = *sP;
-	colorC = *++sP;
-	colorB = *lP++;
-
-	if ((colorX != colorC) && (colorB != colorX))
+	if (first)
 	{
-	#ifdef MSB_FIRST
-		*dP1 = (colorX << 16) + colorX;
-		*dP2 = (colorX << 16) + ((colorB == colorC) ? colorB : colorX);
-	#else
-		*dP1 = colorX + (colorX << 16);
-		*dP2 = colorX + (((colorB == colorC) ? colorB : colorX) << 16);
-	#endif
-	}
-	else
-		*dP1 = *dP2 = (colorX << 16) + colorX;
-
-	dP1++;
-	dP2++;
+		sP  = (uint16_t *) src;
+		lP  = (uint16_t *) (src + src_stride);
+		dP1 = (uint32_t *) dst;
+		dP2 = (uint32_t *) (dst + dst_stride);
 
-	//
+		// left edge
 
-	for (w = width - 2; w; w--)
-	{
-		colorA = colorX;
-		colorX = colorC;
+		colorX = *sP;
 		colorC = *++sP;
 		colorB = *lP++;
 
-		if ((colorA != colorC) && (colorB != colorX))
+		if ((colorX != colorC) && (colorB != colorX))
 		{
 		#ifdef MSB_FIRST
 			*dP1 = (colorX << 16) + colorX;
-			*dP2 = (((colorA == colorB) ? colorA : colorX) << 16) + 
-            ((colorB == colorC) ? colorB : colorX);
+			*dP2 = (colorX << 16) + ((colorB == colorC) ? colorB : colorX);
 		#else
 			*dP1 = colorX + (colorX << 16);
-			*dP2 = ((colorA == colorB) ? colorA : colorX) + 
-            (((colorB == colorC) ? colorB : colorX) << 16);
+			*dP2 = colorX + (((colorB == colorC) ? colorB : colorX) << 16);
 		#endif
 		}
 		else
@@ -177,31 +187,59 @@ static void EPX_16 (int width, int height,
 
 		dP1++;
 		dP2++;
-	}
 
-	/* right edge */
+		//
+
+		for (w = width - 2; w; w--)
+		{
+			colorA = colorX;
+			colorX = colorC;
+			colorC = *++sP;
+			colorB = *lP++;
+
+			if ((colorA != colorC) && (colorB != colorX))
+			{
+			#ifdef MSB_FIRST
+				*dP1 = (colorX << 16) + colorX;
+				*dP2 = (((colorA == colorB) ? colorA : colorX) << 16) + 
+	            ((colorB == colorC) ? colorB : colorX);
+			#else
+				*dP1 = colorX + (colorX << 16);
+				*dP2 = ((colorA == colorB) ? colorA : colorX) + 
+	            (((colorB == colorC) ? colorB : colorX) << 16);
+			#endif
+			}
+			else
+				*dP1 = *dP2 = (colorX << 16) + colorX;
 
-	colorA = colorX;
-	colorX = colorC;
-	colorB = *lP;
+			dP1++;
+			dP2++;
+		}
 
-	if ((colorA != colorX) && (colorB != colorX))
-	{
-	#ifdef MSB_FIRST
-		*dP1 = (colorX << 16) + colorX;
-		*dP2 = (((colorA == colorB) ? colorA : colorX) << 16) + colorX;
-	#else
-		*dP1 = colorX + (colorX << 16);
-		*dP2 = ((colorA == colorB) ? colorA : colorX) + (colorX << 16);
-	#endif
-	}
-	else
-		*dP1 = *dP2 = (colorX << 16) + colorX;
+		/* right edge */
+
+		colorA = colorX;
+		colorX = colorC;
+		colorB = *lP;
 
-	src += src_stride;
-	dst += dst_stride << 1;
+		if ((colorA != colorX) && (colorB != colorX))
+		{
+		#ifdef MSB_FIRST
+			*dP1 = (colorX << 16) + colorX;
+			*dP2 = (((colorA == colorB) ? colorA : colorX) << 16) + colorX;
+		#else
+			*dP1 = colorX + (colorX << 16);
+			*dP2 = ((colorA == colorB) ? colorA : colorX) + (colorX << 16);
+		#endif
+		}
+		else
+			*dP1 = *dP2 = (colorX << 16) + colorX;
+
+		src += src_stride;
+		dst += dst_stride << 1;
+	}
 
-	for (; height; height--)
+	for (; rows > 0; rows--)
 	{
 		sP  = (uint16_t *) src;
 		uP  = (uint16_t *) (src - src_stride);
@@ -287,49 +325,26 @@ static void EPX_16 (int width, int height,
 
 	/* bottom edge */
 
-	sP  = (uint16_t *) src;
-	uP  = (uint16_t *) (src - src_stride);
-	dP1 = (uint32_t *) dst;
-	dP2 = (uint32_t *) (dst + dst_stride);
-
-	/* left edge */
-
-	colorX = *sP;
-	colorC = *++sP;
-	colorD = *uP++;
-
-	if ((colorX != colorC) && (colorX != colorD))
+	if (last)
 	{
-	#ifdef MSB_FIRST
-		*dP1 = (colorX << 16) + ((colorC == colorD) ? colorC : colorX);
-		*dP2 = (colorX << 16) + colorX;
-	#else
-		*dP1 = colorX + (((colorC == colorD) ? colorC : colorX) << 16);
-		*dP2 = colorX + (colorX << 16);
-	#endif
-	}
-	else
-		*dP1 = *dP2 = (colorX << 16) + colorX;
+		sP  = (uint16_t *) src;
+		uP  = (uint16_t *) (src - src_stride);
+		dP1 = (uint32_t *) dst;
+		dP2 = (uint32_t *) (dst + dst_stride);
 
-	dP1++;
-	dP2++;
+		/* left edge */
 
-	for (w = width - 2; w; w--)
-	{
-		colorA = colorX;
-		colorX = colorC;
+		colorX = *sP;
 		colorC = *++sP;
 		colorD = *uP++;
 
-		if ((colorA != colorC) && (colorX != colorD))
+		if ((colorX != colorC) && (colorX != colorD))
 		{
 		#ifdef MSB_FIRST
-			*dP1 = (((colorD == colorA) ? colorD : colorX) << 16) + 
-            ((colorC == colorD) ? colorC : colorX);
+			*dP1 = (colorX << 16) + ((colorC == colorD) ? colorC : colorX);
 			*dP2 = (colorX << 16) + colorX;
 		#else
-			*dP1 = ((colorD == colorA) ? colorD : colorX) + 
-            (((colorC == colorD) ? colorC : colorX) << 16);
+			*dP1 = colorX + (((colorC == colorD) ? colorC : colorX) << 16);
 			*dP2 = colorX + (colorX << 16);
 		#endif
 		}
@@ -338,37 +353,82 @@ static void EPX_16 (int width, int height,
 
 		dP1++;
 		dP2++;
-	}
 
-	/* right edge */
+		for (w = width - 2; w; w--)
+		{
+			colorA = colorX;
+			colorX = colorC;
+			colorC = *++sP;
+			colorD = *uP++;
+
+			if ((colorA != colorC) && (colorX != colorD))
+			{
+			#ifdef MSB_FIRST
+				*dP1 = (((colorD == colorA) ? colorD : colorX) << 16) + 
+	            ((colorC == colorD) ? colorC : colorX);
+				*dP2 = (colorX << 16) + colorX;
+			#else
+				*dP1 = ((colorD == colorA) ? colorD : colorX) + 
+	            (((colorC == colorD) ? colorC : colorX) << 16);
+				*dP2 = colorX + (colorX << 16);
+			#endif
+			}
+			else
+				*dP1 = *dP2 = (colorX << 16) + colorX;
+
+			dP1++;
+			dP2++;
+		}
 
-	colorA = colorX;
-	colorX = colorC;
-	colorD = *uP;
+		/* right edge */
 
-	if ((colorA != colorX) && (colorX != colorD))
-	{
-	#ifdef MSB_FIRST
-		*dP1 = (((colorD == colorA) ? colorD : colorX) << 16) + colorX;
-		*dP2 = (colorX << 16) + colorX;
-	#else
-		*dP1 = ((colorD == colorA) ? colorD : colorX) + (colorX << 16);
-		*dP2 = colorX + (colorX << 16);
-	#endif
+		colorA = colorX;
+		colorX = colorC;
+		colorD = *uP;
+
+		if ((colorA != colorX) && (colorX != colorD))
+		{
+		#ifdef MSB_FIRST
+			*dP1 = (((colorD == colorA) ? colorD : colorX) << 16) + colorX;
+			*dP2 = (colorX << 16) + colorX;
+		#else
+			*dP1 = ((colorD == colorA) ? colorD : colorX) + (colorX << 16);
+			*dP2 = colorX + (colorX << 16);
+		#endif
+		}
+		else
+			*dP1 = *dP2 = (colorX << 16) + colorX;
 	}
-	else
-		*dP1 = *dP2 = (colorX << 16) + colorX;
 }
 
-static void epx_generic_rgb565(unsigned width, unsigned height,
+static void epx_generic_rgb565(struct filter_data *filt,
+      unsigned width, unsigned height,
       int first, int last, uint16_t *src, 
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
-   EPX_16(width, height,
-         first, last,
-         src, src_stride,
-         dst, dst_stride);
+   unsigned y;
 
+   if (!filt->row_rgb565)
+   {
+      EPX_16(width, height,
+            first, last,
+            src, src_stride,
+            dst, dst_stride);
+      return;
+   }
+
+   /* EPX gives the same result as Scale2x,
+    * so the vectorized paths run the Scale2x rows. */
+   for (y = 0; y < height; y++)
+   {
+      const uint16_t *up   = ((y == 0) && first) ? src : src - src_stride;
+      const uint16_t *down = ((y == height - 1) && last) ? src : src + src_stride;
+
+      filt->row_rgb565(dst, dst + dst_stride, up, src, down, width);
+
+      src += src_stride;
+      dst += dst_stride * EPX_SCALE;
+   }
 }
 
 static void epx_work_cb_rgb565(void *data, void *thread_data)
@@ -380,7 +440,7 @@ static void epx_work_cb_rgb565(void *data, void *thread_data)
    unsigned width = thr->width;
    unsigned height = thr->height;
 
-   epx_generic_rgb565(width, height,
+   epx_generic_rgb565((struct filter_data*)data, width, height,
          thr->first, thr->last, input,
          thr->in_pitch / SOFTFILTER_BPP_RGB565,
          output,
@@ -411,7 +471,7 @@ static void epx_generic_packets(void *data,
 
       /* Workers need to know if they can 
        * access pixels outside their given buffer. */
-      thr->first = y_start;
+      thr->first = y_start == 0;
       thr->last = y_end == height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
@@ -435,10 +495,52 @@ static const struct softfilter_implementation epx_generic = {
    "epx",
 };
 
+#if defined(__SSE2__)
+static const struct softfilter_implementation epx_sse2 = {
+   epx_generic_input_fmts,
+   epx_generic_output_fmts,
+
+   epx_sse2_create,
+   epx_generic_destroy,
+
+   epx_generic_threads,
+   epx_generic_output,
+   epx_generic_packets,
+   SOFTFILTER_API_VERSION,
+   "EPX (SSE2)",
+   "epx",
+};
+#endif
+
+#ifdef SCALE2X_HAVE_AVX2
+static const struct softfilter_implementation epx_avx2 = {
+   epx_generic_input_fmts,
+   epx_generic_output_fmts,
+
+   epx_avx2_create,
+   epx_generic_destroy,
+
+   epx_generic_threads,
+   epx_generic_output,
+   epx_generic_packets,
+   SOFTFILTER_API_VERSION,
+   "EPX (AVX2)",
+   "epx",
+};
+#endif
+
 const struct softfilter_implementation *softfilter_get_implementation(
       softfilter_simd_mask_t simd)
 {
    (void)simd;
+#ifdef SCALE2X_HAVE_AVX2
+   if (simd & SOFTFILTER_SIMD_AVX2)
+      return &epx_avx2;
+#endif
+#if defined(__SSE2__)
+   if (simd & SOFTFILTER_SIMD_SSE2)
+      return &epx_sse2;
+#endif
    return &epx_generic;
 }
 
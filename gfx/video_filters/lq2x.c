@@ -116,8 +116,8 @@ static void lq2x_generic_rgb565(unsigned width, unsigned height,
    for(y = 0; y < height; y++)
    {
       int prevline, nextline;
-      prevline = (y == 0 ? 0 : src_stride);
-      nextline = (y == height - 1 || last) ? 0 : src_stride;
+      prevline = (y == 0 && first) ? 0 : src_stride;
+      nextline = (y == height - 1 && last) ? 0 : src_stride;
 
       for(x = 0; x < width; x++)
       {
@@ -162,8 +162,8 @@ static void lq2x_generic_xrgb8888(unsigned width, unsigned height,
 
    for(y = 0; y < height; y++)
    {
-      int prevline = (y == 0 ? 0 : src_stride);
-      int nextline = (y == height - 1 || last) ? 0 : src_stride;
+      int prevline = (y == 0 && first) ? 0 : src_stride;
+      int nextline = (y == height - 1 && last) ? 0 : src_stride;
 
       for(x = 0; x < width; x++)
       {
@@ -254,7 +254,7 @@ static void lq2x_generic_packets(void *data,
 
       /* Workers need to know if they can access pixels 
        * outside their given buffer. */
-      thr->first = y_start;
+      thr->first = y_start == 0;
       thr->last = y_end == height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
@@ -459,7 +459,7 @@ static void phosphor2x_generic_packets(void *data,
 
       /* Workers need to know if they can access pixels 
        * outside their given buffer. */
-      thr->first = y_start;
+      thr->first = y_start == 0;
       thr->last = y_end == height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
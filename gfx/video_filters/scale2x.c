@@ -17,6 +17,7 @@
 // Compile: gcc -o scale2x.so -shared scale2x.c -std=c99 -O3 -Wall -pedantic -fPIC
 
 #include "softfilter.h"
+#include "scale2x_simd.h"
 #include <stdlib.h>
 
 #ifdef RARCH_INTERNAL
@@ -45,67 +46,66 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   scale2x_row_rgb565_t row_rgb565;
+   scale2x_row_xrgb8888_t row_xrgb8888;
 };
 
-#define SCALE2X_GENERIC(typename_t, width, height, first, last, src, src_stride, dst, dst_stride, out0, out1) \
-   for (y = 0; y < height; ++y) \
-   { \
-      const int prevline = ((y == 0) && first) ? 0 : src_stride; \
-      const int nextline = ((y == height - 1) && last) ? 0 : src_stride; \
-      \
-      for (x = 0; x < width; ++x) \
-      { \
-         const typename_t A = *(src - prevline); \
-         const typename_t B = (x > 0) ? *(src - 1) : *src; \
-         const typename_t C = *src; \
-         const typename_t D = (x < width - 1) ? *(src + 1) : *src; \
-         const typename_t E = *(src++ + nextline); \
-         \
-         if (A != E && B != D) \
-         { \
-            *out0++ = (A == B ? A : C); \
-            *out0++ = (A == D ? A : C); \
-            *out1++ = (E == B ? E : C); \
-            *out1++ = (E == D ? E : C); \
-         } \
-         else \
-         { \
-            *out0++ = C; \
-            *out0++ = C; \
-            *out1++ = C; \
-            *out1++ = C; \
-         } \
-      } \
-      \
-      src += src_stride - width; \
-      out0 += dst_stride + dst_stride - (width * SCALE2X_SCALE); \
-      out1 += dst_stride + dst_stride - (width * SCALE2X_SCALE); \
-   }
+static void scale2x_row_rgb565(uint16_t *out0, uint16_t *out1,
+      const uint16_t *up, const uint16_t *src, const uint16_t *down,
+      unsigned width)
+{
+   unsigned x;
+   for (x = 0; x < width; x++)
+      SCALE2X_PIXEL(uint16_t, x);
+}
+
+static void scale2x_row_xrgb8888(uint32_t *out0, uint32_t *out1,
+      const uint32_t *up, const uint32_t *src, const uint32_t *down,
+      unsigned width)
+{
+   unsigned x;
+   for (x = 0; x < width; x++)
+      SCALE2X_PIXEL(uint32_t, x);
+}
 
-static void scale2x_generic_rgb565(unsigned width, unsigned height,
+static void scale2x_generic_rgb565(struct filter_data *filt,
+      unsigned width, unsigned height,
       int first, int last,
       const uint16_t *src, unsigned src_stride,
       uint16_t *dst, unsigned dst_stride)
 {
-   unsigned x, y;
-   uint16_t *out0, *out1;
-   out0 = (uint16_t*)dst;
-   out1 = (uint16_t*)(dst + dst_stride);
-   SCALE2X_GENERIC(uint16_t, width, height, first, last,
-         src, src_stride, dst, dst_stride, out0, out1);
+   unsigned y;
+
+   for (y = 0; y < height; y++)
+   {
+      const uint16_t *up   = ((y == 0) && first) ? src : src - src_stride;
+      const uint16_t *down = ((y == height - 1) && last) ? src : src + src_stride;
+
+      filt->row_rgb565(dst, dst + dst_stride, up, src, down, width);
+
+      src += src_stride;
+      dst += dst_stride * SCALE2X_SCALE;
+   }
 }
 
-static void scale2x_generic_xrgb8888(unsigned width, unsigned height,
+static void scale2x_generic_xrgb8888(struct filter_data *filt,
+      unsigned width, unsigned height,
       int first, int last,
       const uint32_t *src, unsigned src_stride,
       uint32_t *dst, unsigned dst_stride)
 {
-   unsigned x, y;
-   uint32_t *out0, *out1;
-   out0 = (uint32_t*)dst;
-   out1 = (uint32_t*)(dst + dst_stride);
-   SCALE2X_GENERIC(uint32_t, width, height, first, last,
-         src, src_stride, dst, dst_stride, out0, out1);
+   unsigned y;
+
+   for (y = 0; y < height; y++)
+   {
+      const uint32_t *up   = ((y == 0) && first) ? src : src - src_stride;
+      const uint32_t *down = ((y == height - 1) && last) ? src : src + src_stride;
+
+      filt->row_xrgb8888(dst, dst + dst_stride, up, src, down, width);
+
+      src += src_stride;
+      dst += dst_stride * SCALE2X_SCALE;
+   }
 }
 
 static unsigned scale2x_generic_input_fmts(void)
@@ -140,6 +140,8 @@ static void *scale2x_generic_create(const struct softfilter_config *config,
       calloc(threads, sizeof(struct softfilter_thread_data));
    filt->threads = threads;
    filt->in_fmt  = in_fmt;
+   filt->row_rgb565   = scale2x_row_rgb565;
+   filt->row_xrgb8888 = scale2x_row_xrgb8888;
    if (!filt->workers)
    {
       free(filt);
@@ -148,6 +150,40 @@ static void *scale2x_generic_create(const struct softfilter_config *config,
    return filt;
 }
 
+#if defined(__SSE2__)
+static void *scale2x_sse2_create(const struct softfilter_config *config,
+      unsigned in_fmt, unsigned out_fmt,
+      unsigned max_width, unsigned max_height,
+      unsigned threads, softfilter_simd_mask_t simd, void *userdata)
+{
+   struct filter_data *filt = (struct filter_data*)scale2x_generic_create(
+         config, in_fmt, out_fmt, max_width, max_height,
+         threads, simd, userdata);
+   if (!filt)
+      return NULL;
+   filt->row_rgb565   = scale2x_row_rgb565_sse2;
+   filt->row_xrgb8888 = scale2x_row_xrgb8888_sse2;
+   return filt;
+}
+#endif
+
+#ifdef SCALE2X_HAVE_AVX2
+static void *scale2x_avx2_create(const struct softfilter_config *config,
+      unsigned in_fmt, unsigned out_fmt,
+      unsigned max_width, unsigned max_height,
+      unsigned threads, softfilter_simd_mask_t simd, void *userdata)
+{
+   struct filter_data *filt = (struct filter_data*)scale2x_generic_create(
+         config, in_fmt, out_fmt, max_width, max_height,
+         threads, simd, userdata);
+   if (!filt)
+      return NULL;
+   filt->row_rgb565   = scale2x_row_rgb565_avx2;
+   filt->row_xrgb8888 = scale2x_row_xrgb8888_avx2;
+   return filt;
+}
+#endif
+
 static void scale2x_generic_output(void *data,
       unsigned *out_width, unsigned *out_height,
       unsigned width, unsigned height)
@@ -176,7 +212,7 @@ static void scale2x_work_cb_xrgb8888(void *data, void *thread_data)
    unsigned width = thr->width;
    unsigned height = thr->height;
 
-   scale2x_generic_xrgb8888(width, height,
+   scale2x_generic_xrgb8888((struct filter_data*)data, width, height,
          thr->first, thr->last, input,
          thr->in_pitch / SOFTFILTER_BPP_XRGB8888,
          output,
@@ -192,7 +228,7 @@ static void scale2x_work_cb_rgb565(void *data, void *thread_data)
    unsigned width = thr->width;
    unsigned height = thr->height;
 
-   scale2x_generic_rgb565(width, height,
+   scale2x_generic_rgb565((struct filter_data*)data, width, height,
          thr->first, thr->last, input, 
          thr->in_pitch / SOFTFILTER_BPP_RGB565,
          output,
@@ -223,7 +259,7 @@ static void scale2x_generic_packets(void *data,
 
       /* Workers need to know if they can access pixels 
        * outside their given buffer. */
-      thr->first = y_start;
+      thr->first = y_start == 0;
       thr->last = y_end == height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888)
@@ -249,10 +285,52 @@ static const struct softfilter_implementation scale2x_generic = {
    "scale2x",
 };
 
+#if defined(__SSE2__)
+static const struct softfilter_implementation scale2x_sse2 = {
+   scale2x_generic_input_fmts,
+   scale2x_generic_output_fmts,
+
+   scale2x_sse2_create,
+   scale2x_generic_destroy,
+
+   scale2x_generic_threads,
+   scale2x_generic_output,
+   scale2x_generic_packets,
+   SOFTFILTER_API_VERSION,
+   "Scale2x (SSE2)",
+   "scale2x",
+};
+#endif
+
+#ifdef SCALE2X_HAVE_AVX2
+static const struct softfilter_implementation scale2x_avx2 = {
+   scale2x_generic_input_fmts,
+   scale2x_generic_output_fmts,
+
+   scale2x_avx2_create,
+   scale2x_generic_destroy,
+
+   scale2x_generic_threads,
+   scale2x_generic_output,
+   scale2x_generic_packets,
+   SOFTFILTER_API_VERSION,
+   "Scale2x (AVX2)",
+   "scale2x",
+};
+#endif
+
 const struct softfilter_implementation *softfilter_get_implementation(
       softfilter_simd_mask_t simd)
 {
    (void)simd;
+#ifdef SCALE2X_HAVE_AVX2
+   if (simd & SOFTFILTER_SIMD_AVX2)
+      return &scale2x_avx2;
+#endif
+#if defined(__SSE2__)
+   if (simd & SOFTFILTER_SIMD_SSE2)
+      return &scale2x_sse2;
+#endif
    return &scale2x_generic;
 }
 
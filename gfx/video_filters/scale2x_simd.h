@@ -0,0 +1,239 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2014 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Scale2x row kernels, shared by the Scale2x and EPX filters.
+ * EPX and Scale2x are the same algorithm, so both get the
+ * same vectorized rows.
+ *
+ * Every row function scales one input row into two output rows.
+ * up and down point at the rows above and below, which may be
+ * the row itself at the edges of the image. Pixels left and right
+ * of the row are never read, the outermost pixels are repeated.
+ *
+ * The rows are INLINE only so that files using just one of the
+ * pixel formats don't warn about the other one. They are called
+ * through pointers and never actually inlined. */
+
+#ifndef SCALE2X_SIMD_H__
+#define SCALE2X_SIMD_H__
+
+#include <stdint.h>
+#include <retro_inline.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* The AVX2 rows are built with a function-level target,
+ * so they can be picked at runtime like in a distributed build. */
+#if defined(__SSE2__) && (defined(__clang__) || \
+      (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#include <immintrin.h>
+#define SCALE2X_HAVE_AVX2
+#define SCALE2X_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+typedef void (*scale2x_row_rgb565_t)(uint16_t *out0, uint16_t *out1,
+      const uint16_t *up, const uint16_t *src, const uint16_t *down,
+      unsigned width);
+
+typedef void (*scale2x_row_xrgb8888_t)(uint32_t *out0, uint32_t *out1,
+      const uint32_t *up, const uint32_t *src, const uint32_t *down,
+      unsigned width);
+
+/* One pixel of the row, used for the ends of the vectorized rows.
+ *
+ *   A
+ * B C D
+ *   E
+ */
+#define SCALE2X_PIXEL(typename_t, x) \
+{ \
+   const typename_t A = up[x]; \
+   const typename_t B = (x > 0) ? src[x - 1] : src[x]; \
+   const typename_t C = src[x]; \
+   const typename_t D = (x < width - 1) ? src[x + 1] : src[x]; \
+   const typename_t E = down[x]; \
+   \
+   if (A != E && B != D) \
+   { \
+      out0[2 * x + 0] = (A == B ? A : C); \
+      out0[2 * x + 1] = (A == D ? A : C); \
+      out1[2 * x + 0] = (E == B ? E : C); \
+      out1[2 * x + 1] = (E == D ? E : C); \
+   } \
+   else \
+   { \
+      out0[2 * x + 0] = C; \
+      out0[2 * x + 1] = C; \
+      out1[2 * x + 0] = C; \
+      out1[2 * x + 1] = C; \
+   } \
+}
+
+#if defined(__SSE2__)
+/* Picks a where mask is set, c elsewhere. */
+#define SCALE2X_SELECT_SSE2(mask, a, c) \
+   _mm_xor_si128(c, _mm_and_si128(mask, _mm_xor_si128(a, c)))
+
+/* Scale2x on a vector of pixels. cmpeq is the compare for the pixel size,
+ * and unpacklo/unpackhi interleave two vectors of that size. */
+#define SCALE2X_VECTOR_SSE2(cmpeq, unpacklo, unpackhi, pixels, x) \
+{ \
+   const __m128i A = _mm_loadu_si128((const __m128i*)(up + x)); \
+   const __m128i B = _mm_loadu_si128((const __m128i*)(src + x - 1)); \
+   const __m128i C = _mm_loadu_si128((const __m128i*)(src + x)); \
+   const __m128i D = _mm_loadu_si128((const __m128i*)(src + x + 1)); \
+   const __m128i E = _mm_loadu_si128((const __m128i*)(down + x)); \
+   /* Lanes where A == E or B == D keep C in all four outputs. */ \
+   const __m128i keep = _mm_or_si128(cmpeq(A, E), cmpeq(B, D)); \
+   const __m128i o00 = SCALE2X_SELECT_SSE2(_mm_andnot_si128(keep, cmpeq(A, B)), A, C); \
+   const __m128i o01 = SCALE2X_SELECT_SSE2(_mm_andnot_si128(keep, cmpeq(A, D)), A, C); \
+   const __m128i o10 = SCALE2X_SELECT_SSE2(_mm_andnot_si128(keep, cmpeq(E, B)), E, C); \
+   const __m128i o11 = SCALE2X_SELECT_SSE2(_mm_andnot_si128(keep, cmpeq(E, D)), E, C); \
+   \
+   _mm_storeu_si128((__m128i*)(out0 + 2 * x), unpacklo(o00, o01)); \
+   _mm_storeu_si128((__m128i*)(out0 + 2 * x + pixels), unpackhi(o00, o01)); \
+   _mm_storeu_si128((__m128i*)(out1 + 2 * x), unpacklo(o10, o11)); \
+   _mm_storeu_si128((__m128i*)(out1 + 2 * x + pixels), unpackhi(o10, o11)); \
+}
+
+static INLINE void scale2x_row_rgb565_sse2(uint16_t *out0, uint16_t *out1,
+      const uint16_t *up, const uint16_t *src, const uint16_t *down,
+      unsigned width)
+{
+   unsigned x = 0;
+
+   while (x < width)
+   {
+      /* Vectors have to stay off the first and last pixel,
+       * their neighbours are outside the row. */
+      if (x > 0 && x + 8 < width)
+      {
+         SCALE2X_VECTOR_SSE2(_mm_cmpeq_epi16,
+               _mm_unpacklo_epi16, _mm_unpackhi_epi16, 8, x);
+         x += 8;
+      }
+      else
+      {
+         SCALE2X_PIXEL(uint16_t, x);
+         x++;
+      }
+   }
+}
+
+static INLINE void scale2x_row_xrgb8888_sse2(uint32_t *out0, uint32_t *out1,
+      const uint32_t *up, const uint32_t *src, const uint32_t *down,
+      unsigned width)
+{
+   unsigned x = 0;
+
+   while (x < width)
+   {
+      if (x > 0 && x + 4 < width)
+      {
+         SCALE2X_VECTOR_SSE2(_mm_cmpeq_epi32,
+               _mm_unpacklo_epi32, _mm_unpackhi_epi32, 4, x);
+         x += 4;
+      }
+      else
+      {
+         SCALE2X_PIXEL(uint32_t, x);
+         x++;
+      }
+   }
+}
+#endif
+
+#ifdef SCALE2X_HAVE_AVX2
+#define SCALE2X_SELECT_AVX2(mask, a, c) \
+   _mm256_xor_si256(c, _mm256_and_si256(mask, _mm256_xor_si256(a, c)))
+
+/* The AVX2 unpacks interleave within each 128-bit half,
+ * so the halves are put back in order before storing. */
+#define SCALE2X_STORE_AVX2(unpacklo, unpackhi, out, a, b, pixels) \
+{ \
+   const __m256i lo = unpacklo(a, b); \
+   const __m256i hi = unpackhi(a, b); \
+   _mm256_storeu_si256((__m256i*)(out), _mm256_permute2x128_si256(lo, hi, 0x20)); \
+   _mm256_storeu_si256((__m256i*)(out + pixels), _mm256_permute2x128_si256(lo, hi, 0x31)); \
+}
+
+#define SCALE2X_VECTOR_AVX2(cmpeq, unpacklo, unpackhi, pixels, x) \
+{ \
+   const __m256i A = _mm256_loadu_si256((const __m256i*)(up + x)); \
+   const __m256i B = _mm256_loadu_si256((const __m256i*)(src + x - 1)); \
+   const __m256i C = _mm256_loadu_si256((const __m256i*)(src + x)); \
+   const __m256i D = _mm256_loadu_si256((const __m256i*)(src + x + 1)); \
+   const __m256i E = _mm256_loadu_si256((const __m256i*)(down + x)); \
+   const __m256i keep = _mm256_or_si256(cmpeq(A, E), cmpeq(B, D)); \
+   const __m256i o00 = SCALE2X_SELECT_AVX2(_mm256_andnot_si256(keep, cmpeq(A, B)), A, C); \
+   const __m256i o01 = SCALE2X_SELECT_AVX2(_mm256_andnot_si256(keep, cmpeq(A, D)), A, C); \
+   const __m256i o10 = SCALE2X_SELECT_AVX2(_mm256_andnot_si256(keep, cmpeq(E, B)), E, C); \
+   const __m256i o11 = SCALE2X_SELECT_AVX2(_mm256_andnot_si256(keep, cmpeq(E, D)), E, C); \
+   \
+   SCALE2X_STORE_AVX2(unpacklo, unpackhi, out0 + 2 * x, o00, o01, pixels); \
+   SCALE2X_STORE_AVX2(unpacklo, unpackhi, out1 + 2 * x, o10, o11, pixels); \
+}
+
+SCALE2X_TARGET_AVX2
+static INLINE void scale2x_row_rgb565_avx2(uint16_t *out0, uint16_t *out1,
+      const uint16_t *up, const uint16_t *src, const uint16_t *down,
+      unsigned width)
+{
+   unsigned x = 0;
+
+   while (x < width)
+   {
+      if (x > 0 && x + 16 < width)
+      {
+         SCALE2X_VECTOR_AVX2(_mm256_cmpeq_epi16,
+               _mm256_unpacklo_epi16, _mm256_unpackhi_epi16, 16, x);
+         x += 16;
+      }
+      else
+      {
+         SCALE2X_PIXEL(uint16_t, x);
+         x++;
+      }
+   }
+}
+
+SCALE2X_TARGET_AVX2
+static INLINE void scale2x_row_xrgb8888_avx2(uint32_t *out0, uint32_t *out1,
+      const uint32_t *up, const uint32_t *src, const uint32_t *down,
+      unsigned width)
+{
+   unsigned x = 0;
+
+   while (x < width)
+   {
+      if (x > 0 && x + 8 < width)
+      {
+         SCALE2X_VECTOR_AVX2(_mm256_cmpeq_epi32,
+               _mm256_unpacklo_epi32, _mm256_unpackhi_epi32, 8, x);
+         x += 8;
+      }
+      else
+      {
+         SCALE2X_PIXEL(uint32_t, x);
+         x++;
+      }
+   }
+}
+#endif
+
+#endif
@@ -133,7 +133,10 @@ statement in a block (unless you're using C++). */
 /* private */
 enum { snes_ntsc_entry_size = 128 };
 enum { snes_ntsc_palette_size = 0x2000 };
-typedef unsigned long snes_ntsc_rgb_t;
+/* Only the low 32 bits of an entry are ever used. Keeping them in an
+unsigned int halves the table where long is 64 bits, and lets custom
+blitters load entries straight into 32-bit vector lanes. */
+typedef unsigned int snes_ntsc_rgb_t;
 struct snes_ntsc_t {
 	snes_ntsc_rgb_t table [snes_ntsc_palette_size] [snes_ntsc_entry_size];
 };
@@ -147,6 +147,8 @@ typedef void (*softfilter_query_output_size_t)(void *data,
  *
  * The number of elements in the array is as returned by query_num_threads.
  * The processing itself happens in worker threads after this returns.
+ * There are usually more packets than threads, so packets must not
+ * depend on each other and may run in any order.
  */
 typedef void (*softfilter_get_work_packets_t)(void *data,
       struct softfilter_work_packet *packets,
@@ -202,14 +202,18 @@ static void supertwoxsai_generic_xrgb8888(unsigned width, unsigned height,
       int first, int last, uint32_t *src, 
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
-   unsigned nextline, finish;
-   nextline = (last) ? 0 : src_stride;
+   unsigned y, nextline, finish;
 
-   for (; height; height--)
+   for (y = 0; y < height; y++)
    {
       uint32_t *in  = (uint32_t*)src;
       uint32_t *out = (uint32_t*)dst;
 
+      /* Rows which would look outside the image
+       * only look at their own row instead. */
+      nextline = ((first && y == 0) || (last && y + 2 >= height)) ?
+         0 : src_stride;
+
       for (finish = width; finish; finish -= 1)
       {
          supertwoxsai_declare_variables(uint32_t, in, nextline);
@@ -232,14 +236,18 @@ static void supertwoxsai_generic_rgb565(unsigned width, unsigned height,
       int first, int last, uint16_t *src, 
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
-   unsigned nextline, finish;
-   nextline = (last) ? 0 : src_stride;
+   unsigned y, nextline, finish;
 
-   for (; height; height--)
+   for (y = 0; y < height; y++)
    {
       uint16_t *in  = (uint16_t*)src;
       uint16_t *out = (uint16_t*)dst;
 
+      /* Rows which would look outside the image
+       * only look at their own row instead. */
+      nextline = ((first && y == 0) || (last && y + 2 >= height)) ?
+         0 : src_stride;
+
       for (finish = width; finish; finish -= 1)
       {
          supertwoxsai_declare_variables(uint16_t, in, nextline);
@@ -303,7 +311,7 @@ static void supertwoxsai_generic_packets(void *data,
       thr->height = y_end - y_start;
 
       // Workers need to know if they can access pixels outside their given buffer.
-      thr->first = y_start;
+      thr->first = y_start == 0;
       thr->last = y_end == height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
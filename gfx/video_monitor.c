@@ -74,6 +74,15 @@ void video_monitor_compute_fps_statistics(void)
 {
    double avg_fps = 0.0, stddev = 0.0;
    unsigned samples = 0;
+   double avg_error = 0.0, error_dev = 0.0;
+   retro_time_t max_error = 0;
+
+   if (video_monitor_pacing_statistics(&avg_error, &error_dev,
+            &max_error, &samples))
+   {
+      RARCH_LOG("Frame pacing error: %.1f usec average, %.1f usec deviation, %d usec worst (%u samples).\n",
+            avg_error, error_dev, (int)max_error, samples);
+   }
 
    if (g_settings.video.threaded)
    {
@@ -150,6 +159,70 @@ bool video_monitor_fps_statistics(double *refresh_rate,
    return true;
 }
 
+/**
+ * video_monitor_record_pacing_error:
+ * @usec               : how late a paced wait woke up.
+ *
+ * Records a sample for video_monitor_pacing_statistics.
+ **/
+void video_monitor_record_pacing_error(retro_time_t usec)
+{
+   unsigned write_index = 
+      g_extern.measure_data.pacing_error_samples_count++ &
+      (MEASURE_FRAME_TIME_SAMPLES_COUNT - 1);
+   g_extern.measure_data.pacing_error_samples[write_index] = usec;
+}
+
+/**
+ * video_monitor_pacing_statistics:
+ * @avg_error          : average wakeup error, in microseconds.
+ * @deviation          : standard deviation of the wakeup error.
+ * @max_error          : worst wakeup error among the samples.
+ * @sample_points      : amount of sampled points.
+ *
+ * Gets statistics on how precisely the frame limiter and
+ * frame delay met their deadlines.
+ *
+ * Returns: true (1) on success, false (0) if there are
+ * less than 2 samples.
+ **/
+bool video_monitor_pacing_statistics(double *avg_error,
+      double *deviation, retro_time_t *max_error, unsigned *sample_points)
+{
+   unsigned i;
+   double avg;
+   retro_time_t accum = 0, worst = 0;
+   double accum_var   = 0.0;
+   unsigned samples   = min(MEASURE_FRAME_TIME_SAMPLES_COUNT,
+         g_extern.measure_data.pacing_error_samples_count);
+
+   if (samples < 2)
+      return false;
+
+   for (i = 0; i < samples; i++)
+   {
+      retro_time_t error = g_extern.measure_data.pacing_error_samples[i];
+      accum += error;
+      if (error > worst)
+         worst = error;
+   }
+
+   avg = (double)accum / samples;
+
+   for (i = 0; i < samples; i++)
+   {
+      double diff = g_extern.measure_data.pacing_error_samples[i] - avg;
+      accum_var += diff * diff;
+   }
+
+   *avg_error     = avg;
+   *deviation     = sqrt(accum_var / (samples - 1));
+   *max_error     = worst;
+   *sample_points = samples;
+
+   return true;
+}
+
 #ifndef TIME_TO_FPS
 #define TIME_TO_FPS(last_time, new_time, frames) ((1000000.0f * (frames)) / ((new_time) - (last_time)))
 #endif
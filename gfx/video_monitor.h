@@ -19,6 +19,7 @@
 
 #include <boolean.h>
 #include <stddef.h>
+#include "../libretro.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -59,6 +60,30 @@ void video_monitor_compute_fps_statistics(void);
 bool video_monitor_fps_statistics(double *refresh_rate,
       double *deviation, unsigned *sample_points);
 
+/**
+ * video_monitor_record_pacing_error:
+ * @usec               : how late a paced wait woke up.
+ *
+ * Records a sample for video_monitor_pacing_statistics.
+ **/
+void video_monitor_record_pacing_error(retro_time_t usec);
+
+/**
+ * video_monitor_pacing_statistics:
+ * @avg_error          : average wakeup error, in microseconds.
+ * @deviation          : standard deviation of the wakeup error.
+ * @max_error          : worst wakeup error among the samples.
+ * @sample_points      : amount of sampled points.
+ *
+ * Gets statistics on how precisely the frame limiter and
+ * frame delay met their deadlines.
+ *
+ * Returns: true (1) on success, false (0) if there are
+ * less than 2 samples.
+ **/
+bool video_monitor_pacing_statistics(double *avg_error,
+      double *deviation, retro_time_t *max_error, unsigned *sample_points);
+
 /**
  * video_monitor_get_fps:
  * @buf           : string suitable for Window title
@@ -44,6 +44,9 @@ bool init_video_pixel_converter(unsigned size)
 
    /* TODO: Pick either ARGB8888 or RGB565 depending on driver. */
    driver.scaler.out_fmt     = SCALER_FMT_RGB565;
+#ifdef HAVE_THREADS
+   driver.scaler.pool        = driver.video_pool;
+#endif
 
    if (!scaler_ctx_gen_filter(&driver.scaler))
       return false;
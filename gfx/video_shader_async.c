@@ -0,0 +1,339 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "video_shader_async.h"
+#include "../general.h"
+#include "../file_ops.h"
+#include "../performance.h"
+#include <file/file_path.h>
+#include <rthreads/rthreads.h>
+#include <compat/strl.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Everything prepared for one shader. Written by the worker only
+ * until it sets done, afterwards by the main thread only. */
+struct shader_job
+{
+   enum rarch_shader_type type;
+   char path[PATH_MAX_LENGTH];
+
+   struct video_shader *shader;
+
+   char lut_path[GFX_MAX_TEXTURES][PATH_MAX_LENGTH];
+   struct texture_image lut[GFX_MAX_TEXTURES];
+};
+
+static struct
+{
+   sthread_t *thread;
+   slock_t *lock;
+   bool done;
+
+   /* Set while the video driver applies the job. */
+   bool applying;
+   struct shader_job job;
+
+   /* Set when a shader was applied in place meanwhile. */
+   bool cancelled;
+
+   /* Requested while the worker was busy. */
+   bool queued;
+   enum rarch_shader_type queued_type;
+   char queued_path[PATH_MAX_LENGTH];
+} shader_async;
+
+static void shader_free(struct video_shader *shader)
+{
+   unsigned i;
+
+   if (!shader)
+      return;
+
+   for (i = 0; i < shader->passes; i++)
+   {
+      free(shader->pass[i].source.string.vertex);
+      free(shader->pass[i].source.string.fragment);
+   }
+
+   free(shader->script);
+   free(shader);
+}
+
+static void shader_job_free(struct shader_job *job)
+{
+   unsigned i;
+
+   shader_free(job->shader);
+   job->shader = NULL;
+
+   for (i = 0; i < GFX_MAX_TEXTURES; i++)
+   {
+      if (job->lut[i].pixels)
+         texture_image_free(&job->lut[i]);
+      memset(&job->lut[i], 0, sizeof(job->lut[i]));
+      *job->lut_path[i] = '\0';
+   }
+}
+
+/**
+ * shader_job_parse:
+ * @job                : job to parse the shader of.
+ *
+ * Does what the shader backends do before compiling: parse the
+ * preset, resolve relative paths and parameters and, for GLSL,
+ * read the sources, which are used instead of the paths.
+ *
+ * Returns: parsed shader, or NULL if there's nothing to prepare
+ * or if it fails, in which case the backend does it again and
+ * reports the error.
+ **/
+static struct video_shader *shader_job_parse(struct shader_job *job)
+{
+   unsigned i;
+   config_file_t *conf         = NULL;
+   struct video_shader *shader = NULL;
+   const char *ext             = path_get_extension(job->path);
+
+   /* Single Cg shaders are compiled from their path. */
+   if (strcmp(ext, "glsl") && strcmp(ext, "glslp") && strcmp(ext, "cgp"))
+      return NULL;
+
+   shader = (struct video_shader*)calloc(1, sizeof(*shader));
+   if (!shader)
+      return NULL;
+
+   if (strcmp(ext, "glsl") == 0)
+   {
+      strlcpy(shader->pass[0].source.path, job->path,
+            sizeof(shader->pass[0].source.path));
+      shader->passes = 1;
+   }
+   else
+   {
+      conf = config_file_new(job->path);
+      if (!conf || !video_shader_read_conf_cgp(conf, shader))
+         goto error;
+   }
+
+   shader->modern = job->type == RARCH_SHADER_GLSL;
+
+   video_shader_resolve_relative(shader, job->path);
+   video_shader_resolve_parameters(conf, shader);
+
+   if (conf)
+      config_file_free(conf);
+   conf = NULL;
+
+   if (job->type != RARCH_SHADER_GLSL)
+      return shader;
+
+   for (i = 0; i < shader->passes; i++)
+   {
+      struct video_shader_pass *pass = &shader->pass[i];
+
+      if (read_file(pass->source.path,
+               (void**)&pass->source.string.vertex) <= 0)
+         goto error;
+
+      pass->source.string.fragment = strdup(pass->source.string.vertex);
+      if (!pass->source.string.fragment)
+         goto error;
+
+      *pass->source.path = '\0';
+   }
+
+   return shader;
+
+error:
+   if (conf)
+      config_file_free(conf);
+   shader_free(shader);
+   return NULL;
+}
+
+static void shader_async_thread(void *data)
+{
+   unsigned i;
+   struct shader_job *job = (struct shader_job*)data;
+   retro_time_t start     = rarch_get_time_usec();
+
+   job->shader = shader_job_parse(job);
+
+   /* Textures which fail to decode are left to the backend,
+    * which reports the error. */
+   for (i = 0; job->shader && i < job->shader->luts &&
+         i < GFX_MAX_TEXTURES; i++)
+   {
+      strlcpy(job->lut_path[i], job->shader->lut[i].path,
+            sizeof(job->lut_path[i]));
+      if (!texture_image_load(&job->lut[i], job->lut_path[i]))
+         memset(&job->lut[i], 0, sizeof(job->lut[i]));
+   }
+
+   RARCH_LOG("[Shader]: Prepared \"%s\" in %.1f ms.\n", job->path,
+         (rarch_get_time_usec() - start) / 1000.0);
+
+   slock_lock(shader_async.lock);
+   shader_async.done = true;
+   slock_unlock(shader_async.lock);
+}
+
+static bool shader_async_start(enum rarch_shader_type type,
+      const char *path)
+{
+   struct shader_job *job = &shader_async.job;
+
+   if (!shader_async.lock)
+      shader_async.lock = slock_new();
+
+   job->type = type;
+   strlcpy(job->path, path, sizeof(job->path));
+   shader_async.done = false;
+
+   if (shader_async.lock)
+      shader_async.thread = sthread_create(shader_async_thread, job);
+
+   if (!shader_async.thread)
+   {
+      RARCH_WARN("[Shader]: Cannot start worker, loading shader in place.\n");
+      return driver.video->set_shader(driver.video_data, type, path);
+   }
+
+   return true;
+}
+
+bool video_shader_async_load(enum rarch_shader_type type,
+      const char *path)
+{
+   if (!driver.video || !driver.video->set_shader)
+      return false;
+
+   if (shader_async.thread)
+   {
+      shader_async.queued      = true;
+      shader_async.queued_type = type;
+      strlcpy(shader_async.queued_path, path,
+            sizeof(shader_async.queued_path));
+      return true;
+   }
+
+   return shader_async_start(type, path);
+}
+
+void video_shader_async_poll(void)
+{
+   bool done;
+
+   if (!shader_async.thread)
+      return;
+
+   slock_lock(shader_async.lock);
+   done = shader_async.done;
+   slock_unlock(shader_async.lock);
+
+   if (!done)
+      return;
+
+   sthread_join(shader_async.thread);
+   shader_async.thread = NULL;
+
+   /* A newer shader was asked for or applied, this one is
+    * stale already. */
+   if (shader_async.queued || shader_async.cancelled)
+   {
+      shader_async.cancelled = false;
+      shader_job_free(&shader_async.job);
+
+      if (shader_async.queued)
+      {
+         shader_async.queued = false;
+         shader_async_start(shader_async.queued_type,
+               shader_async.queued_path);
+      }
+      return;
+   }
+
+   if (driver.video && driver.video->set_shader)
+   {
+      shader_async.applying = true;
+      if (!driver.video->set_shader(driver.video_data,
+               shader_async.job.type, shader_async.job.path))
+         RARCH_WARN("Failed to apply shader.\n");
+      shader_async.applying = false;
+   }
+
+   shader_job_free(&shader_async.job);
+}
+
+void video_shader_async_cancel(void)
+{
+   shader_async.queued = false;
+
+   if (shader_async.thread)
+      shader_async.cancelled = true;
+}
+
+void video_shader_async_deinit(void)
+{
+   if (shader_async.thread)
+      sthread_join(shader_async.thread);
+   shader_async.thread    = NULL;
+   shader_async.queued    = false;
+   shader_async.cancelled = false;
+
+   shader_job_free(&shader_async.job);
+
+   if (shader_async.lock)
+      slock_free(shader_async.lock);
+   shader_async.lock = NULL;
+}
+
+struct video_shader *video_shader_async_take_shader(const char *path)
+{
+   struct video_shader *shader = NULL;
+
+   if (!shader_async.applying || !path ||
+         strcmp(path, shader_async.job.path))
+      return NULL;
+
+   shader = shader_async.job.shader;
+   shader_async.job.shader = NULL;
+   return shader;
+}
+
+bool video_shader_async_take_lut(const char *path,
+      struct texture_image *img)
+{
+   unsigned i;
+
+   if (!shader_async.applying)
+      return false;
+
+   for (i = 0; i < GFX_MAX_TEXTURES; i++)
+   {
+      struct texture_image *lut = &shader_async.job.lut[i];
+
+      if (!lut->pixels || strcmp(path, shader_async.job.lut_path[i]))
+         continue;
+
+      *img = *lut;
+      memset(lut, 0, sizeof(*lut));
+      return true;
+   }
+
+   return false;
+}
@@ -0,0 +1,103 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __VIDEO_SHADER_ASYNC_H
+#define __VIDEO_SHADER_ASYNC_H
+
+#include <boolean.h>
+#include "video_shader_parse.h"
+#include "image/image.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Shaders are switched in two steps. A worker thread parses the
+ * preset, reads the sources of GLSL passes and decodes the lookup
+ * textures. Meanwhile the old shader keeps rendering. Once the
+ * worker is done, video_shader_async_poll() calls the video
+ * driver's set_shader() between two frames, where the shader
+ * backend takes the prepared data instead of loading it again. */
+
+/**
+ * video_shader_async_load:
+ * @type               : shader type.
+ * @path               : path to shader or preset.
+ *
+ * Starts preparing a shader in the background. If another one
+ * is still being prepared, it's dropped once it's done and
+ * this one is prepared instead.
+ *
+ * Returns: true if the shader will be applied, otherwise false.
+ **/
+bool video_shader_async_load(enum rarch_shader_type type,
+      const char *path);
+
+/**
+ * video_shader_async_poll:
+ *
+ * Applies the shader which has been prepared, if any.
+ * Call once per frame from the main thread.
+ **/
+void video_shader_async_poll(void);
+
+/**
+ * video_shader_async_cancel:
+ *
+ * Drops the shader being prepared, if any, and any queued one.
+ * Call before applying a shader with the video driver's
+ * set_shader() directly, so a slower background load doesn't
+ * replace it later on.
+ **/
+void video_shader_async_cancel(void);
+
+/**
+ * video_shader_async_deinit:
+ *
+ * Waits for the worker and drops whatever it prepared.
+ **/
+void video_shader_async_deinit(void);
+
+/**
+ * video_shader_async_take_shader:
+ * @path               : path the shader backend was asked to load.
+ *
+ * Only for shader backends, from within their init().
+ *
+ * Returns: the parsed shader for @path, with relative paths and
+ * parameters resolved, or NULL if none was prepared. The caller
+ * owns it. GLSL passes have their source strings loaded already.
+ **/
+struct video_shader *video_shader_async_take_shader(const char *path);
+
+/**
+ * video_shader_async_take_lut:
+ * @path               : path of the lookup texture.
+ * @img                : image to move the decoded texture into.
+ *
+ * Only for shader backends, while loading lookup textures.
+ *
+ * Returns: true if @path has been decoded already, in which case
+ * @img has to be freed with texture_image_free().
+ **/
+bool video_shader_async_take_lut(const char *path,
+      struct texture_image *img);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
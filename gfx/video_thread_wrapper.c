@@ -83,6 +83,36 @@ static void thread_update_driver_state(thread_video_t *thr)
    }
 }
 
+/**
+ * thread_take_frame:
+ * @thr                       : Threaded video handle.
+ *
+ * Picks up the waiting frame on the video thread.
+ * Must be called with thr->lock held.
+ **/
+static void thread_take_frame(thread_video_t *thr)
+{
+   if (thr->frame.swap)
+   {
+      unsigned render   = thr->frame.render;
+      thr->frame.render = thr->frame.ready;
+      thr->frame.ready  = render;
+      thr->frame.swap   = false;
+      thr->hit_count++;
+   }
+
+   thr->frame.render_width  = thr->frame.width;
+   thr->frame.render_height = thr->frame.height;
+   thr->frame.render_pitch  = thr->frame.pitch;
+   strlcpy(thr->frame.render_msg, thr->frame.msg,
+         sizeof(thr->frame.render_msg));
+
+   thr->frame.updated = false;
+
+   /* The main thread might be waiting to hand over the next one. */
+   scond_signal(thr->cond_cmd);
+}
+
 static void thread_loop(void *data)
 {
    thread_video_t *thr = (thread_video_t*)data;
@@ -99,7 +129,10 @@ static void thread_loop(void *data)
       while (thr->send_cmd == CMD_NONE && !thr->frame.updated)
          scond_wait(thr->cond_thread, thr->lock);
       if (thr->frame.updated)
+      {
+         thread_take_frame(thr);
          updated = true;
+      }
 
       /* To avoid race condition where send_cmd is updated 
        * right after the switch is checked. */
@@ -314,8 +347,10 @@ static void thread_loop(void *data)
 
          if (thr->driver && thr->driver->frame)
             ret = thr->driver->frame(thr->driver_data,
-               thr->frame.buffer, thr->frame.width, thr->frame.height,
-               thr->frame.pitch, *thr->frame.msg ? thr->frame.msg : NULL);
+               thr->frame.buffer[thr->frame.render],
+               thr->frame.render_width, thr->frame.render_height,
+               thr->frame.render_pitch,
+               *thr->frame.render_msg ? thr->frame.render_msg : NULL);
 
          slock_unlock(thr->frame.lock);
 
@@ -335,7 +370,6 @@ static void thread_loop(void *data)
          thr->alive = alive;
          thr->focus = focus;
          thr->has_windowed = has_windowed;
-         thr->frame.updated = false;
          thr->vp = vp;
          scond_signal(thr->cond_cmd);
          slock_unlock(thr->lock);
@@ -442,7 +476,22 @@ static bool thread_frame(void *data, const void *frame_,
          ? sizeof(uint32_t) : sizeof(uint16_t));
 
    src = (const uint8_t*)frame_;
-   dst = thr->frame.buffer;
+   dst = thr->frame.buffer[thr->frame.write];
+
+   /* The video thread never touches buffer[write], so it is filled
+    * without holding the lock. Cores which rendered straight into it
+    * don't need a copy at all. */
+   if (src == dst)
+   {
+      copy_stride = pitch;
+      thr->direct_count++;
+   }
+   else if (src)
+   {
+      unsigned h;
+      for (h = 0; h < height; h++, src += pitch, dst += copy_stride)
+         memcpy(dst, src, copy_stride);
+   }
 
    slock_lock(thr->lock);
 
@@ -452,54 +501,56 @@ static bool thread_frame(void *data, const void *frame_,
          roundf(1000000LL / g_settings.video.refresh_rate);
       retro_time_t target = thr->last_time + target_frame_time;
 
-      /* Ideally, use absolute time, but that is only a good idea on POSIX. */
+      /* The video thread signals cond_cmd when it takes the frame,
+       * so wait for that or the deadline, whichever comes first.
+       * The wait can overshoot the deadline by the scheduler's
+       * wakeup latency, which is cheaper than spinning for it. */
       while (thr->frame.updated)
       {
-         retro_time_t current = rarch_get_time_usec();
-         retro_time_t delta = target - current;
+         retro_time_t delta = target - rarch_get_time_usec();
 
          if (delta <= 0)
             break;
 
-         if (!scond_wait_timeout(thr->cond_cmd, thr->lock, delta))
-            break;
+         scond_wait_timeout(thr->cond_cmd, thr->lock, delta);
       }
    }
 
-   /* Drop frame if updated flag is still set, as thread is 
-    * still working on last frame. */
-   if (!thr->frame.updated)
+   if (frame_)
    {
-      if (src)
-      {
-         unsigned h;
-         for (h = 0; h < height; h++, src += pitch, dst += copy_stride)
-            memcpy(dst, src, copy_stride);
-      }
+      unsigned ready;
+
+      /* Replace the waiting frame if the video thread is
+       * still busy with an earlier one. */
+      if (thr->frame.updated && thr->frame.swap)
+         thr->miss_count++;
 
-      thr->frame.updated = true;
-      thr->frame.width  = width;
-      thr->frame.height = height;
-      thr->frame.pitch  = copy_stride;
+      ready             = thr->frame.ready;
+      thr->frame.ready  = thr->frame.write;
+      thr->frame.write  = ready;
+      thr->frame.swap   = true;
+   }
+
+   /* Without a new frame, the video thread redraws the last one. */
+   thr->frame.updated = true;
+   thr->frame.width   = width;
+   thr->frame.height  = height;
+   thr->frame.pitch   = copy_stride;
 
-      if (msg)
-         strlcpy(thr->frame.msg, msg, sizeof(thr->frame.msg));
-      else
-         *thr->frame.msg = '\0';
+   if (msg)
+      strlcpy(thr->frame.msg, msg, sizeof(thr->frame.msg));
+   else
+      *thr->frame.msg = '\0';
 
-      scond_signal(thr->cond_thread);
+   scond_signal(thr->cond_thread);
 
 #if defined(HAVE_MENU)
-      if (thr->texture.enable)
-      {
-         while (thr->frame.updated)
-            scond_wait(thr->cond_cmd, thr->lock);
-      }
-#endif
-      thr->hit_count++;
+   if (thr->texture.enable)
+   {
+      while (thr->frame.updated)
+         scond_wait(thr->cond_cmd, thr->lock);
    }
-   else
-      thr->miss_count++;
+#endif
 
    slock_unlock(thr->lock);
 
@@ -519,6 +570,7 @@ static void thread_set_nonblock_state(void *data, bool state)
 static bool thread_init(thread_video_t *thr, const video_info_t *info,
       const input_driver_t **input, void **input_data)
 {
+   unsigned i;
    size_t max_size;
 
    thr->lock = slock_new();
@@ -537,11 +589,20 @@ static bool thread_init(thread_video_t *thr, const video_info_t *info,
    max_size = info->input_scale * RARCH_SCALE_BASE;
    max_size *= max_size;
    max_size *= info->rgb32 ? sizeof(uint32_t) : sizeof(uint16_t);
-   thr->frame.buffer = (uint8_t*)malloc(max_size);
-   if (!thr->frame.buffer)
-      return false;
 
-   memset(thr->frame.buffer, 0x80, max_size);
+   for (i = 0; i < ARRAY_SIZE(thr->frame.buffer); i++)
+   {
+      thr->frame.buffer[i] = (uint8_t*)malloc(max_size);
+      if (!thr->frame.buffer[i])
+         return false;
+
+      memset(thr->frame.buffer[i], 0x80, max_size);
+   }
+
+   thr->frame.size   = max_size;
+   thr->frame.write  = 0;
+   thr->frame.ready  = 1;
+   thr->frame.render = 2;
 
    thr->last_time = rarch_get_time_usec();
 
@@ -621,6 +682,7 @@ static bool thread_read_viewport(void *data, uint8_t *buffer)
 
 static void thread_free(void *data)
 {
+   unsigned i;
    thread_video_t *thr = (thread_video_t*)data;
    if (!thr)
       return;
@@ -632,7 +694,8 @@ static void thread_free(void *data)
 #if defined(HAVE_MENU)
    free(thr->texture.frame);
 #endif
-   free(thr->frame.buffer);
+   for (i = 0; i < ARRAY_SIZE(thr->frame.buffer); i++)
+      free(thr->frame.buffer[i]);
    slock_free(thr->frame.lock);
    slock_free(thr->lock);
    scond_free(thr->cond_cmd);
@@ -641,8 +704,9 @@ static void thread_free(void *data)
    free(thr->alpha_mod);
    slock_free(thr->alpha_lock);
 
-   RARCH_LOG("Threaded video stats: Frames pushed: %u, Frames dropped: %u.\n",
-         thr->hit_count, thr->miss_count);
+   RARCH_LOG("Threaded video stats: Frames pushed: %u, Frames dropped: %u, "
+         "Rendered directly: %u.\n",
+         thr->hit_count, thr->miss_count, thr->direct_count);
 
    free(thr);
 }
@@ -849,6 +913,32 @@ static struct video_shader *thread_get_current_shader(void *data)
    return thr->poke->get_current_shader(thr->driver_data);
 }
 
+/* Hands out the buffer the next frame will be copied into,
+ * so a core can render there and skip the copy. */
+static bool thread_get_current_software_framebuffer(void *data,
+      struct retro_framebuffer *framebuffer)
+{
+   size_t pitch;
+   thread_video_t *thr = (thread_video_t*)data;
+
+   if (!thr || thr->frame.within_thread)
+      return false;
+
+   pitch = framebuffer->width *
+      (thr->info.rgb32 ? sizeof(uint32_t) : sizeof(uint16_t));
+
+   if (pitch * framebuffer->height > thr->frame.size)
+      return false;
+
+   framebuffer->data         = thr->frame.buffer[thr->frame.write];
+   framebuffer->pitch        = pitch;
+   framebuffer->format       = thr->info.rgb32 ?
+      RETRO_PIXEL_FORMAT_XRGB8888 : RETRO_PIXEL_FORMAT_RGB565;
+   framebuffer->memory_flags = RETRO_MEMORY_TYPE_CACHED;
+
+   return true;
+}
+
 static const video_poke_interface_t thread_poke = {
    thread_set_filtering,
 #ifdef HAVE_FBO
@@ -867,6 +957,7 @@ static const video_poke_interface_t thread_poke = {
    NULL,
 
    thread_get_current_shader,
+   thread_get_current_software_framebuffer,
 };
 
 static void thread_get_poke_interface(void *data,
@@ -977,3 +1068,19 @@ void *rarch_threaded_video_resolve(const video_driver_t **drv)
    return thr->driver_data;
 }
 
+bool rarch_threaded_video_get_stats(struct rarch_threaded_video_stats *stats)
+{
+   thread_video_t *thr = (thread_video_t*)driver.video_data;
+
+   if (!thr || !driver.video || driver.video->frame != thread_frame)
+      return false;
+
+   slock_lock(thr->lock);
+   stats->frames  = thr->hit_count;
+   stats->dropped = thr->miss_count;
+   slock_unlock(thr->lock);
+
+   stats->direct  = thr->direct_count;
+
+   return true;
+}
@@ -98,6 +98,7 @@ typedef struct thread_video
    retro_time_t last_time;
    unsigned hit_count;
    unsigned miss_count;
+   unsigned direct_count;
 
    float *alpha_mod;
    unsigned alpha_mods;
@@ -174,13 +175,34 @@ typedef struct thread_video
    struct
    {
       slock_t *lock;
-      uint8_t *buffer;
+
+      /* Triple buffered. The main thread fills buffer[write] without
+       * holding any lock, then swaps it with buffer[ready]. The video
+       * thread swaps buffer[ready] with buffer[render] when it picks
+       * up a frame, so neither side ever waits for a free buffer. */
+      uint8_t *buffer[3];
+      size_t size;
+      unsigned write;
+      unsigned ready;
+      unsigned render;
+
+      /* Describe the last frame handed over. Copied to
+       * the render_* fields when the video thread picks it up. */
       unsigned width;
       unsigned height;
       unsigned pitch;
+      char msg[PATH_MAX_LENGTH];
+
+      unsigned render_width;
+      unsigned render_height;
+      unsigned render_pitch;
+      char render_msg[PATH_MAX_LENGTH];
+
+      /* A frame is waiting for the video thread. */
       bool updated;
+      /* ... and it is in buffer[ready], not a redraw of buffer[render]. */
+      bool swap;
       bool within_thread;
-      char msg[PATH_MAX_LENGTH];
    } frame;
 
    video_driver_t video_thread;
@@ -206,6 +228,27 @@ bool rarch_threaded_video_init(
       const input_driver_t **input, void **input_data,
       const video_driver_t *driver, const video_info_t *info);
 
+struct rarch_threaded_video_stats
+{
+   /* Frames picked up by the video thread. */
+   unsigned frames;
+   /* Frames replaced by a newer one before the video thread
+    * got to them. */
+   unsigned dropped;
+   /* Frames the core rendered straight into a buffer from
+    * RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER. */
+   unsigned direct;
+};
+
+/**
+ * rarch_threaded_video_get_stats:
+ * @stats                     : Filled in with the current counts.
+ *
+ * Returns: true (1) if the threaded video wrapper is in use,
+ * otherwise false (0).
+ **/
+bool rarch_threaded_video_get_stats(struct rarch_threaded_video_stats *stats);
+
 /**
  * rarch_threaded_video_resolve:
  * @drv                       : Found driver.
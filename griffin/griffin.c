@@ -645,8 +645,12 @@ THREAD
 #include "../thread/xenon_sdl_threads.c"
 #elif defined(HAVE_THREADS)
 #include "../libretro-sdk/rthreads/rthreads.c"
+#include "../libretro-sdk/rthreads/task_pool.c"
+#include "../libretro-sdk/queues/fifo_spsc.c"
 #include "../gfx/video_thread_wrapper.c"
+#include "../gfx/video_shader_async.c"
 #include "../audio/audio_thread_wrapper.c"
+#include "../audio/audio_dsp_thread.c"
 #include "../autosave.c"
 #endif
 
@@ -74,6 +74,7 @@
 #define RETRO_LBL_DISK_NEXT "Disk Swap Next"
 #define RETRO_LBL_DISK_PREV "Disk Swap Previous"
 #define RETRO_LBL_GRAB_MOUSE_TOGGLE "Grab mouse toggle"
+#define RETRO_LBL_REWIND_SEEK "Rewind seek"
 #define RETRO_LBL_MENU_TOGGLE "Menu toggle"
 
 #define TERM_STR "\n"
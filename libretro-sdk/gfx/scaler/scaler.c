@@ -29,6 +29,13 @@
 #include <stdio.h>
 #include <math.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/task_pool.h>
+#endif
+
+/* Smallest amount of rows worth handing to another thread. */
+#define SCALER_BAND_HEIGHT 16
+
 /* In case aligned allocs are needed later. */
 
 /**
@@ -211,9 +218,33 @@ static bool set_pix_conv(struct scaler_ctx *ctx)
    return true;
 }
 
+static void scaler_ctx_free_frames(struct scaler_ctx *ctx)
+{
+   scaler_free(ctx->scaled.frame);
+   scaler_free(ctx->input.frame);
+   scaler_free(ctx->output.frame);
+
+   memset(&ctx->scaled, 0, sizeof(ctx->scaled));
+   memset(&ctx->input, 0, sizeof(ctx->input));
+   memset(&ctx->output, 0, sizeof(ctx->output));
+}
+
+/**
+ * scaler_ctx_gen_filter:
+ * @ctx          : pointer to scaler context object.
+ *
+ * Sets up the context for its current formats and geometry.
+ * Filters made for a geometry used before are taken from the
+ * context's filter cache.
+ *
+ * Returns: true if successful, otherwise false.
+ **/
 bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
 {
-   scaler_ctx_gen_reset(ctx);
+   /* The filters stay in the cache. */
+   scaler_ctx_free_frames(ctx);
+   memset(&ctx->horiz, 0, sizeof(ctx->horiz));
+   memset(&ctx->vert, 0, sizeof(ctx->vert));
 
    if (ctx->in_width == ctx->out_width && ctx->in_height == ctx->out_height)
       ctx->unscaled = true; /* Only pixel format conversion ... */
@@ -221,6 +252,13 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
    {
       ctx->scaler_horiz = scaler_argb8888_horiz;
       ctx->scaler_vert  = scaler_argb8888_vert;
+#ifdef SCALER_HAVE_AVX2
+      if (scaler_cpu_has_avx2())
+      {
+         ctx->scaler_horiz = scaler_argb8888_horiz_avx2;
+         ctx->scaler_vert  = scaler_argb8888_vert_avx2;
+      }
+#endif
       ctx->unscaled     = false;
    }
 
@@ -246,21 +284,135 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
    return true;
 }
 
+/**
+ * scaler_ctx_gen_reset:
+ * @ctx          : pointer to scaler context object.
+ *
+ * Frees everything allocated by scaler_ctx_gen_filter(),
+ * including the filter cache.
+ **/
 void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
 {
-   scaler_free(ctx->horiz.filter);
-   scaler_free(ctx->horiz.filter_pos);
-   scaler_free(ctx->vert.filter);
-   scaler_free(ctx->vert.filter_pos);
-   scaler_free(ctx->scaled.frame);
-   scaler_free(ctx->input.frame);
-   scaler_free(ctx->output.frame);
+   scaler_filter_cache_free(ctx);
+   scaler_ctx_free_frames(ctx);
 
    memset(&ctx->horiz, 0, sizeof(ctx->horiz));
    memset(&ctx->vert, 0, sizeof(ctx->vert));
-   memset(&ctx->scaled, 0, sizeof(ctx->scaled));
-   memset(&ctx->input, 0, sizeof(ctx->input));
-   memset(&ctx->output, 0, sizeof(ctx->output));
+}
+
+enum scaler_pass
+{
+   SCALER_PASS_DIRECT = 0,
+   SCALER_PASS_IN,
+   SCALER_PASS_HORIZ,
+   SCALER_PASS_VERT,
+   SCALER_PASS_OUT
+};
+
+struct scaler_band_job
+{
+   const struct scaler_ctx *ctx;
+   enum scaler_pass pass;
+   void *output;
+   const void *input;
+   int out_stride;
+   int in_stride;
+   int rows;
+   unsigned bands;
+};
+
+/* Every row of a pass only depends on rows of the previous pass,
+ * so each pass is split into bands, which are run by passing a
+ * copy of the context with the row setup moved to the band. */
+static void scaler_band(void *data, unsigned index)
+{
+   const struct scaler_band_job *job = (const struct scaler_band_job*)data;
+   const struct scaler_ctx *ctx      = job->ctx;
+   int first  = (int)((int64_t)job->rows * index / job->bands);
+   int last   = (int)((int64_t)job->rows * (index + 1) / job->bands);
+   uint8_t *output      = (uint8_t*)job->output;
+   const uint8_t *input = (const uint8_t*)job->input;
+   struct scaler_ctx band;
+
+   switch (job->pass)
+   {
+      case SCALER_PASS_DIRECT:
+         ctx->direct_pixconv(output + first * job->out_stride,
+               input + first * job->in_stride,
+               ctx->out_width, last - first,
+               job->out_stride, job->in_stride);
+         break;
+
+      case SCALER_PASS_IN:
+         ctx->in_pixconv(output + first * job->out_stride,
+               input + first * job->in_stride,
+               ctx->in_width, last - first,
+               job->out_stride, job->in_stride);
+         break;
+
+      case SCALER_PASS_HORIZ:
+         band               = *ctx;
+         band.scaled.frame  = ctx->scaled.frame +
+            first * (ctx->scaled.stride >> 3);
+         band.scaled.height = last - first;
+         ctx->scaler_horiz(&band, input + first * job->in_stride,
+               job->in_stride);
+         break;
+
+      case SCALER_PASS_VERT:
+         band                 = *ctx;
+         band.vert.filter     = ctx->vert.filter +
+            first * ctx->vert.filter_stride;
+         band.vert.filter_pos = ctx->vert.filter_pos + first;
+         band.out_height      = last - first;
+         ctx->scaler_vert(&band, output + first * job->out_stride,
+               job->out_stride);
+         break;
+
+      case SCALER_PASS_OUT:
+         ctx->out_pixconv(output + first * job->out_stride,
+               input + first * job->in_stride,
+               ctx->out_width, last - first,
+               job->out_stride, job->in_stride);
+         break;
+   }
+}
+
+static void scaler_run_pass(const struct scaler_ctx *ctx,
+      enum scaler_pass pass, int rows,
+      void *output, int out_stride,
+      const void *input, int in_stride)
+{
+   struct scaler_band_job job;
+
+   job.ctx        = ctx;
+   job.pass       = pass;
+   job.output     = output;
+   job.input      = input;
+   job.out_stride = out_stride;
+   job.in_stride  = in_stride;
+   job.rows       = rows;
+   job.bands      = 1;
+
+#ifdef HAVE_THREADS
+   if (ctx->pool)
+   {
+      /* A few bands per thread to even out the load. */
+      unsigned max_bands = task_pool_threads(ctx->pool) * 4;
+
+      job.bands = rows / SCALER_BAND_HEIGHT;
+      if (job.bands > max_bands)
+         job.bands = max_bands;
+      if (job.bands > 1)
+      {
+         task_pool_run(ctx->pool, scaler_band, &job, job.bands);
+         return;
+      }
+      job.bands = 1;
+   }
+#endif
+
+   scaler_band(&job, 0);
 }
 
 /**
@@ -282,17 +434,15 @@ void scaler_ctx_scale(struct scaler_ctx *ctx,
    if (ctx->unscaled)
    {
       /* Just perform straight pixel conversion. */
-      ctx->direct_pixconv(output, input,
-            ctx->out_width, ctx->out_height,
-            ctx->out_stride, ctx->in_stride);
+      scaler_run_pass(ctx, SCALER_PASS_DIRECT, ctx->out_height,
+            output, ctx->out_stride, input, ctx->in_stride);
       return;
    }
 
    if (ctx->in_fmt != SCALER_FMT_ARGB8888)
    {
-      ctx->in_pixconv(ctx->input.frame, input,
-            ctx->in_width, ctx->in_height,
-            ctx->input.stride, ctx->in_stride);
+      scaler_run_pass(ctx, SCALER_PASS_IN, ctx->in_height,
+            ctx->input.frame, ctx->input.stride, input, ctx->in_stride);
 
       input_frame       = ctx->input.frame;
       input_stride      = ctx->input.stride;
@@ -315,13 +465,13 @@ void scaler_ctx_scale(struct scaler_ctx *ctx,
    else
    {
       /* Take generic filter path. */
-      ctx->scaler_horiz(ctx, input_frame, input_stride);
-      ctx->scaler_vert (ctx, output, output_stride);
+      scaler_run_pass(ctx, SCALER_PASS_HORIZ, ctx->scaled.height,
+            NULL, 0, input_frame, input_stride);
+      scaler_run_pass(ctx, SCALER_PASS_VERT, ctx->out_height,
+            output_frame, output_stride, NULL, 0);
    }
 
    if (ctx->out_fmt != SCALER_FMT_ARGB8888)
-      ctx->out_pixconv(output, ctx->output.frame,
-            ctx->out_width, ctx->out_height,
-            ctx->out_stride, ctx->output.stride);
+      scaler_run_pass(ctx, SCALER_PASS_OUT, ctx->out_height,
+            output, ctx->out_stride, ctx->output.frame, ctx->output.stride);
 }
-
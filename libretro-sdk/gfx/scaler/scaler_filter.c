@@ -25,8 +25,45 @@
 #include <retro_miscellaneous.h>
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+/* Number of geometries whose filters are kept around. */
+#define SCALER_FILTER_CACHE_SIZE 4
+
+struct scaler_filter_cache_entry
+{
+   int in_width;
+   int in_height;
+   int out_width;
+   int out_height;
+   enum scaler_type scaler_type;
+
+   struct scaler_filter horiz, vert;
+   void (*scaler_special)(const struct scaler_ctx*,
+         void*, const void*, int, int, int, int, int, int);
+
+   unsigned last_use;
+};
+
+struct scaler_filter_cache
+{
+   struct scaler_filter_cache_entry entries[SCALER_FILTER_CACHE_SIZE];
+   unsigned use_count;
+};
+
+static void free_filters(struct scaler_filter *horiz,
+      struct scaler_filter *vert)
+{
+   scaler_free(horiz->filter);
+   scaler_free(horiz->filter_pos);
+   scaler_free(vert->filter);
+   scaler_free(vert->filter_pos);
+
+   memset(horiz, 0, sizeof(*horiz));
+   memset(vert, 0, sizeof(*vert));
+}
+
 static bool allocate_filters(struct scaler_ctx *ctx)
 {
    ctx->horiz.filter     = (int16_t*)scaler_alloc(sizeof(int16_t), ctx->horiz.filter_stride * ctx->out_width);
@@ -35,7 +72,8 @@ static bool allocate_filters(struct scaler_ctx *ctx)
    ctx->vert.filter      = (int16_t*)scaler_alloc(sizeof(int16_t), ctx->vert.filter_stride * ctx->out_height);
    ctx->vert.filter_pos  = (int*)scaler_alloc(sizeof(int), ctx->out_height);
 
-   return ctx->horiz.filter && ctx->vert.filter;
+   return ctx->horiz.filter && ctx->horiz.filter_pos &&
+      ctx->vert.filter && ctx->vert.filter_pos;
 }
 
 static void gen_filter_point_sub(struct scaler_filter *filter,
@@ -254,7 +292,7 @@ static void fixup_filter(struct scaler_ctx *ctx)
 }
 
 
-bool scaler_gen_filter(struct scaler_ctx *ctx)
+static bool gen_filter(struct scaler_ctx *ctx)
 {
    bool ret = true;
 
@@ -284,3 +322,94 @@ bool scaler_gen_filter(struct scaler_ctx *ctx)
    return validate_filter(ctx);
 }
 
+static struct scaler_filter_cache_entry *find_filter(
+      struct scaler_filter_cache *cache, const struct scaler_ctx *ctx)
+{
+   unsigned i;
+
+   for (i = 0; i < SCALER_FILTER_CACHE_SIZE; i++)
+   {
+      struct scaler_filter_cache_entry *entry = &cache->entries[i];
+
+      if (entry->horiz.filter
+            && entry->in_width    == ctx->in_width
+            && entry->in_height   == ctx->in_height
+            && entry->out_width   == ctx->out_width
+            && entry->out_height  == ctx->out_height
+            && entry->scaler_type == ctx->scaler_type)
+         return entry;
+   }
+
+   return NULL;
+}
+
+/* Takes an empty entry, or else the one used longest ago. */
+static struct scaler_filter_cache_entry *evict_filter(
+      struct scaler_filter_cache *cache)
+{
+   unsigned i;
+   struct scaler_filter_cache_entry *entry = &cache->entries[0];
+
+   for (i = 1; i < SCALER_FILTER_CACHE_SIZE && entry->horiz.filter; i++)
+   {
+      if (!cache->entries[i].horiz.filter
+            || cache->entries[i].last_use < entry->last_use)
+         entry = &cache->entries[i];
+   }
+
+   free_filters(&entry->horiz, &entry->vert);
+   return entry;
+}
+
+bool scaler_gen_filter(struct scaler_ctx *ctx)
+{
+   struct scaler_filter_cache_entry *entry = NULL;
+
+   if (!ctx->filter_cache)
+      ctx->filter_cache = (struct scaler_filter_cache*)
+         calloc(1, sizeof(*ctx->filter_cache));
+   if (!ctx->filter_cache)
+      return false;
+
+   entry = find_filter(ctx->filter_cache, ctx);
+   if (!entry)
+   {
+      if (!gen_filter(ctx))
+      {
+         free_filters(&ctx->horiz, &ctx->vert);
+         return false;
+      }
+
+      entry                 = evict_filter(ctx->filter_cache);
+      entry->in_width       = ctx->in_width;
+      entry->in_height      = ctx->in_height;
+      entry->out_width      = ctx->out_width;
+      entry->out_height     = ctx->out_height;
+      entry->scaler_type    = ctx->scaler_type;
+      entry->horiz          = ctx->horiz;
+      entry->vert           = ctx->vert;
+      entry->scaler_special = ctx->scaler_special;
+   }
+
+   entry->last_use     = ++ctx->filter_cache->use_count;
+   ctx->horiz          = entry->horiz;
+   ctx->vert           = entry->vert;
+   ctx->scaler_special = entry->scaler_special;
+
+   return true;
+}
+
+void scaler_filter_cache_free(struct scaler_ctx *ctx)
+{
+   unsigned i;
+
+   if (!ctx->filter_cache)
+      return;
+
+   for (i = 0; i < SCALER_FILTER_CACHE_SIZE; i++)
+      free_filters(&ctx->filter_cache->entries[i].horiz,
+            &ctx->filter_cache->entries[i].vert);
+
+   free(ctx->filter_cache);
+   ctx->filter_cache = NULL;
+}
@@ -21,6 +21,7 @@
  */
 
 #include <gfx/scaler/scaler_int.h>
+#include <retro_inline.h>
 
 #ifdef SCALER_NO_SIMD
 #undef __SSE2__
@@ -28,6 +29,9 @@
 
 #if defined(__SSE2__)
 #include <emmintrin.h>
+#ifdef SCALER_HAVE_AVX2
+#include <immintrin.h>
+#endif
 #ifdef _WIN32
 #include <intrin.h>
 #endif
@@ -51,9 +55,42 @@
 // The C version of scalers perform the exact same operations as the SIMD code for testing purposes.
 
 #if defined(__SSE2__)
+/* Both taps of a pair go to their own half of the vector,
+ * the halves are only added at the end. */
+static INLINE uint32_t scaler_argb8888_vert_pixel(const struct scaler_ctx *ctx,
+      const int16_t *filter_vert, const uint64_t *input_base_y)
+{
+   int y;
+   __m128i res = _mm_setzero_si128();
+   __m128i final;
+
+   for (y = 0; (y + 1) < ctx->vert.filter_len; y += 2, input_base_y += (ctx->scaled.stride >> 2))
+   {
+      __m128i coeff = _mm_set_epi64x((uint16_t)filter_vert[y + 1] * 0x0001000100010001ull, (uint16_t)filter_vert[y + 0] * 0x0001000100010001ull);
+      __m128i col   = _mm_set_epi64x(input_base_y[ctx->scaled.stride >> 3], input_base_y[0]);
+
+      res = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+   }
+
+   for (; y < ctx->vert.filter_len; y++, input_base_y += (ctx->scaled.stride >> 3))
+   {
+      __m128i coeff = _mm_set_epi64x(0, (uint16_t)filter_vert[y] * 0x0001000100010001ull);
+      __m128i col   = _mm_set_epi64x(0, input_base_y[0]);
+
+      res = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+   }
+
+   res = _mm_adds_epi16(_mm_srli_si128(res, 8), res);
+   res = _mm_srai_epi16(res, (7 - 2 - 2));
+
+   final = _mm_packus_epi16(res, res);
+
+   return _mm_cvtsi128_si32(final);
+}
+
 void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int stride)
 {
-   int h, w, y;
+   int h, w;
    const uint64_t *input = ctx->scaled.frame;
    uint32_t *output = (uint32_t*)output_;
 
@@ -64,36 +101,64 @@ void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int strid
       const uint64_t *input_base = input + ctx->vert.filter_pos[h] * (ctx->scaled.stride >> 3);
 
       for (w = 0; w < ctx->out_width; w++)
+         output[w] = scaler_argb8888_vert_pixel(ctx, filter_vert, input_base + w);
+   }
+}
+
+#ifdef SCALER_HAVE_AVX2
+/* Four pixels at a time. Every pixel of a row uses the same taps,
+ * and even and odd taps are summed apart, so the result is exactly
+ * the same as with SSE2. */
+SCALER_TARGET_AVX2 void scaler_argb8888_vert_avx2(const struct scaler_ctx *ctx, void *output_, int stride)
+{
+   int h, w, y;
+   const uint64_t *input = ctx->scaled.frame;
+   uint32_t *output = (uint32_t*)output_;
+   const int scaled_stride = ctx->scaled.stride >> 3;
+
+   const int16_t *filter_vert = ctx->vert.filter;
+
+   for (h = 0; h < ctx->out_height; h++, filter_vert += ctx->vert.filter_stride, output += stride >> 2)
+   {
+      const uint64_t *input_base = input + ctx->vert.filter_pos[h] * scaled_stride;
+
+      for (w = 0; w + 4 <= ctx->out_width; w += 4)
       {
-         __m128i res = _mm_setzero_si128();
+         __m256i even = _mm256_setzero_si256();
+         __m256i odd  = _mm256_setzero_si256();
+         __m256i res;
 
          const uint64_t *input_base_y = input_base + w;
 
-         for (y = 0; (y + 1) < ctx->vert.filter_len; y += 2, input_base_y += (ctx->scaled.stride >> 2))
+         for (y = 0; (y + 1) < ctx->vert.filter_len; y += 2, input_base_y += 2 * scaled_stride)
          {
-            __m128i coeff = _mm_set_epi64x(filter_vert[y + 1] * 0x0001000100010001ll, filter_vert[y + 0] * 0x0001000100010001ll);
-            __m128i col   = _mm_set_epi64x(input_base_y[ctx->scaled.stride >> 3], input_base_y[0]);
+            __m256i col0 = _mm256_loadu_si256((const __m256i*)input_base_y);
+            __m256i col1 = _mm256_loadu_si256((const __m256i*)(input_base_y + scaled_stride));
 
-            res = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+            even = _mm256_adds_epi16(_mm256_mulhi_epi16(col0, _mm256_set1_epi16(filter_vert[y + 0])), even);
+            odd  = _mm256_adds_epi16(_mm256_mulhi_epi16(col1, _mm256_set1_epi16(filter_vert[y + 1])), odd);
          }
 
-         for (; y < ctx->vert.filter_len; y++, input_base_y += (ctx->scaled.stride >> 3))
+         for (; y < ctx->vert.filter_len; y++, input_base_y += scaled_stride)
          {
-            __m128i coeff = _mm_set_epi64x(0, filter_vert[y] * 0x0001000100010001ll);
-            __m128i col   = _mm_set_epi64x(0, input_base_y[0]);
-
-            res = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+            __m256i col = _mm256_loadu_si256((const __m256i*)input_base_y);
+            even = _mm256_adds_epi16(_mm256_mulhi_epi16(col, _mm256_set1_epi16(filter_vert[y])), even);
          }
 
-         res = _mm_adds_epi16(_mm_srli_si128(res, 8), res);
-         res = _mm_srai_epi16(res, (7 - 2 - 2));
-
-         __m128i final = _mm_packus_epi16(res, res);
+         res = _mm256_adds_epi16(odd, even);
+         res = _mm256_srai_epi16(res, (7 - 2 - 2));
+         res = _mm256_packus_epi16(res, res);
 
-         output[w] = _mm_cvtsi128_si32(final);
+         /* Packing works within 128-bit lanes. */
+         res = _mm256_permute4x64_epi64(res, _MM_SHUFFLE(3, 1, 2, 0));
+         _mm_storeu_si128((__m128i*)(output + w), _mm256_castsi256_si128(res));
       }
+
+      for (; w < ctx->out_width; w++)
+         output[w] = scaler_argb8888_vert_pixel(ctx, filter_vert, input_base + w);
    }
 }
+#endif
 #else
 void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int stride)
 {
@@ -144,9 +209,53 @@ void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int strid
 #endif
 
 #if defined(__SSE2__)
+static INLINE void scaler_argb8888_horiz_pixel(const struct scaler_ctx *ctx,
+      uint64_t *output, const int16_t *filter_horiz, const uint32_t *input_base_x)
+{
+   int x;
+   __m128i res = _mm_setzero_si128();
+
+   for (x = 0; (x + 1) < ctx->horiz.filter_len; x += 2)
+   {
+      __m128i coeff = _mm_set_epi64x((uint16_t)filter_horiz[x + 1] * 0x0001000100010001ull, (uint16_t)filter_horiz[x + 0] * 0x0001000100010001ull);
+
+      __m128i col = _mm_unpacklo_epi8(_mm_set_epi64x(0,
+               ((uint64_t)input_base_x[x + 1] << 32) | input_base_x[x + 0]), _mm_setzero_si128());
+
+      col = _mm_slli_epi16(col, 7);
+      res = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+   }
+
+   for (; x < ctx->horiz.filter_len; x++)
+   {
+      __m128i coeff = _mm_set_epi64x(0, (uint16_t)filter_horiz[x] * 0x0001000100010001ull);
+      __m128i col   = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, 0, input_base_x[x]), _mm_setzero_si128());
+
+      col = _mm_slli_epi16(col, 7);
+      res = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+   }
+
+   res = _mm_adds_epi16(_mm_srli_si128(res, 8), res);
+
+#ifdef __x86_64__
+   *output = _mm_cvtsi128_si64(res);
+#else // 32-bit doesn't have si64. Do it in two steps.
+   {
+      union
+      {
+         uint32_t *u32;
+         uint64_t *u64;
+      } u;
+      u.u64 = output;
+      u.u32[0] = _mm_cvtsi128_si32(res);
+      u.u32[1] = _mm_cvtsi128_si32(_mm_srli_si128(res, 4));
+   }
+#endif
+}
+
 void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int stride)
 {
-   int h, w, x;
+   int h, w;
    const uint32_t *input = (const uint32_t*)input_;
    uint64_t *output      = ctx->scaled.frame;
 
@@ -155,48 +264,85 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
       const int16_t *filter_horiz = ctx->horiz.filter;
 
       for (w = 0; w < ctx->scaled.width; w++, filter_horiz += ctx->horiz.filter_stride)
-      {
-         __m128i res = _mm_setzero_si128();
+         scaler_argb8888_horiz_pixel(ctx, output + w, filter_horiz,
+               input + ctx->horiz.filter_pos[w]);
+   }
+}
 
-         const uint32_t *input_base_x = input + ctx->horiz.filter_pos[w];
+#ifdef SCALER_HAVE_AVX2
+/* Two pixels at a time, one in each 128-bit lane,
+ * each lane doing the same as the SSE2 version. */
+SCALER_TARGET_AVX2 void scaler_argb8888_horiz_avx2(const struct scaler_ctx *ctx, const void *input_, int stride)
+{
+   int h, w, x;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint64_t *output      = ctx->scaled.frame;
+   const int filter_stride = ctx->horiz.filter_stride;
 
-         for (x = 0; (x + 1) < ctx->horiz.filter_len; x += 2)
-         {
-            __m128i coeff = _mm_set_epi64x(filter_horiz[x + 1] * 0x0001000100010001ll, filter_horiz[x + 0] * 0x0001000100010001ll);
+   /* Spreads the taps { a0, a1, b0, b1 } over the channels,
+    * a0 and a1 in the low lane, b0 and b1 in the high lane. */
+   const __m256i coeff_shuf = _mm256_set_epi8(
+         7, 6, 7, 6, 7, 6, 7, 6, 5, 4, 5, 4, 5, 4, 5, 4,
+         3, 2, 3, 2, 3, 2, 3, 2, 1, 0, 1, 0, 1, 0, 1, 0);
 
-            __m128i col = _mm_unpacklo_epi8(_mm_set_epi64x(0,
-                     ((uint64_t)input_base_x[x + 1] << 32) | input_base_x[x + 0]), _mm_setzero_si128());
+   for (h = 0; h < ctx->scaled.height; h++, input += stride >> 2, output += ctx->scaled.stride >> 3)
+   {
+      const int16_t *filter_horiz = ctx->horiz.filter;
 
-            col = _mm_slli_epi16(col, 7);
-            res = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+      for (w = 0; w + 2 <= ctx->scaled.width; w += 2, filter_horiz += 2 * filter_stride)
+      {
+         const int16_t *filter_a = filter_horiz;
+         const int16_t *filter_b = filter_horiz + filter_stride;
+         const uint32_t *input_a = input + ctx->horiz.filter_pos[w + 0];
+         const uint32_t *input_b = input + ctx->horiz.filter_pos[w + 1];
+         __m256i res = _mm256_setzero_si256();
+
+         for (x = 0; (x + 1) < ctx->horiz.filter_len; x += 2)
+         {
+            __m256i coeff = _mm256_shuffle_epi8(_mm256_set1_epi64x(
+                     ((uint64_t)(uint16_t)filter_b[x + 1] << 48) |
+                     ((uint64_t)(uint16_t)filter_b[x + 0] << 32) |
+                     ((uint64_t)(uint16_t)filter_a[x + 1] << 16) |
+                     ((uint64_t)(uint16_t)filter_a[x + 0] <<  0)), coeff_shuf);
+
+            __m256i col = _mm256_cvtepu8_epi16(_mm_unpacklo_epi64(
+                     _mm_loadl_epi64((const __m128i*)(input_a + x)),
+                     _mm_loadl_epi64((const __m128i*)(input_b + x))));
+
+            col = _mm256_slli_epi16(col, 7);
+            res = _mm256_adds_epi16(_mm256_mulhi_epi16(col, coeff), res);
          }
 
          for (; x < ctx->horiz.filter_len; x++)
          {
-            __m128i coeff = _mm_set_epi64x(0, filter_horiz[x] * 0x0001000100010001ll);
-            __m128i col   = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, 0, input_base_x[x]), _mm_setzero_si128());
+            __m256i coeff = _mm256_shuffle_epi8(_mm256_set1_epi64x(
+                     ((uint64_t)(uint16_t)filter_b[x] << 32) |
+                     ((uint64_t)(uint16_t)filter_a[x] <<  0)), coeff_shuf);
 
-            col = _mm_slli_epi16(col, 7);
-            res = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
-         }
+            __m256i col = _mm256_cvtepu8_epi16(_mm_unpacklo_epi64(
+                     _mm_cvtsi32_si128(input_a[x]),
+                     _mm_cvtsi32_si128(input_b[x])));
 
-         res       = _mm_adds_epi16(_mm_srli_si128(res, 8), res);
+            col = _mm256_slli_epi16(col, 7);
+            res = _mm256_adds_epi16(_mm256_mulhi_epi16(col, coeff), res);
+         }
 
-#ifdef __x86_64__
-         output[w] = _mm_cvtsi128_si64(res);
-#else // 32-bit doesn't have si64. Do it in two steps.
-         union
-         {
-            uint32_t *u32;
-            uint64_t *u64;
-         } u;
-         u.u64 = output + w;
-         u.u32[0] = _mm_cvtsi128_si32(res);
-         u.u32[1] = _mm_cvtsi128_si32(_mm_srli_si128(res, 4));
-#endif
+         res = _mm256_adds_epi16(_mm256_srli_si256(res, 8), res);
+         res = _mm256_permute4x64_epi64(res, _MM_SHUFFLE(3, 1, 2, 0));
+         _mm_storeu_si128((__m128i*)(output + w), _mm256_castsi256_si128(res));
       }
+
+      for (; w < ctx->scaled.width; w++, filter_horiz += filter_stride)
+         scaler_argb8888_horiz_pixel(ctx, output + w, filter_horiz,
+               input + ctx->horiz.filter_pos[w]);
    }
 }
+
+bool scaler_cpu_has_avx2(void)
+{
+   return __builtin_cpu_supports("avx2");
+}
+#endif
 #else
 static inline uint64_t build_argb64(uint16_t a, uint16_t r, uint16_t g, uint16_t b)
 {
@@ -32,6 +32,8 @@ extern "C" {
 
 bool scaler_gen_filter(struct scaler_ctx *ctx);
 
+void scaler_filter_cache_free(struct scaler_ctx *ctx);
+
 #ifdef __cplusplus
 }
 #endif
@@ -61,8 +61,15 @@ struct scaler_filter
    int *filter_pos;
 };
 
+struct task_pool;
+struct scaler_filter_cache;
+
 struct scaler_ctx
 {
+   /* Optional. If set, scaling is split into bands of rows
+    * which run on the pool. Needs HAVE_THREADS. */
+   struct task_pool *pool;
+
    int in_width;
    int in_height;
    int in_stride;
@@ -87,7 +94,12 @@ struct scaler_ctx
    void (*direct_pixconv)(void*, const void*, int, int, int, int);
 
    bool unscaled;
+
+   /* Owned by filter_cache, which keeps the filters of the
+    * last few geometries, so switching back and forth between
+    * sizes does not generate them again. */
    struct scaler_filter horiz, vert;
+   struct scaler_filter_cache *filter_cache;
 
    struct
    {
@@ -110,8 +122,25 @@ struct scaler_ctx
    } output;
 };
 
+/**
+ * scaler_ctx_gen_filter:
+ * @ctx          : pointer to scaler context object.
+ *
+ * Sets up the context for its current formats and geometry.
+ * Filters made for a geometry used before are taken from the
+ * context's filter cache.
+ *
+ * Returns: true if successful, otherwise false.
+ **/
 bool scaler_ctx_gen_filter(struct scaler_ctx *ctx);
 
+/**
+ * scaler_ctx_gen_reset:
+ * @ctx          : pointer to scaler context object.
+ *
+ * Frees everything allocated by scaler_ctx_gen_filter(),
+ * including the filter cache.
+ **/
 void scaler_ctx_gen_reset(struct scaler_ctx *ctx);
 
 /**
@@ -31,6 +31,23 @@ void scaler_argb8888_vert(const struct scaler_ctx *ctx,
 void scaler_argb8888_horiz(const struct scaler_ctx *ctx,
       const void *input, int stride);
 
+/* The AVX2 kernels are built with a function-level target,
+ * so scaler_ctx_gen_filter() can pick them at runtime. */
+#if !defined(SCALER_NO_SIMD) && defined(__SSE2__) && \
+      (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || \
+      (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define SCALER_HAVE_AVX2
+#define SCALER_TARGET_AVX2 __attribute__((target("avx2")))
+
+void scaler_argb8888_vert_avx2(const struct scaler_ctx *ctx,
+      void *output, int stride);
+
+void scaler_argb8888_horiz_avx2(const struct scaler_ctx *ctx,
+      const void *input, int stride);
+
+bool scaler_cpu_has_avx2(void);
+#endif
+
 void scaler_argb8888_point_special(const struct scaler_ctx *ctx,
       void *output, const void *input,
       int out_width, int out_height,
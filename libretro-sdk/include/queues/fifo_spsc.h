@@ -0,0 +1,195 @@
+/* Copyright  (C) 2010-2015 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (fifo_spsc.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_FIFO_SPSC_H
+#define __LIBRETRO_SDK_FIFO_SPSC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <boolean.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Single producer, single consumer FIFO.
+ *
+ * One thread may write and one other thread may read at the same
+ * time without any locking. Functions are marked with the side
+ * which is allowed to call them.
+ *
+ * Waiting is only needed when one side runs out of data or room.
+ * The other side wakes it up after a commit, and only takes a lock
+ * when someone is actually waiting. */
+typedef struct fifo_spsc fifo_spsc_t;
+
+/**
+ * fifo_spsc_new:
+ * @size                    : capacity in bytes.
+ *
+ * Creates a new FIFO. Must be freed with fifo_spsc_free.
+ *
+ * Returns: pointer to new FIFO if successful, otherwise NULL.
+ **/
+fifo_spsc_t *fifo_spsc_new(size_t size);
+
+/**
+ * fifo_spsc_free:
+ * @fifo                    : pointer to FIFO object
+ *
+ * Frees a FIFO. Neither side may be using it anymore.
+ **/
+void fifo_spsc_free(fifo_spsc_t *fifo);
+
+/**
+ * fifo_spsc_read_avail:
+ * @fifo                    : pointer to FIFO object
+ *
+ * Consumer side.
+ *
+ * Returns: amount of bytes which can be read.
+ **/
+size_t fifo_spsc_read_avail(fifo_spsc_t *fifo);
+
+/**
+ * fifo_spsc_write_avail:
+ * @fifo                    : pointer to FIFO object
+ *
+ * Producer side.
+ *
+ * Returns: amount of bytes which can be written.
+ **/
+size_t fifo_spsc_write_avail(fifo_spsc_t *fifo);
+
+/**
+ * fifo_spsc_write:
+ * @fifo                    : pointer to FIFO object
+ * @data                    : data to write.
+ * @size                    : size of @data.
+ *
+ * Producer side. Copies as much of @data as fits.
+ *
+ * Returns: amount of bytes written.
+ **/
+size_t fifo_spsc_write(fifo_spsc_t *fifo, const void *data, size_t size);
+
+/**
+ * fifo_spsc_read:
+ * @fifo                    : pointer to FIFO object
+ * @data                    : buffer to read to.
+ * @size                    : size of @data.
+ *
+ * Consumer side. Copies as much as is available, up to @size.
+ *
+ * Returns: amount of bytes read.
+ **/
+size_t fifo_spsc_read(fifo_spsc_t *fifo, void *data, size_t size);
+
+/**
+ * fifo_spsc_write_reserve:
+ * @fifo                    : pointer to FIFO object
+ * @size                    : set to the size of the region.
+ *
+ * Producer side. Gets the largest free region which is contiguous
+ * in memory, so it can be written to in place. The region might be
+ * smaller than fifo_spsc_write_avail when it wraps around.
+ *
+ * Returns: start of the region, publish it with fifo_spsc_write_commit.
+ **/
+void *fifo_spsc_write_reserve(fifo_spsc_t *fifo, size_t *size);
+
+/**
+ * fifo_spsc_write_commit:
+ * @fifo                    : pointer to FIFO object
+ * @size                    : amount of bytes written.
+ *
+ * Producer side. Makes @size bytes of a reserved region
+ * visible to the consumer.
+ **/
+void fifo_spsc_write_commit(fifo_spsc_t *fifo, size_t size);
+
+/**
+ * fifo_spsc_read_peek:
+ * @fifo                    : pointer to FIFO object
+ * @size                    : set to the size of the region.
+ *
+ * Consumer side. Gets the largest readable region which is
+ * contiguous in memory, so it can be consumed in place.
+ *
+ * Returns: start of the region, release it with fifo_spsc_read_commit.
+ **/
+const void *fifo_spsc_read_peek(fifo_spsc_t *fifo, size_t *size);
+
+/**
+ * fifo_spsc_read_commit:
+ * @fifo                    : pointer to FIFO object
+ * @size                    : amount of bytes consumed.
+ *
+ * Consumer side. Hands @size bytes of a peeked region
+ * back to the producer.
+ **/
+void fifo_spsc_read_commit(fifo_spsc_t *fifo, size_t size);
+
+/**
+ * fifo_spsc_wait_read:
+ * @fifo                    : pointer to FIFO object
+ * @size                    : amount of bytes to wait for.
+ * @timeout_us              : timeout in microseconds, negative
+ *                            to wait forever.
+ *
+ * Consumer side. Blocks until @size bytes can be read.
+ *
+ * Returns: true (1) if @size bytes can be read, false (0) on
+ * timeout or if the FIFO was closed.
+ **/
+bool fifo_spsc_wait_read(fifo_spsc_t *fifo, size_t size,
+      int64_t timeout_us);
+
+/**
+ * fifo_spsc_wait_write:
+ * @fifo                    : pointer to FIFO object
+ * @size                    : amount of bytes to wait for.
+ * @timeout_us              : timeout in microseconds, negative
+ *                            to wait forever.
+ *
+ * Producer side. Blocks until @size bytes can be written.
+ *
+ * Returns: true (1) if @size bytes can be written, false (0) on
+ * timeout or if the FIFO was closed.
+ **/
+bool fifo_spsc_wait_write(fifo_spsc_t *fifo, size_t size,
+      int64_t timeout_us);
+
+/**
+ * fifo_spsc_close:
+ * @fifo                    : pointer to FIFO object
+ *
+ * Either side. Wakes up any waiter, and makes all further
+ * waits return false immediately. Used for shutting down.
+ **/
+void fifo_spsc_close(fifo_spsc_t *fifo);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,109 @@
+/* Copyright  (C) 2010-2015 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (task_pool.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_TASK_POOL_H
+#define __LIBRETRO_SDK_TASK_POOL_H
+
+#include <boolean.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Persistent pool of worker threads for data parallel work.
+ *
+ * Work is submitted as a batch of numbered tasks, which are spread
+ * over one queue per worker. A worker runs tasks from its own queue
+ * first, then steals from the back of the others, so uneven tasks
+ * or a busy core don't hold up the whole batch. The submitting thread
+ * helps out until the queues run dry.
+ *
+ * Several threads may submit batches at the same time. */
+typedef struct task_pool task_pool_t;
+
+/* Runs task @index of a batch. */
+typedef void (*task_pool_func_t)(void *data, unsigned index);
+
+/**
+ * task_pool_new:
+ * @threads                 : amount of worker threads.
+ *
+ * Creates a new pool. With zero workers, batches run on the
+ * submitting thread only. Must be freed with task_pool_free.
+ *
+ * Returns: pointer to new pool if successful, otherwise NULL.
+ **/
+task_pool_t *task_pool_new(unsigned threads);
+
+/**
+ * task_pool_free:
+ * @pool                    : pointer to pool object
+ *
+ * Stops the workers and frees the pool.
+ * No batch may be running anymore.
+ **/
+void task_pool_free(task_pool_t *pool);
+
+/**
+ * task_pool_threads:
+ * @pool                    : pointer to pool object
+ *
+ * Returns: amount of threads which run a batch, workers
+ * and submitting thread included. 1 if @pool is NULL.
+ **/
+unsigned task_pool_threads(task_pool_t *pool);
+
+/**
+ * task_pool_run:
+ * @pool                    : pointer to pool object, may be NULL.
+ * @func                    : task callback.
+ * @data                    : passed to @func.
+ * @count                   : amount of tasks.
+ *
+ * Calls @func for every index from 0 to @count - 1, spread over
+ * the workers. Tasks may run in any order and at the same time.
+ * Returns when all of them have finished.
+ **/
+void task_pool_run(task_pool_t *pool, task_pool_func_t func,
+      void *data, unsigned count);
+
+/**
+ * task_pool_run_limited:
+ * @pool                    : pointer to pool object, may be NULL.
+ * @func                    : task callback.
+ * @data                    : passed to @func.
+ * @count                   : amount of tasks.
+ * @threads                 : most threads to run the tasks on,
+ *                            submitting thread included. 0 for
+ *                            as many as the pool has.
+ *
+ * Same as task_pool_run, but no more than @threads threads work
+ * on this batch at the same time.
+ **/
+void task_pool_run_limited(task_pool_t *pool, task_pool_func_t func,
+      void *data, unsigned count, unsigned threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,298 @@
+/* Copyright  (C) 2010-2015 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (fifo_spsc.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <queues/fifo_spsc.h>
+#include <rthreads/rthreads.h>
+
+#if defined(__clang__) || (defined(__GNUC__) && \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#define FIFO_LOAD_ACQUIRE(ptr)       __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define FIFO_STORE_RELEASE(ptr, val) __atomic_store_n(ptr, val, __ATOMIC_RELEASE)
+#define FIFO_FENCE()                 __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#elif defined(__GNUC__)
+#define FIFO_LOAD_ACQUIRE(ptr)       fifo_load_acquire(ptr)
+#define FIFO_STORE_RELEASE(ptr, val) do { __sync_synchronize(); *(ptr) = (val); } while(0)
+#define FIFO_FENCE()                 __sync_synchronize()
+static size_t fifo_load_acquire(volatile size_t *ptr)
+{
+   size_t val = *ptr;
+   __sync_synchronize();
+   return val;
+}
+#elif defined(_MSC_VER)
+#include <windows.h>
+/* Volatile accesses have acquire/release semantics on MSVC. */
+#define FIFO_LOAD_ACQUIRE(ptr)       (*(ptr))
+#define FIFO_STORE_RELEASE(ptr, val) (*(ptr) = (val))
+#define FIFO_FENCE()                 MemoryBarrier()
+#else
+#error "fifo_spsc needs atomics for this compiler."
+#endif
+
+/* Keeps the producer and consumer positions on separate cache lines. */
+#define FIFO_CACHE_LINE 64
+
+struct fifo_spsc
+{
+   uint8_t *buffer;
+   size_t bufsize;
+
+   /* Written by the producer only. */
+   volatile size_t end;
+   volatile size_t write_waiting;
+   uint8_t pad0[FIFO_CACHE_LINE];
+
+   /* Written by the consumer only. */
+   volatile size_t first;
+   volatile size_t read_waiting;
+   uint8_t pad1[FIFO_CACHE_LINE];
+
+   volatile size_t closed;
+
+   slock_t *lock;
+   scond_t *cond_read;
+   scond_t *cond_write;
+};
+
+fifo_spsc_t *fifo_spsc_new(size_t size)
+{
+   fifo_spsc_t *fifo = (fifo_spsc_t*)calloc(1, sizeof(*fifo));
+
+   if (!fifo)
+      return NULL;
+
+   /* One byte stays unused to tell a full buffer from an empty one. */
+   fifo->bufsize    = size + 1;
+   fifo->buffer     = (uint8_t*)calloc(1, fifo->bufsize);
+   fifo->lock       = slock_new();
+   fifo->cond_read  = scond_new();
+   fifo->cond_write = scond_new();
+
+   if (!fifo->buffer || !fifo->lock || !fifo->cond_read || !fifo->cond_write)
+   {
+      fifo_spsc_free(fifo);
+      return NULL;
+   }
+
+   return fifo;
+}
+
+void fifo_spsc_free(fifo_spsc_t *fifo)
+{
+   if (!fifo)
+      return;
+
+   if (fifo->lock)
+      slock_free(fifo->lock);
+   if (fifo->cond_read)
+      scond_free(fifo->cond_read);
+   if (fifo->cond_write)
+      scond_free(fifo->cond_write);
+
+   free(fifo->buffer);
+   free(fifo);
+}
+
+static size_t fifo_spsc_used(const fifo_spsc_t *fifo,
+      size_t first, size_t end)
+{
+   if (end < first)
+      end += fifo->bufsize;
+   return end - first;
+}
+
+size_t fifo_spsc_read_avail(fifo_spsc_t *fifo)
+{
+   return fifo_spsc_used(fifo, fifo->first, FIFO_LOAD_ACQUIRE(&fifo->end));
+}
+
+size_t fifo_spsc_write_avail(fifo_spsc_t *fifo)
+{
+   return (fifo->bufsize - 1) -
+      fifo_spsc_used(fifo, FIFO_LOAD_ACQUIRE(&fifo->first), fifo->end);
+}
+
+/* Wakes up the other side if it is waiting on us.
+ * The fence orders our position update before reading the flag,
+ * pairing with the one in fifo_spsc_wait. */
+static void fifo_spsc_notify(fifo_spsc_t *fifo,
+      volatile size_t *waiting, scond_t *cond)
+{
+   FIFO_FENCE();
+
+   if (!FIFO_LOAD_ACQUIRE(waiting))
+      return;
+
+   slock_lock(fifo->lock);
+   scond_signal(cond);
+   slock_unlock(fifo->lock);
+}
+
+void *fifo_spsc_write_reserve(fifo_spsc_t *fifo, size_t *size)
+{
+   size_t avail = fifo_spsc_write_avail(fifo);
+   size_t tail  = fifo->bufsize - fifo->end;
+
+   *size = avail < tail ? avail : tail;
+   return fifo->buffer + fifo->end;
+}
+
+void fifo_spsc_write_commit(fifo_spsc_t *fifo, size_t size)
+{
+   FIFO_STORE_RELEASE(&fifo->end, (fifo->end + size) % fifo->bufsize);
+   fifo_spsc_notify(fifo, &fifo->read_waiting, fifo->cond_read);
+}
+
+const void *fifo_spsc_read_peek(fifo_spsc_t *fifo, size_t *size)
+{
+   size_t avail = fifo_spsc_read_avail(fifo);
+   size_t tail  = fifo->bufsize - fifo->first;
+
+   *size = avail < tail ? avail : tail;
+   return fifo->buffer + fifo->first;
+}
+
+void fifo_spsc_read_commit(fifo_spsc_t *fifo, size_t size)
+{
+   FIFO_STORE_RELEASE(&fifo->first, (fifo->first + size) % fifo->bufsize);
+   fifo_spsc_notify(fifo, &fifo->write_waiting, fifo->cond_write);
+}
+
+size_t fifo_spsc_write(fifo_spsc_t *fifo, const void *data, size_t size)
+{
+   size_t written = 0;
+
+   /* At most two regions, before and after wrapping around. */
+   while (written < size)
+   {
+      size_t region = 0;
+      void *dst     = fifo_spsc_write_reserve(fifo, &region);
+
+      if (!region)
+         break;
+
+      if (region > size - written)
+         region = size - written;
+
+      memcpy(dst, (const uint8_t*)data + written, region);
+      written += region;
+
+      FIFO_STORE_RELEASE(&fifo->end, (fifo->end + region) % fifo->bufsize);
+   }
+
+   if (written)
+      fifo_spsc_notify(fifo, &fifo->read_waiting, fifo->cond_read);
+   return written;
+}
+
+size_t fifo_spsc_read(fifo_spsc_t *fifo, void *data, size_t size)
+{
+   size_t read = 0;
+
+   while (read < size)
+   {
+      size_t region   = 0;
+      const void *src = fifo_spsc_read_peek(fifo, &region);
+
+      if (!region)
+         break;
+
+      if (region > size - read)
+         region = size - read;
+
+      memcpy((uint8_t*)data + read, src, region);
+      read += region;
+
+      FIFO_STORE_RELEASE(&fifo->first, (fifo->first + region) % fifo->bufsize);
+   }
+
+   if (read)
+      fifo_spsc_notify(fifo, &fifo->write_waiting, fifo->cond_write);
+   return read;
+}
+
+static bool fifo_spsc_wait(fifo_spsc_t *fifo, size_t size,
+      int64_t timeout_us, bool reader)
+{
+   bool ret                 = true;
+   volatile size_t *waiting = reader ? &fifo->read_waiting : &fifo->write_waiting;
+   scond_t *cond            = reader ? fifo->cond_read : fifo->cond_write;
+
+   slock_lock(fifo->lock);
+   FIFO_STORE_RELEASE(waiting, 1);
+
+   for (;;)
+   {
+      size_t avail;
+
+      /* Pairs with the fence in fifo_spsc_notify, so either we see
+       * the new position or the other side sees our flag. */
+      FIFO_FENCE();
+
+      avail = reader ? fifo_spsc_read_avail(fifo) : fifo_spsc_write_avail(fifo);
+      if (avail >= size)
+         break;
+
+      if (fifo->closed)
+      {
+         ret = false;
+         break;
+      }
+
+      if (timeout_us < 0)
+         scond_wait(cond, fifo->lock);
+      else if (!scond_wait_timeout(cond, fifo->lock, timeout_us))
+      {
+         avail = reader ? fifo_spsc_read_avail(fifo) : fifo_spsc_write_avail(fifo);
+         ret   = avail >= size;
+         break;
+      }
+   }
+
+   FIFO_STORE_RELEASE(waiting, 0);
+   slock_unlock(fifo->lock);
+   return ret;
+}
+
+bool fifo_spsc_wait_read(fifo_spsc_t *fifo, size_t size,
+      int64_t timeout_us)
+{
+   return fifo_spsc_wait(fifo, size, timeout_us, true);
+}
+
+bool fifo_spsc_wait_write(fifo_spsc_t *fifo, size_t size,
+      int64_t timeout_us)
+{
+   return fifo_spsc_wait(fifo, size, timeout_us, false);
+}
+
+void fifo_spsc_close(fifo_spsc_t *fifo)
+{
+   slock_lock(fifo->lock);
+   fifo->closed = 1;
+   scond_broadcast(fifo->cond_read);
+   scond_broadcast(fifo->cond_write);
+   slock_unlock(fifo->lock);
+}
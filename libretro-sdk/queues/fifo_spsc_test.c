@@ -0,0 +1,270 @@
+/* Copyright  (C) 2010-2015 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (fifo_spsc_test.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Unit test for fifo_spsc. Build from the libretro-sdk directory with:
+ *
+ *    cc -Iinclude -o fifo_spsc_test queues/fifo_spsc_test.c \
+ *       queues/fifo_spsc.c rthreads/rthreads.c -lpthread
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <queues/fifo_spsc.h>
+#include <rthreads/rthreads.h>
+
+#define STRESS_COUNT 2000000u
+
+static int failures;
+
+#define CHECK(cond) do { \
+   if (!(cond)) \
+   { \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      failures++; \
+   } \
+} while(0)
+
+static void test_basic(void)
+{
+   char out[16];
+   fifo_spsc_t *fifo = fifo_spsc_new(8);
+
+   CHECK(fifo);
+   CHECK(fifo_spsc_read_avail(fifo) == 0);
+   CHECK(fifo_spsc_write_avail(fifo) == 8);
+
+   CHECK(fifo_spsc_write(fifo, "abcde", 5) == 5);
+   CHECK(fifo_spsc_read_avail(fifo) == 5);
+   CHECK(fifo_spsc_write_avail(fifo) == 3);
+
+   /* Writes are short once full, reads once empty. */
+   CHECK(fifo_spsc_write(fifo, "fghij", 5) == 3);
+   CHECK(fifo_spsc_write_avail(fifo) == 0);
+   CHECK(fifo_spsc_write(fifo, "x", 1) == 0);
+
+   CHECK(fifo_spsc_read(fifo, out, sizeof(out)) == 8);
+   CHECK(!memcmp(out, "abcdefgh", 8));
+   CHECK(fifo_spsc_read(fifo, out, sizeof(out)) == 0);
+
+   fifo_spsc_free(fifo);
+}
+
+static void test_wraparound(void)
+{
+   unsigned i;
+   size_t size;
+   char out[8];
+   void *dst;
+   const void *src;
+   fifo_spsc_t *fifo = fifo_spsc_new(8);
+
+   /* Moves the positions near the end of the buffer. */
+   CHECK(fifo_spsc_write(fifo, "012345", 6) == 6);
+   CHECK(fifo_spsc_read(fifo, out, 6) == 6);
+
+   /* Copies split across the end of the buffer. */
+   for (i = 0; i < 20; i++)
+   {
+      char in[5];
+
+      sprintf(in, "%04u", i);
+      CHECK(fifo_spsc_write(fifo, in, 5) == 5);
+      CHECK(fifo_spsc_read(fifo, out, 5) == 5);
+      CHECK(!memcmp(in, out, 5));
+   }
+
+   /* In place regions stop at the end, the rest comes after. */
+   CHECK(fifo_spsc_read_avail(fifo) == 0);
+   dst = fifo_spsc_write_reserve(fifo, &size);
+   CHECK(size > 0 && size <= 8);
+   memset(dst, 'a', size);
+   fifo_spsc_write_commit(fifo, size);
+
+   if (size < 8)
+   {
+      size_t rest;
+
+      dst = fifo_spsc_write_reserve(fifo, &rest);
+      CHECK(size + rest == 8);
+      memset(dst, 'b', rest);
+      fifo_spsc_write_commit(fifo, rest);
+   }
+   CHECK(fifo_spsc_write_avail(fifo) == 0);
+
+   src = fifo_spsc_read_peek(fifo, &size);
+   CHECK(size > 0 && ((const char*)src)[0] == 'a');
+   fifo_spsc_read_commit(fifo, size);
+   CHECK(fifo_spsc_read_avail(fifo) == 8 - size);
+   CHECK(fifo_spsc_read(fifo, out, sizeof(out)) == 8 - size);
+
+   fifo_spsc_free(fifo);
+}
+
+static void test_wait_timeout(void)
+{
+   fifo_spsc_t *fifo = fifo_spsc_new(4);
+
+   CHECK(fifo_spsc_wait_write(fifo, 4, 0));
+   CHECK(!fifo_spsc_wait_write(fifo, 5, 1000));
+   CHECK(!fifo_spsc_wait_read(fifo, 1, 1000));
+
+   CHECK(fifo_spsc_write(fifo, "abc", 3) == 3);
+   CHECK(fifo_spsc_wait_read(fifo, 3, 1000));
+   CHECK(!fifo_spsc_wait_read(fifo, 4, 1000));
+   CHECK(!fifo_spsc_wait_write(fifo, 2, 1000));
+
+   fifo_spsc_free(fifo);
+}
+
+struct close_test
+{
+   fifo_spsc_t *fifo;
+   bool reader;
+   bool ret;
+};
+
+static void close_waiter(void *data)
+{
+   struct close_test *test = (struct close_test*)data;
+
+   test->ret = test->reader ?
+      fifo_spsc_wait_read(test->fifo, 1, -1) :
+      fifo_spsc_wait_write(test->fifo, 1, -1);
+}
+
+static void test_close(bool reader)
+{
+   struct close_test test;
+   sthread_t *thread;
+   slock_t *lock  = slock_new();
+   scond_t *cond  = scond_new();
+
+   test.fifo   = fifo_spsc_new(4);
+   test.reader = reader;
+   test.ret    = true;
+
+   /* Nothing to read, or no room left, so only close wakes it. */
+   if (!reader)
+      CHECK(fifo_spsc_write(test.fifo, "abcd", 4) == 4);
+
+   thread = sthread_create(close_waiter, &test);
+   CHECK(thread);
+   if (!thread)
+      goto end;
+
+   /* Give the waiter a chance to actually block first. */
+   slock_lock(lock);
+   scond_wait_timeout(cond, lock, 20000);
+   slock_unlock(lock);
+
+   fifo_spsc_close(test.fifo);
+   sthread_join(thread);
+   CHECK(!test.ret);
+
+   /* Waits fail right away after closing. */
+   CHECK(!fifo_spsc_wait_read(test.fifo, 16, -1));
+   CHECK(!fifo_spsc_wait_write(test.fifo, 16, -1));
+
+end:
+   fifo_spsc_free(test.fifo);
+   slock_free(lock);
+   scond_free(cond);
+}
+
+static void stress_producer(void *data)
+{
+   fifo_spsc_t *fifo = (fifo_spsc_t*)data;
+   unsigned next     = 0;
+
+   while (next < STRESS_COUNT)
+   {
+      unsigned k, buf[37];
+      unsigned count = (next % 37) + 1;
+
+      if (count > STRESS_COUNT - next)
+         count = STRESS_COUNT - next;
+
+      for (k = 0; k < count; k++)
+         buf[k] = next + k;
+
+      if (!fifo_spsc_wait_write(fifo, count * sizeof(unsigned), -1))
+         return;
+      fifo_spsc_write(fifo, buf, count * sizeof(unsigned));
+      next += count;
+   }
+}
+
+/* Odd sizes against an odd capacity, so copies wrap at every offset. */
+static void test_stress(void)
+{
+   unsigned expected = 0;
+   fifo_spsc_t *fifo = fifo_spsc_new(1001);
+   sthread_t *thread = sthread_create(stress_producer, fifo);
+
+   CHECK(thread);
+   if (!thread)
+   {
+      fifo_spsc_free(fifo);
+      return;
+   }
+
+   while (expected < STRESS_COUNT)
+   {
+      unsigned value;
+
+      if (!fifo_spsc_wait_read(fifo, sizeof(value), -1))
+         break;
+      fifo_spsc_read(fifo, &value, sizeof(value));
+
+      if (value != expected)
+      {
+         CHECK(value == expected);
+         break;
+      }
+      expected++;
+   }
+
+   fifo_spsc_close(fifo);
+   sthread_join(thread);
+   fifo_spsc_free(fifo);
+}
+
+int main(void)
+{
+   test_basic();
+   test_wraparound();
+   test_wait_timeout();
+   test_close(true);
+   test_close(false);
+   test_stress();
+
+   if (failures)
+   {
+      fprintf(stderr, "%d check(s) failed.\n", failures);
+      return 1;
+   }
+
+   printf("All fifo_spsc tests passed.\n");
+   return 0;
+}
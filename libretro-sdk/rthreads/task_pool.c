@@ -0,0 +1,430 @@
+/* Copyright  (C) 2010-2015 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (task_pool.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <rthreads/task_pool.h>
+#include <rthreads/rthreads.h>
+
+/* Keeps the queues of different workers on separate cache lines. */
+#define TASK_POOL_CACHE_LINE 64
+
+struct task_pool_batch
+{
+   task_pool_func_t func;
+   void *data;
+
+   /* Only workers below this index may run its tasks. */
+   unsigned workers;
+
+   /* Tasks not finished yet, under pool->done_lock. */
+   unsigned pending;
+};
+
+struct task_pool_task
+{
+   struct task_pool_batch *batch;
+   unsigned index;
+};
+
+/* The owner takes tasks from the front, thieves from the back. */
+struct task_pool_queue
+{
+   slock_t *lock;
+   struct task_pool_task *tasks;
+   unsigned capacity;
+   unsigned first;
+   unsigned count;
+   uint8_t pad[TASK_POOL_CACHE_LINE];
+};
+
+struct task_pool_worker
+{
+   task_pool_t *pool;
+   sthread_t *thread;
+   unsigned index;
+};
+
+struct task_pool
+{
+   struct task_pool_worker *workers;
+   struct task_pool_queue *queues;
+   unsigned num_queues;
+
+   /* Workers which are running. Equals num_queues
+    * unless task_pool_new failed. */
+   unsigned num_threads;
+
+   /* Workers sleep here while all queues are empty.
+    * generation changes whenever new tasks are queued. */
+   slock_t *lock;
+   scond_t *cond;
+   unsigned generation;
+   unsigned sleeping;
+   bool die;
+
+   /* Submitters wait here for their batch to finish. */
+   slock_t *done_lock;
+   scond_t *done_cond;
+};
+
+static bool task_pool_push(struct task_pool_queue *queue,
+      struct task_pool_batch *batch, unsigned first, unsigned last)
+{
+   unsigned i;
+   unsigned needed = queue->count + (last - first);
+
+   if (needed > queue->capacity)
+   {
+      unsigned capacity = queue->capacity ? queue->capacity : 16;
+      struct task_pool_task *tasks = NULL;
+
+      while (capacity < needed)
+         capacity *= 2;
+
+      tasks = (struct task_pool_task*)malloc(capacity * sizeof(*tasks));
+      if (!tasks)
+         return false;
+
+      for (i = 0; i < queue->count; i++)
+         tasks[i] = queue->tasks[(queue->first + i) % queue->capacity];
+
+      free(queue->tasks);
+      queue->tasks    = tasks;
+      queue->capacity = capacity;
+      queue->first    = 0;
+   }
+
+   for (i = first; i < last; i++)
+   {
+      struct task_pool_task *task = &queue->tasks[
+         (queue->first + queue->count++) % queue->capacity];
+      task->batch = batch;
+      task->index = i;
+   }
+
+   return true;
+}
+
+/**
+ * task_pool_may_run:
+ * @pool                    : pointer to pool object
+ * @batch                   : batch the task belongs to.
+ * @index                   : worker index, or pool->num_queues
+ *                            for a submitting thread.
+ * @own                     : batch of the submitting thread.
+ *
+ * Returns: true (1) if running a task of @batch stays within
+ * the amount of threads it was submitted with.
+ **/
+static bool task_pool_may_run(task_pool_t *pool,
+      const struct task_pool_batch *batch, unsigned index,
+      const struct task_pool_batch *own)
+{
+   if (index < pool->num_queues)
+      return index < batch->workers;
+   return batch == own || batch->workers >= pool->num_queues;
+}
+
+static bool task_pool_pop(task_pool_t *pool, struct task_pool_queue *queue,
+      struct task_pool_task *task, bool steal, unsigned index,
+      const struct task_pool_batch *own)
+{
+   bool ret = false;
+
+   slock_lock(queue->lock);
+   if (queue->count)
+   {
+      if (steal)
+      {
+         *task = queue->tasks[(queue->first + queue->count - 1)
+            % queue->capacity];
+         ret   = task_pool_may_run(pool, task->batch, index, own);
+      }
+      else
+      {
+         *task        = queue->tasks[queue->first];
+         queue->first = (queue->first + 1) % queue->capacity;
+         ret          = true;
+      }
+
+      if (ret)
+         queue->count--;
+   }
+   slock_unlock(queue->lock);
+
+   return ret;
+}
+
+/**
+ * task_pool_get:
+ * @pool                    : pointer to pool object
+ * @index                   : queue owned by the caller, or
+ *                            pool->num_queues for none.
+ * @own                     : batch submitted by the caller, if any.
+ * @task                    : set to the task to run.
+ *
+ * Takes a task from the caller's own queue, or steals one from
+ * the other queues, starting with the next one over so thieves
+ * spread out. Tasks of batches limited to fewer threads are
+ * only stolen by the threads allowed to run them.
+ *
+ * Returns: true (1) if a task was found, otherwise false (0).
+ **/
+static bool task_pool_get(task_pool_t *pool, unsigned index,
+      const struct task_pool_batch *own, struct task_pool_task *task)
+{
+   unsigned i;
+
+   if (index < pool->num_queues &&
+         task_pool_pop(pool, &pool->queues[index], task, false,
+            index, own))
+      return true;
+
+   for (i = 1; i <= pool->num_queues; i++)
+   {
+      unsigned victim = (index + i) % pool->num_queues;
+
+      if (victim != index &&
+            task_pool_pop(pool, &pool->queues[victim], task, true,
+               index, own))
+         return true;
+   }
+
+   return false;
+}
+
+static void task_pool_execute(task_pool_t *pool,
+      const struct task_pool_task *task)
+{
+   struct task_pool_batch *batch = task->batch;
+
+   batch->func(batch->data, task->index);
+
+   slock_lock(pool->done_lock);
+   if (--batch->pending == 0)
+      scond_broadcast(pool->done_cond);
+   slock_unlock(pool->done_lock);
+}
+
+static void task_pool_loop(void *data)
+{
+   struct task_pool_worker *worker = (struct task_pool_worker*)data;
+   task_pool_t *pool               = worker->pool;
+   unsigned generation;
+
+   slock_lock(pool->lock);
+   generation = pool->generation;
+   slock_unlock(pool->lock);
+
+   for (;;)
+   {
+      struct task_pool_task task;
+      bool die;
+
+      while (task_pool_get(pool, worker->index, NULL, &task))
+         task_pool_execute(pool, &task);
+
+      /* Anything queued after we read generation bumps it,
+       * so we can't sleep through it. */
+      slock_lock(pool->lock);
+      while (generation == pool->generation && !pool->die)
+      {
+         pool->sleeping++;
+         scond_wait(pool->cond, pool->lock);
+         pool->sleeping--;
+      }
+      generation = pool->generation;
+      die        = pool->die;
+      slock_unlock(pool->lock);
+
+      if (die)
+         break;
+   }
+}
+
+task_pool_t *task_pool_new(unsigned threads)
+{
+   unsigned i;
+   task_pool_t *pool = (task_pool_t*)calloc(1, sizeof(*pool));
+
+   if (!pool)
+      return NULL;
+
+   pool->lock      = slock_new();
+   pool->cond      = scond_new();
+   pool->done_lock = slock_new();
+   pool->done_cond = scond_new();
+
+   if (!pool->lock || !pool->cond || !pool->done_lock || !pool->done_cond)
+      goto error;
+
+   if (!threads)
+      return pool;
+
+   pool->workers = (struct task_pool_worker*)
+      calloc(threads, sizeof(*pool->workers));
+   pool->queues  = (struct task_pool_queue*)
+      calloc(threads, sizeof(*pool->queues));
+   if (!pool->workers || !pool->queues)
+      goto error;
+   pool->num_queues = threads;
+
+   for (i = 0; i < threads; i++)
+   {
+      pool->queues[i].lock = slock_new();
+      if (!pool->queues[i].lock)
+         goto error;
+   }
+
+   for (i = 0; i < threads; i++)
+   {
+      pool->workers[i].pool  = pool;
+      pool->workers[i].index = i;
+      pool->workers[i].thread = sthread_create(task_pool_loop,
+            &pool->workers[i]);
+      if (!pool->workers[i].thread)
+         goto error;
+      pool->num_threads++;
+   }
+
+   return pool;
+
+error:
+   task_pool_free(pool);
+   return NULL;
+}
+
+void task_pool_free(task_pool_t *pool)
+{
+   unsigned i;
+
+   if (!pool)
+      return;
+
+   if (pool->num_threads)
+   {
+      slock_lock(pool->lock);
+      pool->die = true;
+      scond_broadcast(pool->cond);
+      slock_unlock(pool->lock);
+
+      for (i = 0; i < pool->num_threads; i++)
+         sthread_join(pool->workers[i].thread);
+   }
+
+   for (i = 0; i < pool->num_queues; i++)
+   {
+      if (pool->queues[i].lock)
+         slock_free(pool->queues[i].lock);
+      free(pool->queues[i].tasks);
+   }
+
+   if (pool->lock)
+      slock_free(pool->lock);
+   if (pool->cond)
+      scond_free(pool->cond);
+   if (pool->done_lock)
+      slock_free(pool->done_lock);
+   if (pool->done_cond)
+      scond_free(pool->done_cond);
+
+   free(pool->workers);
+   free(pool->queues);
+   free(pool);
+}
+
+unsigned task_pool_threads(task_pool_t *pool)
+{
+   return pool ? pool->num_threads + 1 : 1;
+}
+
+void task_pool_run(task_pool_t *pool, task_pool_func_t func,
+      void *data, unsigned count)
+{
+   task_pool_run_limited(pool, func, data, count, 0);
+}
+
+void task_pool_run_limited(task_pool_t *pool, task_pool_func_t func,
+      void *data, unsigned count, unsigned threads)
+{
+   unsigned i, workers;
+   struct task_pool_task task;
+   struct task_pool_batch batch;
+
+   if (!pool || !pool->num_threads || count <= 1 || threads == 1)
+   {
+      for (i = 0; i < count; i++)
+         func(data, i);
+      return;
+   }
+
+   workers = pool->num_queues;
+   if (threads && threads - 1 < workers)
+      workers = threads - 1;
+
+   batch.func    = func;
+   batch.data    = data;
+   batch.workers = workers;
+   batch.pending = count;
+
+   /* Every worker gets a contiguous run of tasks, so neighbouring
+    * work stays on one core unless it gets stolen. */
+   for (i = 0; i < workers; i++)
+   {
+      struct task_pool_queue *queue = &pool->queues[i];
+      unsigned first = (unsigned)((uint64_t)count * i / workers);
+      unsigned last  = (unsigned)((uint64_t)count * (i + 1) / workers);
+      bool pushed;
+
+      slock_lock(queue->lock);
+      pushed = task_pool_push(queue, &batch, first, last);
+      slock_unlock(queue->lock);
+
+      /* Out of memory, do this part ourselves. */
+      if (!pushed)
+      {
+         unsigned j;
+         for (j = first; j < last; j++)
+         {
+            task.batch = &batch;
+            task.index = j;
+            task_pool_execute(pool, &task);
+         }
+      }
+   }
+
+   slock_lock(pool->lock);
+   pool->generation++;
+   if (pool->sleeping)
+      scond_broadcast(pool->cond);
+   slock_unlock(pool->lock);
+
+   while (task_pool_get(pool, pool->num_queues, &batch, &task))
+      task_pool_execute(pool, &task);
+
+   slock_lock(pool->done_lock);
+   while (batch.pending)
+      scond_wait(pool->done_cond, pool->done_lock);
+   slock_unlock(pool->done_lock);
+}
@@ -58,6 +58,11 @@ static void video_frame(const void *data, unsigned width,
    g_extern.frame_cache.height = height;
    g_extern.frame_cache.pitch  = pitch;
 
+   /* Frames hidden by run-ahead are still cached,
+    * so they can be shown if saving the state fails. */
+   if (g_extern.run_ahead.hide_video)
+      return;
+
    if (g_extern.system.pix_fmt == RETRO_PIXEL_FORMAT_0RGB1555 &&
          data && data != RETRO_HW_FRAME_BUFFER_VALID)
    {
@@ -115,41 +120,177 @@ static void video_frame(const void *data, unsigned width,
       pitch = opitch;
    }
 
+   if (g_settings.video.frame_delay_auto)
+      g_extern.frame_delay.submit_time = rarch_get_time_usec();
+
    if (!driver.video->frame(driver.video_data, data, width, height, pitch, msg))
       driver.video_active = false;
 }
 
-/*
- * readjust_audio_input_rate:
+/**
+ * audio_flush_passthrough:
+ * @data                 : pointer to audio buffer.
+ * @samples              : amount of samples to write.
  *
- * Readjust the audio input rate.
- */
-static void readjust_audio_input_rate(void)
+ * Writes samples without resampling or DSP. Only valid
+ * when the resampler would not change anything.
+ *
+ * Returns: result of the audio driver write.
+ **/
+static ssize_t audio_flush_passthrough(const int16_t *data, size_t samples)
+{
+   ssize_t ret;
+
+   RARCH_PERFORMANCE_INIT(audio_passthrough);
+   RARCH_PERFORMANCE_START(audio_passthrough);
+
+   if (g_extern.audio_data.use_float)
+   {
+      audio_convert_s16_to_float(g_extern.audio_data.outsamples, data,
+            samples, g_extern.audio_data.volume_gain);
+      ret = driver.audio->write(driver.audio_data,
+            g_extern.audio_data.outsamples, samples * sizeof(float));
+   }
+   else
+      ret = driver.audio->write(driver.audio_data,
+            data, samples * sizeof(int16_t));
+
+   RARCH_PERFORMANCE_STOP(audio_passthrough);
+   return ret;
+}
+
+/**
+ * audio_flush_blocks:
+ * @data                 : pointer to audio buffer.
+ * @samples              : amount of samples to write.
+ *
+ * Converts, filters and resamples @data one block of
+ * AUDIO_BLOCK_FRAMES at a time, so every stage works on
+ * data the previous stage just left in cache.
+ *
+ * Returns: result of the audio driver write.
+ **/
+static ssize_t audio_flush_blocks(const int16_t *data, size_t samples)
 {
-   int avail = driver.audio->write_avail(driver.audio_data);
+   size_t i;
+   ssize_t ret;
+   size_t out_samples  = 0;
+   size_t conv_samples = 0;
+   float *outsamples   = g_extern.audio_data.outsamples;
+   bool use_float      = g_extern.audio_data.use_float;
+   double ratio;
+
+   if (g_extern.audio_data.rate_control)
+      audio_driver_readjust_input_rate();
+
+   ratio = g_extern.audio_data.src_ratio;
+   if (g_extern.is_slowmotion)
+      ratio *= g_settings.slowmotion_ratio;
+
+   RARCH_PERFORMANCE_INIT(audio_pipeline);
+   RARCH_PERFORMANCE_START(audio_pipeline);
+
+   for (i = 0; i < samples; i += AUDIO_BLOCK_FRAMES * 2)
+   {
+      struct resampler_data src_data = {0};
+      struct rarch_dsp_data dsp_data = {0};
+      size_t block = samples - i;
+
+      if (block > AUDIO_BLOCK_FRAMES * 2)
+         block = AUDIO_BLOCK_FRAMES * 2;
+
+      audio_convert_s16_to_float(g_extern.audio_data.data, data + i, block,
+            g_extern.audio_data.volume_gain);
 
-   //RARCH_LOG_OUTPUT("Audio buffer is %u%% full\n",
-   //      (unsigned)(100 - (avail * 100) / g_extern.audio_data.driver_buffer_size));
+      src_data.data_in      = g_extern.audio_data.data;
+      src_data.input_frames = block >> 1;
 
-   unsigned write_idx = g_extern.measure_data.buffer_free_samples_count++ &
-      (AUDIO_BUFFER_FREE_SAMPLES_COUNT - 1);
-   int      half_size   = g_extern.audio_data.driver_buffer_size / 2;
-   int      delta_mid   = avail - half_size;
-   double   direction   = (double)delta_mid / half_size;
-   double   adjust      = 1.0 + g_settings.audio.rate_control_delta *
-      direction;
+      if (g_extern.audio_data.dsp)
+      {
+         dsp_data.input        = g_extern.audio_data.data;
+         dsp_data.input_frames = block >> 1;
+
+         rarch_dsp_filter_process(g_extern.audio_data.dsp, &dsp_data);
+
+         if (dsp_data.output)
+         {
+            src_data.data_in      = dsp_data.output;
+            src_data.input_frames = dsp_data.output_frames;
+         }
+      }
 
-   g_extern.measure_data.buffer_free_samples[write_idx] = avail;
-   g_extern.audio_data.src_ratio = g_extern.audio_data.orig_src_ratio * adjust;
+      src_data.data_out = outsamples + out_samples;
+      src_data.ratio    = ratio;
 
-   //RARCH_LOG_OUTPUT("New rate: %lf, Orig rate: %lf\n",
-   //      g_extern.audio_data.src_ratio, g_extern.audio_data.orig_src_ratio);
+      rarch_resampler_process(driver.resampler,
+            driver.resampler_data, &src_data);
+
+      out_samples += src_data.output_frames * 2;
+
+      /* Convert whatever is done so far, in multiples of 8
+       * samples so both buffers stay 16-byte aligned for
+       * the SIMD converters. */
+      if (!use_float)
+      {
+         size_t conv = (out_samples - conv_samples) & ~7;
+         audio_convert_float_to_s16(
+               g_extern.audio_data.conv_outsamples + conv_samples,
+               outsamples + conv_samples, conv);
+         conv_samples += conv;
+      }
+   }
+
+   if (!use_float)
+      audio_convert_float_to_s16(
+            g_extern.audio_data.conv_outsamples + conv_samples,
+            outsamples + conv_samples, out_samples - conv_samples);
+
+   RARCH_PERFORMANCE_STOP(audio_pipeline);
+
+   if (use_float)
+      ret = driver.audio->write(driver.audio_data,
+            outsamples, out_samples * sizeof(float));
+   else
+      ret = driver.audio->write(driver.audio_data,
+            g_extern.audio_data.conv_outsamples,
+            out_samples * sizeof(int16_t));
+
+   return ret;
+}
+
+#ifdef HAVE_THREADS
+/**
+ * audio_flush_threaded:
+ * @data                 : pointer to audio buffer.
+ * @samples              : amount of samples to write.
+ *
+ * Hands @data to the DSP thread, which does the rest of
+ * the pipeline, and writes out what it has finished.
+ *
+ * Returns: -1 if the audio driver failed, otherwise 0.
+ **/
+static ssize_t audio_flush_threaded(const int16_t *data, size_t samples)
+{
+   double ratio;
+
+   if (g_extern.audio_data.rate_control)
+      audio_driver_readjust_input_rate();
+
+   ratio = g_extern.audio_data.src_ratio;
+   if (g_extern.is_slowmotion)
+      ratio *= g_settings.slowmotion_ratio;
+
+   if (!audio_dsp_thread_push(g_extern.audio_data.dsp_thread,
+            data, samples, ratio))
+      return -1;
+   return 0;
 }
+#endif
 
 /**
  * retro_flush_audio:
  * @data                 : pointer to audio buffer.
- * @right                : amount of samples to write.
+ * @samples              : amount of samples to write.
  *
  * Writes audio samples to audio driver. Will first
  * perform DSP processing (if enabled) and resampling.
@@ -159,11 +300,8 @@ static void readjust_audio_input_rate(void)
  **/
 bool retro_flush_audio(const int16_t *data, size_t samples)
 {
-   const void *output_data        = NULL;
-   unsigned output_frames         = 0;
-   size_t   output_size           = sizeof(float);
-   struct resampler_data src_data = {0};
-   struct rarch_dsp_data dsp_data = {0};
+   ssize_t ret;
+   bool passthrough;
 
    if (driver.recording_data)
    {
@@ -180,64 +318,28 @@ bool retro_flush_audio(const int16_t *data, size_t samples)
    if (!driver.audio_active || !g_extern.audio_data.data)
       return false;
 
-   RARCH_PERFORMANCE_INIT(audio_convert_s16);
-   RARCH_PERFORMANCE_START(audio_convert_s16);
-   audio_convert_s16_to_float(g_extern.audio_data.data, data, samples,
-         g_extern.audio_data.volume_gain);
-   RARCH_PERFORMANCE_STOP(audio_convert_s16);
-
-   src_data.data_in               = g_extern.audio_data.data;
-   src_data.input_frames          = samples >> 1;
-
-   dsp_data.input                 = g_extern.audio_data.data;
-   dsp_data.input_frames          = samples >> 1;
-
-   if (g_extern.audio_data.dsp)
-   {
-      RARCH_PERFORMANCE_INIT(audio_dsp);
-      RARCH_PERFORMANCE_START(audio_dsp);
-      rarch_dsp_filter_process(g_extern.audio_data.dsp, &dsp_data);
-      RARCH_PERFORMANCE_STOP(audio_dsp);
-
-      if (dsp_data.output)
-      {
-         src_data.data_in      = dsp_data.output;
-         src_data.input_frames = dsp_data.output_frames;
-      }
-   }
-
-   src_data.data_out = g_extern.audio_data.outsamples;
-
-   if (g_extern.audio_data.rate_control)
-      readjust_audio_input_rate();
-
-   src_data.ratio = g_extern.audio_data.src_ratio;
-   if (g_extern.is_slowmotion)
-      src_data.ratio *= g_settings.slowmotion_ratio;
-
-   RARCH_PERFORMANCE_INIT(resampler_proc);
-   RARCH_PERFORMANCE_START(resampler_proc);
-   rarch_resampler_process(driver.resampler,
-         driver.resampler_data, &src_data);
-   RARCH_PERFORMANCE_STOP(resampler_proc);
-
-   output_data   = g_extern.audio_data.outsamples;
-   output_frames = src_data.output_frames;
-
-   if (!g_extern.audio_data.use_float)
-   {
-      RARCH_PERFORMANCE_INIT(audio_convert_float);
-      RARCH_PERFORMANCE_START(audio_convert_float);
-      audio_convert_float_to_s16(g_extern.audio_data.conv_outsamples,
-            (const float*)output_data, output_frames * 2);
-      RARCH_PERFORMANCE_STOP(audio_convert_float);
-
-      output_data = g_extern.audio_data.conv_outsamples;
-      output_size = sizeof(int16_t);
-   }
+   /* Core and driver already agree on the rate, and nothing
+    * would change the samples but the volume. Rate control
+    * is checked instead of the current ratio, so we don't
+    * flip between paths while it adjusts. */
+   passthrough = !g_extern.audio_data.dsp &&
+      !g_extern.audio_data.rate_control &&
+      !g_extern.is_slowmotion &&
+      g_extern.audio_data.orig_src_ratio == 1.0 &&
+      (g_extern.audio_data.use_float ||
+       g_extern.audio_data.volume_gain == 1.0f);
+
+#ifdef HAVE_THREADS
+   if (g_extern.audio_data.dsp_thread)
+      ret = audio_flush_threaded(data, samples);
+   else
+#endif
+   if (passthrough)
+      ret = audio_flush_passthrough(data, samples);
+   else
+      ret = audio_flush_blocks(data, samples);
 
-   if (driver.audio->write(driver.audio_data, output_data,
-            output_frames * output_size * 2) < 0)
+   if (ret < 0)
    {
       RARCH_ERR(RETRO_LOG_AUDIO_WRITE_FAILED);
 
@@ -257,13 +359,16 @@ bool retro_flush_audio(const int16_t *data, size_t samples)
  **/
 static void audio_sample(int16_t left, int16_t right)
 {
-   g_extern.audio_data.conv_outsamples[g_extern.audio_data.data_ptr++] = left;
-   g_extern.audio_data.conv_outsamples[g_extern.audio_data.data_ptr++] = right;
+   if (g_extern.run_ahead.hide_audio)
+      return;
+
+   g_extern.audio_data.sample_buf[g_extern.audio_data.data_ptr++] = left;
+   g_extern.audio_data.sample_buf[g_extern.audio_data.data_ptr++] = right;
 
    if (g_extern.audio_data.data_ptr < g_extern.audio_data.chunk_size)
       return;
 
-   retro_flush_audio(g_extern.audio_data.conv_outsamples, g_extern.audio_data.data_ptr);
+   retro_flush_audio(g_extern.audio_data.sample_buf, g_extern.audio_data.data_ptr);
 
    g_extern.audio_data.data_ptr = 0;
 }
@@ -283,6 +388,9 @@ static size_t audio_sample_batch(const int16_t *data, size_t frames)
    if (frames > (AUDIO_CHUNK_SIZE_NONBLOCKING >> 1))
       frames = AUDIO_CHUNK_SIZE_NONBLOCKING >> 1;
 
+   if (g_extern.run_ahead.hide_audio)
+      return frames;
+
    retro_flush_audio(data, frames << 1);
 
    return frames;
@@ -263,6 +263,16 @@ static INLINE void get_title(const char *label, const char *dir,
       strlcpy(title, "CORE INPUT REMAPPING OPTIONS", sizeof_title);
    else if (!strcmp(label, "core_information"))
       strlcpy(title, "CORE INFO", sizeof_title);
+   else if (!strcmp(label, "rewind_information"))
+      strlcpy(title, "REWIND INFO", sizeof_title);
+   else if (!strcmp(label, "frame_delay_information"))
+      strlcpy(title, "FRAME DELAY INFO", sizeof_title);
+   else if (!strcmp(label, "audio_information"))
+      strlcpy(title, "AUDIO INFO", sizeof_title);
+   else if (!strcmp(label, "video_information"))
+      strlcpy(title, "VIDEO INFO", sizeof_title);
+   else if (!strcmp(label, "netplay_information"))
+      strlcpy(title, "NETPLAY INFO", sizeof_title);
    else if (!strcmp(elem0, "Privacy Options"))
    {
       strlcpy(title, "PRIVACY OPTIONS", sizeof_title);
@@ -26,6 +26,11 @@
 #include "../../gfx/gl_common.h"
 #include "../../gfx/video_thread_wrapper.h"
 #include <compat/posix_string.h>
+#include <retro_miscellaneous.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "shared.h"
 #include "../menu_animation.h"
@@ -38,6 +43,16 @@
 #define XMB_DELAY 0.02
 #endif
 
+/* Icons are packed into atlas pages of cells this big,
+ * which matches the icons in xmb->icon_dir. */
+#define XMB_ATLAS_CELL 256
+#define XMB_ATLAS_MAX_CELLS 8
+
+/* Decoded textures uploaded per frame at most. */
+#define XMB_UPLOADS_PER_FRAME 16
+
+#define XMB_PLACEHOLDER_SIZE 16
+
 typedef struct
 {
    float alpha;
@@ -45,8 +60,8 @@ typedef struct
    float zoom;
    float x;
    float y;
-   GLuint icon;
-   GLuint content_icon;
+   struct xmb_texture_item *icon;
+   struct xmb_texture_item *content_icon;
 } xmb_node_t;
 
 enum
@@ -71,12 +86,37 @@ enum
    XMB_TEXTURE_LAST
 };
 
+enum xmb_texture_state
+{
+   XMB_TEXTURE_STATE_PENDING = 0,
+   XMB_TEXTURE_STATE_DECODED,
+   XMB_TEXTURE_STATE_READY,
+   XMB_TEXTURE_STATE_FAILED
+};
+
 struct xmb_texture_item
 {
+   /* Texture to bind, the placeholder until the image is uploaded
+    * and 0 if it can't be loaded. */
    GLuint id;
+   GLfloat tex_coord[8];
+   /* Goes into an atlas cell rather than a texture of its own. */
+   bool atlas;
+
+   /* Guarded by the loader lock until the state is READY. */
+   enum xmb_texture_state state;
+   struct texture_image image;
+
    char path[PATH_MAX_LENGTH];
 };
 
+struct xmb_atlas_page
+{
+   GLuint id;
+   /* Mipmaps have to be regenerated. */
+   bool dirty;
+};
+
 typedef struct xmb_handle
 {
    file_list_t *menu_stack_old;
@@ -91,7 +131,23 @@ typedef struct xmb_handle
    char icon_dir[4];
    char box_message[PATH_MAX_LENGTH];
    char title[PATH_MAX_LENGTH];
-   struct xmb_texture_item textures[XMB_TEXTURE_LAST];
+   /* The XMB_TEXTURE_* ones, then icon and content icon of each core. */
+   struct xmb_texture_item *textures;
+   unsigned num_textures;
+   GLuint placeholder;
+   GLuint bound_texture;
+   struct xmb_atlas_page *atlas_pages;
+   unsigned num_atlas_pages;
+   unsigned atlas_cols;
+   unsigned atlas_rows;
+#ifdef HAVE_THREADS
+   sthread_t *loader;
+   slock_t *loader_lock;
+   bool loader_cancel;
+#endif
+   /* Textures decoded or failed, which xmb_textures_upload()
+    * hasn't looked at yet. */
+   unsigned loader_finished;
    int icon_size;
    float x;
    float categories_x;
@@ -197,8 +253,8 @@ static char *xmb_str_replace (const char *string,
    return newstr;
 }
 
-static void xmb_draw_icon(GLuint texture, float x, float y,
-      float alpha, float rotation, float scale_factor)
+static void xmb_draw_icon(const struct xmb_texture_item *icon,
+      float x, float y, float alpha, float rotation, float scale_factor)
 {
    struct gl_coords coords;
    math_matrix_4x4 mymat, mrot, mscal;
@@ -211,7 +267,7 @@ static void xmb_draw_icon(GLuint texture, float x, float y,
    if (alpha > xmb->alpha)
       alpha = xmb->alpha;
 
-   if (alpha == 0)
+   if (alpha == 0 || !icon || !icon->id)
       return;
 
    gl = (gl_t*)video_driver_resolve(NULL);
@@ -237,10 +293,16 @@ static void xmb_draw_icon(GLuint texture, float x, float y,
 
    coords.vertices = 4;
    coords.vertex = rmb_vertex;
-   coords.tex_coord = rmb_tex_coord;
-   coords.lut_tex_coord = rmb_tex_coord;
+   coords.tex_coord = icon->tex_coord;
+   coords.lut_tex_coord = icon->tex_coord;
    coords.color = color;
-   glBindTexture(GL_TEXTURE_2D, texture);
+
+   /* Icons from the same atlas page follow each other. */
+   if (icon->id != xmb->bound_texture)
+   {
+      glBindTexture(GL_TEXTURE_2D, icon->id);
+      xmb->bound_texture = icon->id;
+   }
 
    matrix_4x4_rotate_z(&mrot, rotation);
    matrix_4x4_multiply(&mymat, &mrot, &gl->mvp_no_rot);
@@ -297,6 +359,9 @@ static void xmb_draw_text(const char *str, float x,
        && driver.video_poke->set_osd_msg)
        driver.video_poke->set_osd_msg(driver.video_data,
                                       str, &params, xmb->font);
+
+   /* The font renderer binds its own texture. */
+   xmb->bound_texture = 0;
 }
 
 static void xmb_render_background(bool force_transparency)
@@ -360,7 +425,7 @@ static void xmb_render_background(bool force_transparency)
    if ((g_settings.menu.pause_libretro
       || !g_extern.main_is_init || g_extern.libretro_dummy)
       && !force_transparency
-      && xmb->textures[XMB_TEXTURE_BG].id)
+      && xmb->textures && xmb->textures[XMB_TEXTURE_BG].id)
    {
       coords.color = color;
       glBindTexture(GL_TEXTURE_2D, xmb->textures[XMB_TEXTURE_BG].id);
@@ -380,6 +445,7 @@ static void xmb_render_background(bool force_transparency)
    glDisable(GL_BLEND);
 
    gl->coords.color = gl->white_color_ptr;
+   xmb->bound_texture = 0;
 }
 
 static void xmb_get_message(const char *message)
@@ -567,51 +633,382 @@ static void xmb_list_open_new(file_list_t *list, int dir, size_t current)
    xmb->old_depth = xmb->depth;
 }
 
-static GLuint xmb_png_texture_load_(const char * file_name)
+static void xmb_loader_lock(xmb_handle_t *xmb)
+{
+#ifdef HAVE_THREADS
+   if (xmb->loader_lock)
+      slock_lock(xmb->loader_lock);
+#endif
+}
+
+static void xmb_loader_unlock(xmb_handle_t *xmb)
+{
+#ifdef HAVE_THREADS
+   if (xmb->loader_lock)
+      slock_unlock(xmb->loader_lock);
+#endif
+}
+
+/**
+ * xmb_texture_decode:
+ * @data               : XMB handle.
+ * @index              : texture to decode.
+ *
+ * Decodes a texture into memory. Runs on the video task pool,
+ * many at the same time, so it doesn't touch GL.
+ **/
+static void xmb_texture_decode(void *data, unsigned index)
+{
+   bool cancel                   = false;
+   struct texture_image ti       = {0};
+   xmb_handle_t *xmb             = (xmb_handle_t*)data;
+   struct xmb_texture_item *item = &xmb->textures[index];
+
+#ifdef HAVE_THREADS
+   xmb_loader_lock(xmb);
+   cancel = xmb->loader_cancel;
+   xmb_loader_unlock(xmb);
+#endif
+
+   if (!cancel && path_file_exists(item->path)
+         && !texture_image_load(&ti, item->path))
+      memset(&ti, 0, sizeof(ti));
+
+   xmb_loader_lock(xmb);
+   item->image = ti;
+   item->state = ti.pixels ?
+      XMB_TEXTURE_STATE_DECODED : XMB_TEXTURE_STATE_FAILED;
+   xmb->loader_finished++;
+   xmb_loader_unlock(xmb);
+}
+
+#ifdef HAVE_THREADS
+static void xmb_loader_thread(void *data)
+{
+   xmb_handle_t *xmb = (xmb_handle_t*)data;
+
+   task_pool_run(driver.video_pool, xmb_texture_decode,
+         xmb, xmb->num_textures);
+}
+#endif
+
+/**
+ * xmb_loader_start:
+ * @xmb                : XMB handle.
+ *
+ * Starts decoding all textures in the background. The menu keeps
+ * rendering with placeholders, and xmb_textures_upload() picks up
+ * whatever has been decoded each frame. Without threads, they're
+ * decoded right away.
+ **/
+static void xmb_loader_start(xmb_handle_t *xmb)
+{
+   unsigned i;
+
+#ifdef HAVE_THREADS
+   if (!xmb->loader_lock)
+      xmb->loader_lock = slock_new();
+
+   xmb->loader_cancel = false;
+
+   if (xmb->loader_lock)
+      xmb->loader = sthread_create(xmb_loader_thread, xmb);
+
+   if (xmb->loader)
+      return;
+#endif
+
+   for (i = 0; i < xmb->num_textures; i++)
+      xmb_texture_decode(xmb, i);
+}
+
+/* Drops whatever hasn't been decoded yet and waits for the loader. */
+static void xmb_loader_stop(xmb_handle_t *xmb)
+{
+#ifdef HAVE_THREADS
+   if (!xmb->loader)
+      return;
+
+   xmb_loader_lock(xmb);
+   xmb->loader_cancel = true;
+   xmb_loader_unlock(xmb);
+
+   sthread_join(xmb->loader);
+   xmb->loader = NULL;
+#endif
+}
+
+/* Frees the textures in memory, the loader must be stopped. */
+static void xmb_textures_free(xmb_handle_t *xmb)
 {
-   struct texture_image ti = {0};
+   unsigned i;
+
+   for (i = 0; i < xmb->num_textures; i++)
+   {
+      if (xmb->textures[i].state == XMB_TEXTURE_STATE_DECODED)
+         texture_image_free(&xmb->textures[i].image);
+   }
+
+   free(xmb->textures);
+   xmb->textures        = NULL;
+   xmb->num_textures    = 0;
+   xmb->loader_finished = 0;
+}
+
+static void xmb_textures_new(xmb_handle_t *xmb, unsigned count)
+{
+   unsigned i;
+
+   xmb->textures = (struct xmb_texture_item*)
+      calloc(count, sizeof(*xmb->textures));
+
+   if (!xmb->textures)
+      return;
+
+   xmb->num_textures = count;
+
+   /* The background is much bigger than the icons. */
+   for (i = 0; i < count; i++)
+      xmb->textures[i].atlas = i != XMB_TEXTURE_BG;
+}
+
+static GLuint xmb_placeholder_new(void)
+{
+   unsigned x, y;
    GLuint texture = 0;
+   uint8_t pixels[XMB_PLACEHOLDER_SIZE * XMB_PLACEHOLDER_SIZE * 4];
+   int center     = XMB_PLACEHOLDER_SIZE - 1;
+   int radius     = XMB_PLACEHOLDER_SIZE / 2;
 
-   if (! path_file_exists(file_name))
-      return 0;
+   /* A faint dot in the middle, coordinates are doubled
+    * so the center falls between pixels. */
+   for (y = 0; y < XMB_PLACEHOLDER_SIZE; y++)
+   {
+      for (x = 0; x < XMB_PLACEHOLDER_SIZE; x++)
+      {
+         int dx      = 2 * x - center;
+         int dy      = 2 * y - center;
+         uint8_t *px = &pixels[(y * XMB_PLACEHOLDER_SIZE + x) * 4];
 
-   texture_image_load(&ti, file_name);
+         px[0] = px[1] = px[2] = 0xff;
+         px[3] = (dx * dx + dy * dy <= radius * radius) ? 0x60 : 0;
+      }
+   }
 
-   /* Generate the OpenGL texture object */
    glGenTextures(1, &texture);
    glBindTexture(GL_TEXTURE_2D, texture);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, ti.width, ti.height, 0,
-         GL_RGBA, GL_UNSIGNED_BYTE, ti.pixels);
-   glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, XMB_PLACEHOLDER_SIZE,
+         XMB_PLACEHOLDER_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+   glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-   glGenerateMipmap(GL_TEXTURE_2D);
-
-   free(ti.pixels);
 
    return texture;
 }
 
-static int xmb_png_texture_load_wrap(void *data)
+/**
+ * xmb_atlas_init:
+ * @xmb                : XMB handle.
+ *
+ * Creates the placeholder and enough empty atlas pages for all
+ * icons, which all show the placeholder for now. Needs the GL
+ * context, so it's done on the first frame.
+ **/
+static void xmb_atlas_init(xmb_handle_t *xmb)
 {
-   const char *filename = (const char*)data;
-   return xmb_png_texture_load_(filename);
+   unsigned i, cells, per_page, max_cells;
+   GLint max_size = 0;
+   void *zero     = NULL;
+
+   xmb->placeholder = xmb_placeholder_new();
+
+   for (i = 0; i < xmb->num_textures; i++)
+   {
+      if (!xmb->textures[i].atlas)
+         continue;
+      xmb->textures[i].id = xmb->placeholder;
+      memcpy(xmb->textures[i].tex_coord, rmb_tex_coord,
+            sizeof(rmb_tex_coord));
+   }
+
+   cells = xmb->num_textures - 1;
+   if (!cells)
+      return;
+
+   glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+   max_cells = max(min(max_size / XMB_ATLAS_CELL, XMB_ATLAS_MAX_CELLS), 1);
+
+   xmb->atlas_cols = min(next_pow2(cells), max_cells);
+   xmb->atlas_rows = min(next_pow2((cells + xmb->atlas_cols - 1)
+            / xmb->atlas_cols), max_cells);
+   per_page        = xmb->atlas_cols * xmb->atlas_rows;
+
+   xmb->num_atlas_pages = (cells + per_page - 1) / per_page;
+   xmb->atlas_pages     = (struct xmb_atlas_page*)
+      calloc(xmb->num_atlas_pages, sizeof(*xmb->atlas_pages));
+
+   /* Cleared, as filtering reaches into the neighbouring cells. */
+   zero = calloc(per_page, XMB_ATLAS_CELL * XMB_ATLAS_CELL * 4);
+
+   if (!xmb->atlas_pages || !zero)
+   {
+      free(xmb->atlas_pages);
+      xmb->atlas_pages     = NULL;
+      xmb->num_atlas_pages = 0;
+      free(zero);
+      return;
+   }
+
+   for (i = 0; i < xmb->num_atlas_pages; i++)
+   {
+      glGenTextures(1, &xmb->atlas_pages[i].id);
+      glBindTexture(GL_TEXTURE_2D, xmb->atlas_pages[i].id);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
+            xmb->atlas_cols * XMB_ATLAS_CELL,
+            xmb->atlas_rows * XMB_ATLAS_CELL, 0,
+            GL_RGBA, GL_UNSIGNED_BYTE, zero);
+      glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+      glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      xmb->atlas_pages[i].dirty = true;
+   }
+
+   free(zero);
+}
+
+/**
+ * xmb_texture_upload_atlas:
+ * @xmb                : XMB handle.
+ * @index              : texture to upload.
+ *
+ * Copies a decoded icon into its atlas cell. Each texture but
+ * the background has a cell of its own, in order.
+ *
+ * Returns: true if it's in the atlas, false if it doesn't fit
+ * into a cell.
+ **/
+static bool xmb_texture_upload_atlas(xmb_handle_t *xmb, unsigned index)
+{
+   unsigned x, y, cell;
+   GLfloat x0, y0, x1, y1;
+   struct xmb_atlas_page *page   = NULL;
+   struct xmb_texture_item *item = &xmb->textures[index];
+   unsigned per_page             = xmb->atlas_cols * xmb->atlas_rows;
+   unsigned slot                 = index - 1;
+
+   if (!item->atlas || !per_page || slot / per_page >= xmb->num_atlas_pages
+         || item->image.width > XMB_ATLAS_CELL
+         || item->image.height > XMB_ATLAS_CELL)
+      return false;
+
+   page = &xmb->atlas_pages[slot / per_page];
+   cell = slot % per_page;
+   x    = (cell % xmb->atlas_cols) * XMB_ATLAS_CELL;
+   y    = (cell / xmb->atlas_cols) * XMB_ATLAS_CELL;
+
+   glBindTexture(GL_TEXTURE_2D, page->id);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, x, y,
+         item->image.width, item->image.height,
+         GL_RGBA, GL_UNSIGNED_BYTE, item->image.pixels);
+   page->dirty = true;
+
+   /* Half a texel in, so the edges don't blend with the next cell. */
+   x0 = (x + 0.5f) / (xmb->atlas_cols * XMB_ATLAS_CELL);
+   x1 = (x + item->image.width - 0.5f) / (xmb->atlas_cols * XMB_ATLAS_CELL);
+   y0 = (y + 0.5f) / (xmb->atlas_rows * XMB_ATLAS_CELL);
+   y1 = (y + item->image.height - 0.5f) / (xmb->atlas_rows * XMB_ATLAS_CELL);
+
+   item->id           = page->id;
+   item->tex_coord[0] = x0;
+   item->tex_coord[1] = y1;
+   item->tex_coord[2] = x1;
+   item->tex_coord[3] = y1;
+   item->tex_coord[4] = x0;
+   item->tex_coord[5] = y0;
+   item->tex_coord[6] = x1;
+   item->tex_coord[7] = y0;
+
+   return true;
 }
 
-static GLuint xmb_png_texture_load(const char* file_name)
+static void xmb_texture_upload(xmb_handle_t *xmb, unsigned index)
 {
-   if (g_settings.video.threaded
-         && !g_extern.system.hw_render_callback.context_type)
+   struct xmb_texture_item *item = &xmb->textures[index];
+
+   if (!xmb_texture_upload_atlas(xmb, index))
    {
-      thread_video_t *thr = (thread_video_t*)driver.video_data;
-      thr->cmd_data.custom_command.method = xmb_png_texture_load_wrap;
-      thr->cmd_data.custom_command.data   = (void*)file_name;
-      thr->send_cmd_func(thr, CMD_CUSTOM_COMMAND);
-      thr->wait_reply_func(thr, CMD_CUSTOM_COMMAND);
+      item->atlas = false;
+
+      glGenTextures(1, &item->id);
+      glBindTexture(GL_TEXTURE_2D, item->id);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
+            item->image.width, item->image.height, 0,
+            GL_RGBA, GL_UNSIGNED_BYTE, item->image.pixels);
+      glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+      glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      glGenerateMipmap(GL_TEXTURE_2D);
+
+      memcpy(item->tex_coord, rmb_tex_coord, sizeof(rmb_tex_coord));
+   }
+
+   texture_image_free(&item->image);
+}
+
+/**
+ * xmb_textures_upload:
+ * @xmb                : XMB handle.
+ *
+ * Uploads textures the loader has decoded since the last frame,
+ * up to XMB_UPLOADS_PER_FRAME, then regenerates the mipmaps of
+ * the atlas pages they went into, once per page. Icons which
+ * can't be loaded stop showing the placeholder.
+ **/
+static void xmb_textures_upload(xmb_handle_t *xmb)
+{
+   unsigned i, count = 0;
+   unsigned batch[XMB_UPLOADS_PER_FRAME];
+
+   if (!xmb->textures)
+      return;
+
+   if (!xmb->placeholder)
+      xmb_atlas_init(xmb);
+
+   xmb_loader_lock(xmb);
+   for (i = 0; xmb->loader_finished && i < xmb->num_textures; i++)
+   {
+      struct xmb_texture_item *item = &xmb->textures[i];
+
+      if (item->state == XMB_TEXTURE_STATE_FAILED)
+         item->id = 0;
+      else if (item->state != XMB_TEXTURE_STATE_DECODED
+            || count == XMB_UPLOADS_PER_FRAME)
+         continue;
+      else
+         batch[count++] = i;
+
+      /* Ready from now on, so the loader won't touch it anymore. */
+      item->state = XMB_TEXTURE_STATE_READY;
+      xmb->loader_finished--;
+   }
+   xmb_loader_unlock(xmb);
+
+   if (!count)
+      return;
+
+   for (i = 0; i < count; i++)
+      xmb_texture_upload(xmb, batch[i]);
+
+   for (i = 0; i < xmb->num_atlas_pages; i++)
+   {
+      if (!xmb->atlas_pages[i].dirty)
+         continue;
 
-      return thr->cmd_data.custom_command.return_value;
+      glBindTexture(GL_TEXTURE_2D, xmb->atlas_pages[i].id);
+      glGenerateMipmap(GL_TEXTURE_2D);
+      xmb->atlas_pages[i].dirty = false;
    }
 
-   return xmb_png_texture_load_(file_name);
+   glBindTexture(GL_TEXTURE_2D, 0);
+   xmb->bound_texture = 0;
 }
 
 static xmb_node_t* xmb_node_for_core(int i)
@@ -889,52 +1286,52 @@ static void xmb_draw_items(file_list_t *list, file_list_t *stack,
       if (type == MENU_FILE_CONTENTLIST_ENTRY)
          strlcpy(path_buf, path_basename(path_buf), sizeof(path_buf));
 
-      GLuint icon = 0;
+      struct xmb_texture_item *icon = NULL;
       switch(type)
       {
          case MENU_FILE_DIRECTORY:
-            icon = xmb->textures[XMB_TEXTURE_FOLDER].id;
+            icon = &xmb->textures[XMB_TEXTURE_FOLDER];
             break;
          case MENU_FILE_PLAIN:
-            icon = xmb->textures[XMB_TEXTURE_FILE].id;
+            icon = &xmb->textures[XMB_TEXTURE_FILE];
             break;
          case MENU_FILE_PLAYLIST_ENTRY:
-            icon = xmb->textures[XMB_TEXTURE_FILE].id;
+            icon = &xmb->textures[XMB_TEXTURE_FILE];
             break;
          case MENU_FILE_CONTENTLIST_ENTRY:
-            icon = core_node ? core_node->content_icon : xmb->textures[XMB_TEXTURE_FILE].id;
+            icon = core_node ? core_node->content_icon : &xmb->textures[XMB_TEXTURE_FILE];
             break;
          case MENU_FILE_CARCHIVE:
-            icon = xmb->textures[XMB_TEXTURE_ZIP].id;
+            icon = &xmb->textures[XMB_TEXTURE_ZIP];
             break;
          case MENU_FILE_CORE:
-            icon = xmb->textures[XMB_TEXTURE_CORE].id;
+            icon = &xmb->textures[XMB_TEXTURE_CORE];
             break;
          case MENU_SETTING_ACTION_RUN:
-            icon = xmb->textures[XMB_TEXTURE_RUN].id;
+            icon = &xmb->textures[XMB_TEXTURE_RUN];
             break;
          case MENU_SETTING_ACTION_SAVESTATE:
-            icon = xmb->textures[XMB_TEXTURE_SAVESTATE].id;
+            icon = &xmb->textures[XMB_TEXTURE_SAVESTATE];
             break;
          case MENU_SETTING_ACTION_LOADSTATE:
-            icon = xmb->textures[XMB_TEXTURE_LOADSTATE].id;
+            icon = &xmb->textures[XMB_TEXTURE_LOADSTATE];
             break;
          case MENU_SETTING_ACTION_SCREENSHOT:
-            icon = xmb->textures[XMB_TEXTURE_SCREENSHOT].id;
+            icon = &xmb->textures[XMB_TEXTURE_SCREENSHOT];
             break;
          case MENU_SETTING_ACTION_RESET:
-            icon = xmb->textures[XMB_TEXTURE_RELOAD].id;
+            icon = &xmb->textures[XMB_TEXTURE_RELOAD];
             break;
          case MENU_SETTING_ACTION:
             icon = (xmb->depth == 3) ?
-                  xmb->textures[XMB_TEXTURE_SUBSETTING].id :
-                  xmb->textures[XMB_TEXTURE_SETTING].id;
+                  &xmb->textures[XMB_TEXTURE_SUBSETTING] :
+                  &xmb->textures[XMB_TEXTURE_SETTING];
             break;
          case MENU_SETTING_GROUP:
-            icon = xmb->textures[XMB_TEXTURE_SETTING].id;
+            icon = &xmb->textures[XMB_TEXTURE_SETTING];
             break;
          default:
-            icon = xmb->textures[XMB_TEXTURE_SUBSETTING].id;
+            icon = &xmb->textures[XMB_TEXTURE_SUBSETTING];
             break;
       }
 
@@ -978,7 +1375,7 @@ static void xmb_draw_items(file_list_t *list, file_list_t *stack,
                0);
 
       if (!strcmp(val_buf, "ON") && xmb->textures[XMB_TEXTURE_SWITCH_ON].id)
-         xmb_draw_icon(xmb->textures[XMB_TEXTURE_SWITCH_ON].id,
+         xmb_draw_icon(&xmb->textures[XMB_TEXTURE_SWITCH_ON],
                node->x + xmb->margin_left + xmb->hspacing
                + xmb->icon_size/2.0 + xmb->setting_margin_left,
                xmb->margin_top + node->y + xmb->icon_size/2.0,
@@ -987,7 +1384,7 @@ static void xmb_draw_items(file_list_t *list, file_list_t *stack,
                1);
 
       if (!strcmp(val_buf, "OFF") && xmb->textures[XMB_TEXTURE_SWITCH_OFF].id)
-         xmb_draw_icon(xmb->textures[XMB_TEXTURE_SWITCH_OFF].id,
+         xmb_draw_icon(&xmb->textures[XMB_TEXTURE_SWITCH_OFF],
                node->x + xmb->margin_left + xmb->hspacing
                + xmb->icon_size/2.0 + xmb->setting_margin_left,
                xmb->margin_top + node->y + xmb->icon_size/2.0,
@@ -1007,11 +1404,14 @@ static void xmb_frame(void)
 
    gl_t *gl = (gl_t*)video_driver_resolve(NULL);
 
-   if (!xmb || !gl)
+   if (!xmb || !gl || !xmb->textures)
       return;
 
    update_tweens(0.002);
 
+   xmb->bound_texture = 0;
+   xmb_textures_upload(xmb);
+
    glViewport(0, 0, gl->win_width, gl->win_height);
 
    xmb_render_background(false);
@@ -1046,7 +1446,7 @@ static void xmb_frame(void)
          gl->win_height - xmb->title_margin_bottom, 1, 1, 0);
 
 
-   xmb_draw_icon(xmb->textures[XMB_TEXTURE_ARROW].id,
+   xmb_draw_icon(&xmb->textures[XMB_TEXTURE_ARROW],
          xmb->x + xmb->margin_left + xmb->hspacing - xmb->icon_size/2.0 + xmb->icon_size,
          xmb->margin_top + xmb->icon_size/2.0 + xmb->vspacing * xmb->active_item_factor,
          xmb->arrow_alpha,
@@ -1229,10 +1629,21 @@ static void *xmb_init(void)
 static void xmb_free(void *data)
 {
    menu_handle_t *menu = (menu_handle_t*)data;
+   xmb_handle_t *xmb   = menu ? (xmb_handle_t*)menu->userdata : NULL;
 
    if (g_extern.core_info)
       core_info_list_free(g_extern.core_info);
 
+   if (xmb)
+   {
+      xmb_loader_stop(xmb);
+      xmb_textures_free(xmb);
+#ifdef HAVE_THREADS
+      if (xmb->loader_lock)
+         slock_free(xmb->loader_lock);
+#endif
+   }
+
    if (menu->userdata)
       free(menu->userdata);
 
@@ -1265,11 +1676,10 @@ static bool xmb_font_init_first(const gl_font_renderer_t **font_driver,
 
 static void xmb_context_reset(void *data)
 {
-   int i, k;
+   int i;
    char bgpath[PATH_MAX_LENGTH];
    char mediapath[PATH_MAX_LENGTH], themepath[PATH_MAX_LENGTH], iconpath[PATH_MAX_LENGTH],
-         fontpath[PATH_MAX_LENGTH], core_id[PATH_MAX_LENGTH], texturepath[PATH_MAX_LENGTH],
-         content_texturepath[PATH_MAX_LENGTH];
+         fontpath[PATH_MAX_LENGTH], core_id[PATH_MAX_LENGTH];
 
    core_info_t* info = NULL;
    core_info_list_t* info_list = NULL;
@@ -1306,6 +1716,13 @@ static void xmb_context_reset(void *data)
 
    xmb_font_init_first(&gl->font_driver, &xmb->font, gl, fontpath, xmb->font_size);
 
+   xmb_loader_stop(xmb);
+   xmb_textures_free(xmb);
+   xmb_textures_new(xmb, XMB_TEXTURE_LAST + 2 * (xmb->num_categories - 1));
+
+   if (!xmb->textures)
+      return;
+
    if (*g_settings.menu.wallpaper)
       strlcpy(xmb->textures[XMB_TEXTURE_BG].path, g_settings.menu.wallpaper,
             sizeof(xmb->textures[XMB_TEXTURE_BG].path));
@@ -1345,22 +1762,21 @@ static void xmb_context_reset(void *data)
    fill_pathname_join(xmb->textures[XMB_TEXTURE_SWITCH_OFF].path, iconpath,
          "off.png", sizeof(xmb->textures[XMB_TEXTURE_SWITCH_OFF].path));
 
-   for (k = 0; k < XMB_TEXTURE_LAST; k++)
-      xmb->textures[k].id = xmb_png_texture_load(xmb->textures[k].path);
-
-   xmb->settings_node.icon = xmb->textures[XMB_TEXTURE_SETTINGS].id;
+   xmb->settings_node.icon = &xmb->textures[XMB_TEXTURE_SETTINGS];
    xmb->settings_node.alpha = xmb->c_active_alpha;
    xmb->settings_node.zoom = xmb->c_active_zoom;
 
    info_list = (core_info_list_t*)g_extern.core_info;
 
-   if (!info_list)
-      return;
-
-   for (i = 1; i < xmb->num_categories; i++)
+   for (i = 1; info_list && i < xmb->num_categories; i++)
    {
+      struct xmb_texture_item *icon = &xmb->textures[XMB_TEXTURE_LAST + 2 * (i-1)];
+
       node = xmb_node_for_core(i-1);
 
+      if (!node)
+         continue;
+
       fill_pathname_join(mediapath, g_settings.assets_directory,
             "lakka", sizeof(mediapath));
       fill_pathname_join(themepath, mediapath, XMB_THEME, sizeof(themepath));
@@ -1381,20 +1797,22 @@ static void xmb_context_reset(void *data)
       else
          strlcpy(core_id, "default", sizeof(core_id));
 
-      strlcpy(texturepath, iconpath, sizeof(texturepath));
-      strlcat(texturepath, core_id, sizeof(texturepath));
-      strlcat(texturepath, ".png", sizeof(texturepath));
+      strlcpy(icon[0].path, iconpath, sizeof(icon[0].path));
+      strlcat(icon[0].path, core_id, sizeof(icon[0].path));
+      strlcat(icon[0].path, ".png", sizeof(icon[0].path));
 
-      strlcpy(content_texturepath, iconpath, sizeof(content_texturepath));
-      strlcat(content_texturepath, core_id, sizeof(content_texturepath));
-      strlcat(content_texturepath, "-content.png", sizeof(content_texturepath));
+      strlcpy(icon[1].path, iconpath, sizeof(icon[1].path));
+      strlcat(icon[1].path, core_id, sizeof(icon[1].path));
+      strlcat(icon[1].path, "-content.png", sizeof(icon[1].path));
 
       node->alpha = (i == xmb->active_category) ? xmb->c_active_alpha
             : (xmb->depth <= 1) ? xmb->c_passive_alpha : 0;
       node->zoom  = (i == xmb->active_category) ? xmb->c_active_zoom : xmb->c_passive_zoom;
-      node->icon  = xmb_png_texture_load(texturepath);
-      node->content_icon = xmb_png_texture_load(content_texturepath);
+      node->icon  = &icon[0];
+      node->content_icon = &icon[1];
    }
+
+   xmb_loader_start(xmb);
 }
 
 static void xmb_navigation_clear(void *data, bool pending_push)
@@ -1561,19 +1979,28 @@ static void xmb_context_destroy(void *data)
    if (!xmb)
       return;
 
-   for (i = 0; i < XMB_TEXTURE_LAST; i++)
-      glDeleteTextures(1, &xmb->textures[i].id);
+   xmb_loader_stop(xmb);
 
-   for (i = 1; i < xmb->num_categories; i++)
+   /* Atlas cells and the placeholder are deleted below. */
+   for (i = 0; i < xmb->num_textures; i++)
    {
-      xmb_node_t *node = xmb_node_for_core(i-1);
+      struct xmb_texture_item *item = &xmb->textures[i];
 
-      if (!node)
-         continue;
-
-      glDeleteTextures(1, &node->icon);
-      glDeleteTextures(1, &node->content_icon);
+      if (item->state == XMB_TEXTURE_STATE_READY && !item->atlas)
+         glDeleteTextures(1, &item->id);
+      item->id = 0;
    }
+
+   for (i = 0; i < xmb->num_atlas_pages; i++)
+      glDeleteTextures(1, &xmb->atlas_pages[i].id);
+
+   free(xmb->atlas_pages);
+   xmb->atlas_pages     = NULL;
+   xmb->num_atlas_pages = 0;
+
+   if (xmb->placeholder)
+      glDeleteTextures(1, &xmb->placeholder);
+   xmb->placeholder = 0;
 }
 
 static void xmb_toggle(bool menu_on)
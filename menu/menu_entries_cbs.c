@@ -33,12 +33,20 @@
 #include "../net_http.h"
 #endif
 
+#ifdef HAVE_NETPLAY
+#include "../netplay.h"
+#endif
+
 #ifdef HAVE_LIBRETRODB
 #include "../database_info.h"
 #endif
 
 #include "menu_database.h"
 
+#ifdef HAVE_THREADS
+#include "../gfx/video_thread_wrapper.h"
+#endif
+
 #include "../input/input_autodetect.h"
 #include "../input/input_remapping.h"
 
@@ -2602,6 +2610,297 @@ static int deferred_push_core_information(void *data, void *userdata,
 }
 #endif
 
+static int deferred_push_rewind_information(void *data, void *userdata,
+      const char *path, const char *label, unsigned type)
+{
+   char tmp[PATH_MAX_LENGTH];
+   unsigned entries       = 0;
+   size_t bytes           = 0;
+   uint64_t raw           = 0;
+   uint64_t delta         = 0;
+   uint64_t stored        = 0;
+   double seconds         = 0.0;
+   double fps             = g_extern.system.av_info.timing.fps;
+   file_list_t *list      = (file_list_t*)data;
+   file_list_t *menu_list = (file_list_t*)userdata;
+
+   if (!list || !menu_list)
+      return -1;
+
+   menu_list_clear(list);
+
+   if (!g_extern.state_manager)
+   {
+      menu_list_push(list,
+            "No information available.", "",
+            MENU_SETTINGS_CORE_OPTION_NONE, 0);
+      goto end;
+   }
+
+   state_manager_capacity(g_extern.state_manager, &entries, &bytes, NULL);
+   state_manager_stats(g_extern.state_manager, &raw, &delta, &stored);
+
+   if (fps > 0.0)
+      seconds = entries * (g_settings.rewind_granularity ?
+            g_settings.rewind_granularity : 1) / fps;
+
+   snprintf(tmp, sizeof(tmp), "Frames: %u", entries);
+   menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+
+   snprintf(tmp, sizeof(tmp), "Buffer usage: %.1f / %.1f MB",
+         bytes / 1000000.0, g_settings.rewind_buffer_size / 1000000.0);
+   menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+
+   snprintf(tmp, sizeof(tmp), "History: %.1f seconds", seconds);
+   menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+
+   if (bytes)
+   {
+      snprintf(tmp, sizeof(tmp), "History per MB: %.1f seconds",
+            seconds * 1000000.0 / bytes);
+      menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+   }
+
+   if (delta)
+   {
+      snprintf(tmp, sizeof(tmp), "Delta ratio: %.2f:1",
+            (double)raw / delta);
+      menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+   }
+
+   if (state_manager_compressed(g_extern.state_manager) && stored)
+   {
+      snprintf(tmp, sizeof(tmp), "Compression ratio: %.2f:1",
+            (double)delta / stored);
+      menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+   }
+
+end:
+   if (driver.menu_ctx && driver.menu_ctx->populate_entries)
+      driver.menu_ctx->populate_entries(driver.menu, path, label, type);
+
+   return 0;
+}
+
+static int deferred_push_frame_delay_information(void *data, void *userdata,
+      const char *path, const char *label, unsigned type)
+{
+   unsigned i;
+   char tmp[PATH_MAX_LENGTH];
+   uint64_t total         = 0;
+   file_list_t *list      = (file_list_t*)data;
+   file_list_t *menu_list = (file_list_t*)userdata;
+
+   if (!list || !menu_list)
+      return -1;
+
+   menu_list_clear(list);
+
+   for (i = 0; i < FRAME_DELAY_HISTOGRAM_SIZE; i++)
+      total += g_extern.frame_delay.histogram[i];
+
+   if (!total)
+   {
+      menu_list_push(list,
+            "No information available.", "",
+            MENU_SETTINGS_CORE_OPTION_NONE, 0);
+      goto end;
+   }
+
+   snprintf(tmp, sizeof(tmp), "Current delay: %.2f ms",
+         g_extern.frame_delay.delay / 1000.0);
+   menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+
+   snprintf(tmp, sizeof(tmp), "Frames: %llu",
+         (unsigned long long)g_extern.frame_delay.frames);
+   menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+
+   snprintf(tmp, sizeof(tmp), "Late frames: %llu",
+         (unsigned long long)g_extern.frame_delay.late_frames);
+   menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+
+   for (i = 0; i < FRAME_DELAY_HISTOGRAM_SIZE; i++)
+   {
+      uint32_t count = g_extern.frame_delay.histogram[i];
+      double   lo    = i * FRAME_DELAY_BUCKET_USEC / 1000.0;
+
+      if (!count)
+         continue;
+
+      if (i == FRAME_DELAY_HISTOGRAM_SIZE - 1)
+         snprintf(tmp, sizeof(tmp), "Run time >= %.2f ms: %u (%.1f%%)",
+               lo, count, 100.0 * count / total);
+      else
+         snprintf(tmp, sizeof(tmp), "Run time %.2f - %.2f ms: %u (%.1f%%)",
+               lo, lo + FRAME_DELAY_BUCKET_USEC / 1000.0,
+               count, 100.0 * count / total);
+      menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+   }
+
+end:
+   if (driver.menu_ctx && driver.menu_ctx->populate_entries)
+      driver.menu_ctx->populate_entries(driver.menu, path, label, type);
+
+   return 0;
+}
+
+static int deferred_push_audio_information(void *data, void *userdata,
+      const char *path, const char *label, unsigned type)
+{
+   char tmp[PATH_MAX_LENGTH];
+   struct audio_driver_stats stats;
+   file_list_t *list      = (file_list_t*)data;
+   file_list_t *menu_list = (file_list_t*)userdata;
+
+   if (!list || !menu_list)
+      return -1;
+
+   menu_list_clear(list);
+
+   if (!audio_driver_get_stats(&stats))
+   {
+      menu_list_push(list,
+            "No information available.", "",
+            MENU_SETTINGS_CORE_OPTION_NONE, 0);
+      goto end;
+   }
+
+   if (stats.rate_control)
+   {
+      snprintf(tmp, sizeof(tmp), "Buffer fill: %.1f%%",
+            stats.buffer_fill * 100.0);
+      menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+
+      snprintf(tmp, sizeof(tmp), "Latency: %.1f ms", stats.latency_ms);
+      menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+
+      snprintf(tmp, sizeof(tmp), "Rate adjustment: %+.4f%%",
+            (stats.ratio - 1.0) * 100.0);
+      menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+
+      snprintf(tmp, sizeof(tmp), "Underruns: %u", stats.underruns);
+      menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+   }
+
+   if (stats.dsp_thread)
+   {
+      snprintf(tmp, sizeof(tmp), "DSP thread latency: %.1f ms",
+            stats.dsp_thread_latency_ms);
+      menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+   }
+
+end:
+   if (driver.menu_ctx && driver.menu_ctx->populate_entries)
+      driver.menu_ctx->populate_entries(driver.menu, path, label, type);
+
+   return 0;
+}
+
+#ifdef HAVE_THREADS
+static int deferred_push_video_information(void *data, void *userdata,
+      const char *path, const char *label, unsigned type)
+{
+   char tmp[PATH_MAX_LENGTH];
+   struct rarch_threaded_video_stats stats;
+   file_list_t *list      = (file_list_t*)data;
+   file_list_t *menu_list = (file_list_t*)userdata;
+
+   if (!list || !menu_list)
+      return -1;
+
+   menu_list_clear(list);
+
+   if (!rarch_threaded_video_get_stats(&stats))
+   {
+      menu_list_push(list,
+            "No information available.", "",
+            MENU_SETTINGS_CORE_OPTION_NONE, 0);
+      goto end;
+   }
+
+   snprintf(tmp, sizeof(tmp), "Frames shown: %u", stats.frames);
+   menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+
+   snprintf(tmp, sizeof(tmp), "Frames dropped: %u", stats.dropped);
+   menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+
+   snprintf(tmp, sizeof(tmp), "Rendered directly by core: %u",
+         stats.direct);
+   menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+
+end:
+   if (driver.menu_ctx && driver.menu_ctx->populate_entries)
+      driver.menu_ctx->populate_entries(driver.menu, path, label, type);
+
+   return 0;
+}
+#endif
+
+#ifdef HAVE_NETPLAY
+static int deferred_push_netplay_information(void *data, void *userdata,
+      const char *path, const char *label, unsigned type)
+{
+   char tmp[PATH_MAX_LENGTH];
+   struct netplay_stats stats;
+   unsigned input_latency = 0;
+   retro_time_t rtt       = 0;
+   file_list_t *list      = (file_list_t*)data;
+   file_list_t *menu_list = (file_list_t*)userdata;
+
+   if (!list || !menu_list)
+      return -1;
+
+   menu_list_clear(list);
+
+   if (!netplay_get_stats((netplay_t*)driver.netplay_data, &stats,
+            &input_latency, &rtt))
+   {
+      menu_list_push(list,
+            "No information available.", "",
+            MENU_SETTINGS_CORE_OPTION_NONE, 0);
+      goto end;
+   }
+
+   snprintf(tmp, sizeof(tmp), "Input latency: %u frames", input_latency);
+   menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+
+   if (rtt)
+   {
+      snprintf(tmp, sizeof(tmp), "Round trip time: %.1f ms", rtt / 1000.0);
+      menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+   }
+
+   snprintf(tmp, sizeof(tmp), "Frames: %llu",
+         (unsigned long long)stats.frames);
+   menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+
+   snprintf(tmp, sizeof(tmp), "Mispredictions: %llu",
+         (unsigned long long)stats.mispredictions);
+   menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+
+   snprintf(tmp, sizeof(tmp), "Frames replayed: %llu (longest %u)",
+         (unsigned long long)stats.frames_replayed, stats.longest_replay);
+   menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+
+   snprintf(tmp, sizeof(tmp), "Stalls: %llu",
+         (unsigned long long)stats.stalls);
+   menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+
+   if (stats.serializations)
+   {
+      snprintf(tmp, sizeof(tmp), "Serialize: %.1f usec",
+            (double)stats.serialize_usec / stats.serializations);
+      menu_list_push(list, tmp, "", MENU_SETTINGS_CORE_INFO_NONE, 0);
+   }
+
+end:
+   if (driver.menu_ctx && driver.menu_ctx->populate_entries)
+      driver.menu_ctx->populate_entries(driver.menu, path, label, type);
+
+   return 0;
+}
+#endif
+
 static int deferred_push_performance_counters(void *data, void *userdata,
       const char *path, const char *label, unsigned type)
 {
@@ -4227,6 +4526,11 @@ static void menu_entries_cbs_init_bind_ok(menu_file_list_cbs_t *cbs,
          !strcmp(label, "core_cheat_options") ||
          !strcmp(label, "core_input_remapping_options") ||
          !strcmp(label, "core_information") ||
+         !strcmp(label, "rewind_information") ||
+         !strcmp(label, "frame_delay_information") ||
+         !strcmp(label, "audio_information") ||
+         !strcmp(label, "video_information") ||
+         !strcmp(label, "netplay_information") ||
          !strcmp(label, "disk_options") ||
          !strcmp(label, "settings") ||
          !strcmp(label, "performance_counters") ||
@@ -4606,6 +4910,20 @@ static void menu_entries_cbs_init_bind_deferred_push(menu_file_list_cbs_t *cbs,
       cbs->action_deferred_push = deferred_push_cursor_manager_list_deferred_query_subsearch;
    else if (!strcmp(label, "core_information"))
       cbs->action_deferred_push = deferred_push_core_information;
+   else if (!strcmp(label, "rewind_information"))
+      cbs->action_deferred_push = deferred_push_rewind_information;
+   else if (!strcmp(label, "frame_delay_information"))
+      cbs->action_deferred_push = deferred_push_frame_delay_information;
+   else if (!strcmp(label, "audio_information"))
+      cbs->action_deferred_push = deferred_push_audio_information;
+#ifdef HAVE_THREADS
+   else if (!strcmp(label, "video_information"))
+      cbs->action_deferred_push = deferred_push_video_information;
+#endif
+#ifdef HAVE_NETPLAY
+   else if (!strcmp(label, "netplay_information"))
+      cbs->action_deferred_push = deferred_push_netplay_information;
+#endif
    else if (!strcmp(label, "performance_counters"))
       cbs->action_deferred_push = deferred_push_performance_counters;
    else if (!strcmp(label, "core_counters"))
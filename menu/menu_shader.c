@@ -16,6 +16,7 @@
 
 #include "menu_shader.h"
 #include "menu_entries.h"
+#include "../gfx/video_shader_async.h"
 #include <file/file_path.h>
 
 
@@ -129,6 +130,10 @@ void menu_shader_manager_set_preset(struct video_shader *shader,
 
    if (!driver.video->set_shader)
       return;
+#ifdef HAVE_THREADS
+   /* Don't let a shader still being prepared replace this one. */
+   video_shader_async_cancel();
+#endif
    if (!driver.video->set_shader(driver.video_data,
             (enum rarch_shader_type)type, preset_path))
       return;
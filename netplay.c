@@ -23,9 +23,19 @@
 #include "general.h"
 #include "autosave.h"
 #include "dynamic.h"
+#include "performance.h"
 #include <queues/message_queue.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#ifdef HAVE_ZLIB_DEFLATE
+#include <zlib.h>
+#endif
 
 struct delta_frame
 {
@@ -39,12 +49,88 @@ struct delta_frame
    bool used_real;
 };
 
-#define UDP_FRAME_PACKETS 16
+#define UDP_FRAME_PACKETS 24
+
+#ifdef HAVE_THREADS
+/* With the listening socket, this is as many sockets as
+ * select() takes with Winsock's default FD_SETSIZE of 64. */
+#define MAX_SPECTATORS 63
+/* Input we hold for a spectator before we give up on it. */
+#define SPECTATE_QUEUE_MAX (256 * 1024)
+/* How often the spectator thread looks for new input to send. */
+#define SPECTATE_POLL_USEC 4000
+/* Time a new spectator gets to send its nickname and encodings. */
+#define SPECTATE_HANDSHAKE_USEC 5000000
+#else
 #define MAX_SPECTATORS 16
+#endif
+
+/* Our input is sent this many frames ahead at most,
+ * so the packet window has to cover it on top of the
+ * rollback window. */
+#define NETPLAY_MAX_INPUT_LATENCY 8
+#define NETPLAY_MAX_FRAMES (UDP_FRAME_PACKETS - NETPLAY_MAX_INPUT_LATENCY)
+#define NETPLAY_SELF_INPUT_SIZE 16
+
+/* Frames between RTT measurements. */
+#define NETPLAY_PING_INTERVAL 60
+
+/* Savestate encodings, sent ahead of a savestate. */
+#define NETPLAY_STATE_RAW 0
+#define NETPLAY_STATE_DEFLATE 1
 
 #define NETPLAY_CMD_ACK 0
 #define NETPLAY_CMD_NAK 1
 #define NETPLAY_CMD_FLIP_PLAYERS 2
+#define NETPLAY_CMD_PING 3
+#define NETPLAY_CMD_PONG 4
+
+/* Bump whenever packets, commands or handshakes change, so that
+ * peers on different versions refuse each other up front instead
+ * of failing halfway through a session. Builds from before this
+ * existed count as version 0. */
+#define NETPLAY_PROTOCOL_VERSION 1
+/* Spreads the protocol version over the whole magic value. */
+#define NETPLAY_PROTOCOL_MIX 0x9e3779b9u
+
+struct netplay_spectator
+{
+   int fd;
+   char nick[32];
+   struct sockaddr_storage addr;
+   bool accept_deflate;
+
+#ifdef HAVE_THREADS
+   /* Nickname and savestate encoding exchange, done on the
+    * non-blocking socket before the spectator gets a state. */
+   bool handshake_done;
+   uint8_t handshake_in[1 + 32 + sizeof(uint32_t)];
+   size_t handshake_in_len;
+   uint8_t handshake_out[1 + 32];
+   size_t handshake_out_len;
+   size_t handshake_out_ptr;
+   retro_time_t handshake_deadline;
+
+   /* Waiting for the emulation thread to save a state for it. */
+   bool needs_state;
+   /* Saved state, still to be encoded by the spectator thread. */
+   uint32_t *raw_state;
+   size_t raw_state_size;
+   /* Encoded BSV header and state, sent before any input. */
+   uint8_t *state;
+   size_t state_size;
+   size_t state_ptr;
+   bool state_sent;
+
+   uint8_t *queue;
+   size_t queue_size;
+   size_t queue_len;
+   size_t queue_ptr;
+
+   /* Set by the emulation thread, the spectator thread disconnects it. */
+   bool drop;
+#endif
+};
 
 #define PREV_PTR(x) ((x) == 0 ? netplay->buffer_size - 1 : (x) - 1)
 #define NEXT_PTR(x) ((x + 1) % netplay->buffer_size)
@@ -100,7 +186,12 @@ struct netplay
    /* Spectating. */
    bool spectate;
    bool spectate_client;
-   int spectate_fds[MAX_SPECTATORS];
+   struct netplay_spectator spectators[MAX_SPECTATORS];
+#ifdef HAVE_THREADS
+   sthread_t *spectate_thread;
+   slock_t *spectate_lock;
+   bool spectate_quit;
+#endif
    uint16_t *spectate_input;
    size_t spectate_input_ptr;
    size_t spectate_input_size;
@@ -112,8 +203,27 @@ struct netplay
     * well after flip_frame before allowing another flip. */
    bool flip;
    uint32_t flip_frame;
+
+   /* Local input latency.
+    * Input read on frame N is sent and applied for frame N + input_latency,
+    * so the other side gets it before it has to predict it. */
+   unsigned input_latency;
+   unsigned min_input_latency;
+   bool input_latency_auto;
+   /* Next frame we have not sent input for yet. */
+   uint32_t send_frame_count;
+   uint16_t self_input[NETPLAY_SELF_INPUT_SIZE];
+
+   /* Smoothed round trip time in microseconds, 0 until measured. */
+   retro_time_t rtt;
+
+   struct netplay_stats stats;
 };
 
+#ifdef HAVE_THREADS
+static void netplay_spectate_thread(void *data);
+#endif
+
 /**
  * warn_hangup:
  *
@@ -186,6 +296,7 @@ static bool get_self_input_state(netplay_t *netplay)
    unsigned i;
    struct delta_frame *ptr = &netplay->buffer[netplay->self_ptr];
    uint32_t state = 0;
+   uint32_t target_frame = netplay->frame_count + netplay->input_latency;
 
    if (!driver.block_libretro_input && netplay->frame_count > 0)
    {
@@ -201,10 +312,20 @@ static bool get_self_input_state(netplay_t *netplay)
       }
    }
 
-   memmove(netplay->packet_buffer, netplay->packet_buffer + 2,
-         sizeof (netplay->packet_buffer) - 2 * sizeof(uint32_t));
-   netplay->packet_buffer[(UDP_FRAME_PACKETS - 1) * 2] = htonl(netplay->frame_count); 
-   netplay->packet_buffer[(UDP_FRAME_PACKETS - 1) * 2 + 1] = htonl(state);
+   /* If input latency went up, the frames in between get this input
+    * as well. If it went down, we already sent input for this frame. */
+   while (netplay->send_frame_count <= target_frame)
+   {
+      memmove(netplay->packet_buffer, netplay->packet_buffer + 2,
+            sizeof (netplay->packet_buffer) - 2 * sizeof(uint32_t));
+      netplay->packet_buffer[(UDP_FRAME_PACKETS - 1) * 2] =
+         htonl(netplay->send_frame_count);
+      netplay->packet_buffer[(UDP_FRAME_PACKETS - 1) * 2 + 1] = htonl(state);
+
+      netplay->self_input[netplay->send_frame_count
+         % NETPLAY_SELF_INPUT_SIZE] = state;
+      netplay->send_frame_count++;
+   }
 
    if (!send_chunk(netplay))
    {
@@ -213,7 +334,8 @@ static bool get_self_input_state(netplay_t *netplay)
       return false;
    }
 
-   ptr->self_state = state;
+   ptr->self_state = netplay->self_input[netplay->frame_count
+      % NETPLAY_SELF_INPUT_SIZE];
    netplay->self_ptr = NEXT_PTR(netplay->self_ptr);
    return true;
 }
@@ -230,30 +352,120 @@ static bool netplay_cmd_nak(netplay_t *netplay)
    return socket_send_all_blocking(netplay->fd, &cmd, sizeof(cmd));
 }
 
+static bool netplay_send_cmd(netplay_t *netplay, uint32_t cmd,
+      const void *data, size_t size)
+{
+   cmd = (cmd << 16) | (size & 0xffff);
+   cmd = htonl(cmd);
+
+   if (!socket_send_all_blocking(netplay->fd, &cmd, sizeof(cmd)))
+      return false;
+
+   if (!socket_send_all_blocking(netplay->fd, data, size))
+      return false;
+
+   return true;
+}
+
+/**
+ * netplay_update_input_latency:
+ * @netplay              : pointer to netplay object
+ *
+ * Picks a local input latency which covers the one-way trip
+ * to the other side, so it rarely has to predict our input.
+ * Moves by one frame at a time to keep the game from skipping.
+ **/
+static void netplay_update_input_latency(netplay_t *netplay)
+{
+   unsigned target;
+   double frame_usec;
+
+   if (!netplay->input_latency_auto || !netplay->rtt
+         || g_extern.system.av_info.timing.fps <= 0.0)
+      return;
+
+   frame_usec = 1000000.0 / g_extern.system.av_info.timing.fps;
+   target     = (unsigned)ceil(netplay->rtt / 2 / frame_usec);
+   target     = max(min(target, NETPLAY_MAX_INPUT_LATENCY),
+         netplay->min_input_latency);
+
+   if (target > netplay->input_latency)
+      netplay->input_latency++;
+   else if (target < netplay->input_latency)
+      netplay->input_latency--;
+}
+
+static bool netplay_handle_cmd(netplay_t *netplay, uint32_t cmd);
+
 static bool netplay_get_response(netplay_t *netplay)
 {
    uint32_t response;
-   if (!socket_receive_all_blocking(netplay->fd, &response, sizeof(response)))
-      return false;
 
-   return ntohl(response) == NETPLAY_CMD_ACK;
+   for (;;)
+   {
+      if (!socket_receive_all_blocking(netplay->fd, &response, sizeof(response)))
+         return false;
+
+      response = ntohl(response);
+      if (response == NETPLAY_CMD_ACK || response == NETPLAY_CMD_NAK)
+         break;
+
+      /* A ping may have been sent before the other side saw our command. */
+      if (!netplay_handle_cmd(netplay, response))
+         return false;
+   }
+
+   return response == NETPLAY_CMD_ACK;
 }
 
 static bool netplay_get_cmd(netplay_t *netplay)
 {
-   uint32_t cmd, flip_frame;
-   size_t cmd_size;
+   uint32_t cmd;
 
    if (!socket_receive_all_blocking(netplay->fd, &cmd, sizeof(cmd)))
       return false;
 
-   cmd = ntohl(cmd);
+   return netplay_handle_cmd(netplay, ntohl(cmd));
+}
+
+static bool netplay_handle_cmd(netplay_t *netplay, uint32_t cmd)
+{
+   uint32_t flip_frame, timestamp;
+   size_t cmd_size;
 
    cmd_size = cmd & 0xffff;
    cmd = cmd >> 16;
 
    switch (cmd)
    {
+      case NETPLAY_CMD_PING:
+      case NETPLAY_CMD_PONG:
+         if (cmd_size != sizeof(uint32_t))
+         {
+            RARCH_ERR("CMD_PING has unexpected command size.\n");
+            return false;
+         }
+
+         if (!socket_receive_all_blocking(netplay->fd, &timestamp, sizeof(timestamp)))
+         {
+            RARCH_ERR("Failed to receive CMD_PING argument.\n");
+            return false;
+         }
+
+         if (cmd == NETPLAY_CMD_PING)
+            return netplay_send_cmd(netplay, NETPLAY_CMD_PONG,
+                  &timestamp, sizeof(timestamp));
+
+         {
+            /* Unsigned difference survives the timestamp wrapping around. */
+            retro_time_t sample = (uint32_t)rarch_get_time_usec() - ntohl(timestamp);
+
+            netplay->rtt = netplay->rtt ?
+               (7 * netplay->rtt + sample) / 8 : sample;
+            netplay_update_input_latency(netplay);
+         }
+         return true;
+
       case NETPLAY_CMD_FLIP_PLAYERS:
          if (cmd_size != sizeof(uint32_t))
          {
@@ -360,11 +572,16 @@ static bool receive_data(netplay_t *netplay, uint32_t *buffer, size_t size)
 static void parse_packet(netplay_t *netplay, uint32_t *buffer, unsigned size)
 {
    unsigned i;
+   /* The other side sends its input up to its own latency ahead.
+    * Keep what arrives early, as long as it doesn't overwrite
+    * frames we may still have to replay. */
+   uint32_t last_frame = min(netplay->frame_count + NETPLAY_MAX_INPUT_LATENCY,
+         netplay->other_frame_count + netplay->buffer_size - 1);
 
    for (i = 0; i < size * 2; i++)
       buffer[i] = ntohl(buffer[i]);
 
-   for (i = 0; i < size && netplay->read_frame_count <= netplay->frame_count; i++)
+   for (i = 0; i < size && netplay->read_frame_count <= last_frame; i++)
    {
       uint32_t frame = buffer[2 * i + 0];
       uint32_t state = buffer[2 * i + 1];
@@ -428,6 +645,8 @@ static bool netplay_poll(netplay_t *netplay)
 
    /* We might have reached the end of the buffer, where we 
     * simply have to block. */
+   if (netplay->other_ptr == netplay->self_ptr)
+      netplay->stats.stalls++;
    res = poll_input(netplay, netplay->other_ptr == netplay->self_ptr);
    if (res == -1)
    {
@@ -464,7 +683,7 @@ static bool netplay_poll(netplay_t *netplay)
       }
    }
 
-   if (netplay->read_ptr != netplay->self_ptr)
+   if (netplay->read_frame_count <= netplay->frame_count)
       simulate_input(netplay);
    else
       netplay->buffer[PREV_PTR(netplay->self_ptr)].used_real = true;
@@ -830,6 +1049,49 @@ static uint32_t implementation_magic_value(void)
    return res;
 }
 
+/**
+ * netplay_magic_value:
+ *
+ * implementation_magic_value, with the netplay protocol version
+ * mixed in.
+ **/
+static uint32_t netplay_magic_value(void)
+{
+   return implementation_magic_value() ^
+      (NETPLAY_PROTOCOL_VERSION * NETPLAY_PROTOCOL_MIX);
+}
+
+/**
+ * netplay_check_magic:
+ * @magic              : magic value received from the peer.
+ *
+ * Checks the peer's netplay_magic_value against ours, and tells
+ * a different protocol version apart from a different implementation.
+ *
+ * Returns: true if they match.
+ **/
+static bool netplay_check_magic(uint32_t magic)
+{
+   unsigned version;
+   uint32_t impl = implementation_magic_value();
+
+   if (magic == netplay_magic_value())
+      return true;
+
+   for (version = 0; version < 256; version++)
+   {
+      if (magic != (impl ^ (version * NETPLAY_PROTOCOL_MIX)))
+         continue;
+
+      RARCH_ERR("Netplay protocols differ, peer uses version %u, we use version %u. Make sure you're using the exact same RetroArch version.\n",
+            version, NETPLAY_PROTOCOL_VERSION);
+      return false;
+   }
+
+   RARCH_ERR("Implementations differ, make sure you're using exact same libretro implementations and RetroArch version.\n");
+   return false;
+}
+
 static bool send_nickname(netplay_t *netplay, int fd)
 {
    uint8_t nick_size = strlen(netplay->nick);
@@ -881,7 +1143,7 @@ static bool send_info(netplay_t *netplay)
    void *sram = NULL;
    uint32_t header[3] = {
       htonl(g_extern.content_crc),
-      htonl(implementation_magic_value()),
+      htonl(netplay_magic_value()),
       htonl(pretro_get_memory_size(RETRO_MEMORY_SAVE_RAM))
    };
 
@@ -900,13 +1162,15 @@ static bool send_info(netplay_t *netplay)
 
    if (!socket_receive_all_blocking(netplay->fd, sram, sram_size))
    {
-      RARCH_ERR("Failed to receive SRAM data from host.\n");
+      /* The host hangs up if our magic value didn't match,
+       * this or the nick is where we notice. */
+      RARCH_ERR("Failed to receive SRAM data from host, check that both sides use the same core and RetroArch version.\n");
       return false;
    }
 
    if (!get_nickname(netplay, netplay->fd))
    {
-      RARCH_ERR("Failed to receive nick from host.\n");
+      RARCH_ERR("Failed to receive nick from host, check that both sides use the same core and RetroArch version.\n");
       return false;
    }
 
@@ -935,11 +1199,8 @@ static bool get_info(netplay_t *netplay)
       return false;
    }
 
-   if (implementation_magic_value() != ntohl(header[1]))
-   {
-      RARCH_ERR("Implementations differ, make sure you're using exact same libretro implementations and RetroArch version.\n");
+   if (!netplay_check_magic(ntohl(header[1])))
       return false;
-   }
 
    if (pretro_get_memory_size(RETRO_MEMORY_SAVE_RAM) != ntohl(header[2]))
    {
@@ -1041,6 +1302,150 @@ static bool bsv_parse_header(const uint32_t *header, uint32_t magic)
    return true;
 }
 
+#ifdef HAVE_ZLIB_DEFLATE
+/* Used on the spectator thread, but registered by netplay_new
+ * on the main thread, as the counter list isn't thread safe. */
+static struct retro_perf_counter netplay_deflate_state =
+   {"netplay_deflate_state"};
+#endif
+
+/**
+ * netplay_encode_state:
+ * @state                : savestate data.
+ * @size                 : size of @state.
+ * @accept_deflate       : the receiver can inflate.
+ * @out_size             : size of the encoded state.
+ *
+ * Encodes a savestate for sending, deflated if the receiver
+ * supports it.
+ *
+ * Returns: encoded state, to be freed by the caller, or NULL.
+ **/
+static uint8_t *netplay_encode_state(const void *state, size_t size,
+      bool accept_deflate, size_t *out_size)
+{
+   uint32_t header[2];
+   uint8_t *out = NULL;
+
+#ifdef HAVE_ZLIB_DEFLATE
+   if (accept_deflate && size)
+   {
+      int err          = Z_MEM_ERROR;
+      uLongf comp_size = compressBound(size);
+
+      out = (uint8_t*)malloc(sizeof(header) + comp_size);
+
+      RARCH_PERFORMANCE_START(netplay_deflate_state);
+      if (out)
+         err = compress2(out + sizeof(header), &comp_size,
+               (const Bytef*)state, size, Z_BEST_SPEED);
+      RARCH_PERFORMANCE_STOP(netplay_deflate_state);
+
+      if (err == Z_OK)
+      {
+         RARCH_LOG("Sending savestate deflated from %u to %u bytes.\n",
+               (unsigned)size, (unsigned)comp_size);
+
+         header[0] = htonl(NETPLAY_STATE_DEFLATE);
+         header[1] = htonl(comp_size);
+         memcpy(out, header, sizeof(header));
+         *out_size = sizeof(header) + comp_size;
+         return out;
+      }
+
+      free(out);
+   }
+#endif
+
+   out = (uint8_t*)malloc(sizeof(header) + size);
+   if (!out)
+      return NULL;
+
+   header[0] = htonl(NETPLAY_STATE_RAW);
+   header[1] = htonl(size);
+   memcpy(out, header, sizeof(header));
+   memcpy(out + sizeof(header), state, size);
+   *out_size = sizeof(header) + size;
+   return out;
+}
+
+/**
+ * netplay_receive_state:
+ * @fd                   : socket to receive from.
+ * @state                : buffer for the savestate.
+ * @size                 : expected size of the savestate.
+ *
+ * Receives a savestate sent with netplay_send_state().
+ *
+ * Returns: true (1) if successful, otherwise false (0).
+ **/
+static bool netplay_receive_state(int fd, void *state, size_t size)
+{
+   uint32_t header[2];
+
+   if (!socket_receive_all_blocking(fd, header, sizeof(header)))
+      return false;
+
+   header[0] = ntohl(header[0]);
+   header[1] = ntohl(header[1]);
+
+   switch (header[0])
+   {
+      case NETPLAY_STATE_RAW:
+         if (header[1] != size)
+         {
+            RARCH_ERR("Savestate size mismatch, got %u, expected %u.\n",
+                  (unsigned)header[1], (unsigned)size);
+            return false;
+         }
+         return socket_receive_all_blocking(fd, state, size);
+
+#ifdef HAVE_ZLIB_DEFLATE
+      case NETPLAY_STATE_DEFLATE:
+      {
+         int err;
+         uLongf dest_size = size;
+         Bytef *comp      = NULL;
+
+         /* The length comes from the peer, so bound it
+          * before allocating anything. */
+         if (header[1] > compressBound(size))
+         {
+            RARCH_ERR("Deflated savestate too large, got %u, at most %u.\n",
+                  (unsigned)header[1], (unsigned)compressBound(size));
+            return false;
+         }
+
+         comp = (Bytef*)malloc(header[1]);
+         if (!comp)
+            return false;
+
+         if (!socket_receive_all_blocking(fd, comp, header[1]))
+         {
+            free(comp);
+            return false;
+         }
+
+         err = uncompress((Bytef*)state, &dest_size, comp, header[1]);
+         free(comp);
+
+         if (err != Z_OK || dest_size != size)
+         {
+            RARCH_ERR("Failed to inflate savestate.\n");
+            return false;
+         }
+         return true;
+      }
+#endif
+
+      default:
+         break;
+   }
+
+   RARCH_ERR("Unknown savestate encoding %u.\n", (unsigned)header[0]);
+   return false;
+}
+
 static bool get_info_spectate(netplay_t *netplay)
 {
    void *buf;
@@ -1048,6 +1453,11 @@ static bool get_info_spectate(netplay_t *netplay)
    uint32_t header[4];
    char msg[512];
    bool ret = true;
+   uint32_t accept_deflate = 0;
+
+#ifdef HAVE_ZLIB_DEFLATE
+   accept_deflate = htonl(1);
+#endif
 
    if (!send_nickname(netplay, netplay->fd))
    {
@@ -1061,6 +1471,13 @@ static bool get_info_spectate(netplay_t *netplay)
       return false;
    }
 
+   if (!socket_send_all_blocking(netplay->fd,
+            &accept_deflate, sizeof(accept_deflate)))
+   {
+      RARCH_ERR("Failed to send savestate encodings to host.\n");
+      return false;
+   }
+
    snprintf(msg, sizeof(msg), "Connected to \"%s\"", netplay->other_nick);
    msg_queue_push(g_extern.msg_queue, msg, 1, 180);
    RARCH_LOG("%s\n", msg);
@@ -1073,7 +1490,8 @@ static bool get_info_spectate(netplay_t *netplay)
    }
 
    save_state_size = pretro_serialize_size();
-   if (!bsv_parse_header(header, implementation_magic_value()))
+   if (!netplay_check_magic(swap_if_big32(header[SERIALIZER_INDEX]))
+         || !bsv_parse_header(header, netplay_magic_value()))
    {
       RARCH_ERR("Received invalid BSV header from host.\n");
       return false;
@@ -1085,7 +1503,7 @@ static bool get_info_spectate(netplay_t *netplay)
 
    size = save_state_size;
 
-   if (!socket_receive_all_blocking(netplay->fd, buf, size))
+   if (!netplay_receive_state(netplay->fd, buf, size))
    {
       RARCH_ERR("Failed to receive save state from host.\n");
       free(buf);
@@ -1149,8 +1567,8 @@ netplay_t *netplay_new(const char *server, uint16_t port,
    unsigned i;
    netplay_t *netplay = NULL;
 
-   if (frames > UDP_FRAME_PACKETS)
-      frames = UDP_FRAME_PACKETS;
+   if (frames > NETPLAY_MAX_FRAMES)
+      frames = NETPLAY_MAX_FRAMES;
 
    netplay = (netplay_t*)calloc(1, sizeof(*netplay));
    if (!netplay)
@@ -1164,6 +1582,17 @@ netplay_t *netplay_new(const char *server, uint16_t port,
    netplay->spectate_client = server != NULL;
    strlcpy(netplay->nick, nick, sizeof(netplay->nick));
 
+#ifdef HAVE_ZLIB_DEFLATE
+   if (!netplay_deflate_state.registered)
+      rarch_perf_register(&netplay_deflate_state);
+#endif
+
+   netplay->min_input_latency  = min(
+         g_settings.input.netplay_input_latency_frames,
+         NETPLAY_MAX_INPUT_LATENCY);
+   netplay->input_latency      = netplay->min_input_latency;
+   netplay->input_latency_auto = g_settings.input.netplay_input_latency_auto;
+
    if (!init_socket(netplay, server, port))
    {
       free(netplay);
@@ -1179,7 +1608,21 @@ netplay_t *netplay_new(const char *server, uint16_t port,
       }
 
       for (i = 0; i < MAX_SPECTATORS; i++)
-         netplay->spectate_fds[i] = -1;
+         netplay->spectators[i].fd = -1;
+
+#ifdef HAVE_THREADS
+      if (!server)
+      {
+         netplay->spectate_lock = slock_new();
+         if (!netplay->spectate_lock)
+            goto error;
+
+         netplay->spectate_thread = sthread_create(
+               netplay_spectate_thread, netplay);
+         if (!netplay->spectate_thread)
+            goto error;
+      }
+#endif
    }
    else
    {
@@ -1205,6 +1648,10 @@ netplay_t *netplay_new(const char *server, uint16_t port,
    return netplay;
 
 error:
+#ifdef HAVE_THREADS
+   if (netplay->spectate_lock)
+      slock_free(netplay->spectate_lock);
+#endif
    if (netplay->fd >= 0)
       socket_close(netplay->fd);
    if (netplay->udp_fd >= 0)
@@ -1214,21 +1661,6 @@ error:
    return NULL;
 }
 
-static bool netplay_send_cmd(netplay_t *netplay, uint32_t cmd,
-      const void *data, size_t size)
-{
-   cmd = (cmd << 16) | (size & 0xffff);
-   cmd = htonl(cmd);
-
-   if (!socket_send_all_blocking(netplay->fd, &cmd, sizeof(cmd)))
-      return false;
-
-   if (!socket_send_all_blocking(netplay->fd, data, size))
-      return false;
-
-   return true;
-}
-
 /**
  * netplay_flip_users:
  * @netplay              : pointer to netplay object
@@ -1294,13 +1726,48 @@ void netplay_free(netplay_t *netplay)
 {
    unsigned i;
 
+   if (!netplay->spectate && netplay->frame_count)
+   {
+      RARCH_LOG("Netplay: %u frames, %u mispredictions, %u frames replayed (longest %u).\n",
+            (unsigned)netplay->stats.frames,
+            (unsigned)netplay->stats.mispredictions,
+            (unsigned)netplay->stats.frames_replayed,
+            netplay->stats.longest_replay);
+      if (netplay->stats.serializations)
+         RARCH_LOG("Netplay: %.1f usec per serialize, %u stalls.\n",
+               (double)netplay->stats.serialize_usec
+               / netplay->stats.serializations,
+               (unsigned)netplay->stats.stalls);
+   }
+
    socket_close(netplay->fd);
 
    if (netplay->spectate)
    {
+#ifdef HAVE_THREADS
+      if (netplay->spectate_thread)
+      {
+         slock_lock(netplay->spectate_lock);
+         netplay->spectate_quit = true;
+         slock_unlock(netplay->spectate_lock);
+
+         sthread_join(netplay->spectate_thread);
+      }
+
+      if (netplay->spectate_lock)
+         slock_free(netplay->spectate_lock);
+
+      for (i = 0; i < MAX_SPECTATORS; i++)
+      {
+         free(netplay->spectators[i].raw_state);
+         free(netplay->spectators[i].state);
+         free(netplay->spectators[i].queue);
+      }
+#endif
+
       for (i = 0; i < MAX_SPECTATORS; i++)
-         if (netplay->spectate_fds[i] >= 0)
-            socket_close(netplay->spectate_fds[i]);
+         if (netplay->spectators[i].fd >= 0)
+            socket_close(netplay->spectators[i].fd);
 
       free(netplay->spectate_input);
    }
@@ -1320,6 +1787,51 @@ void netplay_free(netplay_t *netplay)
    free(netplay);
 }
 
+/**
+ * netplay_get_stats:
+ * @netplay              : pointer to netplay object
+ * @stats                : counters since netplay started.
+ * @input_latency        : current local input latency in frames.
+ * @rtt                  : round trip time in microseconds,
+ *                         0 if not measured.
+ *
+ * Gets statistics for tuning netplay sessions.
+ *
+ * Returns: false (0) in spectator mode, otherwise true (1).
+ **/
+bool netplay_get_stats(netplay_t *netplay, struct netplay_stats *stats,
+      unsigned *input_latency, retro_time_t *rtt)
+{
+   if (!netplay || netplay->spectate)
+      return false;
+
+   *stats         = netplay->stats;
+   *input_latency = netplay->input_latency;
+   *rtt           = netplay->rtt;
+   return true;
+}
+
+/**
+ * netplay_serialize:
+ * @netplay              : pointer to netplay object
+ * @ptr                  : buffer slot to save the state to.
+ *
+ * Saves the current state for a later replay and keeps
+ * track of what that costs.
+ **/
+static void netplay_serialize(netplay_t *netplay, size_t ptr)
+{
+   retro_time_t start = rarch_get_time_usec();
+
+   RARCH_PERFORMANCE_INIT(netplay_serialize);
+   RARCH_PERFORMANCE_START(netplay_serialize);
+   pretro_serialize(netplay->buffer[ptr].state, netplay->state_size);
+   RARCH_PERFORMANCE_STOP(netplay_serialize);
+
+   netplay->stats.serialize_usec += rarch_get_time_usec() - start;
+   netplay->stats.serializations++;
+}
+
 /**
  * netplay_pre_frame_net:   
  * @netplay              : pointer to netplay object
@@ -1328,10 +1840,22 @@ void netplay_free(netplay_t *netplay)
  **/
 static void netplay_pre_frame_net(netplay_t *netplay)
 {
-   pretro_serialize(netplay->buffer[netplay->self_ptr].state,
-         netplay->state_size);
+   netplay_serialize(netplay, netplay->self_ptr);
    netplay->can_poll = true;
 
+   if (netplay->has_connection && netplay->input_latency_auto
+         && netplay->frame_count % NETPLAY_PING_INTERVAL == 0)
+   {
+      uint32_t timestamp = htonl((uint32_t)rarch_get_time_usec());
+
+      if (!netplay_send_cmd(netplay, NETPLAY_CMD_PING,
+               &timestamp, sizeof(timestamp)))
+      {
+         warn_hangup();
+         netplay->has_connection = false;
+      }
+   }
+
    input_poll_net();
 }
 
@@ -1382,6 +1906,469 @@ int16_t input_state_spectate_client(unsigned port, unsigned device,
          device, idx, id);
 }
 
+#ifdef HAVE_THREADS
+/**
+ * netplay_spectator_close:
+ * @netplay              : pointer to netplay object
+ * @idx                  : spectator slot.
+ *
+ * Disconnects a spectator and frees its buffers.
+ * Call with the spectator lock held.
+ **/
+static void netplay_spectator_close(netplay_t *netplay, unsigned idx)
+{
+   struct netplay_spectator *spectator = &netplay->spectators[idx];
+
+   socket_close(spectator->fd);
+   free(spectator->raw_state);
+   free(spectator->state);
+   free(spectator->queue);
+
+   memset(spectator, 0, sizeof(*spectator));
+   spectator->fd = -1;
+
+   RARCH_LOG("Client (#%u) disconnected ...\n", idx);
+}
+
+/**
+ * netplay_spectator_flush:
+ * @spectator            : spectator to send to.
+ *
+ * Sends as much of the savestate and queued input as the
+ * socket takes without blocking. Input is only sent once
+ * the whole savestate has gone out.
+ * Call with the spectator lock held.
+ *
+ * Returns: false (0) if the spectator has to be disconnected.
+ **/
+static bool netplay_spectator_flush(struct netplay_spectator *spectator)
+{
+   ssize_t ret;
+
+   if (!spectator->state_sent)
+   {
+      if (!spectator->state)
+         return true;
+
+      ret = send(spectator->fd,
+            (const char*)spectator->state + spectator->state_ptr,
+            spectator->state_size - spectator->state_ptr, MSG_NOSIGNAL);
+      if (ret < 0)
+         return isagain(ret);
+
+      spectator->state_ptr += ret;
+      if (spectator->state_ptr < spectator->state_size)
+         return true;
+
+      free(spectator->state);
+      spectator->state      = NULL;
+      spectator->state_sent = true;
+   }
+
+   if (spectator->queue_ptr == spectator->queue_len)
+      return true;
+
+   ret = send(spectator->fd,
+         (const char*)spectator->queue + spectator->queue_ptr,
+         spectator->queue_len - spectator->queue_ptr, MSG_NOSIGNAL);
+   if (ret < 0)
+      return isagain(ret);
+
+   spectator->queue_ptr += ret;
+   if (spectator->queue_ptr == spectator->queue_len)
+      spectator->queue_ptr = spectator->queue_len = 0;
+
+   return true;
+}
+
+/**
+ * netplay_spectator_accept:
+ * @netplay              : pointer to netplay object
+ * @spectator            : filled in for the new spectator.
+ *
+ * Accepts an incoming spectator on a non-blocking socket and
+ * queues our nickname for it. The rest of the handshake is done
+ * by netplay_spectator_handshake.
+ *
+ * Returns: false (0) if no spectator could be accepted.
+ **/
+static bool netplay_spectator_accept(netplay_t *netplay,
+      struct netplay_spectator *spectator)
+{
+   socklen_t addr_size = sizeof(spectator->addr);
+   uint8_t nick_size   = strlen(netplay->nick);
+   int new_fd          = accept(netplay->fd,
+         (struct sockaddr*)&spectator->addr, &addr_size);
+
+   if (new_fd < 0)
+   {
+      RARCH_ERR("Failed to accept incoming spectator.\n");
+      return false;
+   }
+
+   if (!socket_nonblock(new_fd))
+   {
+      socket_close(new_fd);
+      return false;
+   }
+
+   spectator->fd                 = new_fd;
+   spectator->handshake_out[0]   = nick_size;
+   memcpy(spectator->handshake_out + 1, netplay->nick, nick_size);
+   spectator->handshake_out_len  = 1 + nick_size;
+   spectator->handshake_deadline = rarch_get_time_usec() +
+      SPECTATE_HANDSHAKE_USEC;
+   return true;
+}
+
+/**
+ * netplay_spectator_handshake:
+ * @spectator            : spectator to exchange nicknames with.
+ *
+ * Sends our nickname and receives the spectator's nickname and
+ * savestate encodings, as far as it goes without blocking.
+ * Once done, the spectator waits for a state.
+ * Call with the spectator lock held.
+ *
+ * Returns: false (0) if the spectator has to be disconnected.
+ **/
+static bool netplay_spectator_handshake(struct netplay_spectator *spectator)
+{
+   ssize_t ret;
+   size_t needed;
+   uint32_t accept_deflate;
+
+   if (spectator->handshake_out_ptr < spectator->handshake_out_len)
+   {
+      ret = send(spectator->fd,
+            (const char*)spectator->handshake_out +
+            spectator->handshake_out_ptr,
+            spectator->handshake_out_len - spectator->handshake_out_ptr,
+            MSG_NOSIGNAL);
+      if (ret < 0)
+         return isagain(ret);
+
+      spectator->handshake_out_ptr += ret;
+   }
+
+   /* Nick size, nick, then the encodings. Only read what
+    * belongs to the handshake. */
+   for (;;)
+   {
+      needed = 1;
+      if (spectator->handshake_in_len)
+      {
+         if (spectator->handshake_in[0] >= sizeof(spectator->nick))
+         {
+            RARCH_ERR("Invalid nick size.\n");
+            return false;
+         }
+         needed += spectator->handshake_in[0] + sizeof(uint32_t);
+      }
+
+      if (spectator->handshake_in_len == needed)
+         break;
+
+      ret = recv(spectator->fd,
+            (char*)spectator->handshake_in + spectator->handshake_in_len,
+            needed - spectator->handshake_in_len, 0);
+      if (ret == 0)
+         return false;
+      if (ret < 0)
+         return isagain(ret);
+
+      spectator->handshake_in_len += ret;
+   }
+
+   if (spectator->handshake_out_ptr < spectator->handshake_out_len)
+      return true;
+
+   memcpy(spectator->nick, spectator->handshake_in + 1,
+         spectator->handshake_in[0]);
+   spectator->nick[spectator->handshake_in[0]] = '\0';
+   memcpy(&accept_deflate,
+         spectator->handshake_in + 1 + spectator->handshake_in[0],
+         sizeof(accept_deflate));
+
+   spectator->accept_deflate = ntohl(accept_deflate);
+   spectator->handshake_done = true;
+   spectator->needs_state    = true;
+   return true;
+}
+
+/**
+ * netplay_spectate_thread:
+ * @data                 : pointer to netplay object
+ *
+ * Accepts spectators and feeds them savestates and input
+ * with non-blocking sockets, so a slow spectator never
+ * holds up the emulation thread.
+ **/
+static void netplay_spectate_thread(void *data)
+{
+   unsigned i;
+   netplay_t *netplay = (netplay_t*)data;
+
+   for (;;)
+   {
+      fd_set read_fds, write_fds;
+      struct timeval tv  = {0};
+      int max_fd         = netplay->fd;
+      int free_slot      = -1;
+      int encode_slot    = -1;
+
+      tv.tv_usec = SPECTATE_POLL_USEC;
+
+      FD_ZERO(&read_fds);
+      FD_ZERO(&write_fds);
+
+      slock_lock(netplay->spectate_lock);
+
+      if (netplay->spectate_quit)
+      {
+         slock_unlock(netplay->spectate_lock);
+         break;
+      }
+
+      for (i = 0; i < MAX_SPECTATORS; i++)
+      {
+         struct netplay_spectator *spectator = &netplay->spectators[i];
+
+         if (spectator->fd < 0)
+         {
+            if (free_slot < 0)
+               free_slot = i;
+            continue;
+         }
+
+         if (spectator->drop)
+         {
+            netplay_spectator_close(netplay, i);
+            if (free_slot < 0)
+               free_slot = i;
+            continue;
+         }
+
+         if (!spectator->handshake_done)
+         {
+            if (rarch_get_time_usec() > spectator->handshake_deadline)
+            {
+               RARCH_ERR("Spectator timed out before sending its nickname.\n");
+               netplay_spectator_close(netplay, i);
+               if (free_slot < 0)
+                  free_slot = i;
+               continue;
+            }
+
+            FD_SET(spectator->fd, &read_fds);
+            if (spectator->handshake_out_ptr < spectator->handshake_out_len)
+               FD_SET(spectator->fd, &write_fds);
+         }
+         else
+         {
+            if (spectator->raw_state && encode_slot < 0)
+               encode_slot = i;
+
+            /* Spectators never talk back after the handshake,
+             * this only catches hangups. */
+            FD_SET(spectator->fd, &read_fds);
+            if ((!spectator->state_sent && spectator->state)
+                  || (spectator->state_sent
+                     && spectator->queue_ptr < spectator->queue_len))
+               FD_SET(spectator->fd, &write_fds);
+         }
+
+         if (spectator->fd > max_fd)
+            max_fd = spectator->fd;
+      }
+
+      slock_unlock(netplay->spectate_lock);
+
+      /* Encode outside the lock, only this thread touches
+       * the state buffers once they are handed over. */
+      if (encode_slot >= 0)
+      {
+         struct netplay_spectator *spectator =
+            &netplay->spectators[encode_slot];
+         size_t state_size = 0;
+         uint8_t *state    = netplay_encode_state(spectator->raw_state + 4,
+               spectator->raw_state_size - 4 * sizeof(uint32_t),
+               spectator->accept_deflate, &state_size);
+
+         slock_lock(netplay->spectate_lock);
+         if (state)
+         {
+            spectator->state_size = 4 * sizeof(uint32_t) + state_size;
+            spectator->state      = (uint8_t*)malloc(spectator->state_size);
+         }
+
+         if (!state || !spectator->state)
+            netplay_spectator_close(netplay, encode_slot);
+         else
+         {
+            memcpy(spectator->state, spectator->raw_state,
+                  4 * sizeof(uint32_t));
+            memcpy(spectator->state + 4 * sizeof(uint32_t),
+                  state, state_size);
+            free(spectator->raw_state);
+            spectator->raw_state = NULL;
+         }
+         slock_unlock(netplay->spectate_lock);
+
+         free(state);
+         continue;
+      }
+
+      if (free_slot >= 0)
+         FD_SET(netplay->fd, &read_fds);
+
+      if (socket_select(max_fd + 1, &read_fds, &write_fds, NULL, &tv) < 0)
+         continue;
+
+      if (free_slot >= 0 && FD_ISSET(netplay->fd, &read_fds))
+      {
+         struct netplay_spectator spectator = {0};
+
+         if (netplay_spectator_accept(netplay, &spectator))
+         {
+            slock_lock(netplay->spectate_lock);
+            netplay->spectators[free_slot] = spectator;
+            slock_unlock(netplay->spectate_lock);
+         }
+      }
+
+      slock_lock(netplay->spectate_lock);
+      for (i = 0; i < MAX_SPECTATORS; i++)
+      {
+         struct netplay_spectator *spectator = &netplay->spectators[i];
+
+         if (spectator->fd < 0 || (int)i == free_slot)
+            continue;
+
+         if (!spectator->handshake_done)
+         {
+            if ((FD_ISSET(spectator->fd, &read_fds)
+                     || FD_ISSET(spectator->fd, &write_fds))
+                  && !netplay_spectator_handshake(spectator))
+               netplay_spectator_close(netplay, i);
+            continue;
+         }
+
+         if (FD_ISSET(spectator->fd, &read_fds))
+         {
+            char buf[64];
+            ssize_t ret = recv(spectator->fd, buf, sizeof(buf), 0);
+
+            if (ret == 0 || (ret < 0 && !isagain(ret)))
+            {
+               netplay_spectator_close(netplay, i);
+               continue;
+            }
+         }
+
+         if (FD_ISSET(spectator->fd, &write_fds)
+               && !netplay_spectator_flush(spectator))
+            netplay_spectator_close(netplay, i);
+      }
+      slock_unlock(netplay->spectate_lock);
+   }
+}
+
+/**
+ * netplay_pre_frame_spectate:   
+ * @netplay              : pointer to netplay object
+ *
+ * Pre-frame for Netplay (spectate mode version).
+ * Saves a state for spectators which just joined,
+ * the spectator thread sends it.
+ **/
+static void netplay_pre_frame_spectate(netplay_t *netplay)
+{
+   unsigned i;
+
+   if (netplay->spectate_client)
+      return;
+
+   slock_lock(netplay->spectate_lock);
+   for (i = 0; i < MAX_SPECTATORS; i++)
+   {
+      struct netplay_spectator *spectator = &netplay->spectators[i];
+
+      if (spectator->fd < 0 || !spectator->needs_state || spectator->drop)
+         continue;
+
+      spectator->needs_state = false;
+      spectator->raw_state   = bsv_header_generate(
+            &spectator->raw_state_size, netplay_magic_value());
+
+      if (!spectator->raw_state)
+      {
+         RARCH_ERR("Failed to generate BSV header.\n");
+         spectator->drop = true;
+         continue;
+      }
+
+#ifndef HAVE_SOCKET_LEGACY
+      log_connection(&spectator->addr, i, spectator->nick);
+#endif
+   }
+   slock_unlock(netplay->spectate_lock);
+}
+#else
+/**
+ * netplay_spectate_accept:
+ * @netplay              : pointer to netplay object
+ * @spectator            : filled in for the new spectator.
+ *
+ * Accepts an incoming spectator and exchanges nicknames and
+ * savestate encodings with it. Blocks until that is done.
+ *
+ * Returns: socket of the new spectator, or -1 on failure.
+ **/
+static int netplay_spectate_accept(netplay_t *netplay,
+      struct netplay_spectator *spectator)
+{
+   int new_fd;
+   socklen_t addr_size;
+   uint32_t accept_deflate = 0;
+
+   addr_size = sizeof(spectator->addr);
+   new_fd = accept(netplay->fd, (struct sockaddr*)&spectator->addr,
+         &addr_size);
+   if (new_fd < 0)
+   {
+      RARCH_ERR("Failed to accept incoming spectator.\n");
+      return -1;
+   }
+
+   if (!get_nickname(netplay, new_fd))
+   {
+      RARCH_ERR("Failed to get nickname from client.\n");
+      goto error;
+   }
+
+   if (!send_nickname(netplay, new_fd))
+   {
+      RARCH_ERR("Failed to send nickname to client.\n");
+      goto error;
+   }
+
+   if (!socket_receive_all_blocking(new_fd,
+            &accept_deflate, sizeof(accept_deflate)))
+   {
+      RARCH_ERR("Failed to receive savestate encodings from client.\n");
+      goto error;
+   }
+
+   strlcpy(spectator->nick, netplay->other_nick, sizeof(spectator->nick));
+   spectator->accept_deflate = ntohl(accept_deflate);
+   return new_fd;
+
+error:
+   socket_close(new_fd);
+   return -1;
+}
+
 /**
  * netplay_pre_frame_spectate:   
  * @netplay              : pointer to netplay object
@@ -1392,12 +2379,12 @@ static void netplay_pre_frame_spectate(netplay_t *netplay)
 {
    unsigned i;
    uint32_t *header;
+   uint8_t *state;
    int new_fd, idx, bufsize;
-   size_t header_size;
-   struct sockaddr_storage their_addr;
-   socklen_t addr_size;
+   size_t header_size, state_size = 0;
    fd_set fds;
    struct timeval tmp_tv = {0};
+   struct netplay_spectator spectator = {0};
 
    if (netplay->spectate_client)
       return;
@@ -1411,18 +2398,10 @@ static void netplay_pre_frame_spectate(netplay_t *netplay)
    if (!FD_ISSET(netplay->fd, &fds))
       return;
 
-   addr_size = sizeof(their_addr);
-   new_fd = accept(netplay->fd, (struct sockaddr*)&their_addr, &addr_size);
-   if (new_fd < 0)
-   {
-      RARCH_ERR("Failed to accept incoming spectator.\n");
-      return;
-   }
-
    idx = -1;
    for (i = 0; i < MAX_SPECTATORS; i++)
    {
-      if (netplay->spectate_fds[i] == -1)
+      if (netplay->spectators[i].fd == -1)
       {
          idx = i;
          break;
@@ -1432,26 +2411,20 @@ static void netplay_pre_frame_spectate(netplay_t *netplay)
    /* No vacant client streams :( */
    if (idx == -1)
    {
-      socket_close(new_fd);
-      return;
-   }
-
-   if (!get_nickname(netplay, new_fd))
-   {
-      RARCH_ERR("Failed to get nickname from client.\n");
-      socket_close(new_fd);
+      socklen_t addr_size = sizeof(spectator.addr);
+      new_fd = accept(netplay->fd, (struct sockaddr*)&spectator.addr,
+            &addr_size);
+      if (new_fd >= 0)
+         socket_close(new_fd);
       return;
    }
 
-   if (!send_nickname(netplay, new_fd))
-   {
-      RARCH_ERR("Failed to send nickname to client.\n");
-      socket_close(new_fd);
+   new_fd = netplay_spectate_accept(netplay, &spectator);
+   if (new_fd < 0)
       return;
-   }
 
    header = bsv_header_generate(&header_size,
-         implementation_magic_value());
+         netplay_magic_value());
 
    if (!header)
    {
@@ -1460,25 +2433,36 @@ static void netplay_pre_frame_spectate(netplay_t *netplay)
       return;
    }
 
-   bufsize = header_size;
+   state = netplay_encode_state(header + 4,
+         header_size - 4 * sizeof(uint32_t),
+         spectator.accept_deflate, &state_size);
+
+   bufsize = 4 * sizeof(uint32_t) + state_size;
    setsockopt(new_fd, SOL_SOCKET, SO_SNDBUF, (const char*)&bufsize,
          sizeof(int));
 
-   if (!socket_send_all_blocking(new_fd, header, header_size))
+   if (!state
+         || !socket_send_all_blocking(new_fd, header, 4 * sizeof(uint32_t))
+         || !socket_send_all_blocking(new_fd, state, state_size))
    {
       RARCH_ERR("Failed to send header to client.\n");
       socket_close(new_fd);
       free(header);
+      free(state);
       return;
    }
 
    free(header);
-   netplay->spectate_fds[idx] = new_fd;
+   free(state);
+
+   spectator.fd = new_fd;
+   netplay->spectators[idx] = spectator;
 
 #ifndef HAVE_SOCKET_LEGACY
-   log_connection(&their_addr, idx, netplay->other_nick);
+   log_connection(&spectator.addr, idx, spectator.nick);
 #endif
 }
+#endif
 
 /**
  * netplay_pre_frame:   
@@ -1504,15 +2488,21 @@ void netplay_pre_frame(netplay_t *netplay)
  **/
 static void netplay_post_frame_net(netplay_t *netplay)
 {
+   uint32_t read_frame_count;
+
    netplay->frame_count++;
+   netplay->stats.frames++;
+
+   /* Input read ahead of the frames we ran has nothing to check yet. */
+   read_frame_count = min(netplay->read_frame_count, netplay->frame_count);
 
    /* Nothing to do... */
-   if (netplay->other_frame_count == netplay->read_frame_count)
+   if (netplay->other_frame_count == read_frame_count)
       return;
 
    /* Skip ahead if we predicted correctly.
     * Skip until our simulation failed. */
-   while (netplay->other_frame_count < netplay->read_frame_count)
+   while (netplay->other_frame_count < read_frame_count)
    {
       const struct delta_frame *ptr = &netplay->buffer[netplay->other_ptr];
 
@@ -1523,9 +2513,21 @@ static void netplay_post_frame_net(netplay_t *netplay)
       netplay->other_frame_count++;
    }
 
-   if (netplay->other_frame_count < netplay->read_frame_count)
+   if (netplay->other_frame_count < read_frame_count)
    {
       bool first = true;
+      unsigned replayed = 0;
+      size_t ptr = netplay->other_ptr;
+      uint32_t frame;
+
+      for (frame = netplay->other_frame_count; frame < read_frame_count;
+            frame++, ptr = NEXT_PTR(ptr))
+      {
+         if (netplay->buffer[ptr].simulated_input_state !=
+               netplay->buffer[ptr].real_input_state
+               && !netplay->buffer[ptr].used_real)
+            netplay->stats.mispredictions++;
+      }
 
       /* Replay frames. */
       netplay->is_replay = true;
@@ -1537,8 +2539,7 @@ static void netplay_post_frame_net(netplay_t *netplay)
 
       while (first || (netplay->tmp_ptr != netplay->self_ptr))
       {
-         pretro_serialize(netplay->buffer[netplay->tmp_ptr].state,
-               netplay->state_size);
+         netplay_serialize(netplay, netplay->tmp_ptr);
 #if defined(HAVE_THREADS) && !defined(RARCH_CONSOLE)
          lock_autosave();
 #endif
@@ -1548,11 +2549,16 @@ static void netplay_post_frame_net(netplay_t *netplay)
 #endif
          netplay->tmp_ptr = NEXT_PTR(netplay->tmp_ptr);
          netplay->tmp_frame_count++;
+         replayed++;
          first = false;
       }
 
-      netplay->other_ptr = netplay->read_ptr;
-      netplay->other_frame_count = netplay->read_frame_count;
+      netplay->stats.frames_replayed += replayed;
+      if (replayed > netplay->stats.longest_replay)
+         netplay->stats.longest_replay = replayed;
+
+      netplay->other_ptr = ptr;
+      netplay->other_frame_count = read_frame_count;
       netplay->is_replay = false;
    }
 }
@@ -1568,19 +2574,74 @@ static void netplay_post_frame_spectate(netplay_t *netplay)
 {
    unsigned i;
 
+   size_t size = netplay->spectate_input_ptr * sizeof(int16_t);
+
    if (netplay->spectate_client)
       return;
 
+#ifdef HAVE_THREADS
+   slock_lock(netplay->spectate_lock);
    for (i = 0; i < MAX_SPECTATORS; i++)
    {
       char msg[PATH_MAX_LENGTH];
+      struct netplay_spectator *spectator = &netplay->spectators[i];
+      size_t queued = spectator->queue_len - spectator->queue_ptr;
 
-      if (netplay->spectate_fds[i] == -1)
+      if (spectator->fd < 0 || !spectator->handshake_done
+            || spectator->needs_state || spectator->drop)
          continue;
 
-      if (socket_send_all_blocking(netplay->spectate_fds[i],
-               netplay->spectate_input,
-               netplay->spectate_input_ptr * sizeof(int16_t)))
+      if (queued + size > SPECTATE_QUEUE_MAX)
+      {
+         RARCH_WARN("Client (#%u) is lagging behind, disconnecting ...\n", i);
+
+         snprintf(msg, sizeof(msg), "Client (#%u) lagged behind and was disconnected.", i);
+         msg_queue_push(g_extern.msg_queue, msg, 1, 180);
+
+         spectator->drop = true;
+         continue;
+      }
+
+      if (spectator->queue_len + size > spectator->queue_size)
+      {
+         /* Make room at the front before growing. */
+         memmove(spectator->queue, spectator->queue + spectator->queue_ptr,
+               queued);
+         spectator->queue_len = queued;
+         spectator->queue_ptr = 0;
+      }
+
+      if (spectator->queue_len + size > spectator->queue_size)
+      {
+         size_t new_size = max(spectator->queue_len + size,
+               2 * spectator->queue_size);
+         uint8_t *queue  = (uint8_t*)realloc(spectator->queue, new_size);
+
+         if (!queue)
+         {
+            spectator->drop = true;
+            continue;
+         }
+
+         spectator->queue      = queue;
+         spectator->queue_size = new_size;
+      }
+
+      memcpy(spectator->queue + spectator->queue_len,
+            netplay->spectate_input, size);
+      spectator->queue_len += size;
+   }
+   slock_unlock(netplay->spectate_lock);
+#else
+   for (i = 0; i < MAX_SPECTATORS; i++)
+   {
+      char msg[PATH_MAX_LENGTH];
+
+      if (netplay->spectators[i].fd == -1)
+         continue;
+
+      if (socket_send_all_blocking(netplay->spectators[i].fd,
+               netplay->spectate_input, size))
          continue;
 
       RARCH_LOG("Client (#%u) disconnected ...\n", i);
@@ -1588,10 +2649,11 @@ static void netplay_post_frame_spectate(netplay_t *netplay)
       snprintf(msg, sizeof(msg), "Client (#%u) disconnected.", i);
       msg_queue_push(g_extern.msg_queue, msg, 1, 180);
 
-      socket_close(netplay->spectate_fds[i]);
-      netplay->spectate_fds[i] = -1;
+      socket_close(netplay->spectators[i].fd);
+      netplay->spectators[i].fd = -1;
       break;
    }
+#endif
 
    netplay->spectate_input_ptr = 0;
 }
@@ -26,6 +26,20 @@
 
 typedef struct netplay netplay_t;
 
+struct netplay_stats
+{
+   uint64_t frames;
+   /* Frames where our prediction of the other side's input was wrong. */
+   uint64_t mispredictions;
+   uint64_t frames_replayed;
+   unsigned longest_replay;
+   /* Frames we had to wait for the other side. */
+   uint64_t stalls;
+
+   uint64_t serializations;
+   retro_time_t serialize_usec;
+};
+
 void input_poll_net(void);
 
 int16_t input_state_net(unsigned port, unsigned device,
@@ -79,6 +93,21 @@ void netplay_free(netplay_t *handle);
  **/
 void netplay_flip_users(netplay_t *handle);
 
+/**
+ * netplay_get_stats:
+ * @netplay              : pointer to netplay object
+ * @stats                : counters since netplay started.
+ * @input_latency        : current local input latency in frames.
+ * @rtt                  : round trip time in microseconds,
+ *                         0 if not measured.
+ *
+ * Gets statistics for tuning netplay sessions.
+ *
+ * Returns: false (0) in spectator mode, otherwise true (1).
+ **/
+bool netplay_get_stats(netplay_t *handle, struct netplay_stats *stats,
+      unsigned *input_latency, retro_time_t *rtt);
+
 /**
  * netplay_pre_frame:   
  * @netplay              : pointer to netplay object
@@ -73,11 +73,34 @@
 #include <emscripten.h>
 #endif
 
+/* Absolute deadlines on the same clock as rarch_get_time_usec(). */
+#if (defined(__linux__) && !defined(ANDROID)) || defined(__QNX__) || \
+   defined(__FreeBSD__) || defined(__NetBSD__)
+#define HAVE_CLOCK_NANOSLEEP
+#elif defined(__APPLE__) || defined(ANDROID)
+#define HAVE_NANOSLEEP
+#endif
+
+/* How long before a deadline to stop sleeping and start spinning.
+ * Has to cover the scheduler's wakeup latency, which is well below
+ * this with (clock_)nanosleep. Sleep() on Windows only has timer
+ * tick precision. */
+#if defined(HAVE_CLOCK_NANOSLEEP)
+#define SLEEP_SPIN_USEC 200
+#elif defined(HAVE_NANOSLEEP)
+#define SLEEP_SPIN_USEC 250
+#elif defined(_WIN32)
+#define SLEEP_SPIN_USEC 2000
+#else
+#define SLEEP_SPIN_USEC 1000
+#endif
+
 #if defined(BSD) || defined(__APPLE__)
 #include <sys/sysctl.h>
 #endif
 
 #include <string.h>
+#include <errno.h>
 
 const struct retro_perf_counter *perf_counters_rarch[MAX_COUNTERS];
 const struct retro_perf_counter *perf_counters_libretro[MAX_COUNTERS];
@@ -247,6 +270,50 @@ retro_time_t rarch_get_time_usec(void)
 #endif
 }
 
+/**
+ * rarch_sleep_until_usec:
+ * @target             : time to wake up at, see rarch_get_time_usec().
+ *
+ * Sleeps until shortly before @target, then spins for the rest,
+ * so the deadline is met with sub-millisecond precision.
+ *
+ * Returns: how late we woke up, in microseconds.
+ **/
+retro_time_t rarch_sleep_until_usec(retro_time_t target)
+{
+   retro_time_t current = rarch_get_time_usec();
+
+   if (target - current > SLEEP_SPIN_USEC)
+   {
+#if defined(HAVE_CLOCK_NANOSLEEP)
+      struct timespec tv;
+      retro_time_t wakeup = target - SLEEP_SPIN_USEC;
+
+      tv.tv_sec  = wakeup / 1000000;
+      tv.tv_nsec = (wakeup % 1000000) * 1000;
+
+      while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &tv, NULL) == EINTR);
+#elif defined(HAVE_NANOSLEEP)
+      struct timespec tv;
+      retro_time_t duration = target - current - SLEEP_SPIN_USEC;
+
+      tv.tv_sec  = duration / 1000000;
+      tv.tv_nsec = (duration % 1000000) * 1000;
+
+      while (nanosleep(&tv, &tv) == -1 && errno == EINTR);
+#else
+      rarch_sleep((unsigned)((target - current - SLEEP_SPIN_USEC) / 1000));
+#endif
+   }
+
+   do
+   {
+      current = rarch_get_time_usec();
+   } while (current < target);
+
+   return current - target;
+}
+
 #if defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__)
 #define CPU_X86
 #endif
@@ -442,7 +509,9 @@ uint64_t rarch_get_cpu_features(void)
          && ((xgetbv_x86(0) & 0x6) == 0x6))
       cpu |= RETRO_SIMD_AVX;
 
-   if (max_flag >= 7)
+   /* AVX2 uses the same register state as AVX,
+    * so it also needs the OS support checked above. */
+   if (max_flag >= 7 && (cpu & RETRO_SIMD_AVX))
    {
       x86_cpuid(7, flags);
       if (flags[1] & (1 << 5))
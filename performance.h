@@ -68,6 +68,17 @@ retro_perf_tick_t rarch_get_perf_counter(void);
  **/
 retro_time_t rarch_get_time_usec(void);
 
+/**
+ * rarch_sleep_until_usec:
+ * @target             : time to wake up at, see rarch_get_time_usec().
+ *
+ * Sleeps until shortly before @target, then spins for the rest,
+ * so the deadline is met with sub-millisecond precision.
+ *
+ * Returns: how late we woke up, in microseconds.
+ **/
+retro_time_t rarch_sleep_until_usec(retro_time_t target);
+
 void rarch_perf_register(struct retro_perf_counter *perf);
 
 /* Same as rarch_perf_register, just for libretro cores. */
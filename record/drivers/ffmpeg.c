@@ -44,7 +44,7 @@ extern "C" {
 #include <stdio.h>
 #include <stdlib.h>
 #include <boolean.h>
-#include <queues/fifo_buffer.h>
+#include <queues/fifo_spsc.h>
 #include <rthreads/rthreads.h>
 #include "../../general.h"
 #include <gfx/scaler/scaler.h>
@@ -172,16 +172,18 @@ typedef struct ffmpeg
    
    struct ffemu_params params;
 
+   /* Only used to put the encoder thread to sleep,
+    * the FIFOs themselves are lock-free. */
    scond_t *cond;
    slock_t *cond_lock;
-   slock_t *lock;
-   fifo_buffer_t *audio_fifo;
-   fifo_buffer_t *video_fifo;
-   fifo_buffer_t *attr_fifo;
+   bool idle;
+
+   fifo_spsc_t *audio_fifo;
+   fifo_spsc_t *video_fifo;
+   fifo_spsc_t *attr_fifo;
    sthread_t *thread;
 
    volatile bool alive;
-   volatile bool can_sleep;
 } ffmpeg_t;
 
 static bool ffmpeg_codec_has_sample_format(enum AVSampleFormat fmt,
@@ -305,6 +307,7 @@ static bool ffmpeg_init_audio(ffmpeg_t *handle)
       rarch_resampler_realloc(&audio->resampler_data,
             &audio->resampler,
             g_settings.audio.resampler,
+            (enum resampler_quality)g_settings.audio.resampler_quality,
             audio->ratio);
    }
    else
@@ -618,20 +621,19 @@ static void ffmpeg_thread(void *data);
 
 static bool init_thread(ffmpeg_t *handle)
 {
-   handle->lock = slock_new();
    handle->cond_lock = slock_new();
    handle->cond = scond_new();
-   handle->audio_fifo = fifo_new(32000 * sizeof(int16_t) *
+   handle->audio_fifo = fifo_spsc_new(32000 * sizeof(int16_t) *
          handle->params.channels * MAX_FRAMES / 60); /* Some arbitrary max size. */
-   handle->attr_fifo = fifo_new(sizeof(struct ffemu_video_data) * MAX_FRAMES);
-   handle->video_fifo = fifo_new(handle->params.fb_width * handle->params.fb_height *
+   handle->attr_fifo = fifo_spsc_new(sizeof(struct ffemu_video_data) * MAX_FRAMES);
+   handle->video_fifo = fifo_spsc_new(handle->params.fb_width * handle->params.fb_height *
             handle->video.pix_size * MAX_FRAMES);
 
    handle->alive = true;
-   handle->can_sleep = true;
+   handle->idle = false;
    handle->thread = sthread_create(ffmpeg_thread, handle);
 
-   assert(handle->lock && handle->cond_lock &&
+   assert(handle->cond_lock &&
       handle->cond && handle->audio_fifo &&
       handle->attr_fifo && handle->video_fifo && handle->thread);
 
@@ -645,13 +647,11 @@ static void deinit_thread(ffmpeg_t *handle)
 
    slock_lock(handle->cond_lock);
    handle->alive = false;
-   handle->can_sleep = false;
+   scond_signal(handle->cond);
    slock_unlock(handle->cond_lock);
 
-   scond_signal(handle->cond);
    sthread_join(handle->thread);
 
-   slock_free(handle->lock);
    slock_free(handle->cond_lock);
    scond_free(handle->cond);
 
@@ -662,19 +662,19 @@ static void deinit_thread_buf(ffmpeg_t *handle)
 {
    if (handle->audio_fifo)
    {
-      fifo_free(handle->audio_fifo);
+      fifo_spsc_free(handle->audio_fifo);
       handle->audio_fifo = NULL;
    }
    
    if (handle->attr_fifo)
    {
-      fifo_free(handle->attr_fifo);
+      fifo_spsc_free(handle->attr_fifo);
       handle->attr_fifo = NULL;
    }
 
    if (handle->video_fifo)
    {
-      fifo_free(handle->video_fifo);
+      fifo_spsc_free(handle->video_fifo);
       handle->video_fifo = NULL;
    }
 }
@@ -766,11 +766,22 @@ error:
    return NULL;
 }
 
+static void ffmpeg_wake_thread(ffmpeg_t *handle)
+{
+   /* The encoder thread re-checks the FIFOs under cond_lock
+    * before going idle, so a wakeup can't be missed. */
+   slock_lock(handle->cond_lock);
+   if (handle->idle)
+      scond_signal(handle->cond);
+   slock_unlock(handle->cond_lock);
+}
+
 static bool ffmpeg_push_video(void *data,
       const struct ffemu_video_data *video_data)
 {
    unsigned y;
    bool drop_frame;
+   size_t offset = 0;
    struct ffemu_video_data attr_data;
    ffmpeg_t *handle = (ffmpeg_t*)data;
 
@@ -785,33 +796,8 @@ static bool ffmpeg_push_video(void *data,
    if (drop_frame)
       return true;
 
-   for (;;)
-   {
-      unsigned avail;
-      slock_lock(handle->lock);
-      avail = fifo_write_avail(handle->attr_fifo);
-      slock_unlock(handle->lock);
-
-      if (!handle->alive)
-         return false;
-
-      if (avail >= sizeof(*video_data))
-         break;
-
-      slock_lock(handle->cond_lock);
-      if (handle->can_sleep)
-      {
-         handle->can_sleep = false;
-         scond_wait(handle->cond, handle->cond_lock);
-         handle->can_sleep = true;
-      }
-      else
-         scond_signal(handle->cond);
-
-      slock_unlock(handle->cond_lock);
-   }
-
-   slock_lock(handle->lock);
+   if (!handle->alive)
+      return false;
 
    /* Tightly pack our frame to conserve memory.
     * libretro tends to use a very large pitch.
@@ -823,15 +809,22 @@ static bool ffmpeg_push_video(void *data,
    else
       attr_data.pitch = attr_data.width * handle->video.pix_size;
 
-   fifo_write(handle->attr_fifo, &attr_data, sizeof(attr_data));
+   /* The encoder pops the attributes before it reads the pixels,
+    * so room for one doesn't imply room for the other. */
+   if (!fifo_spsc_wait_write(handle->attr_fifo, sizeof(attr_data), -1))
+      return false;
+   if (!fifo_spsc_wait_write(handle->video_fifo,
+            attr_data.height * attr_data.pitch, -1))
+      return false;
 
-   int offset = 0;
+   /* The attributes go last, so the frame is complete
+    * once the encoder thread sees them. */
    for (y = 0; y < attr_data.height; y++, offset += video_data->pitch)
-      fifo_write(handle->video_fifo,
+      fifo_spsc_write(handle->video_fifo,
             (const uint8_t*)video_data->data + offset, attr_data.pitch);
 
-   slock_unlock(handle->lock);
-   scond_signal(handle->cond);
+   fifo_spsc_write(handle->attr_fifo, &attr_data, sizeof(attr_data));
+   ffmpeg_wake_thread(handle);
 
    return true;
 }
@@ -847,38 +840,16 @@ static bool ffmpeg_push_audio(void *data,
    if (!handle->config.audio_enable)
       return true;
 
-   for (;;)
-   {
-      unsigned avail;
-      slock_lock(handle->lock);
-      avail = fifo_write_avail(handle->audio_fifo);
-      slock_unlock(handle->lock);
-
-      if (!handle->alive)
-         return false;
-
-      if (avail >= audio_data->frames * handle->params.channels
-            * sizeof(int16_t))
-         break;
-
-      slock_lock(handle->cond_lock);
-      if (handle->can_sleep)
-      {
-         handle->can_sleep = false;
-         scond_wait(handle->cond, handle->cond_lock);
-         handle->can_sleep = true;
-      }
-      else
-         scond_signal(handle->cond);
+   if (!handle->alive)
+      return false;
 
-      slock_unlock(handle->cond_lock);
-   }
+   if (!fifo_spsc_wait_write(handle->audio_fifo, audio_data->frames *
+            handle->params.channels * sizeof(int16_t), -1))
+      return false;
 
-   slock_lock(handle->lock);
-   fifo_write(handle->audio_fifo, audio_data->data,
+   fifo_spsc_write(handle->audio_fifo, audio_data->data,
          audio_data->frames * handle->params.channels * sizeof(int16_t));
-   slock_unlock(handle->lock);
-   scond_signal(handle->cond);
+   ffmpeg_wake_thread(handle);
 
    return true;
 }
@@ -1218,11 +1189,11 @@ static bool ffmpeg_push_audio_thread(ffmpeg_t *handle,
 static void ffmpeg_flush_audio(ffmpeg_t *handle, void *audio_buf,
       size_t audio_buf_size)
 {
-   size_t avail = fifo_read_avail(handle->audio_fifo);
+   size_t avail = fifo_spsc_read(handle->audio_fifo,
+         audio_buf, audio_buf_size);
 
    if (avail)
    {
-      fifo_read(handle->audio_fifo, audio_buf, avail);
 
       struct ffemu_audio_data aud = {0};
       aud.frames = avail / (sizeof(int16_t) * handle->params.channels);
@@ -1274,9 +1245,9 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 
       if (handle->config.audio_enable)
       {
-         if (fifo_read_avail(handle->audio_fifo) >= audio_buf_size)
+         if (fifo_spsc_read_avail(handle->audio_fifo) >= audio_buf_size)
          {
-            fifo_read(handle->audio_fifo, audio_buf, audio_buf_size);
+            fifo_spsc_read(handle->audio_fifo, audio_buf, audio_buf_size);
 
             struct ffemu_audio_data aud = {0};
             aud.frames = handle->audio.codec->frame_size;
@@ -1287,10 +1258,10 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
          }
       }
 
-      if (fifo_read_avail(handle->attr_fifo) >= sizeof(attr_buf))
+      if (fifo_spsc_read_avail(handle->attr_fifo) >= sizeof(attr_buf))
       {
-         fifo_read(handle->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(handle->video_fifo, video_buf, 
+         fifo_spsc_read(handle->attr_fifo, &attr_buf, sizeof(attr_buf));
+         fifo_spsc_read(handle->video_fifo, video_buf, 
                attr_buf.height * attr_buf.pitch);
          attr_buf.data = video_buf;
          ffmpeg_push_video_thread(handle, &attr_buf);
@@ -1330,6 +1301,17 @@ static bool ffmpeg_finalize(void *data)
    return true;
 }
 
+static bool ffmpeg_thread_avail(ffmpeg_t *ff, size_t audio_buf_size,
+      bool *avail_video, bool *avail_audio)
+{
+   *avail_video = fifo_spsc_read_avail(ff->attr_fifo) >=
+      sizeof(struct ffemu_video_data);
+   *avail_audio = ff->config.audio_enable &&
+      fifo_spsc_read_avail(ff->audio_fifo) >= audio_buf_size;
+
+   return *avail_video || *avail_audio;
+}
+
 static void ffmpeg_thread(void *data)
 {
    ffmpeg_t *ff = (ffmpeg_t*)data;
@@ -1351,38 +1333,24 @@ static void ffmpeg_thread(void *data)
       bool avail_video = false;
       bool avail_audio = false;
 
-      slock_lock(ff->lock);
-      if (fifo_read_avail(ff->attr_fifo) >= sizeof(attr_buf))
-         avail_video = true;
-
-      if (ff->config.audio_enable)
-         if (fifo_read_avail(ff->audio_fifo) >= audio_buf_size)
-            avail_audio = true;
-      slock_unlock(ff->lock);
-
-      if (!avail_video && !avail_audio)
+      if (!ffmpeg_thread_avail(ff, audio_buf_size,
+               &avail_video, &avail_audio))
       {
          slock_lock(ff->cond_lock);
-         if (ff->can_sleep)
-         {
-            ff->can_sleep = false;
+         ff->idle = true;
+         if (ff->alive && !ffmpeg_thread_avail(ff, audio_buf_size,
+                  &avail_video, &avail_audio))
             scond_wait(ff->cond, ff->cond_lock);
-            ff->can_sleep = true;
-         }
-         else
-            scond_signal(ff->cond);
-
+         ff->idle = false;
          slock_unlock(ff->cond_lock);
+         continue;
       }
 
       if (avail_video)
       {
-         slock_lock(ff->lock);
-         fifo_read(ff->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(ff->video_fifo, video_buf,
+         fifo_spsc_read(ff->attr_fifo, &attr_buf, sizeof(attr_buf));
+         fifo_spsc_read(ff->video_fifo, video_buf,
                attr_buf.height * attr_buf.pitch);
-         slock_unlock(ff->lock);
-         scond_signal(ff->cond);
 
          attr_buf.data = video_buf;
          ffmpeg_push_video_thread(ff, &attr_buf);
@@ -1390,10 +1358,7 @@ static void ffmpeg_thread(void *data)
 
       if (avail_audio)
       {
-         slock_lock(ff->lock);
-         fifo_read(ff->audio_fifo, audio_buf, audio_buf_size);
-         slock_unlock(ff->lock);
-         scond_signal(ff->cond);
+         fifo_spsc_read(ff->audio_fifo, audio_buf, audio_buf_size);
 
          struct ffemu_audio_data aud = {0};
          aud.frames = ff->audio.codec->frame_size;
@@ -1214,7 +1214,8 @@ static void init_cheats(void)
 
 static void init_rewind(void)
 {
-   void *state = NULL;
+   void *state      = NULL;
+   unsigned threads = g_settings.rewind_threads;
 #ifdef HAVE_NETPLAY
    if (driver.netplay_data)
       return;
@@ -1240,8 +1241,16 @@ static void init_rewind(void)
    RARCH_LOG(RETRO_MSG_REWIND_INIT "%u MB\n",
          (unsigned)(g_settings.rewind_buffer_size / 1000000));
 
+#ifdef HAVE_THREADS
+   /* Keep compression off the main thread. */
+   if (g_settings.rewind_compression && !threads)
+      threads = 1;
+#endif
+
    g_extern.state_manager = state_manager_new(g_extern.state_size,
-         g_settings.rewind_buffer_size);
+         g_settings.rewind_buffer_size, threads,
+         g_settings.rewind_keyframe_interval,
+         g_settings.rewind_compression);
 
    if (!g_extern.state_manager)
       RARCH_WARN(RETRO_LOG_REWIND_INIT_FAILED);
@@ -2090,6 +2099,9 @@ static void init_system_av_info(void)
 
 static void deinit_core(void)
 {
+   free(g_extern.run_ahead.state);
+   memset(&g_extern.run_ahead, 0, sizeof(g_extern.run_ahead));
+
    pretro_unload_game();
    pretro_deinit();
 
@@ -2700,20 +2712,38 @@ bool rarch_main_command(unsigned cmd)
 #endif
          break;
       case RARCH_CMD_DSP_FILTER_DEINIT:
+#ifdef HAVE_THREADS
+         audio_dsp_thread_lock(g_extern.audio_data.dsp_thread);
+#endif
          if (g_extern.audio_data.dsp)
             rarch_dsp_filter_free(g_extern.audio_data.dsp);
          g_extern.audio_data.dsp = NULL;
+#ifdef HAVE_THREADS
+         audio_dsp_thread_unlock(g_extern.audio_data.dsp_thread);
+#endif
          break;
       case RARCH_CMD_DSP_FILTER_INIT:
-         rarch_main_command(RARCH_CMD_DSP_FILTER_DEINIT);
-         if (!*g_settings.audio.dsp_plugin)
-            break;
+         {
+            rarch_dsp_filter_t *dsp = NULL;
+
+            rarch_main_command(RARCH_CMD_DSP_FILTER_DEINIT);
+            if (!*g_settings.audio.dsp_plugin)
+               break;
 
-         g_extern.audio_data.dsp = rarch_dsp_filter_new(
-               g_settings.audio.dsp_plugin, g_extern.audio_data.in_rate);
-         if (!g_extern.audio_data.dsp)
-            RARCH_ERR("[DSP]: Failed to initialize DSP filter \"%s\".\n",
-                  g_settings.audio.dsp_plugin);
+            dsp = rarch_dsp_filter_new(
+                  g_settings.audio.dsp_plugin, g_extern.audio_data.in_rate);
+            if (!dsp)
+               RARCH_ERR("[DSP]: Failed to initialize DSP filter \"%s\".\n",
+                     g_settings.audio.dsp_plugin);
+
+#ifdef HAVE_THREADS
+            audio_dsp_thread_lock(g_extern.audio_data.dsp_thread);
+#endif
+            g_extern.audio_data.dsp = dsp;
+#ifdef HAVE_THREADS
+            audio_dsp_thread_unlock(g_extern.audio_data.dsp_thread);
+#endif
+         }
          break;
       case RARCH_CMD_GPU_RECORD_DEINIT:
          if (g_extern.record_gpu_buffer)
@@ -18,10 +18,19 @@
 #define __STDC_LIMIT_MACROS
 #include "rewind.h"
 #include "performance.h"
+#include "retroarch_logger.h"
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#ifdef HAVE_ZLIB_DEFLATE
+#include <zlib.h>
+#endif
+
 #ifndef UINT16_MAX
 #define UINT16_MAX 0xffff
 #endif
@@ -42,7 +51,17 @@
 /* Format per frame (pseudocode): */
 #if 0
 size nextstart;
-repeat {
+uint16 type; /* REWIND_FRAME_DELTA or REWIND_FRAME_KEYFRAME */
+if (type & REWIND_FRAME_DEFLATE)
+{
+   uint32 deflatesize;
+   uint8[deflatesize] deflated; /* everything below, padded to uint16 */
+}
+else if (type == REWIND_FRAME_KEYFRAME)
+{
+   uint16[blocksize / 2] olddata; /* the entire previous state */
+}
+else repeat {
    uint16 numchanged; /* everything is counted in units of uint16 */
    if (numchanged)
    {
@@ -77,7 +96,36 @@ size thisstart;
  * the tail retreats until it can no longer collide.
  *
  * This means that on average, ~2 * maxcompsize is 
- * unused at any given moment. */
+ * unused at any given moment.
+ *
+ * When the state manager is created with threads, the delta is
+ * generated on a worker thread while the core serializes the next
+ * state into a third block. With more than one thread, the state is
+ * additionally split into chunks which are encoded in parallel; every
+ * chunk but the last ends with an explicit numunchanged entry covering
+ * its unchanged tail, so the concatenated chunks are a valid frame in
+ * the format above and pop does not need to know about them.
+ *
+ * With a keyframe interval, every Nth frame stores the previous
+ * state verbatim instead of a delta. The keyframes are indexed,
+ * so state_manager_seek can restore any state by copying one
+ * keyframe and applying less than N deltas on top of it.
+ *
+ * With compression, each frame is additionally deflated after it's
+ * encoded, on the worker thread if there is one. Frames that don't
+ * get any smaller are stored as is. */
+
+/* Started and stopped on whichever thread encodes, but registered
+ * on the main thread by state_manager_new, as the counter list
+ * isn't thread safe. */
+static struct retro_perf_counter gen_deltas = {"gen_deltas"};
+
+enum
+{
+   REWIND_FRAME_DELTA    = 0,
+   REWIND_FRAME_KEYFRAME = 1,
+   REWIND_FRAME_DEFLATE  = 1 << 8
+};
 
 
 /* These are called very few constant times per frame, 
@@ -95,6 +143,34 @@ static inline size_t read_size_t(const void *ptr)
    return ret;
 }
 
+#ifdef HAVE_THREADS
+/* Don't bother splitting states smaller than this. */
+#define REWIND_MIN_CHUNK_SIZE (64 * 1024)
+
+struct state_manager_chunk
+{
+   state_manager_t *state;
+   sthread_t *thread;
+
+   /* Offset and length of this chunk, in uint16 units. */
+   size_t offset;
+   size_t num16s;
+
+   /* Scratch output, appended to the frame once every chunk is done.
+    * Chunk 0 is encoded by the push thread directly into the buffer. */
+   uint16_t *out;
+   uint16_t *out_end;
+};
+#endif
+
+struct state_manager_keyframe
+{
+   /* Offset of the frame's nextstart. */
+   size_t pos;
+   /* Sequence number of the state stored in it. */
+   uint64_t seq;
+};
+
 struct state_manager
 {
    uint8_t *data;
@@ -117,162 +193,68 @@ struct state_manager
 
    unsigned entries;
    bool thisblock_valid;
-};
-
-state_manager_t *state_manager_new(size_t state_size, size_t buffer_size)
-{
-   size_t newblocksize;
-   int maxcblks;
-   const int maxcblkcover = UINT16_MAX * sizeof(uint16_t);
-   state_manager_t *state = (state_manager_t*)calloc(1, sizeof(*state));
-
-   if (!state)
-      return NULL;
-
-   newblocksize = ((state_size - 1) | (sizeof(uint16_t) - 1)) + 1;
-   state->blocksize = newblocksize;
-
-   maxcblks = (state->blocksize + maxcblkcover - 1) / maxcblkcover;
-   state->maxcompsize = state->blocksize + maxcblks * sizeof(uint16_t) * 2 +
-      sizeof(uint16_t) + sizeof(uint32_t) + sizeof(size_t) * 2;
-
-   state->data = (uint8_t*)malloc(buffer_size);
-
-   state->thisblock = (uint8_t*)
-      calloc(state->blocksize + sizeof(uint16_t) * 4 + 16, 1);
-   state->nextblock = (uint8_t*)
-      calloc(state->blocksize + sizeof(uint16_t) * 4 + 16, 1);
-   if (!state->data || !state->thisblock || !state->nextblock)
-      goto error;
-
-   /* Force in a different byte at the end, so we don't need to check 
-    * bounds in the innermost loop (it's expensive).
-    *
-    * There is also a large amount of data that's the same, to stop 
-    * the other scan.
-    *
-    * There is also some padding at the end. This is so we don't 
-    * read outside the buffer end if we're reading in large blocks;
-    *
-    * It doesn't make any difference to us, but sacrificing 16 bytes to get 
-    * Valgrind happy is worth it. */
-   *(uint16_t*)(state->thisblock + state->blocksize + sizeof(uint16_t) * 3) =
-      0xFFFF;
-   *(uint16_t*)(state->nextblock + state->blocksize + sizeof(uint16_t) * 3) =
-      0x0000;
-
-   state->capacity = buffer_size;
-
-   state->head = state->data + sizeof(size_t);
-   state->tail = state->data + sizeof(size_t);
-
-   return state;
-
-error:
-   state_manager_free(state);
-   return NULL;
-}
-
-void state_manager_free(state_manager_t *state)
-{
-   if (!state)
-      return;
-
-   free(state->data);
-   free(state->thisblock);
-   free(state->nextblock);
-   free(state);
-}
-
-bool state_manager_pop(state_manager_t *state, const void **data)
-{
-   size_t start;
-   uint8_t *out;
-   uint16_t *out16;
-   const uint8_t *compressed = NULL;
-   const uint16_t *compressed16 = NULL;
-
-   *data = NULL;
-
-   if (state->thisblock_valid)
-   {
-      state->thisblock_valid = false;
-      state->entries--;
-      *data = state->thisblock;
-      return true;
-   }
-
-   if (state->head == state->tail)
-      return false;
-
-   start = read_size_t(state->head - sizeof(size_t));
-   state->head = state->data + start;
-
-   compressed = state->data + start + sizeof(size_t);
-   out = state->thisblock;
-
-   /* Begin decompression code
-    * out is the last pushed (or returned) state */
-   compressed16 = (const uint16_t*)compressed;
-   out16 = (uint16_t*)out;
-
-   for (;;)
-   {
-      uint16_t i;
-      uint16_t numchanged = *(compressed16++);
 
-      if (numchanged)
-      {
-         out16 += *compressed16++;
+   /* Encode with the AVX2 scanners. */
+   bool avx2;
 
-         /* We could do memcpy, but it seems that memcpy has a 
-          * constant-per-call overhead that actually shows up.
-          *
-          * Our average size in here seems to be 8 or something.
-          * Therefore, we do something with lower overhead. */
-         for (i = 0; i < numchanged; i++)
-            out16[i] = compressed16[i];
+   /* Sequence number of the state in thisblock. */
+   uint64_t thisblock_seq;
 
-         compressed16 += numchanged;
-         out16 += numchanged;
-      }
-      else
-      {
-         uint32_t numunchanged = compressed16[0] | (compressed16[1] << 16);
+   /* Bytes of state pushed, after delta encoding, and as stored. */
+   uint64_t stat_raw;
+   uint64_t stat_delta;
+   uint64_t stat_stored;
 
-         if (!numunchanged)
-            break;
-         compressed16 += 2;
-         out16 += numunchanged;
-      }
-   }
-   /* End decompression code */
+#ifdef HAVE_ZLIB_DEFLATE
+   bool compress;
+   /* Encoder output on push, inflate output on pop. */
+   uint8_t *scratch;
+#endif
 
-   state->entries--;
-   *data = state->thisblock;
-   return true;
-}
+   /* Keyframe index, oldest first. */
+   struct state_manager_keyframe *keyframes;
+   unsigned keyframe_interval;
+   unsigned keyframe_first;
+   unsigned keyframe_count;
+   unsigned keyframe_capacity;
+
+#ifdef HAVE_THREADS
+   /* Written by the core while the worker encodes
+    * job_new against job_old. */
+   uint8_t *spareblock;
+   const uint8_t *job_old;
+   const uint8_t *job_new;
+   uint64_t job_seq;
+
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   bool busy;
+   bool quit;
+
+   struct state_manager_chunk *chunks;
+   unsigned num_chunks;
+   unsigned chunks_pending;
+   unsigned chunk_generation;
+   scond_t *chunk_cond;
+   scond_t *chunk_done_cond;
+#endif
+};
 
-void state_manager_push_where(state_manager_t *state, void **data)
-{
-   /* We need to ensure we have an uncompressed copy of the last
-    * pushed state, or we could end up applying a 'patch' to wrong 
-    * savestate, and that'd blow up rather quickly. */
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-   if (!state->thisblock_valid) 
-   {
-      const void *ignored;
-      if (state_manager_pop(state, &ignored))
-      {
-         state->thisblock_valid = true;
-         state->entries++;
-      }
-   }
-   
-   *data = state->nextblock;
-}
+/* The AVX2 scanners are built with a function-level target,
+ * so they can be picked at runtime like in a distributed build. */
+#if defined(__SSE2__) && (defined(__clang__) || \
+      (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#include <immintrin.h>
+#define REWIND_HAVE_AVX2
+#define REWIND_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
 
-#if __SSE2__
+#if defined(__SSE2__)
 #if defined(__GNUC__)
 static inline int compat_ctz(unsigned x)
 {
@@ -285,28 +267,32 @@ static inline int compat_ctz(unsigned x)
 
 static inline int compat_ctz(unsigned x)
 {
-   if (x & 0x000f)
-      return 0;
-   if (x & 0x00f0)
-      return 4;
-   if (x & 0x0f00)
-      return 8;
-   if (x & 0xf000)
-      return 12;
-   return 16;
+   int i;
+
+   for (i = 0; i < 32; i += 4)
+      if (x & (0xfu << i))
+         return i;
+   return 32;
 }
 #endif
+#endif
 
-#include <emmintrin.h>
 /* There's no equivalent in libc, you'd think so ...
- * std::mismatch exists, but it's not optimized at all. */
+ * std::mismatch exists, but it's not optimized at all.
+ *
+ * Both scanners stop once they have looked at max uint16s;
+ * the return value may then be anything >= max. The blocks
+ * are padded so that reading a vector past max is harmless. */
 
-static inline size_t find_change(const uint16_t *a, const uint16_t *b)
+#if __SSE2__
+static inline size_t find_change(const uint16_t *a, const uint16_t *b,
+      size_t max)
 {
    const __m128i *a128 = (const __m128i*)a;
    const __m128i *b128 = (const __m128i*)b;
+   const __m128i *end  = (const __m128i*)(a + max);
 	
-   for (;;)
+   while (a128 < end)
    {
       __m128i v0    = _mm_loadu_si128(a128);
       __m128i v1    = _mm_loadu_si128(b128);
@@ -323,24 +309,28 @@ static inline size_t find_change(const uint16_t *a, const uint16_t *b)
       a128++;
       b128++;
    }
+
+   return max;
 }
 #else
-static inline size_t find_change(const uint16_t *a, const uint16_t *b)
+static inline size_t find_change(const uint16_t *a, const uint16_t *b,
+      size_t max)
 {
    const uint16_t *a_org = a;
+   const uint16_t *a_end = a + max;
 #ifdef NO_UNALIGNED_MEM
-   while (((uintptr_t)a & (sizeof(size_t) - 1)) && *a == *b)
+   while (a < a_end && ((uintptr_t)a & (sizeof(size_t) - 1)) && *a == *b)
    {
       a++;
       b++;
    }
-   if (*a == *b)
+   if (a < a_end && *a == *b)
 #endif
    {
       const size_t *a_big = (const size_t*)a;
       const size_t *b_big = (const size_t*)b;
 		
-      while (*a_big == *b_big)
+      while ((const uint16_t*)a_big < a_end && *a_big == *b_big)
       {
          a_big++;
          b_big++;
@@ -348,7 +338,7 @@ static inline size_t find_change(const uint16_t *a, const uint16_t *b)
       a = (const uint16_t*)a_big;
       b = (const uint16_t*)b_big;
 		
-      while (*a == *b)
+      while (a < a_end && *a == *b)
       {
          a++;
          b++;
@@ -358,9 +348,11 @@ static inline size_t find_change(const uint16_t *a, const uint16_t *b)
 }
 #endif
 
-static inline size_t find_same(const uint16_t *a, const uint16_t *b)
+static inline size_t find_same(const uint16_t *a, const uint16_t *b,
+      size_t max)
 {
    const uint16_t *a_org = a;
+   const uint16_t *a_end = a + max;
 #ifdef NO_UNALIGNED_MEM
    if (((uintptr_t)a & (sizeof(uint32_t) - 1)) && *a != *b)
    {
@@ -381,7 +373,7 @@ static inline size_t find_same(const uint16_t *a, const uint16_t *b)
       const uint32_t *a_big = (const uint32_t*)a;
       const uint32_t *b_big = (const uint32_t*)b;
 		
-      while (*a_big != *b_big)
+      while ((const uint16_t*)a_big < a_end && *a_big != *b_big)
       {
          a_big++;
          b_big++;
@@ -398,121 +390,1093 @@ static inline size_t find_same(const uint16_t *a, const uint16_t *b)
    return a - a_org;
 }
 
-void state_manager_push_do(state_manager_t *state)
+#ifdef REWIND_HAVE_AVX2
+static inline REWIND_TARGET_AVX2 size_t find_change_avx2(
+      const uint16_t *a, const uint16_t *b, size_t max)
 {
-   if (state->thisblock_valid)
-   {
-      if (state->capacity < sizeof(size_t) + state->maxcompsize)
-         return;
-
-recheckcapacity:;
+   const __m256i *a256 = (const __m256i*)a;
+   const __m256i *b256 = (const __m256i*)b;
+   const __m256i *end  = (const __m256i*)(a + max);
 
-      size_t headpos = state->head - state->data;
-      size_t tailpos = state->tail - state->data;
-      size_t remaining = (tailpos + state->capacity -
-            sizeof(size_t) - headpos - 1) % state->capacity + 1;
+   while (a256 < end)
+   {
+      __m256i v0    = _mm256_loadu_si256(a256);
+      __m256i v1    = _mm256_loadu_si256(b256);
+      __m256i c     = _mm256_cmpeq_epi32(v0, v1);
+      uint32_t mask = _mm256_movemask_epi8(c);
 
-      if (remaining <= state->maxcompsize)
+      if (mask != 0xffffffffu) /* Something has changed, figure out where. */
       {
-         state->tail = state->data + read_size_t(state->tail);
-         state->entries--;
-         goto recheckcapacity;
+         size_t ret = (((uint8_t*)a256 - (uint8_t*)a) |
+               (compat_ctz(~mask))) >> 1;
+         return ret | (a[ret] == b[ret]);
       }
 
-      RARCH_PERFORMANCE_INIT(gen_deltas);
-      RARCH_PERFORMANCE_START(gen_deltas);
+      a256++;
+      b256++;
+   }
 
-      const uint8_t *oldb = state->thisblock;
-      const uint8_t *newb = state->nextblock;
-      uint8_t *compressed = state->head + sizeof(size_t);
+   return max;
+}
 
-      /* Begin compression code; 'compressed' will point to 
-       * the end of the compressed data (excluding the prev pointer). */
-      const uint16_t *old16 = (const uint16_t*)oldb;
-      const uint16_t *new16 = (const uint16_t*)newb;
-      uint16_t *compressed16 = (uint16_t*)compressed;
-      size_t num16s = state->blocksize / sizeof(uint16_t);
+static inline REWIND_TARGET_AVX2 size_t find_same_avx2(
+      const uint16_t *a, const uint16_t *b, size_t max)
+{
+   const __m256i *a256 = (const __m256i*)a;
+   const __m256i *b256 = (const __m256i*)b;
+   const __m256i *end  = (const __m256i*)(a + max);
 
-      while (num16s)
+   while (a256 < end)
+   {
+      __m256i v0    = _mm256_loadu_si256(a256);
+      __m256i v1    = _mm256_loadu_si256(b256);
+      __m256i c     = _mm256_cmpeq_epi32(v0, v1);
+      uint32_t mask = _mm256_movemask_epi8(c);
+
+      /* Same rules as the scalar version: the first identical
+       * uint32, extended back by one uint16 if that matches too. */
+      if (mask)
       {
-         size_t i;
-         size_t skip = find_change(old16, new16);
+         size_t ret = (((uint8_t*)a256 - (uint8_t*)a) |
+               (compat_ctz(mask))) >> 1;
+         if (ret && a[ret - 1] == b[ret - 1])
+            ret--;
+         return ret;
+      }
 
-         if (skip >= num16s)
-            break;
+      a256++;
+      b256++;
+   }
+
+   return max;
+}
+#endif
+
+/**
+ * state_manager_encode_generic:
+ * @old16                : previous state.
+ * @new16                : current state.
+ * @num16s               : amount of uint16s to compare.
+ * @compressed16         : output buffer.
+ * @pad                  : cover unchanged data at the end explicitly.
+ * @avx2                 : use the AVX2 scanners.
+ *
+ * Encodes the changes between @new16 and @old16 (storing the old
+ * data, so that applying it to @new16 yields @old16) without the
+ * terminating entry.
+ *
+ * Returns: end of the encoded data.
+ **/
+static inline uint16_t *state_manager_encode_generic(const uint16_t *old16,
+      const uint16_t *new16, size_t num16s,
+      uint16_t *compressed16, bool pad, bool avx2)
+{
+   while (num16s)
+   {
+      size_t i, changed, skip;
 
-         old16 += skip;
-         new16 += skip;
-         num16s -= skip;
+#ifdef REWIND_HAVE_AVX2
+      if (avx2)
+         skip = find_change_avx2(old16, new16, num16s);
+      else
+#endif
+         skip = find_change(old16, new16, num16s);
 
-         if (skip > UINT16_MAX)
+      if (skip >= num16s)
+      {
+         if (pad)
          {
-            if (skip > UINT32_MAX)
-            {
-               /* This will make it scan the entire thing again, 
-                * but it only hits on 8GB unchanged data anyways,
-                * and if you're doing that, you've got bigger problems. */
-               skip = UINT32_MAX;
-            }
             *compressed16++ = 0;
-            *compressed16++ = skip;
-            *compressed16++ = skip >> 16;
-            skip = 0;
-            continue;
+            *compressed16++ = num16s;
+            *compressed16++ = num16s >> 16;
          }
+         break;
+      }
 
-         size_t changed = find_same(old16, new16);
-         if (changed > UINT16_MAX)
-            changed = UINT16_MAX;
+      old16 += skip;
+      new16 += skip;
+      num16s -= skip;
 
-         *compressed16++ = changed;
+      if (skip > UINT16_MAX)
+      {
+         if (skip > UINT32_MAX)
+         {
+            /* This will make it scan the entire thing again, 
+             * but it only hits on 8GB unchanged data anyways,
+             * and if you're doing that, you've got bigger problems. */
+            skip = UINT32_MAX;
+         }
+         *compressed16++ = 0;
          *compressed16++ = skip;
+         *compressed16++ = skip >> 16;
+         skip = 0;
+         continue;
+      }
 
-         for (i = 0; i < changed; i++)
-            compressed16[i] = old16[i];
+#ifdef REWIND_HAVE_AVX2
+      if (avx2)
+         changed = find_same_avx2(old16, new16, num16s);
+      else
+#endif
+         changed = find_same(old16, new16, num16s);
+      if (changed > num16s)
+         changed = num16s;
+      if (changed > UINT16_MAX)
+         changed = UINT16_MAX;
+
+      *compressed16++ = changed;
+      *compressed16++ = skip;
+
+      for (i = 0; i < changed; i++)
+         compressed16[i] = old16[i];
+
+      old16 += changed;
+      new16 += changed;
+      num16s -= changed;
+      compressed16 += changed;
+   }
 
-         old16 += changed;
-         new16 += changed;
-         num16s -= changed;
-         compressed16 += changed;
-      }
+   return compressed16;
+}
 
-      compressed16[0] = 0;
-      compressed16[1] = 0;
-      compressed16[2] = 0;
-      compressed = (uint8_t*)(compressed16 + 3);
-      /* End compression code. */
+#ifdef REWIND_HAVE_AVX2
+static REWIND_TARGET_AVX2 uint16_t *state_manager_encode_avx2(
+      const uint16_t *old16, const uint16_t *new16, size_t num16s,
+      uint16_t *compressed16, bool pad)
+{
+   return state_manager_encode_generic(old16, new16, num16s,
+         compressed16, pad, true);
+}
+#endif
+
+/**
+ * state_manager_encode:
+ * @state                : state manager.
+ * @old16                : previous state.
+ * @new16                : current state.
+ * @num16s               : amount of uint16s to compare.
+ * @compressed16         : output buffer.
+ * @pad                  : cover unchanged data at the end explicitly.
+ *
+ * Encodes with the fastest scanners the CPU supports,
+ * see state_manager_encode_generic.
+ *
+ * Returns: end of the encoded data.
+ **/
+static uint16_t *state_manager_encode(const state_manager_t *state,
+      const uint16_t *old16, const uint16_t *new16, size_t num16s,
+      uint16_t *compressed16, bool pad)
+{
+#ifdef REWIND_HAVE_AVX2
+   if (state->avx2)
+      return state_manager_encode_avx2(old16, new16, num16s,
+            compressed16, pad);
+#endif
+   return state_manager_encode_generic(old16, new16, num16s,
+         compressed16, pad, false);
+}
+
+#ifdef HAVE_THREADS
+/**
+ * state_manager_chunk_thread:
+ * @data                 : pointer to state_manager_chunk.
+ *
+ * Encodes one chunk of the current job each time
+ * state_manager::chunk_generation changes.
+ **/
+static void state_manager_chunk_thread(void *data)
+{
+   struct state_manager_chunk *chunk = (struct state_manager_chunk*)data;
+   state_manager_t *state = chunk->state;
+   unsigned generation    = 0;
+
+   for (;;)
+   {
+      slock_lock(state->lock);
+      while (!state->quit && state->chunk_generation == generation)
+         scond_wait(state->chunk_cond, state->lock);
 
-      if (compressed - state->data + state->maxcompsize > state->capacity)
+      /* A job that was started before quitting still has to be
+       * finished, the push worker is waiting for it. */
+      if (state->chunk_generation == generation)
       {
-         compressed = state->data;
-         if (state->tail == state->data + sizeof(size_t))
-            state->tail = state->data + read_size_t(state->tail);
+         slock_unlock(state->lock);
+         break;
       }
-      write_size_t(compressed, state->head-state->data);
-      compressed += sizeof(size_t);
-      write_size_t(state->head, compressed-state->data);
-      state->head = compressed;
-
-      RARCH_PERFORMANCE_STOP(gen_deltas);
+      generation = state->chunk_generation;
+      slock_unlock(state->lock);
+
+      chunk->out_end = state_manager_encode(state,
+            (const uint16_t*)state->job_old + chunk->offset,
+            (const uint16_t*)state->job_new + chunk->offset,
+            chunk->num16s, chunk->out,
+            chunk != &state->chunks[state->num_chunks - 1]);
+
+      slock_lock(state->lock);
+      if (--state->chunks_pending == 0)
+         scond_signal(state->chunk_done_cond);
+      slock_unlock(state->lock);
    }
-   else
-      state->thisblock_valid = true;
+}
 
-   uint8_t *swap = state->thisblock;
-   state->thisblock = state->nextblock;
-   state->nextblock = swap;
+/**
+ * state_manager_encode_chunks:
+ * @state                : state manager.
+ * @compressed16         : output buffer.
+ *
+ * Encodes the current job with all chunk threads.
+ *
+ * Returns: end of the encoded data.
+ **/
+static uint16_t *state_manager_encode_chunks(state_manager_t *state,
+      uint16_t *compressed16)
+{
+   unsigned i;
 
-   state->entries++;
-   return;
+   slock_lock(state->lock);
+   state->chunks_pending = state->num_chunks - 1;
+   state->chunk_generation++;
+   scond_broadcast(state->chunk_cond);
+   slock_unlock(state->lock);
+
+   compressed16 = state_manager_encode(state,
+         (const uint16_t*)state->job_old,
+         (const uint16_t*)state->job_new,
+         state->chunks[0].num16s, compressed16, true);
+
+   slock_lock(state->lock);
+   while (state->chunks_pending)
+      scond_wait(state->chunk_done_cond, state->lock);
+   slock_unlock(state->lock);
+
+   for (i = 1; i < state->num_chunks; i++)
+   {
+      size_t len = state->chunks[i].out_end - state->chunks[i].out;
+
+      memcpy(compressed16, state->chunks[i].out, len * sizeof(uint16_t));
+      compressed16 += len;
+   }
+
+   return compressed16;
 }
+#endif
 
-void state_manager_capacity(state_manager_t *state,
-      unsigned *entries, size_t *bytes, bool *full)
+/**
+ * state_manager_drop_tail:
+ * @state                : state manager.
+ *
+ * Discards the oldest frame, and its keyframe index entry if any.
+ **/
+static void state_manager_drop_tail(state_manager_t *state)
 {
-   size_t headpos   = state->head - state->data;
-   size_t tailpos   = state->tail - state->data;
-   size_t remaining = (tailpos + state->capacity -
+   size_t tailpos = state->tail - state->data;
+
+   if (state->keyframe_count &&
+         state->keyframes[state->keyframe_first].pos == tailpos)
+   {
+      state->keyframe_first = (state->keyframe_first + 1) %
+         state->keyframe_capacity;
+      state->keyframe_count--;
+   }
+
+   state->tail = state->data + read_size_t(state->tail);
+   state->entries--;
+}
+
+/**
+ * state_manager_push_delta:
+ * @state                : state manager.
+ * @oldb                 : previously pushed state.
+ * @newb                 : state being pushed.
+ * @old_seq              : sequence number of @oldb.
+ *
+ * Makes room in the buffer and writes the delta between
+ * @newb and @oldb at the head, or @oldb itself if it is due
+ * to become a keyframe.
+ **/
+static void state_manager_push_delta(state_manager_t *state,
+      const uint8_t *oldb, const uint8_t *newb, uint64_t old_seq)
+{
+   bool keyframe = state->keyframe_interval &&
+      (old_seq % state->keyframe_interval) == 0;
+   uint16_t type;
+   size_t rawsize;
+   const void *raw;
+   uint8_t *compressed;
+   uint16_t *compressed16, *out16, *end;
+   size_t headpos, tailpos, remaining;
+
+   for (;;)
+   {
+      headpos   = state->head - state->data;
+      tailpos   = state->tail - state->data;
+      remaining = (tailpos + state->capacity -
+            sizeof(size_t) - headpos - 1) % state->capacity + 1;
+
+      if (remaining > state->maxcompsize)
+         break;
+
+      state_manager_drop_tail(state);
+   }
+
+   RARCH_PERFORMANCE_START(gen_deltas);
+
+   compressed   = state->head + sizeof(size_t);
+   compressed16 = (uint16_t*)compressed;
+   out16        = compressed16 + 1;
+
+#ifdef HAVE_ZLIB_DEFLATE
+   if (state->compress)
+      out16 = (uint16_t*)state->scratch;
+#endif
+
+   if (keyframe)
+   {
+      type = REWIND_FRAME_KEYFRAME;
+      raw  = oldb;
+      end  = out16 + state->blocksize / sizeof(uint16_t);
+#ifdef HAVE_ZLIB_DEFLATE
+      /* Deflate straight from the block. */
+      if (!state->compress)
+#endif
+         memcpy(out16, oldb, state->blocksize);
+   }
+   else
+   {
+      type = REWIND_FRAME_DELTA;
+      raw  = out16;
+
+      /* Begin compression code; 'end' will point to 
+       * the end of the compressed data (excluding the prev pointer). */
+#ifdef HAVE_THREADS
+      if (state->num_chunks > 1)
+         end = state_manager_encode_chunks(state, out16);
+      else
+#endif
+         end = state_manager_encode(state, (const uint16_t*)oldb,
+               (const uint16_t*)newb, state->blocksize / sizeof(uint16_t),
+               out16, false);
+
+      end[0] = 0;
+      end[1] = 0;
+      end[2] = 0;
+      end   += 3;
+      /* End compression code. */
+   }
+
+   rawsize = (end - out16) * sizeof(uint16_t);
+   end     = compressed16 + 1 + (end - out16);
+
+#ifdef HAVE_ZLIB_DEFLATE
+   if (state->compress)
+   {
+      /* Only keep the deflated data if it's smaller. */
+      uLongf zsize = rawsize;
+
+      if (compress2((Bytef*)(compressed16 + 3), &zsize,
+               (const Bytef*)raw, rawsize, Z_BEST_SPEED) == Z_OK)
+      {
+         type           |= REWIND_FRAME_DEFLATE;
+         compressed16[1] = zsize;
+         compressed16[2] = zsize >> 16;
+         end             = compressed16 + 3 +
+            (zsize + sizeof(uint16_t) - 1) / sizeof(uint16_t);
+      }
+      else
+         memcpy(compressed16 + 1, raw, rawsize);
+   }
+#endif
+
+   compressed16[0] = type;
+   compressed      = (uint8_t*)end;
+
+   state->stat_raw    += state->blocksize;
+   state->stat_delta  += rawsize;
+   state->stat_stored += compressed - state->head;
+
+   if (keyframe)
+   {
+      struct state_manager_keyframe *key;
+
+      /* Shouldn't happen with the index sized as it is, but the
+       * newest keyframes are the ones worth keeping. */
+      if (state->keyframe_count == state->keyframe_capacity)
+      {
+         state->keyframe_first = (state->keyframe_first + 1) %
+            state->keyframe_capacity;
+         state->keyframe_count--;
+      }
+
+      key = &state->keyframes[
+         (state->keyframe_first + state->keyframe_count++) %
+         state->keyframe_capacity];
+
+      key->pos = state->head - state->data;
+      key->seq = old_seq;
+   }
+
+   if (compressed - state->data + state->maxcompsize > state->capacity)
+   {
+      compressed = state->data;
+      if (state->tail == state->data + sizeof(size_t))
+         state_manager_drop_tail(state);
+   }
+   write_size_t(compressed, state->head-state->data);
+   compressed += sizeof(size_t);
+   write_size_t(state->head, compressed-state->data);
+   state->head = compressed;
+
+   RARCH_PERFORMANCE_STOP(gen_deltas);
+}
+
+#ifdef HAVE_THREADS
+/**
+ * state_manager_thread:
+ * @data                 : pointer to state manager.
+ *
+ * Callback function for threaded delta generation.
+ **/
+static void state_manager_thread(void *data)
+{
+   state_manager_t *state = (state_manager_t*)data;
+
+   slock_lock(state->lock);
+
+   for (;;)
+   {
+      while (!state->busy && !state->quit)
+         scond_wait(state->cond, state->lock);
+
+      if (state->quit)
+         break;
+
+      slock_unlock(state->lock);
+      state_manager_push_delta(state, state->job_old, state->job_new,
+            state->job_seq);
+      slock_lock(state->lock);
+
+      state->busy = false;
+      scond_signal(state->cond);
+   }
+
+   slock_unlock(state->lock);
+}
+
+static bool state_manager_init_threads(state_manager_t *state,
+      unsigned threads)
+{
+   unsigned i;
+   size_t num16s     = state->blocksize / sizeof(uint16_t);
+   size_t chunk16s   = 0;
+   unsigned max_chunks = state->blocksize / REWIND_MIN_CHUNK_SIZE;
+
+   state->spareblock = (uint8_t*)
+      calloc(state->blocksize + sizeof(uint16_t) * 4 + 32, 1);
+   state->lock            = slock_new();
+   state->cond            = scond_new();
+   state->chunk_cond      = scond_new();
+   state->chunk_done_cond = scond_new();
+
+   if (!state->spareblock || !state->lock || !state->cond
+         || !state->chunk_cond || !state->chunk_done_cond)
+      return false;
+
+   *(uint16_t*)(state->spareblock + state->blocksize + sizeof(uint16_t) * 3) =
+      0x5555;
+
+   state->num_chunks = threads;
+   if (state->num_chunks > max_chunks)
+      state->num_chunks = max_chunks;
+   if (state->num_chunks < 1)
+      state->num_chunks = 1;
+
+   if (state->num_chunks > 1)
+   {
+      const int maxcblkcover = UINT16_MAX * sizeof(uint16_t);
+
+      /* Keep chunk boundaries on cache lines. */
+      chunk16s = (num16s / state->num_chunks) & ~(size_t)31;
+
+      state->chunks = (struct state_manager_chunk*)
+         calloc(state->num_chunks, sizeof(*state->chunks));
+      if (!state->chunks)
+         return false;
+
+      for (i = 0; i < state->num_chunks; i++)
+      {
+         struct state_manager_chunk *chunk = &state->chunks[i];
+         size_t chunksize;
+
+         chunk->state  = state;
+         chunk->offset = i * chunk16s;
+         chunk->num16s = (i == state->num_chunks - 1) ?
+            num16s - chunk->offset : chunk16s;
+
+         /* Every chunk can add a numunchanged entry for its tail. */
+         state->maxcompsize += sizeof(uint16_t) * 3;
+
+         if (i == 0)
+            continue;
+
+         chunksize  = chunk->num16s * sizeof(uint16_t);
+         chunk->out = (uint16_t*)malloc(chunksize +
+               ((chunksize + maxcblkcover - 1) / maxcblkcover + 1) *
+               sizeof(uint16_t) * 2 + sizeof(uint16_t) * 3);
+         if (!chunk->out)
+            return false;
+
+         chunk->thread = sthread_create(state_manager_chunk_thread, chunk);
+         if (!chunk->thread)
+            return false;
+      }
+   }
+
+   state->thread = sthread_create(state_manager_thread, state);
+   return state->thread != NULL;
+}
+
+static void state_manager_deinit_threads(state_manager_t *state)
+{
+   unsigned i;
+
+   if (state->lock)
+   {
+      slock_lock(state->lock);
+      state->quit = true;
+      scond_broadcast(state->cond);
+      scond_broadcast(state->chunk_cond);
+      slock_unlock(state->lock);
+   }
+
+   if (state->thread)
+      sthread_join(state->thread);
+
+   if (state->chunks)
+   {
+      for (i = 0; i < state->num_chunks; i++)
+      {
+         if (state->chunks[i].thread)
+            sthread_join(state->chunks[i].thread);
+         free(state->chunks[i].out);
+      }
+   }
+
+   if (state->chunk_done_cond)
+      scond_free(state->chunk_done_cond);
+   if (state->chunk_cond)
+      scond_free(state->chunk_cond);
+   if (state->cond)
+      scond_free(state->cond);
+   if (state->lock)
+      slock_free(state->lock);
+
+   free(state->chunks);
+   free(state->spareblock);
+}
+#endif
+
+/**
+ * state_manager_sync:
+ * @state                : state manager.
+ *
+ * Waits until the worker thread has finished the last push.
+ **/
+static void state_manager_sync(state_manager_t *state)
+{
+#ifdef HAVE_THREADS
+   if (!state->thread)
+      return;
+
+   RARCH_PERFORMANCE_INIT(rewind_wait);
+   RARCH_PERFORMANCE_START(rewind_wait);
+
+   slock_lock(state->lock);
+   while (state->busy)
+      scond_wait(state->cond, state->lock);
+   slock_unlock(state->lock);
+
+   RARCH_PERFORMANCE_STOP(rewind_wait);
+#endif
+}
+
+state_manager_t *state_manager_new(size_t state_size, size_t buffer_size,
+      unsigned threads, unsigned keyframe_interval, bool compress)
+{
+   size_t newblocksize;
+   int maxcblks;
+   const int maxcblkcover = UINT16_MAX * sizeof(uint16_t);
+   state_manager_t *state = (state_manager_t*)calloc(1, sizeof(*state));
+
+   if (!state)
+      return NULL;
+
+   newblocksize = ((state_size - 1) | (sizeof(uint16_t) - 1)) + 1;
+   state->blocksize = newblocksize;
+
+#ifdef REWIND_HAVE_AVX2
+   state->avx2 = (rarch_get_cpu_features() & RETRO_SIMD_AVX2) != 0;
+#endif
+
+   if (!gen_deltas.registered)
+      rarch_perf_register(&gen_deltas);
+
+   maxcblks = (state->blocksize + maxcblkcover - 1) / maxcblkcover;
+   state->maxcompsize = state->blocksize + maxcblks * sizeof(uint16_t) * 2 +
+      sizeof(uint16_t) * 2 + sizeof(uint32_t) * 2 + sizeof(size_t) * 2;
+
+   state->data = (uint8_t*)malloc(buffer_size);
+
+   state->thisblock = (uint8_t*)
+      calloc(state->blocksize + sizeof(uint16_t) * 4 + 32, 1);
+   state->nextblock = (uint8_t*)
+      calloc(state->blocksize + sizeof(uint16_t) * 4 + 32, 1);
+   if (!state->data || !state->thisblock || !state->nextblock)
+      goto error;
+
+   if (keyframe_interval)
+   {
+      /* Keyframes are closest together when every delta in between
+       * is empty and, with compression, the keyframe deflates as far
+       * as zlib goes (1032:1). Size the index for that, so it
+       * covers the whole buffer. */
+      size_t min_delta = sizeof(size_t) + sizeof(uint16_t) * 4;
+      size_t min_key   = sizeof(size_t) + sizeof(uint16_t) +
+         state->blocksize;
+#ifdef HAVE_ZLIB_DEFLATE
+      if (compress)
+         min_key = sizeof(size_t) + sizeof(uint16_t) * 3 +
+            state->blocksize / 1032;
+#endif
+
+      state->keyframe_interval = keyframe_interval;
+      state->keyframe_capacity = buffer_size /
+         (min_key + (keyframe_interval - 1) * min_delta) + 1;
+      state->keyframes = (struct state_manager_keyframe*)
+         calloc(state->keyframe_capacity, sizeof(*state->keyframes));
+      if (!state->keyframes)
+         goto error;
+   }
+
+   /* Force in a different byte at the end, so we don't need to check 
+    * bounds in the innermost loop (it's expensive).
+    *
+    * There is also a large amount of data that's the same, to stop 
+    * the other scan.
+    *
+    * There is also some padding at the end. This is so we don't 
+    * read outside the buffer end if we're reading in large blocks;
+    *
+    * It doesn't make any difference to us, but sacrificing 32 bytes to get 
+    * Valgrind happy is worth it. */
+   *(uint16_t*)(state->thisblock + state->blocksize + sizeof(uint16_t) * 3) =
+      0xFFFF;
+   *(uint16_t*)(state->nextblock + state->blocksize + sizeof(uint16_t) * 3) =
+      0x0000;
+
+#ifdef HAVE_THREADS
+   if (threads && !state_manager_init_threads(state, threads))
+      goto error;
+#endif
+
+#ifdef HAVE_ZLIB_DEFLATE
+   /* After the threads, chunks make maxcompsize larger. */
+   if (compress)
+   {
+      state->compress = true;
+      state->scratch  = (uint8_t*)malloc(state->maxcompsize);
+      if (!state->scratch)
+         goto error;
+   }
+#endif
+
+   state->capacity = buffer_size;
+
+   state->head = state->data + sizeof(size_t);
+   state->tail = state->data + sizeof(size_t);
+
+   return state;
+
+error:
+   state_manager_free(state);
+   return NULL;
+}
+
+void state_manager_free(state_manager_t *state)
+{
+   if (!state)
+      return;
+
+#ifdef HAVE_THREADS
+   /* Let the last push finish before the threads are told to quit. */
+   state_manager_sync(state);
+   state_manager_deinit_threads(state);
+#endif
+
+#ifdef HAVE_ZLIB_DEFLATE
+   free(state->scratch);
+#endif
+   free(state->keyframes);
+   free(state->data);
+   free(state->thisblock);
+   free(state->nextblock);
+   free(state);
+}
+
+/**
+ * state_manager_discard:
+ * @state                : state manager.
+ *
+ * Empties the buffer, after a frame in it turned out to be corrupt.
+ **/
+static void state_manager_discard(state_manager_t *state)
+{
+   state->head            = state->data + sizeof(size_t);
+   state->tail            = state->data + sizeof(size_t);
+   state->entries         = 0;
+   state->keyframe_count  = 0;
+   state->thisblock_valid = false;
+}
+
+/**
+ * state_manager_apply_frame:
+ * @state                : state manager.
+ * @start                : offset of the frame's nextstart.
+ *
+ * Applies a frame to thisblock.
+ *
+ * Returns: false if the frame is corrupt, thisblock is
+ * garbage then.
+ **/
+static bool state_manager_apply_frame(state_manager_t *state, size_t start)
+{
+   uint16_t type;
+   uint8_t *out;
+   uint16_t *out16;
+   const uint16_t *out_end;
+   const uint8_t *compressed = NULL;
+   const uint16_t *compressed16 = NULL;
+   const uint16_t *compressed_end = NULL;
+
+   compressed = state->data + start + sizeof(size_t);
+   out = state->thisblock;
+
+   compressed16   = (const uint16_t*)compressed;
+   compressed_end = (const uint16_t*)(state->data + state->capacity);
+   type = *compressed16++;
+
+#ifdef HAVE_ZLIB_DEFLATE
+   if (type & REWIND_FRAME_DEFLATE)
+   {
+      uint32_t zsize = compressed16[0] | (compressed16[1] << 16);
+      uLongf size    = state->maxcompsize;
+
+      type &= ~REWIND_FRAME_DEFLATE;
+
+      if (type == REWIND_FRAME_KEYFRAME)
+      {
+         size = state->blocksize;
+         return uncompress(out, &size, (const Bytef*)(compressed16 + 2),
+               zsize) == Z_OK && size == state->blocksize;
+      }
+
+      if (uncompress(state->scratch, &size,
+               (const Bytef*)(compressed16 + 2), zsize) != Z_OK)
+         return false;
+
+      compressed16   = (const uint16_t*)state->scratch;
+      compressed_end = compressed16 + size / sizeof(uint16_t);
+   }
+#endif
+
+   if (type == REWIND_FRAME_KEYFRAME)
+   {
+      memcpy(out, compressed16, state->blocksize);
+      return true;
+   }
+
+   /* Begin decompression code
+    * out is the last pushed (or returned) state */
+   out16   = (uint16_t*)out;
+   out_end = out16 + state->blocksize / sizeof(uint16_t);
+
+   for (;;)
+   {
+      uint16_t i;
+      uint16_t numchanged;
+
+      if (compressed_end - compressed16 < 3)
+         return false;
+
+      numchanged = *(compressed16++);
+
+      if (numchanged)
+      {
+         out16 += *compressed16++;
+
+         if (compressed_end - compressed16 < numchanged
+               || out_end - out16 < numchanged)
+            return false;
+
+         /* We could do memcpy, but it seems that memcpy has a 
+          * constant-per-call overhead that actually shows up.
+          *
+          * Our average size in here seems to be 8 or something.
+          * Therefore, we do something with lower overhead. */
+         for (i = 0; i < numchanged; i++)
+            out16[i] = compressed16[i];
+
+         compressed16 += numchanged;
+         out16 += numchanged;
+      }
+      else
+      {
+         uint32_t numunchanged = compressed16[0] | (compressed16[1] << 16);
+
+         if (!numunchanged)
+            break;
+         compressed16 += 2;
+         out16 += numunchanged;
+      }
+   }
+   /* End decompression code */
+
+   return true;
+}
+
+/**
+ * state_manager_pop_frame:
+ * @state                : state manager.
+ *
+ * Removes the newest frame from the buffer and applies it to
+ * thisblock. The buffer must not be empty.
+ *
+ * Returns: false if the frame is corrupt, the buffer is
+ * discarded then.
+ **/
+static bool state_manager_pop_frame(state_manager_t *state)
+{
+   size_t start = read_size_t(state->head - sizeof(size_t));
+   const uint16_t *type = (const uint16_t*)
+      (state->data + start + sizeof(size_t));
+
+   state->head = state->data + start;
+   state->entries--;
+   state->thisblock_seq--;
+
+   if ((*type & ~REWIND_FRAME_DEFLATE) == REWIND_FRAME_KEYFRAME
+         && state->keyframe_count && state->keyframes[
+            (state->keyframe_first + state->keyframe_count - 1) %
+            state->keyframe_capacity].pos == start)
+      state->keyframe_count--;
+
+   if (!state_manager_apply_frame(state, start))
+   {
+      RARCH_ERR("Rewind frame is corrupt, discarding the rewind buffer.\n");
+      state_manager_discard(state);
+      return false;
+   }
+
+   return true;
+}
+
+bool state_manager_pop(state_manager_t *state, const void **data)
+{
+   *data = NULL;
+
+   state_manager_sync(state);
+
+   if (state->thisblock_valid)
+   {
+      state->thisblock_valid = false;
+      state->entries--;
+      *data = state->thisblock;
+      return true;
+   }
+
+   if (state->head == state->tail)
+      return false;
+
+   if (!state_manager_pop_frame(state))
+      return false;
+
+   *data = state->thisblock;
+   return true;
+}
+
+bool state_manager_seek(state_manager_t *state, unsigned frames,
+      const void **data)
+{
+   unsigned i;
+   uint64_t target;
+   unsigned key_index = 0;
+   const struct state_manager_keyframe *key = NULL;
+
+   *data = NULL;
+
+   if (!frames)
+      return false;
+
+   state_manager_sync(state);
+
+   if (state->thisblock_valid)
+   {
+      state->thisblock_valid = false;
+      state->entries--;
+      *data = state->thisblock;
+      frames--;
+   }
+
+   /* Once thisblock is handed out, every remaining entry
+    * is one frame in the buffer. */
+   if (frames > state->entries)
+      frames = state->entries;
+
+   if (!frames)
+      return *data != NULL;
+
+   target = state->thisblock_seq - frames;
+
+   /* Find the oldest keyframe at or after the target, and drop 
+    * everything up to and including it in one go. */
+   for (i = state->keyframe_count; i-- > 0; )
+   {
+      const struct state_manager_keyframe *cur = &state->keyframes[
+         (state->keyframe_first + i) % state->keyframe_capacity];
+
+      if (cur->seq < target)
+         break;
+      key       = cur;
+      key_index = i;
+   }
+
+   *data = NULL;
+
+   if (key)
+   {
+      state->entries       -= state->thisblock_seq - key->seq;
+      state->thisblock_seq  = key->seq;
+      state->head           = state->data + key->pos;
+      state->keyframe_count = key_index;
+
+      if (!state_manager_apply_frame(state, key->pos))
+      {
+         RARCH_ERR("Rewind keyframe is corrupt, discarding the rewind buffer.\n");
+         state_manager_discard(state);
+         return false;
+      }
+   }
+
+   while (state->thisblock_seq > target && state->head != state->tail)
+   {
+      if (!state_manager_pop_frame(state))
+         return false;
+   }
+
+   *data = state->thisblock;
+   return true;
+}
+
+void state_manager_push_where(state_manager_t *state, void **data)
+{
+   /* We need to ensure we have an uncompressed copy of the last
+    * pushed state, or we could end up applying a 'patch' to wrong 
+    * savestate, and that'd blow up rather quickly. */
+
+   if (!state->thisblock_valid) 
+   {
+      const void *ignored;
+      if (state_manager_pop(state, &ignored))
+      {
+         state->thisblock_valid = true;
+         state->entries++;
+      }
+   }
+   
+   *data = state->nextblock;
+}
+
+void state_manager_push_do(state_manager_t *state)
+{
+   uint8_t *swap = NULL;
+
+   state_manager_sync(state);
+
+   if (state->thisblock_valid)
+   {
+      if (state->capacity < sizeof(size_t) + state->maxcompsize)
+         return;
+
+#ifdef HAVE_THREADS
+      if (state->thread)
+      {
+         /* The worker diffs the two blocks while the core
+          * serializes the next state into the spare one. */
+         state->job_old    = state->thisblock;
+         state->job_new    = state->nextblock;
+         state->job_seq    = state->thisblock_seq;
+
+         swap              = state->spareblock;
+         state->spareblock = state->thisblock;
+         state->thisblock  = state->nextblock;
+         state->nextblock  = swap;
+
+         state->thisblock_seq++;
+         state->entries++;
+
+         slock_lock(state->lock);
+         state->busy = true;
+         scond_signal(state->cond);
+         slock_unlock(state->lock);
+         return;
+      }
+#endif
+
+      state_manager_push_delta(state, state->thisblock, state->nextblock,
+            state->thisblock_seq);
+   }
+   else
+      state->thisblock_valid = true;
+
+   swap = state->thisblock;
+   state->thisblock = state->nextblock;
+   state->nextblock = swap;
+
+   state->thisblock_seq++;
+   state->entries++;
+}
+
+void state_manager_stats(state_manager_t *state,
+      uint64_t *raw, uint64_t *delta, uint64_t *stored)
+{
+   state_manager_sync(state);
+
+   if (raw)
+      *raw = state->stat_raw;
+   if (delta)
+      *delta = state->stat_delta;
+   if (stored)
+      *stored = state->stat_stored;
+}
+
+bool state_manager_compressed(state_manager_t *state)
+{
+#ifdef HAVE_ZLIB_DEFLATE
+   return state->compress;
+#else
+   return false;
+#endif
+}
+
+void state_manager_capacity(state_manager_t *state,
+      unsigned *entries, size_t *bytes, bool *full)
+{
+   size_t headpos, tailpos, remaining;
+
+   state_manager_sync(state);
+
+   headpos   = state->head - state->data;
+   tailpos   = state->tail - state->data;
+   remaining = (tailpos + state->capacity -
          sizeof(size_t) - headpos - 1) % state->capacity + 1;
 
    if (entries)
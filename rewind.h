@@ -23,16 +23,45 @@ extern "C" {
 #endif
 
 #include <stddef.h>
+#include <stdint.h>
 #include <boolean.h>
 
 typedef struct state_manager state_manager_t;
 
-state_manager_t *state_manager_new(size_t state_size, size_t buffer_size);
+/**
+ * state_manager_new:
+ * @state_size           : size of a savestate.
+ * @buffer_size          : size of the rewind buffer.
+ * @threads              : amount of encoder threads, 0 encodes
+ *                         synchronously in state_manager_push_do.
+ * @keyframe_interval    : store a full state every this many pushes,
+ *                         0 to only store deltas.
+ * @compress             : deflate every frame (requires zlib).
+ *
+ * Returns: new state manager, or NULL on failure.
+ **/
+state_manager_t *state_manager_new(size_t state_size, size_t buffer_size,
+      unsigned threads, unsigned keyframe_interval, bool compress);
 
 void state_manager_free(state_manager_t *state);
 
 bool state_manager_pop(state_manager_t *state, const void **data);
 
+/**
+ * state_manager_seek:
+ * @state                : state manager.
+ * @frames               : amount of pushed states to go back.
+ * @data                 : resulting state.
+ *
+ * Same as calling state_manager_pop @frames times, but with 
+ * keyframes only the deltas after the nearest keyframe are 
+ * applied. Stops at the oldest state if there are not enough.
+ *
+ * Returns: true if at least one state was popped.
+ **/
+bool state_manager_seek(state_manager_t *state, unsigned frames,
+      const void **data);
+
 void state_manager_push_where(state_manager_t *state, void **data);
 
 void state_manager_push_do(state_manager_t *state);
@@ -40,6 +69,26 @@ void state_manager_push_do(state_manager_t *state);
 void state_manager_capacity(state_manager_t *state,
       unsigned int *entries, size_t *bytes, bool *full);
 
+/**
+ * state_manager_stats:
+ * @state                : state manager.
+ * @raw                  : bytes of state pushed.
+ * @delta                : bytes after delta encoding.
+ * @stored               : bytes written to the buffer, after compression.
+ *
+ * Gets totals over every state pushed since creation.
+ **/
+void state_manager_stats(state_manager_t *state,
+      uint64_t *raw, uint64_t *delta, uint64_t *stored);
+
+/**
+ * state_manager_compressed:
+ * @state                : state manager.
+ *
+ * Returns: true if frames are deflated before they are stored.
+ **/
+bool state_manager_compressed(state_manager_t *state);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,208 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Unit test for state_manager_seek. Build from the top directory with:
+ *
+ *    cc -I. -Ilibretro-sdk/include -DHAVE_THREADS -DHAVE_ZLIB_DEFLATE \
+ *       -o rewind_test rewind_test.c rewind.c \
+ *       libretro-sdk/rthreads/rthreads.c -lz -lpthread
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "general.h"
+#include "performance.h"
+#include "rewind.h"
+
+#define STATE_SIZE   4099
+#define STATE_FRAMES 200
+
+struct global g_extern;
+
+static int failures;
+
+#define CHECK(cond) do { \
+   if (!(cond)) \
+   { \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      failures++; \
+   } \
+} while(0)
+
+/* rewind.c only needs these from the rest of RetroArch. */
+void rarch_perf_register(struct retro_perf_counter *perf)
+{
+   perf->registered = true;
+}
+
+retro_perf_tick_t rarch_get_perf_counter(void)
+{
+   return 0;
+}
+
+uint64_t rarch_get_cpu_features(void)
+{
+   return 0;
+}
+
+/* Every frame changes a few small runs and, now and then, a big one. */
+static void next_state(uint8_t *state, unsigned frame)
+{
+   unsigned i;
+   unsigned runs = rand() % 8;
+
+   for (i = 0; i < runs; i++)
+   {
+      size_t pos = rand() % STATE_SIZE;
+      size_t len = rand() % ((frame % 16) ? 32 : 1024);
+
+      while (len-- && pos < STATE_SIZE)
+         state[pos++] = rand();
+   }
+}
+
+static void push_state(state_manager_t *state, const uint8_t *data)
+{
+   void *where = NULL;
+
+   state_manager_push_where(state, &where);
+   memcpy(where, data, STATE_SIZE);
+   state_manager_push_do(state);
+}
+
+static void test_seek(unsigned threads, unsigned keyframe_interval,
+      bool compress)
+{
+   unsigned i;
+   const void *data = NULL;
+   uint8_t *snapshots[STATE_FRAMES];
+   uint8_t *cur           = (uint8_t*)calloc(1, STATE_SIZE);
+   state_manager_t *state = state_manager_new(STATE_SIZE, 16 << 20,
+         threads, keyframe_interval, compress);
+
+   CHECK(state);
+   if (!state)
+   {
+      free(cur);
+      return;
+   }
+
+   srand(threads * 31 + keyframe_interval);
+
+   for (i = 0; i < STATE_FRAMES; i++)
+   {
+      next_state(cur, i);
+      snapshots[i] = (uint8_t*)malloc(STATE_SIZE);
+      memcpy(snapshots[i], cur, STATE_SIZE);
+      push_state(state, cur);
+   }
+
+   /* Popping once gives back the newest state, so seeking N
+    * frames lands on the Nth newest. */
+   CHECK(state_manager_seek(state, 1, &data));
+   CHECK(data && !memcmp(data, snapshots[STATE_FRAMES - 1], STATE_SIZE));
+
+   CHECK(state_manager_seek(state, 37, &data));
+   CHECK(data && !memcmp(data, snapshots[STATE_FRAMES - 38], STATE_SIZE));
+
+   /* Seeking agrees with popping afterwards. */
+   CHECK(state_manager_pop(state, &data));
+   CHECK(data && !memcmp(data, snapshots[STATE_FRAMES - 39], STATE_SIZE));
+
+   CHECK(state_manager_seek(state, 50, &data));
+   CHECK(data && !memcmp(data, snapshots[STATE_FRAMES - 89], STATE_SIZE));
+
+   /* Pushing after a seek continues from the restored point. */
+   next_state(cur, 0);
+   push_state(state, cur);
+
+   CHECK(state_manager_pop(state, &data));
+   CHECK(data && !memcmp(data, cur, STATE_SIZE));
+   CHECK(state_manager_seek(state, 10, &data));
+   CHECK(data && !memcmp(data, snapshots[STATE_FRAMES - 99], STATE_SIZE));
+
+   /* Seeking past the end stops at the oldest state. */
+   CHECK(state_manager_seek(state, 100000, &data));
+   CHECK(data && !memcmp(data, snapshots[0], STATE_SIZE));
+   CHECK(!state_manager_pop(state, &data));
+   CHECK(!state_manager_seek(state, 5, &data));
+
+   state_manager_free(state);
+
+   for (i = 0; i < STATE_FRAMES; i++)
+      free(snapshots[i]);
+   free(cur);
+}
+
+/* With deflate, frames are much smaller than a block, so there
+ * are far more keyframes in the buffer than blocks would fit. */
+static void test_seek_small_frames(unsigned threads)
+{
+   unsigned i;
+   const void *data = NULL;
+   uint8_t *snapshots[STATE_FRAMES];
+   uint8_t *cur           = (uint8_t*)calloc(1, STATE_SIZE);
+   state_manager_t *state = state_manager_new(STATE_SIZE, 64 << 10,
+         threads, 2, true);
+
+   CHECK(state);
+   if (!state)
+   {
+      free(cur);
+      return;
+   }
+
+   for (i = 0; i < STATE_FRAMES; i++)
+   {
+      cur[i % STATE_SIZE] = i;
+      snapshots[i] = (uint8_t*)malloc(STATE_SIZE);
+      memcpy(snapshots[i], cur, STATE_SIZE);
+      push_state(state, cur);
+   }
+
+   CHECK(state_manager_seek(state, 150, &data));
+   CHECK(data && !memcmp(data, snapshots[STATE_FRAMES - 150], STATE_SIZE));
+   CHECK(state_manager_seek(state, 40, &data));
+   CHECK(data && !memcmp(data, snapshots[STATE_FRAMES - 190], STATE_SIZE));
+
+   state_manager_free(state);
+
+   for (i = 0; i < STATE_FRAMES; i++)
+      free(snapshots[i]);
+   free(cur);
+}
+
+int main(void)
+{
+   test_seek(0, 0, false);
+   test_seek(0, 16, false);
+   test_seek(0, 7, true);
+   test_seek(2, 16, false);
+   test_seek(2, 7, true);
+   test_seek_small_frames(0);
+   test_seek_small_frames(2);
+
+   if (failures)
+   {
+      fprintf(stderr, "%d check(s) failed.\n", failures);
+      return 1;
+   }
+
+   printf("All rewind tests passed.\n");
+   return 0;
+}
@@ -23,6 +23,11 @@
 #include "intl/intl.h"
 #include "retroarch.h"
 #include "runloop.h"
+#include "gfx/video_monitor.h"
+
+#ifdef HAVE_THREADS
+#include "gfx/video_shader_async.h"
+#endif
 
 #ifdef HAVE_MENU
 #include "menu/menu.h"
@@ -201,10 +206,10 @@ static inline void setup_rewind_audio(void)
    for (i = 0; i < g_extern.audio_data.data_ptr; i += 2)
    {
       g_extern.audio_data.rewind_buf[--g_extern.audio_data.rewind_ptr] =
-         g_extern.audio_data.conv_outsamples[i + 1];
+         g_extern.audio_data.sample_buf[i + 1];
 
       g_extern.audio_data.rewind_buf[--g_extern.audio_data.rewind_ptr] =
-         g_extern.audio_data.conv_outsamples[i + 0];
+         g_extern.audio_data.sample_buf[i + 0];
    }
 
    g_extern.audio_data.data_ptr = 0;
@@ -284,6 +289,50 @@ static void check_rewind(bool pressed)
    retro_set_rewind_callbacks();
 }
 
+/**
+ * check_rewind_seek:
+ * @pressed              : was rewind seek key pressed?
+ *
+ * Jumps back rewind_seek_seconds in the rewind buffer at once.
+ **/
+static void check_rewind_seek(bool pressed)
+{
+   unsigned frames;
+   float fps;
+   const void *buf = NULL;
+
+   if (!pressed || !g_extern.state_manager)
+      return;
+
+   msg_queue_clear(g_extern.msg_queue);
+
+   /* The movie can only be rewound one frame at a time. */
+   if (g_extern.bsv.movie)
+   {
+      msg_queue_push(g_extern.msg_queue,
+            "Can't seek back while a movie is active.", 0, 180);
+      return;
+   }
+
+   fps    = g_extern.system.av_info.timing.fps;
+   frames = (fps > 0.0f ? fps : 60.0f) * g_settings.rewind_seek_seconds /
+      (g_settings.rewind_granularity ? g_settings.rewind_granularity : 1);
+
+   if (state_manager_seek(g_extern.state_manager,
+            frames ? frames : 1, &buf))
+   {
+      char msg[64];
+
+      snprintf(msg, sizeof(msg), "Rewound %u seconds.",
+            g_settings.rewind_seek_seconds);
+      msg_queue_push(g_extern.msg_queue, msg, 0, 60);
+      pretro_unserialize(buf, g_extern.state_size);
+   }
+   else
+      msg_queue_push(g_extern.msg_queue,
+            RETRO_MSG_REWIND_REACHED_END, 0, 30);
+}
+
 /**
  * check_slowmotion:
  * @pressed              : was slow motion key pressed or held?
@@ -452,6 +501,16 @@ static void check_shader_dir(bool pressed_next, bool pressed_prev)
    msg_queue_push(g_extern.msg_queue, msg, 1, 120);
    RARCH_LOG("Applying shader \"%s\".\n", shader);
 
+#ifdef HAVE_THREADS
+   if (g_settings.video.shader_async)
+   {
+      if (!video_shader_async_load(type, shader))
+         RARCH_WARN("Failed to apply shader.\n");
+      return;
+   }
+   video_shader_async_cancel();
+#endif
+
    if (!driver.video->set_shader(driver.video_data, type, shader))
       RARCH_WARN("Failed to apply shader.\n");
 }
@@ -587,6 +646,7 @@ static int do_state_checks(
    else if (BIT64_GET(trigger_input, RARCH_LOAD_STATE_KEY))
       rarch_main_command(RARCH_CMD_LOAD_STATE);
 
+   check_rewind_seek(BIT64_GET(trigger_input, RARCH_REWIND_SEEK));
    check_rewind_func(input);
 
    check_slowmotion_func(input);
@@ -677,7 +737,7 @@ static void update_frame_time(void)
 static void limit_frame_time(void)
 {
    double effective_fps, mft_f;
-   retro_time_t current, target = 0, to_sleep_ms = 0;
+   retro_time_t current, target = 0;
 
    current       = rarch_get_time_usec();
    effective_fps = g_extern.system.av_info.timing.fps 
@@ -688,19 +748,17 @@ static void limit_frame_time(void)
 
    target        = g_extern.frame_limit.last_frame_time + 
                    g_extern.frame_limit.minimum_frame_time;
-   to_sleep_ms   = (target - current) / 1000;
 
-   if (to_sleep_ms <= 0)
+   if (target <= current)
    {
-      g_extern.frame_limit.last_frame_time = rarch_get_time_usec();
+      g_extern.frame_limit.last_frame_time = current;
       return;
    }
 
-   rarch_sleep((unsigned int)to_sleep_ms);
+   video_monitor_record_pacing_error(rarch_sleep_until_usec(target));
 
-   /* Combat jitter a bit. */
-   g_extern.frame_limit.last_frame_time += 
-      g_extern.frame_limit.minimum_frame_time;
+   /* Keep deadlines absolute, so oversleeping doesn't accumulate. */
+   g_extern.frame_limit.last_frame_time = target;
 }
 
 /**
@@ -969,6 +1027,183 @@ static int rarch_main_iterate_http_poll(void)
 }
 #endif
 
+/* Headroom left between the end of the frame and VSync. */
+#define FRAME_DELAY_MARGIN_USEC 2000
+/* Frames between attempts to raise the delay. */
+#define FRAME_DELAY_INTERVAL 60
+/* Same ceiling as video_frame_delay. */
+#define FRAME_DELAY_MAX_USEC 15000
+/* Largest step by which the delay is raised at once. */
+#define FRAME_DELAY_STEP_USEC 500
+/* Samples in the recent histogram before it decays. */
+#define FRAME_DELAY_DECAY_COUNT 1024
+
+/**
+ * frame_delay_percentile:
+ * @percent            : percentile to look up (0 - 100).
+ *
+ * Returns: upper bound of the histogram bucket holding the
+ * @percent percentile of recent core run times, in microseconds.
+ **/
+static retro_time_t frame_delay_percentile(unsigned percent)
+{
+   unsigned i;
+   uint32_t accum = 0;
+   uint32_t limit = (g_extern.frame_delay.recent_count * percent + 99) / 100;
+
+   for (i = 0; i < FRAME_DELAY_HISTOGRAM_SIZE - 1; i++)
+   {
+      accum += g_extern.frame_delay.recent[i];
+      if (accum >= limit)
+         break;
+   }
+
+   return (i + 1) * FRAME_DELAY_BUCKET_USEC;
+}
+
+/**
+ * update_frame_delay:
+ * @frame_start        : time the frame started, before the delay.
+ * @run_start          : time pretro_run() was called.
+ *
+ * Records how long the core took to produce this frame and
+ * retunes the automatic frame delay. Lowers the delay at once
+ * when a frame ran late, raises it slowly otherwise.
+ **/
+static void update_frame_delay(retro_time_t frame_start,
+      retro_time_t run_start)
+{
+   unsigned i, bucket;
+   retro_time_t end, run_time, budget, target;
+   float refresh_rate = g_settings.video.refresh_rate;
+
+   if (refresh_rate <= 0.0f)
+      return;
+
+   /* Not the core_run perf counter: that one counts CPU ticks,
+    * only when perfcnt_enable is set, and it also includes
+    * video->frame(), which blocks on vsync. What matters here is
+    * the wall-clock time until the frame was handed over. */
+   end = g_extern.frame_delay.submit_time ?
+      g_extern.frame_delay.submit_time : rarch_get_time_usec();
+   run_time = end - run_start;
+   budget   = (retro_time_t)(1000000.0f / refresh_rate)
+      - FRAME_DELAY_MARGIN_USEC;
+
+   bucket = min(run_time / FRAME_DELAY_BUCKET_USEC,
+         FRAME_DELAY_HISTOGRAM_SIZE - 1);
+   g_extern.frame_delay.histogram[bucket]++;
+   g_extern.frame_delay.recent[bucket]++;
+   g_extern.frame_delay.frames++;
+
+   if (++g_extern.frame_delay.recent_count >= FRAME_DELAY_DECAY_COUNT)
+   {
+      g_extern.frame_delay.recent_count = 0;
+      for (i = 0; i < FRAME_DELAY_HISTOGRAM_SIZE; i++)
+      {
+         g_extern.frame_delay.recent[i] /= 2;
+         g_extern.frame_delay.recent_count += g_extern.frame_delay.recent[i];
+      }
+   }
+
+   if (end - frame_start > budget)
+   {
+      /* Missed the deadline, back off right away. */
+      g_extern.frame_delay.late_frames++;
+      g_extern.frame_delay.frames_since_late = 0;
+      target = budget - run_time;
+      g_extern.frame_delay.delay = max(min(target, FRAME_DELAY_MAX_USEC), 0);
+      return;
+   }
+
+   if (++g_extern.frame_delay.frames_since_late < FRAME_DELAY_INTERVAL)
+      return;
+   g_extern.frame_delay.frames_since_late = 0;
+
+   target = budget - frame_delay_percentile(99);
+   target = max(min(target, FRAME_DELAY_MAX_USEC), 0);
+
+   if (target > g_extern.frame_delay.delay)
+      g_extern.frame_delay.delay = min(target,
+            g_extern.frame_delay.delay + FRAME_DELAY_STEP_USEC);
+   else
+      g_extern.frame_delay.delay = target;
+}
+
+/**
+ * run_ahead:
+ * @frames             : amount of frames to run ahead.
+ *
+ * Runs the real frame with video hidden and saves its state,
+ * then runs @frames more frames with audio hidden, showing only
+ * the last one, and rolls back to the saved state.
+ *
+ * Disables itself for the current core if savestates fail.
+ **/
+static void run_ahead(unsigned frames)
+{
+   unsigned i;
+   size_t size = pretro_serialize_size();
+
+   if (size != g_extern.run_ahead.state_size)
+   {
+      void *state;
+
+      if (!size)
+      {
+         RARCH_WARN("Core does not support savestates, disabling run-ahead.\n");
+         g_extern.run_ahead.unsupported = true;
+         pretro_run();
+         return;
+      }
+
+      state = realloc(g_extern.run_ahead.state, size);
+      if (!state)
+      {
+         RARCH_ERR("Failed to allocate %u bytes for the run-ahead state, "
+               "disabling run-ahead.\n", (unsigned)size);
+         g_extern.run_ahead.unsupported = true;
+         pretro_run();
+         return;
+      }
+
+      g_extern.run_ahead.state      = state;
+      g_extern.run_ahead.state_size = size;
+   }
+
+   g_extern.run_ahead.hide_video = true;
+   pretro_run();
+   g_extern.run_ahead.hide_video = false;
+
+   RARCH_PERFORMANCE_INIT(run_ahead_serialize);
+   RARCH_PERFORMANCE_START(run_ahead_serialize);
+   if (!pretro_serialize(g_extern.run_ahead.state, size))
+   {
+      RARCH_PERFORMANCE_STOP(run_ahead_serialize);
+      RARCH_WARN("Failed to save state, disabling run-ahead.\n");
+      g_extern.run_ahead.unsupported = true;
+
+      /* The frame that just ran was hidden, show it after all. */
+      rarch_render_cached_frame();
+      return;
+   }
+   RARCH_PERFORMANCE_STOP(run_ahead_serialize);
+
+   g_extern.run_ahead.hide_audio = true;
+   for (i = 0; i < frames; i++)
+   {
+      g_extern.run_ahead.hide_video = i + 1 < frames;
+      pretro_run();
+   }
+   g_extern.run_ahead.hide_video = false;
+   g_extern.run_ahead.hide_audio = false;
+
+   RARCH_PERFORMANCE_INIT(run_ahead_unserialize);
+   RARCH_PERFORMANCE_START(run_ahead_unserialize);
+   pretro_unserialize(g_extern.run_ahead.state, size);
+   RARCH_PERFORMANCE_STOP(run_ahead_unserialize);
+}
+
 /**
  * rarch_main_iterate:
  *
@@ -983,6 +1218,8 @@ int rarch_main_iterate(void)
    retro_input_t trigger_input;
    int ret                         = 0;
    static retro_input_t last_input = 0;
+   retro_time_t frame_start        = rarch_get_time_usec();
+   retro_time_t run_start          = 0;
    retro_input_t old_input         = last_input;
    retro_input_t input             = input_keys_pressed();
    last_input                      = input;
@@ -1000,6 +1237,11 @@ int rarch_main_iterate(void)
 
    do_pre_state_checks(input, old_input, trigger_input);
 
+#ifdef HAVE_THREADS
+   /* Swaps in a shader loaded in the background, between frames. */
+   video_shader_async_poll();
+#endif
+
 #ifdef HAVE_NETWORKING
    if (g_extern.http_handle)
    {
@@ -1065,12 +1307,37 @@ int rarch_main_iterate(void)
             g_settings.input.analog_dpad_mode[i]);
    }
 
-   if ((g_settings.video.frame_delay > 0) && !driver.nonblock_state)
-      rarch_sleep(g_settings.video.frame_delay);
+   if (g_settings.video.frame_delay_auto)
+   {
+      if (g_extern.frame_delay.delay > 0 && !driver.nonblock_state)
+         video_monitor_record_pacing_error(rarch_sleep_until_usec(
+                  frame_start + g_extern.frame_delay.delay));
+   }
+   else if ((g_settings.video.frame_delay > 0) && !driver.nonblock_state)
+      video_monitor_record_pacing_error(rarch_sleep_until_usec(
+               frame_start + g_settings.video.frame_delay * 1000));
+
+   run_start = rarch_get_time_usec();
+   g_extern.frame_delay.submit_time = 0;
 
+   RARCH_PERFORMANCE_INIT(core_run);
+   RARCH_PERFORMANCE_START(core_run);
 
    /* Run libretro for one frame. */
-   pretro_run();
+   if (g_settings.run_ahead_frames && !g_extern.run_ahead.unsupported
+         && !g_extern.frame_is_reverse && !g_extern.bsv.movie
+#ifdef HAVE_NETPLAY
+         && !driver.netplay_data
+#endif
+         )
+      run_ahead(g_settings.run_ahead_frames);
+   else
+      pretro_run();
+
+   RARCH_PERFORMANCE_STOP(core_run);
+
+   if (g_settings.video.frame_delay_auto && !driver.nonblock_state)
+      update_frame_delay(frame_start, run_start);
 
    for (i = 0; i < g_settings.input.max_users; i++)
    {
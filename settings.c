@@ -397,7 +397,9 @@ static void config_set_defaults(void)
    g_settings.video.vsync = vsync;
    g_settings.video.hard_sync = hard_sync;
    g_settings.video.hard_sync_frames = hard_sync_frames;
+   g_settings.video.pbo_upload = pbo_upload;
    g_settings.video.frame_delay = frame_delay;
+   g_settings.video.frame_delay_auto = frame_delay_auto;
    g_settings.video.black_frame_insertion = black_frame_insertion;
    g_settings.video.swap_interval = swap_interval;
    g_settings.video.threaded = video_threaded;
@@ -419,6 +421,7 @@ static void config_set_defaults(void)
    g_settings.video.aspect_ratio_auto = aspect_ratio_auto; // Let implementation decide if automatic, or 1:1 PAR.
    g_settings.video.aspect_ratio_idx = aspect_ratio_idx;
    g_settings.video.shader_enable = shader_enable;
+   g_settings.video.shader_async = shader_async;
    g_settings.video.allow_rotate = allow_rotate;
 
    g_settings.video.font_enable = font_enable;
@@ -444,6 +447,8 @@ static void config_set_defaults(void)
    g_settings.audio.enable = audio_enable;
    g_settings.audio.mute_enable = false;
    g_settings.audio.out_rate = out_rate;
+   g_settings.audio.resampler_quality = audio_resampler_quality;
+   g_settings.audio.dsp_thread = audio_dsp_thread;
    g_settings.audio.block_frames = 0;
    if (audio_device)
       strlcpy(g_settings.audio.device,
@@ -464,6 +469,11 @@ static void config_set_defaults(void)
    g_settings.rewind_enable = rewind_enable;
    g_settings.rewind_buffer_size = rewind_buffer_size;
    g_settings.rewind_granularity = rewind_granularity;
+   g_settings.rewind_threads = rewind_threads;
+   g_settings.rewind_keyframe_interval = rewind_keyframe_interval;
+   g_settings.rewind_seek_seconds = rewind_seek_seconds;
+   g_settings.rewind_compression = rewind_compression;
+   g_settings.run_ahead_frames = run_ahead_frames;
    g_settings.slowmotion_ratio = slowmotion_ratio;
    g_settings.fastforward_ratio = fastforward_ratio;
    g_settings.fastforward_ratio_throttle_enable = fastforward_ratio_throttle_enable;
@@ -536,6 +546,8 @@ static void config_set_defaults(void)
 
    g_settings.input.axis_threshold = axis_threshold;
    g_settings.input.netplay_client_swap_input = netplay_client_swap_input;
+   g_settings.input.netplay_input_latency_frames = netplay_input_latency_frames;
+   g_settings.input.netplay_input_latency_auto = netplay_input_latency_auto;
    g_settings.input.turbo_period = turbo_period;
    g_settings.input.turbo_duty_cycle = turbo_duty_cycle;
 
@@ -1107,10 +1119,12 @@ static bool config_load_file(const char *path, bool set_defaults)
    CONFIG_GET_INT(video.hard_sync_frames, "video_hard_sync_frames");
    if (g_settings.video.hard_sync_frames > 3)
       g_settings.video.hard_sync_frames = 3;
+   CONFIG_GET_BOOL(video.pbo_upload, "video_pbo_upload");
 
    CONFIG_GET_INT(video.frame_delay, "video_frame_delay");
    if (g_settings.video.frame_delay > 15)
       g_settings.video.frame_delay = 15;
+   CONFIG_GET_BOOL(video.frame_delay_auto, "video_frame_delay_auto");
 
    CONFIG_GET_BOOL(video.black_frame_insertion, "video_black_frame_insertion");
    CONFIG_GET_INT(video.swap_interval, "video_swap_interval");
@@ -1133,6 +1147,7 @@ static bool config_load_file(const char *path, bool set_defaults)
 
    CONFIG_GET_PATH(video.shader_path, "video_shader");
    CONFIG_GET_BOOL(video.shader_enable, "video_shader_enable");
+   CONFIG_GET_BOOL(video.shader_async, "video_shader_async");
 
    CONFIG_GET_BOOL(video.allow_rotate, "video_allow_rotate");
 
@@ -1205,6 +1220,10 @@ static bool config_load_file(const char *path, bool set_defaults)
    CONFIG_GET_FLOAT(input.axis_threshold, "input_axis_threshold");
    CONFIG_GET_BOOL(input.netplay_client_swap_input,
          "netplay_client_swap_input");
+   CONFIG_GET_INT(input.netplay_input_latency_frames,
+         "netplay_input_latency_frames");
+   CONFIG_GET_BOOL(input.netplay_input_latency_auto,
+         "netplay_input_latency_auto");
    CONFIG_GET_INT(input.max_users, "input_max_users");
    CONFIG_GET_BOOL(input.input_descriptor_label_show,
          "input_descriptor_label_show");
@@ -1259,6 +1278,8 @@ static bool config_load_file(const char *path, bool set_defaults)
    CONFIG_GET_FLOAT(audio.max_timing_skew, "audio_max_timing_skew");
    CONFIG_GET_FLOAT(audio.volume, "audio_volume");
    CONFIG_GET_STRING(audio.resampler, "audio_resampler");
+   CONFIG_GET_INT(audio.resampler_quality, "audio_resampler_quality");
+   CONFIG_GET_BOOL(audio.dsp_thread, "audio_dsp_thread");
    g_extern.audio_data.volume_gain = db_to_gain(g_settings.audio.volume);
 
    CONFIG_GET_STRING(camera.device, "camera_device");
@@ -1369,6 +1390,13 @@ static bool config_load_file(const char *path, bool set_defaults)
       g_settings.rewind_buffer_size = buffer_size * UINT64_C(1000000);
 
    CONFIG_GET_INT(rewind_granularity, "rewind_granularity");
+   CONFIG_GET_INT(rewind_threads, "rewind_threads");
+   CONFIG_GET_INT(rewind_keyframe_interval, "rewind_keyframe_interval");
+   CONFIG_GET_INT(rewind_seek_seconds, "rewind_seek_seconds");
+   CONFIG_GET_BOOL(rewind_compression, "rewind_compression");
+   CONFIG_GET_INT(run_ahead_frames, "run_ahead_frames");
+   if (g_settings.run_ahead_frames > 6)
+      g_settings.run_ahead_frames = 6;
    CONFIG_GET_FLOAT(slowmotion_ratio, "slowmotion_ratio");
    if (g_settings.slowmotion_ratio < 1.0f)
       g_settings.slowmotion_ratio = 1.0f;
@@ -1809,6 +1837,10 @@ bool config_save_file(const char *path)
          g_settings.input.remap_binds_enable);
    config_set_bool(conf, "netplay_client_swap_input",
          g_settings.input.netplay_client_swap_input);
+   config_set_int(conf, "netplay_input_latency_frames",
+         g_settings.input.netplay_input_latency_frames);
+   config_set_bool(conf, "netplay_input_latency_auto",
+         g_settings.input.netplay_input_latency_auto);
    config_set_bool(conf, "input_descriptor_label_show",
          g_settings.input.input_descriptor_label_show);
    config_set_bool(conf, "autoconfig_descriptor_label_show",
@@ -1833,9 +1865,17 @@ bool config_save_file(const char *path)
    config_set_bool(conf,  "audio_sync",    g_settings.audio.sync);
    config_set_int(conf,   "audio_block_frames", g_settings.audio.block_frames);
    config_set_int(conf,   "rewind_granularity", g_settings.rewind_granularity);
+   config_set_int(conf,   "rewind_threads", g_settings.rewind_threads);
+   config_set_int(conf,   "run_ahead_frames", g_settings.run_ahead_frames);
+   config_set_int(conf,   "rewind_keyframe_interval",
+         g_settings.rewind_keyframe_interval);
+   config_set_int(conf,   "rewind_seek_seconds", g_settings.rewind_seek_seconds);
+   config_set_bool(conf,  "rewind_compression", g_settings.rewind_compression);
    config_set_path(conf,  "video_shader", g_settings.video.shader_path);
    config_set_bool(conf,  "video_shader_enable",
          g_settings.video.shader_enable);
+   config_set_bool(conf,  "video_shader_async",
+         g_settings.video.shader_async);
    config_set_float(conf, "video_aspect_ratio", g_settings.video.aspect_ratio);
    config_set_bool(conf,  "video_aspect_ratio_auto", g_settings.video.aspect_ratio_auto);
    config_set_bool(conf,  "video_windowed_fullscreen",
@@ -1872,7 +1912,10 @@ bool config_save_file(const char *path)
    config_set_bool(conf,  "video_hard_sync", g_settings.video.hard_sync);
    config_set_int(conf,   "video_hard_sync_frames",
          g_settings.video.hard_sync_frames);
+   config_set_bool(conf,  "video_pbo_upload", g_settings.video.pbo_upload);
    config_set_int(conf,   "video_frame_delay", g_settings.video.frame_delay);
+   config_set_bool(conf,  "video_frame_delay_auto",
+         g_settings.video.frame_delay_auto);
    config_set_bool(conf,  "video_black_frame_insertion",
          g_settings.video.black_frame_insertion);
    config_set_bool(conf,  "video_disable_composition",
@@ -1928,6 +1971,9 @@ bool config_save_file(const char *path)
    config_set_path(conf, "resampler_directory",
          g_settings.resampler_directory);
    config_set_string(conf, "audio_resampler", g_settings.audio.resampler);
+   config_set_int(conf, "audio_resampler_quality",
+         g_settings.audio.resampler_quality);
+   config_set_bool(conf, "audio_dsp_thread", g_settings.audio.dsp_thread);
    config_set_path(conf, "savefile_directory",
          *g_extern.savefile_dir ? g_extern.savefile_dir : "default");
    config_set_path(conf, "savestate_directory",
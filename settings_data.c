@@ -1388,6 +1388,26 @@ static void setting_data_get_string_representation_uint_libretro_log_level(void
          type_str_size);
 }
 
+static void setting_data_get_string_representation_uint_audio_resampler_quality(
+      void *data, char *type_str, size_t type_str_size)
+{
+   rarch_setting_t *setting = (rarch_setting_t*)data;
+   static const char *modes[] = {
+      "Don't care",
+      "1 (Lowest)",
+      "2 (Lower)",
+      "3 (Normal)",
+      "4 (Higher)",
+      "5 (Highest)"
+   };
+
+   if (!setting || *setting->value.unsigned_integer > 5)
+      return;
+
+   strlcpy(type_str, modes[*setting->value.unsigned_integer],
+         type_str_size);
+}
+
 static void setting_data_get_string_representation_uint(void *data,
       char *type_str, size_t type_str_size)
 {
@@ -1946,6 +1966,15 @@ int setting_data_get_description(const char *label, char *msg,
             "in the main menu."
             );
    }
+   else if (!strcmp(label, "audio_resampler_quality"))
+   {
+      snprintf(msg, sizeof_msg,
+            " -- Quality level of the SINC resampler. \n"
+            " \n"
+            "Higher levels have a cleaner sound, but \n"
+            "need a lot more CPU time. Lower levels \n"
+            "are meant for weak hardware.");
+   }
    else if (!strcmp(label, "audio_resampler_driver"))
    {
       if (!strcmp(g_settings.audio.resampler, "sinc"))
@@ -2017,6 +2046,16 @@ int setting_data_get_description(const char *label, char *msg,
             "the driver."
             );
    }
+   else if (!strcmp(label, "audio_dsp_thread"))
+   {
+      snprintf(msg, sizeof_msg,
+            " -- Threaded DSP.\n"
+            " \n"
+            "Runs the DSP plugin and the resampler \n"
+            "on a separate thread. Helps when a heavy \n"
+            "DSP chain slows down emulation, but adds \n"
+            "a little audio latency.");
+   }
    else if (!strcmp(label, "libretro_dir_path"))
    {
       snprintf(msg, sizeof_msg,
@@ -2146,6 +2185,17 @@ int setting_data_get_description(const char *label, char *msg,
             " 1: Syncs to previous frame.\n"
             " 2: Etc ...");
    }
+   else if (!strcmp(label, "video_pbo_upload"))
+   {
+      snprintf(msg, sizeof_msg,
+            " -- Streams frames to the GPU through \n"
+            "a ring of pixel buffers.\n"
+            " \n"
+            "Can avoid stalls in drivers where \n"
+            "uploading a frame waits for the GPU.\n"
+            " \n"
+            "Desktop OpenGL only.");
+   }
    else if (!strcmp(label, "video_frame_delay"))
    {
       snprintf(msg, sizeof_msg,
@@ -2157,6 +2207,39 @@ int setting_data_get_description(const char *label, char *msg,
             " \n"
             "Maximum is 15.");
    }
+   else if (!strcmp(label, "video_frame_delay_auto"))
+   {
+      snprintf(msg, sizeof_msg,
+            " -- Picks the frame delay automatically.\n"
+            " \n"
+            "Measures how long the core takes to\n"
+            "produce each frame and uses the largest\n"
+            "delay which still leaves enough time\n"
+            "before VSync. Backs off immediately\n"
+            "when a frame runs late.\n"
+            " \n"
+            "Overrides Frame Delay.");
+   }
+   else if (!strcmp(label, "run_ahead_frames"))
+   {
+      snprintf(msg, sizeof_msg,
+            " -- Runs the core ahead to hide input lag.\n"
+            " \n"
+            "Every frame, the core runs this many\n"
+            "extra frames with current input and\n"
+            "only the last one is shown. The core\n"
+            "then rolls back using savestates.\n"
+            " \n"
+            "Set it to the amount of lag frames\n"
+            "the game has. Too high a value makes\n"
+            "the game skip visibly. Costs that many\n"
+            "extra core runs per frame.\n"
+            " \n"
+            "Requires savestate support. Disabled\n"
+            "during netplay and movie playback.\n"
+            " \n"
+            "Maximum is 6.");
+   }
    else if (!strcmp(label, "audio_rate_control_delta"))
    {
       snprintf(msg, sizeof_msg,
@@ -2170,7 +2253,11 @@ int setting_data_get_description(const char *label, char *msg,
             "dynamically.\n"
             " \n"
             " Input rate is defined as: \n"
-            " input rate * (1.0 +/- (rate control delta))");
+            " input rate * (1.0 +/- (rate control delta))\n"
+            " \n"
+            "Rate control keeps the audio buffer half \n"
+            "full, which lets a low audio latency run \n"
+            "without crackling.");
    }
    else if (!strcmp(label, "audio_max_timing_skew"))
    {
@@ -2249,7 +2336,22 @@ int setting_data_get_description(const char *label, char *msg,
             " \n"
             "Using this might improve performance at \n"
             "possible cost of latency and more video \n"
-            "stuttering.");
+            "stuttering.\n"
+            " \n"
+            "Frames are triple buffered, and cores which \n"
+            "render into the frontend's framebuffer \n"
+            "skip the copy entirely.");
+   }
+   else if (!strcmp(label, "video_shader_async"))
+   {
+      snprintf(msg, sizeof_msg,
+            " -- Loads shaders in the background.\n"
+            " \n"
+            "Applies to shaders switched while \n"
+            "running, from the shader directory or \n"
+            "with the SET_SHADER command. The current \n"
+            "shader keeps rendering until the new \n"
+            "one is ready.");
    }
    else if (!strcmp(label, "video_scale_integer"))
    {
@@ -2454,6 +2556,46 @@ int setting_data_get_description(const char *label, char *msg,
             "at a time, increasing the rewinding \n"
             "speed.");
    }
+   else if (!strcmp(label, "rewind_threads"))
+   {
+      snprintf(msg, sizeof_msg,
+            " -- Rewind encoder threads.\n"
+            " \n"
+            "With 0, rewind states are encoded on \n"
+            "the main thread. Otherwise encoding \n"
+            "happens in the background and big \n"
+            "states are split over this many \n"
+            "threads.");
+   }
+   else if (!strcmp(label, "rewind_keyframe_interval"))
+   {
+      snprintf(msg, sizeof_msg,
+            " -- Rewind keyframe interval.\n"
+            " \n"
+            "Stores a full state every this many \n"
+            "rewind frames, so that jumping far back \n"
+            "doesn't have to walk through every \n"
+            "frame in between. Costs buffer space. \n"
+            " \n"
+            "0 disables keyframes.");
+   }
+   else if (!strcmp(label, "rewind_seek_seconds"))
+   {
+      snprintf(msg, sizeof_msg,
+            " -- Rewind seek length.\n"
+            " \n"
+            "How many seconds the Rewind seek \n"
+            "hotkey jumps back at once.");
+   }
+   else if (!strcmp(label, "rewind_compression"))
+   {
+      snprintf(msg, sizeof_msg,
+            " -- Compress rewind frames.\n"
+            " \n"
+            "Fits more rewind history in the same \n"
+            "buffer size. Compression is done on \n"
+            "a background thread.");
+   }
    else if (!strcmp(label, "rewind_enable"))
    {
       snprintf(msg, sizeof_msg,
@@ -2675,6 +2817,23 @@ int setting_data_get_description(const char *label, char *msg,
    else if (!strcmp(label, "netplay_flip_players"))
       snprintf(msg, sizeof_msg,
             " -- Netplay flip users.");
+   else if (!strcmp(label, "netplay_input_latency_frames"))
+      snprintf(msg, sizeof_msg,
+            " -- Delays local input over netplay.\n"
+            " \n"
+            "Input is applied this many frames\n"
+            "later, so the other side receives it\n"
+            "before it needs it and has to roll\n"
+            "back less often.\n"
+            " \n"
+            "Maximum is 8.");
+   else if (!strcmp(label, "netplay_input_latency_auto"))
+      snprintf(msg, sizeof_msg,
+            " -- Picks netplay input latency from\n"
+            "the measured round trip time.\n"
+            " \n"
+            "Never goes below Netplay Input\n"
+            "Latency Frames.");
    else if (!strcmp(label, "frame_advance"))
       snprintf(msg, sizeof_msg,
             " -- Frame advance when content is paused.");
@@ -3531,6 +3690,55 @@ static bool setting_data_append_list_main_menu_options(
          group_info.name,
          subgroup_info.name);
 
+   if (g_extern.state_manager)
+   {
+      CONFIG_ACTION(
+            "rewind_information",
+            "Rewind Information",
+            group_info.name,
+            subgroup_info.name);
+   }
+
+   if (g_extern.audio_data.rate_control || g_extern.audio_data.dsp_thread)
+   {
+      CONFIG_ACTION(
+            "audio_information",
+            "Audio Information",
+            group_info.name,
+            subgroup_info.name);
+   }
+
+#ifdef HAVE_THREADS
+   if (g_settings.video.threaded)
+   {
+      CONFIG_ACTION(
+            "video_information",
+            "Video Information",
+            group_info.name,
+            subgroup_info.name);
+   }
+#endif
+
+#ifdef HAVE_NETPLAY
+   if (driver.netplay_data && !g_extern.netplay_is_spectate)
+   {
+      CONFIG_ACTION(
+            "netplay_information",
+            "Netplay Information",
+            group_info.name,
+            subgroup_info.name);
+   }
+#endif
+
+   if (g_settings.video.frame_delay_auto)
+   {
+      CONFIG_ACTION(
+            "frame_delay_information",
+            "Frame Delay Information",
+            group_info.name,
+            subgroup_info.name);
+   }
+
    if (g_extern.perfcnt_enable)
    {
       CONFIG_ACTION(
@@ -3872,6 +4080,55 @@ static bool setting_data_append_list_general_options(
             general_read_handler);
    settings_list_current_add_range(list, list_info, 1, 32768, 1, true, false);
 
+#ifdef HAVE_THREADS
+   CONFIG_UINT(
+         g_settings.rewind_threads,
+         "rewind_threads",
+         "Rewind Threads",
+         rewind_threads,
+         group_info.name,
+         subgroup_info.name,
+         general_write_handler,
+         general_read_handler);
+   settings_list_current_add_range(list, list_info, 0, 16, 1, true, true);
+#endif
+
+   CONFIG_UINT(
+         g_settings.rewind_keyframe_interval,
+         "rewind_keyframe_interval",
+         "Rewind Keyframe Interval",
+         rewind_keyframe_interval,
+         group_info.name,
+         subgroup_info.name,
+         general_write_handler,
+         general_read_handler);
+   settings_list_current_add_range(list, list_info, 0, 3600, 60, true, true);
+
+   CONFIG_UINT(
+         g_settings.rewind_seek_seconds,
+         "rewind_seek_seconds",
+         "Rewind Seek Length",
+         rewind_seek_seconds,
+         group_info.name,
+         subgroup_info.name,
+         general_write_handler,
+         general_read_handler);
+   settings_list_current_add_range(list, list_info, 1, 600, 1, true, true);
+
+#ifdef HAVE_ZLIB_DEFLATE
+   CONFIG_BOOL(
+         g_settings.rewind_compression,
+         "rewind_compression",
+         "Rewind Compression",
+         rewind_compression,
+         "OFF",
+         "ON",
+         group_info.name,
+         subgroup_info.name,
+         general_write_handler,
+         general_read_handler);
+#endif
+
    CONFIG_BOOL(
          g_settings.block_sram_overwrite,
          "block_sram_overwrite",
@@ -4375,6 +4632,20 @@ static bool setting_data_append_list_video_options(
    settings_data_list_current_add_flags(list, list_info, SD_FLAG_CMD_APPLY_AUTO);
 #endif
 
+#ifdef HAVE_THREADS
+   CONFIG_BOOL(
+         g_settings.video.shader_async,
+         "video_shader_async",
+         "Background Shader Loading",
+         shader_async,
+         "OFF",
+         "ON",
+         group_info.name,
+         subgroup_info.name,
+         general_write_handler,
+         general_read_handler);
+#endif
+
    CONFIG_BOOL(
          g_settings.video.vsync,
          "video_vsync",
@@ -4423,6 +4694,20 @@ static bool setting_data_append_list_video_options(
          general_read_handler);
    settings_list_current_add_range(list, list_info, 0, 3, 1, true, true);
 
+   CONFIG_BOOL(
+         g_settings.video.pbo_upload,
+         "video_pbo_upload",
+         "PBO Frame Upload",
+         pbo_upload,
+         "OFF",
+         "ON",
+         group_info.name,
+         subgroup_info.name,
+         general_write_handler,
+         general_read_handler);
+   settings_list_current_add_cmd(list, list_info, RARCH_CMD_REINIT);
+   settings_data_list_current_add_flags(list, list_info, SD_FLAG_CMD_APPLY_AUTO);
+
    CONFIG_UINT(
          g_settings.video.frame_delay,
          "video_frame_delay",
@@ -4433,6 +4718,29 @@ static bool setting_data_append_list_video_options(
          general_write_handler,
          general_read_handler);
    settings_list_current_add_range(list, list_info, 0, 15, 1, true, true);
+
+   CONFIG_BOOL(
+         g_settings.video.frame_delay_auto,
+         "video_frame_delay_auto",
+         "Automatic Frame Delay",
+         frame_delay_auto,
+         "OFF",
+         "ON",
+         group_info.name,
+         subgroup_info.name,
+         general_write_handler,
+         general_read_handler);
+
+   CONFIG_UINT(
+         g_settings.run_ahead_frames,
+         "run_ahead_frames",
+         "Run-Ahead Frames",
+         run_ahead_frames,
+         group_info.name,
+         subgroup_info.name,
+         general_write_handler,
+         general_read_handler);
+   settings_list_current_add_range(list, list_info, 0, 6, 1, true, true);
 #if !defined(RARCH_MOBILE)
    CONFIG_BOOL(
          g_settings.video.black_frame_insertion,
@@ -4852,6 +5160,20 @@ static bool setting_data_append_list_audio_options(
          general_write_handler,
          general_read_handler);
 
+   CONFIG_UINT(
+         g_settings.audio.resampler_quality,
+         "audio_resampler_quality",
+         "Resampler Quality",
+         audio_resampler_quality,
+         group_info.name,
+         subgroup_info.name,
+         general_write_handler,
+         general_read_handler);
+   settings_list_current_add_range(list, list_info, 1, 5, 1.0, true, true);
+   settings_list_current_add_cmd(list, list_info, RARCH_CMD_AUDIO_REINIT);
+   (*list)[list_info->index - 1].get_string_representation = 
+      &setting_data_get_string_representation_uint_audio_resampler_quality;
+
    CONFIG_PATH(
          g_settings.audio.dsp_plugin,
          "audio_dsp_plugin",
@@ -4865,6 +5187,21 @@ static bool setting_data_append_list_audio_options(
    settings_list_current_add_cmd(list, list_info, RARCH_CMD_DSP_FILTER_INIT);
    settings_data_list_current_add_flags(list, list_info, SD_FLAG_ALLOW_EMPTY);
 
+#ifdef HAVE_THREADS
+   CONFIG_BOOL(
+         g_settings.audio.dsp_thread,
+         "audio_dsp_thread",
+         "Threaded DSP",
+         audio_dsp_thread,
+         "OFF",
+         "ON",
+         group_info.name,
+         subgroup_info.name,
+         general_write_handler,
+         general_read_handler);
+   settings_list_current_add_cmd(list, list_info, RARCH_CMD_AUDIO_REINIT);
+#endif
+
    END_SUB_GROUP(list, list_info);
    END_GROUP(list, list_info);
 
@@ -5704,6 +6041,29 @@ static bool setting_data_append_list_netplay_options(
          general_read_handler);
    settings_list_current_add_range(list, list_info, 0, 10, 1, true, false);
 
+   CONFIG_UINT(
+         g_settings.input.netplay_input_latency_frames,
+         "netplay_input_latency_frames",
+         "Netplay Input Latency Frames",
+         netplay_input_latency_frames,
+         group_info.name,
+         subgroup_info.name,
+         general_write_handler,
+         general_read_handler);
+   settings_list_current_add_range(list, list_info, 0, 8, 1, true, true);
+
+   CONFIG_BOOL(
+         g_settings.input.netplay_input_latency_auto,
+         "netplay_input_latency_auto",
+         "Netplay Automatic Input Latency",
+         netplay_input_latency_auto,
+         "OFF",
+         "ON",
+         group_info.name,
+         subgroup_info.name,
+         general_write_handler,
+         general_read_handler);
+
    CONFIG_UINT(
          g_extern.netplay_port,
          "netplay_tcp_udp_port",